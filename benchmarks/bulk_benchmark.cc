@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "camera_movement.pb.h"
+#include "cave_talk_bulk.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+#include "movement.pb.h"
+
+/* Compares decoding a recording of Movement and CameraMovement frames one message at a time, parsing each and handing
+ * it to a callback, against decoding the whole recording into column arrays with CaveTalk_BulkDecode. One frame in
+ * kZeroEvery stops the robot, which the encoders send without its zero fields and which takes the fallback path.
+ * Messages come in runs of kRunLength frames, one CameraMovement run to every three Movement runs, as a log sorted
+ * or split by id would hold them. */
+
+static const std::size_t kFrames    = 1000000U;
+static const std::size_t kZeroEvery = 64U;
+static const std::size_t kRunLength = 256U;
+static const std::size_t kRounds    = 5U;
+
+struct Columns
+{
+    std::vector<double> first;
+    std::vector<double> second;
+};
+
+static std::vector<uint8_t> Record(void)
+{
+    std::vector<uint8_t> recording;
+    uint8_t              payload[32U];
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        const double  time   = static_cast<double>(index) / 50.0;
+        const bool    stop   = (0U == (index % kZeroEvery));
+        const bool    camera = (0U == ((index / kRunLength) % 4U));
+        CaveTalk_Id_t id     = CAVE_TALK_ID_MOVEMENT;
+        int           length = 0;
+
+        if (camera)
+        {
+            cave_talk::CameraMovement camera_movement;
+
+            camera_movement.set_pan_angle_radians(stop ? 0.0 : std::sin(time));
+            camera_movement.set_tilt_angle_radians(stop ? 0.0 : std::cos(time));
+            camera_movement.SerializeToArray(payload, sizeof(payload));
+            length = static_cast<int>(camera_movement.ByteSizeLong());
+            id     = CAVE_TALK_ID_CAMERA_MOVEMENT;
+        }
+        else
+        {
+            cave_talk::Movement movement;
+
+            movement.set_speed_meters_per_second(stop ? 0.0 : 1.5 * std::sin(time * 0.2));
+            movement.set_turn_rate_radians_per_second(stop ? 0.0 : 0.5 * std::cos(time * 0.7));
+            movement.SerializeToArray(payload, sizeof(payload));
+            length = static_cast<int>(movement.ByteSizeLong());
+        }
+
+        recording.push_back(CAVE_TALK_VERSION);
+        recording.push_back(id);
+        recording.push_back(static_cast<uint8_t>(length));
+        recording.insert(recording.end(), payload, payload + length);
+        recording.insert(recording.end(), CAVE_TALK_CRC_SIZE, 0U);
+    }
+
+    return recording;
+}
+
+static void HearMovement(Columns &columns, const double speed, const double turn_rate)
+{
+    columns.first.push_back(speed);
+    columns.second.push_back(turn_rate);
+}
+
+static void HearCameraMovement(Columns &columns, const double pan, const double tilt)
+{
+    columns.first.push_back(pan);
+    columns.second.push_back(tilt);
+}
+
+static double PerMessage(const std::vector<uint8_t> &recording, Columns &movement, Columns &camera_movement)
+{
+    const auto                start = std::chrono::steady_clock::now();
+    cave_talk::Movement       movement_message;
+    cave_talk::CameraMovement camera_movement_message;
+    std::size_t               offset = 0U;
+
+    movement.first.clear();
+    movement.second.clear();
+    camera_movement.first.clear();
+    camera_movement.second.clear();
+
+    while (offset < recording.size())
+    {
+        const CaveTalk_Id_t     id      = recording[offset + 1U];
+        const CaveTalk_Length_t length  = recording[offset + 2U];
+        const uint8_t *const    payload = &recording[offset + CAVE_TALK_HEADER_SIZE];
+
+        if ((CAVE_TALK_ID_MOVEMENT == id) && movement_message.ParseFromArray(payload, length))
+        {
+            HearMovement(movement, movement_message.speed_meters_per_second(), movement_message.turn_rate_radians_per_second());
+        }
+        else if ((CAVE_TALK_ID_CAMERA_MOVEMENT == id) && camera_movement_message.ParseFromArray(payload, length))
+        {
+            HearCameraMovement(camera_movement, camera_movement_message.pan_angle_radians(), camera_movement_message.tilt_angle_radians());
+        }
+
+        offset += CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double Bulk(const std::vector<uint8_t> &recording, Columns &movement, Columns &camera_movement, CaveTalk_BulkColumns_t &columns)
+{
+    const auto start    = std::chrono::steady_clock::now();
+    size_t     consumed = 0U;
+
+    movement.first.resize(kFrames);
+    movement.second.resize(kFrames);
+    camera_movement.first.resize(kFrames);
+    camera_movement.second.resize(kFrames);
+
+    std::memset(&columns, 0, sizeof(columns));
+    columns.speed                    = movement.first.data();
+    columns.turn_rate                = movement.second.data();
+    columns.movement_capacity        = kFrames;
+    columns.pan                      = camera_movement.first.data();
+    columns.tilt                     = camera_movement.second.data();
+    columns.camera_movement_capacity = kFrames;
+
+    if (CAVE_TALK_ERROR_NONE != CaveTalk_BulkDecode(&columns, recording.data(), recording.size(), &consumed))
+    {
+        std::fprintf(stderr, "bulk decode failed at byte %zu\n", consumed);
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void)
+{
+    const std::vector<uint8_t> recording = Record();
+    Columns                    movement;
+    Columns                    camera_movement;
+    Columns                    bulk_movement;
+    Columns                    bulk_camera_movement;
+    CaveTalk_BulkColumns_t     columns;
+    double                     per_message = INFINITY;
+    double                     bulk        = INFINITY;
+
+    for (std::size_t round = 0U; round < kRounds; round++)
+    {
+        per_message = std::fmin(per_message, PerMessage(recording, movement, camera_movement));
+        bulk        = std::fmin(bulk, Bulk(recording, bulk_movement, bulk_camera_movement, columns));
+    }
+
+    /* Both decoders must agree before their times mean anything */
+    const bool agree = (movement.first.size() == columns.movement_count) &&
+                       (camera_movement.first.size() == columns.camera_movement_count) &&
+                       std::equal(movement.first.begin(), movement.first.end(), bulk_movement.first.begin()) &&
+                       std::equal(movement.second.begin(), movement.second.end(), bulk_movement.second.begin()) &&
+                       std::equal(camera_movement.first.begin(), camera_movement.first.end(), bulk_camera_movement.first.begin()) &&
+                       std::equal(camera_movement.second.begin(), camera_movement.second.end(), bulk_camera_movement.second.begin());
+
+    if (!agree)
+    {
+        std::fprintf(stderr, "bulk decode disagrees with per message decode\n");
+        return 1;
+    }
+
+    std::printf("%zu frames, %zu bytes, %u fallbacks\n", kFrames, recording.size(), columns.fallbacks);
+    std::printf("per message %7.2f ns/frame %6.1f M frames/s\n", 1e9 * per_message / kFrames, kFrames / per_message / 1e6);
+    std::printf("bulk        %7.2f ns/frame %6.1f M frames/s (%.1fx)\n", 1e9 * bulk / kFrames, kFrames / bulk / 1e6, per_message / bulk);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "cave_talk_delta.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Compares bytes per Movement frame sent whole against delta encoded, for a joystick trace sampled at 50 Hz. Without a
+ * trace file a synthetic one is used: a driver easing in and out of turns with a little stick noise and idle periods.
+ * A trace file holds one "speed,turn_rate" pair per line. */
+
+static const std::size_t   kSamples          = 50U * 60U * 5U;
+static const double        kQuantum          = 0.001;
+static const uint32_t      kKeyframeInterval = 50U;
+static const CaveTalk_Id_t kIdMovement       = 2U; /* See ids.proto */
+static const std::size_t   kAbsoluteSize     = 18U; /* Movement with both doubles set */
+
+struct Sample
+{
+    double speed;
+    double turn_rate;
+};
+
+static std::vector<Sample> Synthetic(void)
+{
+    std::vector<Sample> samples;
+    uint32_t            noise = 12345U;
+
+    for (std::size_t index = 0U; index < kSamples; index++)
+    {
+        const double time = static_cast<double>(index) / 50.0;
+
+        noise = (noise * 1103515245U) + 12345U;
+
+        const double jitter = (static_cast<double>((noise >> 16U) & 0xFFU) / 255.0 - 0.5) * 0.004;
+        const bool   idle   = (std::fmod(time, 30.0) > 25.0);
+
+        samples.push_back({.speed     = idle ? 0.0 : (1.2 * std::sin(time * 0.2) + jitter),
+                           .turn_rate = idle ? 0.0 : (0.8 * std::sin(time * 0.7) * std::cos(time * 0.05) + jitter)});
+    }
+
+    return samples;
+}
+
+static std::vector<Sample> Load(const char *const path)
+{
+    std::vector<Sample> samples;
+    std::FILE *const    file = std::fopen(path, "r");
+    Sample              sample;
+
+    if (nullptr != file)
+    {
+        while (2 == std::fscanf(file, "%lf,%lf", &sample.speed, &sample.turn_rate))
+        {
+            samples.push_back(sample);
+        }
+
+        std::fclose(file);
+    }
+
+    return samples;
+}
+
+int main(int argc, char *argv[])
+{
+    const std::vector<Sample> samples = (argc > 1) ? Load(argv[1]) : Synthetic();
+    CaveTalk_DeltaStream_t    stream;
+    uint8_t                   data[CAVE_TALK_DELTA_SIZE_MAX];
+    uint64_t                  delta_bytes = 0U;
+
+    if (samples.empty())
+    {
+        std::fprintf(stderr, "no samples in %s\n", argv[1]);
+        return 1;
+    }
+
+    CaveTalk_DeltaInit(&stream, kIdMovement, kQuantum, kKeyframeInterval);
+
+    for (const Sample &sample : samples)
+    {
+        const double      values[CAVE_TALK_DELTA_VALUES] = {sample.speed, sample.turn_rate};
+        CaveTalk_Length_t length                         = 0U;
+
+        CaveTalk_DeltaEncode(&stream, values, data, sizeof(data), &length);
+        delta_bytes += CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+    }
+
+    const double absolute = static_cast<double>(CAVE_TALK_HEADER_SIZE + kAbsoluteSize + CAVE_TALK_CRC_SIZE);
+    const double delta    = static_cast<double>(delta_bytes) / samples.size();
+
+    std::printf("%zu samples, %u keyframes, %u deltas\n", samples.size(), stream.counters.keyframes, stream.counters.deltas);
+    std::printf("absolute %6.2f bytes/frame\n", absolute);
+    std::printf("delta    %6.2f bytes/frame (%.0f%% of absolute)\n", delta, 100.0 * delta / absolute);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "cave_talk_engine.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Measures how the relay rate of the sharded engine scales with its shard count. Both ends of every socket pair are
+ * attached, and consecutive attaches land on different shards, so with two or more shards every frame heard on one end
+ * is handed off to the shard of the other end and sent back across the pair. A few frames are kept in flight in each
+ * direction of every pair, so shards are never idle waiting on each other. Every pair is attached and its partners
+ * recorded before the first frame is written, so the relay never reads a partner that is still being filled in. */
+
+static const std::size_t kPairs          = 128U;
+static const std::size_t kLinksPerShard  = 2U * kPairs;
+static const std::size_t kFramesInFlight = 8U;
+static const std::size_t kHandoffSlots   = 2U * kPairs * kFramesInFlight; /* Every frame in flight fits, none are dropped */
+static const uint8_t     kPayloadSize    = 8U;
+static const auto        kDuration       = std::chrono::seconds(1);
+
+static void Relay(void *const context,
+                  CaveTalk_Engine_t *const engine,
+                  const std::size_t shard,
+                  const uint32_t link,
+                  const CaveTalk_Id_t id,
+                  const uint8_t *const payload,
+                  const CaveTalk_Length_t length)
+{
+    const std::vector<uint32_t> &partners = *static_cast<const std::vector<uint32_t> *>(context);
+
+    CaveTalk_EngineSend(engine, shard, partners[CAVE_TALK_ENGINE_LINK_INDEX(link)], id, payload, length);
+}
+
+static uint64_t FramesIn(const CaveTalk_Engine_t &engine, const std::size_t shards, uint64_t *const handed_off, uint64_t *const dropped)
+{
+    uint64_t frames = 0U;
+
+    *handed_off = 0U;
+    *dropped    = 0U;
+
+    for (std::size_t shard = 0U; shard < shards; shard++)
+    {
+        CaveTalk_EngineCounters_t counters;
+
+        CaveTalk_EngineCounters(&engine, shard, &counters);
+        frames      += counters.frames_in;
+        *handed_off += counters.handed_off;
+        *dropped    += counters.dropped;
+    }
+
+    return frames;
+}
+
+/* Returns frames relayed per second */
+static double Run(const std::size_t shards, double *const handoff_share, uint64_t *const dropped)
+{
+    CaveTalk_Engine_t                                                              engine;
+    std::vector<uint32_t>                                                          partners(shards * kLinksPerShard);
+    std::vector<int>                                                               seeds;
+    std::array<uint8_t, CAVE_TALK_HEADER_SIZE + kPayloadSize + CAVE_TALK_CRC_SIZE> frame      = {CAVE_TALK_VERSION, 2U, kPayloadSize};
+    uint64_t                                                                       handed_off = 0U;
+
+    CaveTalk_EngineOpen(&engine, shards, kLinksPerShard, kHandoffSlots, true, Relay, &partners);
+
+    /* The engine owns the attached ends, so the frames in flight are seeded through duplicates of them */
+    for (std::size_t pair = 0U; pair < kPairs; pair++)
+    {
+        std::array<int, 2U>      fds   = {-1, -1};
+        std::array<uint32_t, 2U> links = {0U, 0U};
+
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data());
+        seeds.push_back(dup(fds[0U]));
+        seeds.push_back(dup(fds[1U]));
+
+        CaveTalk_EngineAttach(&engine, fds[0U], &links[0U]);
+        CaveTalk_EngineAttach(&engine, fds[1U], &links[1U]);
+        partners[CAVE_TALK_ENGINE_LINK_INDEX(links[0U])] = links[1U];
+        partners[CAVE_TALK_ENGINE_LINK_INDEX(links[1U])] = links[0U];
+    }
+
+    for (const int fd : seeds)
+    {
+        for (std::size_t frame_index = 0U; frame_index < kFramesInFlight; frame_index++)
+        {
+            if (static_cast<ssize_t>(frame.size()) != write(fd, frame.data(), frame.size()))
+            {
+                std::fprintf(stderr, "Failed to seed socket pair\n");
+            }
+        }
+
+        close(fd);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const uint64_t before = FramesIn(engine, shards, &handed_off, dropped);
+    const auto     start  = std::chrono::steady_clock::now();
+    const uint64_t handed = handed_off;
+
+    std::this_thread::sleep_for(kDuration);
+
+    const uint64_t after   = FramesIn(engine, shards, &handed_off, dropped);
+    const double   seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CaveTalk_EngineClose(&engine);
+
+    *handoff_share = (after == before) ? 0.0 : 100.0 * static_cast<double>(handed_off - handed) / static_cast<double>(after - before);
+
+    return static_cast<double>(after - before) / seconds;
+}
+
+int main(void)
+{
+    const std::size_t cores    = (0U == std::thread::hardware_concurrency()) ? 1U : std::thread::hardware_concurrency();
+    double            baseline = 0.0;
+
+    std::printf("%zu cores, %zu socket pairs, %zu frames in flight each way\n", cores, kPairs, kFramesInFlight);
+    std::printf("%8s %14s %10s %12s %10s\n", "shards", "frames/s", "speedup", "handed off", "dropped");
+
+    /* Two shards are always run so the handoff path is measured even on a single core */
+    for (std::size_t shards = 1U; (shards <= cores) || (shards <= 2U); shards *= 2U)
+    {
+        double       handoff_share = 0.0;
+        uint64_t     dropped       = 0U;
+        const double rate          = Run(shards, &handoff_share, &dropped);
+
+        if (1U == shards)
+        {
+            baseline = rate;
+        }
+
+        std::printf("%8zu %14.0f %9.2fx %11.1f%% %10llu\n", shards, rate, rate / baseline, handoff_share, static_cast<unsigned long long>(dropped));
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_router.h"
+#include "cave_talk_types.h"
+
+/* Forwards frames between an operator link and a growing number of robot links held in memory, so the router itself is
+ * measured rather than a transport. Operator frames fan out to every robot and robot frames fan in to the operator. */
+
+static const std::size_t kLinkCounts[]    = {2U, 4U, 8U, 16U};
+static const std::size_t kQueueSlots      = 64U;
+static const std::size_t kBudget          = 16U;
+static const std::size_t kPayloadSize     = 18U;
+static const auto        kRunTime         = std::chrono::milliseconds(500);
+static const std::size_t kFramesPerStream = 64U;
+
+/* An endless stream of frames on the input side, sent frames are counted and discarded */
+struct MemoryLink
+{
+    std::vector<uint8_t> stream;
+    std::size_t offset = 0U;
+    uint64_t bytes_sent = 0U;
+};
+
+static CaveTalk_Error_t MemorySend(void *const context, const void *const data, const size_t size)
+{
+    CAVE_TALK_UNUSED(data);
+
+    static_cast<MemoryLink *>(context)->bytes_sent += size;
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t MemoryReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    MemoryLink *const link  = static_cast<MemoryLink *>(context);
+    uint8_t *const    bytes = static_cast<uint8_t *>(data);
+
+    for (std::size_t index = 0U; index < size; index++)
+    {
+        bytes[index] = link->stream[link->offset];
+        link->offset = (link->offset + 1U) % link->stream.size();
+    }
+
+    *bytes_received = size;
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t MemoryAvailable(void *const context, size_t *const bytes_available)
+{
+    *bytes_available = static_cast<MemoryLink *>(context)->stream.size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static void Run(const std::size_t link_count)
+{
+    const CaveTalk_RouterRule_t rules[] = {
+        {.sources = 1U, .id = 2U, .destinations = CAVE_TALK_ROUTER_LINKS_ALL},
+        {.sources = CAVE_TALK_ROUTER_LINKS_ALL & ~1U, .id = CAVE_TALK_ROUTER_ID_ANY, .destinations = 1U},
+    };
+    std::vector<MemoryLink>            memory_links(link_count);
+    std::vector<CaveTalk_LinkHandle_t> link_handles(link_count, kCaveTalk_LinkHandleNull);
+    std::vector<uint8_t>               queues(link_count * kQueueSlots * CAVE_TALK_ROUTER_FRAME_SIZE_MAX);
+    std::vector<CaveTalk_RouterLink_t> links(link_count);
+    CaveTalk_Router_t                  router;
+
+    for (std::size_t index = 0U; index < link_count; index++)
+    {
+        const CaveTalk_LinkBinding_t binding = {&memory_links[index], MemorySend, MemoryReceive, MemoryAvailable};
+
+        for (std::size_t frame = 0U; frame < kFramesPerStream; frame++)
+        {
+            memory_links[index].stream.insert(memory_links[index].stream.end(), {CAVE_TALK_VERSION, 2U, kPayloadSize});
+            memory_links[index].stream.insert(memory_links[index].stream.end(), kPayloadSize + CAVE_TALK_CRC_SIZE, 0U);
+        }
+
+        CaveTalk_LinkBind(&binding, &link_handles[index]);
+        CaveTalk_RouterLinkInit(&links[index],
+                                &link_handles[index],
+                                &queues[index * kQueueSlots * CAVE_TALK_ROUTER_FRAME_SIZE_MAX],
+                                kQueueSlots * CAVE_TALK_ROUTER_FRAME_SIZE_MAX);
+    }
+
+    CaveTalk_RouterInit(&router, links.data(), links.size(), rules, sizeof(rules) / sizeof(rules[0]), kBudget);
+
+    uint64_t   forwarded = 0U;
+    const auto begin     = std::chrono::steady_clock::now();
+    auto       now       = begin;
+
+    while ((now - begin) < kRunTime)
+    {
+        for (std::size_t pass = 0U; pass < 64U; pass++)
+        {
+            std::size_t sent = 0U;
+
+            CaveTalk_RouterPoll(&router, &sent);
+            forwarded += sent;
+        }
+
+        now = std::chrono::steady_clock::now();
+    }
+
+    const std::chrono::duration<double> elapsed = now - begin;
+
+    std::printf("%4zu links %12.0f frames/s %8.1f ns/frame\n", link_count, forwarded / elapsed.count(), (elapsed.count() * 1e9) / forwarded);
+
+    for (const CaveTalk_LinkHandle_t &link_handle : link_handles)
+    {
+        CaveTalk_LinkUnbind(&link_handle);
+    }
+}
+
+int main(void)
+{
+    for (const std::size_t link_count : kLinkCounts)
+    {
+        Run(link_count);
+    }
+
+    return 0;
+}
\ No newline at end of file
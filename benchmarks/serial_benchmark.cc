@@ -0,0 +1,256 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_serial.h"
+#include "cave_talk_types.h"
+
+/* Compares the serial backend against the straightforward backend that maps each link callback onto one system call,
+ * over a pseudo terminal pair. The peer delivers frames in bursts the way a UART driver hands over its FIFO. */
+
+static const std::size_t kFrames         = 200000U;
+static const std::size_t kFramesPerBurst = 32U;
+static const std::size_t kPayloadSize    = 18U;
+
+static int      naive_fd       = -1;
+static uint64_t naive_syscalls = 0U;
+
+static CaveTalk_Error_t NaiveSend(const void *const data, const size_t size)
+{
+    naive_syscalls++;
+
+    return (static_cast<ssize_t>(size) == write(naive_fd, data, size)) ? CAVE_TALK_ERROR_NONE : CAVE_TALK_ERROR_IO;
+}
+
+/* Blocks until the whole request is read so frames are never split */
+static CaveTalk_Error_t NaiveReceive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    *bytes_received = 0U;
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (*bytes_received < size))
+    {
+        const ssize_t result = read(naive_fd, static_cast<uint8_t *>(data) + *bytes_received, size - *bytes_received);
+
+        naive_syscalls++;
+
+        if (result > 0)
+        {
+            *bytes_received += static_cast<size_t>(result);
+        }
+        else
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t NaiveAvailable(size_t *const bytes_available)
+{
+    int bytes = 0;
+
+    naive_syscalls++;
+    ioctl(naive_fd, FIONREAD, &bytes);
+    *bytes_available = static_cast<size_t>(bytes);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static uint64_t NaiveSyscalls(void)
+{
+    return naive_syscalls;
+}
+
+static const CaveTalk_LinkHandle_t kNaiveLinkHandle = {
+    .send      = NaiveSend,
+    .receive   = NaiveReceive,
+    .available = NaiveAvailable,
+};
+
+struct Result
+{
+    std::size_t frames;
+    double frames_per_second;
+    double syscalls_per_frame;
+};
+
+static int OpenPeer(std::string &path)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+    if ((master < 0) || (0 != grantpt(master)) || (0 != unlockpt(master)))
+    {
+        std::perror("posix_openpt");
+        std::exit(EXIT_FAILURE);
+    }
+
+    path = ptsname(master);
+
+    return master;
+}
+
+static void OpenNaive(const std::string &path)
+{
+    struct termios attributes;
+
+    naive_fd = open(path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    tcgetattr(naive_fd, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(naive_fd, TCSANOW, &attributes);
+    naive_syscalls = 0U;
+}
+
+/* Writes bursts of frames to the peer end until every frame is sent */
+static std::thread Transmit(const int master, std::atomic<bool> &done)
+{
+    return std::thread([master, &done]() {
+        std::vector<uint8_t> burst;
+
+        for (std::size_t index = 0U; index < kFramesPerBurst; index++)
+        {
+            burst.insert(burst.end(), {CAVE_TALK_VERSION, 1U, kPayloadSize});
+            burst.insert(burst.end(), kPayloadSize + CAVE_TALK_CRC_SIZE, 0U);
+        }
+
+        for (std::size_t sent = 0U; sent < kFrames; sent += kFramesPerBurst)
+        {
+            std::size_t offset = 0U;
+
+            while (offset < burst.size())
+            {
+                const ssize_t result = write(master, burst.data() + offset, burst.size() - offset);
+                offset += (result > 0) ? static_cast<std::size_t>(result) : 0U;
+            }
+        }
+
+        done = true;
+    });
+}
+
+/* Reads and discards everything written to the peer end */
+static std::thread Drain(const int master, const std::size_t bytes)
+{
+    return std::thread([master, bytes]() {
+        std::array<uint8_t, 4096U> buffer;
+        std::size_t                drained = 0U;
+
+        while (drained < bytes)
+        {
+            const ssize_t result = read(master, buffer.data(), buffer.size());
+            drained += (result > 0) ? static_cast<std::size_t>(result) : 0U;
+        }
+    });
+}
+
+static Result Listen(const CaveTalk_LinkHandle_t &link_handle, const int master, const std::function<uint64_t()> &syscalls)
+{
+    std::array<uint8_t, UINT8_MAX> data;
+    CaveTalk_Id_t                  id     = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t              length = 0U;
+    std::size_t                    heard  = 0U;
+    bool                           idle   = false;
+    std::atomic<bool>              done   = false;
+    const uint64_t                 start  = syscalls();
+    const auto                     begin  = std::chrono::steady_clock::now();
+    std::thread                    peer   = Transmit(master, done);
+
+    /* Frames lost by a backend would never arrive, so also stop once the peer is done and the link is idle */
+    while ((heard < kFrames) && !idle)
+    {
+        const bool finished = done;
+
+        if ((CAVE_TALK_ERROR_NONE == CaveTalk_Listen(&link_handle, &id, data.data(), data.size(), &length)) && (CAVE_TALK_ID_NONE != id))
+        {
+            heard++;
+        }
+        else
+        {
+            idle = finished && (CAVE_TALK_ID_NONE == id);
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    peer.join();
+
+    return {heard, heard / elapsed.count(), static_cast<double>(syscalls() - start) / heard};
+}
+
+static Result Speak(const CaveTalk_LinkHandle_t &link_handle, const int master, const std::function<uint64_t()> &syscalls)
+{
+    const std::array<uint8_t, kPayloadSize> payload = {};
+    const uint64_t                          start   = syscalls();
+    const auto                              begin   = std::chrono::steady_clock::now();
+    std::thread                             peer    = Drain(master, kFrames * (CAVE_TALK_HEADER_SIZE + kPayloadSize + CAVE_TALK_CRC_SIZE));
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        while (CAVE_TALK_ERROR_NONE != CaveTalk_Speak(&link_handle, 1U, payload.data(), payload.size()))
+        {
+        }
+    }
+
+    peer.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    return {kFrames, kFrames / elapsed.count(), static_cast<double>(syscalls() - start) / kFrames};
+}
+
+static void Report(const char *const name, const Result &result)
+{
+    std::printf("%-16s %8zu frames %12.0f frames/s %8.3f syscalls/frame\n", name, result.frames, result.frames_per_second, result.syscalls_per_frame);
+    std::fflush(stdout);
+}
+
+int main(void)
+{
+    std::string path;
+    int         master = OpenPeer(path);
+
+    OpenNaive(path);
+    Report("naive listen", Listen(kNaiveLinkHandle, master, NaiveSyscalls));
+    Report("naive speak", Speak(kNaiveLinkHandle, master, NaiveSyscalls));
+    close(naive_fd);
+    close(master);
+
+    std::array<uint8_t, 8192U> buffer;
+    CaveTalk_Serial_t          serial;
+    CaveTalk_LinkHandle_t      link_handle = kCaveTalk_LinkHandleNull;
+
+    master = OpenPeer(path);
+
+    if (CAVE_TALK_ERROR_NONE != CaveTalk_SerialOpen(&serial, path.c_str(), &kCaveTalk_SerialConfigDefault, buffer.data(), buffer.size(), &link_handle))
+    {
+        std::fprintf(stderr, "Failed to open %s\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    /* Every read and write the backend issues is counted in its stats */
+    const auto serial_syscalls = [&serial]() {
+        return serial.stats.reads + serial.stats.writes;
+    };
+
+    Report("serial listen", Listen(link_handle, master, serial_syscalls));
+    Report("serial speak", Speak(link_handle, master, serial_syscalls));
+
+    CaveTalk_SerialClose(&serial);
+    close(master);
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
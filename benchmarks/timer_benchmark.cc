@@ -0,0 +1,188 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+
+/* Compares the timer wheel against a sorted map, the usual ordered container for timers, at 1k to 100k links. Each
+ * link has a periodic heartbeat timer with an interval between 10 ms and 1 s, and a retransmit timer that is started
+ * when a frame goes out and cancelled when it is acknowledged. Time is simulated in 1 ms ticks. */
+
+static const CaveTalk_Microseconds_t kTick              = 1000U;
+static const CaveTalk_Microseconds_t kDuration          = 10U * 1000U * 1000U;
+static const CaveTalk_Microseconds_t kRetransmitTimeout = 200U * 1000U;
+static const std::size_t             kSendsPerTick      = 100U;
+
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+struct Link
+{
+    CaveTalk_TimerWheel_t *wheel;
+    CaveTalk_Timer_t heartbeat;
+    CaveTalk_Timer_t retransmit;
+    CaveTalk_Microseconds_t interval;
+    uint64_t beats;
+};
+
+static void Beat(void *const context)
+{
+    Link *const link = static_cast<Link *>(context);
+
+    link->beats++;
+    CaveTalk_TimerStart(link->wheel, &link->heartbeat, link->interval);
+}
+
+static void Retransmit(void *const context)
+{
+    CAVE_TALK_UNUSED(context);
+}
+
+static std::vector<CaveTalk_Microseconds_t> Intervals(const std::size_t links)
+{
+    std::vector<CaveTalk_Microseconds_t> intervals;
+    uint32_t                             noise = 12345U;
+
+    for (std::size_t index = 0U; index < links; index++)
+    {
+        noise = (noise * 1103515245U) + 12345U;
+        intervals.push_back((10U + ((noise >> 8U) % 991U)) * 1000U);
+    }
+
+    return intervals;
+}
+
+static double Seconds(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Returns ns per timer operation, each fired, started or cancelled timer counting as one */
+static double Wheel(const std::vector<CaveTalk_Microseconds_t> &intervals)
+{
+    CaveTalk_TimerWheel_t wheel;
+    std::vector<Link>     links(intervals.size());
+    uint64_t              operations = 0U;
+    std::size_t           fired      = 0U;
+    std::size_t           sender     = 0U;
+
+    now = 0U;
+    CaveTalk_TimerWheelInit(&wheel, Clock, kTick);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t index = 0U; index < links.size(); index++)
+    {
+        links[index].wheel    = &wheel;
+        links[index].interval = intervals[index];
+        links[index].beats    = 0U;
+        CaveTalk_TimerInit(&links[index].heartbeat, Beat, &links[index]);
+        CaveTalk_TimerInit(&links[index].retransmit, Retransmit, &links[index]);
+        CaveTalk_TimerStart(&wheel, &links[index].heartbeat, intervals[index]);
+    }
+
+    while (now < kDuration)
+    {
+        now += kTick;
+
+        for (std::size_t send = 0U; send < kSendsPerTick; send++)
+        {
+            Link &link = links[sender];
+
+            CaveTalk_TimerCancel(&wheel, &link.retransmit);
+            CaveTalk_TimerStart(&wheel, &link.retransmit, kRetransmitTimeout);
+            sender = (sender + 1U) % links.size();
+        }
+
+        CaveTalk_TimerWheelAdvance(&wheel, &fired);
+        operations += (2U * kSendsPerTick) + (2U * fired);
+    }
+
+    return 1e9 * Seconds(start) / static_cast<double>(operations + links.size());
+}
+
+static double Map(const std::vector<CaveTalk_Microseconds_t> &intervals)
+{
+    struct Entry
+    {
+        std::size_t link;
+        bool heartbeat;
+    };
+
+    using Timers = std::multimap<CaveTalk_Microseconds_t, Entry>;
+
+    Timers                        timers;
+    std::vector<Timers::iterator> retransmits(intervals.size(), timers.end());
+    std::vector<uint64_t>         beats(intervals.size(), 0U);
+    uint64_t                      operations = 0U;
+    std::size_t                   sender     = 0U;
+
+    now = 0U;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t index = 0U; index < intervals.size(); index++)
+    {
+        timers.emplace(intervals[index], Entry{.link = index, .heartbeat = true});
+    }
+
+    while (now < kDuration)
+    {
+        now += kTick;
+
+        for (std::size_t send = 0U; send < kSendsPerTick; send++)
+        {
+            if (timers.end() != retransmits[sender])
+            {
+                timers.erase(retransmits[sender]);
+            }
+
+            retransmits[sender] = timers.emplace(now + kRetransmitTimeout, Entry{.link = sender, .heartbeat = false});
+            sender              = (sender + 1U) % intervals.size();
+        }
+
+        while (!timers.empty() && (timers.begin()->first <= now))
+        {
+            const Entry entry = timers.begin()->second;
+
+            timers.erase(timers.begin());
+            operations += 2U;
+
+            if (entry.heartbeat)
+            {
+                beats[entry.link]++;
+                timers.emplace(now + intervals[entry.link], entry);
+            }
+            else
+            {
+                retransmits[entry.link] = timers.end();
+            }
+        }
+
+        operations += 2U * kSendsPerTick;
+    }
+
+    return 1e9 * Seconds(start) / static_cast<double>(operations + intervals.size());
+}
+
+int main(void)
+{
+    std::printf("%8s %12s %12s\n", "links", "wheel ns/op", "map ns/op");
+
+    for (const std::size_t links : {1000U, 10000U, 100000U})
+    {
+        const std::vector<CaveTalk_Microseconds_t> intervals = Intervals(links);
+
+        std::printf("%8zu %12.1f %12.1f\n", links, Wheel(intervals), Map(intervals));
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+#include "cave_talk_uring.h"
+
+/* Compares the io_uring backend against the plain backend that maps each link callback onto one read, write or ioctl,
+ * over a TCP loopback connection. Both listen until nothing is available and then sleep until the link is readable,
+ * while the peer sends frames in bursts from another thread. CPU time is that of the listening or speaking thread only,
+ * kernel time included. */
+
+static const std::size_t kFrames         = 200000U;
+static const std::size_t kFramesPerBurst = 32U;
+static const std::size_t kPayloadSize    = 18U;
+static const std::size_t kFrameSize      = CAVE_TALK_HEADER_SIZE + kPayloadSize + CAVE_TALK_CRC_SIZE;
+
+static int      plain_fd       = -1;
+static uint64_t plain_syscalls = 0U;
+
+static CaveTalk_Error_t PlainSend(const void *const data, const size_t size)
+{
+    plain_syscalls++;
+
+    return (static_cast<ssize_t>(size) == write(plain_fd, data, size)) ? CAVE_TALK_ERROR_NONE : CAVE_TALK_ERROR_IO;
+}
+
+/* Blocks until the whole request is read so frames are never split */
+static CaveTalk_Error_t PlainReceive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    *bytes_received = 0U;
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (*bytes_received < size))
+    {
+        const ssize_t result = read(plain_fd, static_cast<uint8_t *>(data) + *bytes_received, size - *bytes_received);
+
+        plain_syscalls++;
+
+        if (result > 0)
+        {
+            *bytes_received += static_cast<size_t>(result);
+        }
+        else
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t PlainAvailable(size_t *const bytes_available)
+{
+    int bytes = 0;
+
+    plain_syscalls++;
+    ioctl(plain_fd, FIONREAD, &bytes);
+    *bytes_available = static_cast<size_t>(bytes);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t PlainWait(void *const context, const CaveTalk_Microseconds_t timeout)
+{
+    struct pollfd poll_fd = {plain_fd, POLLIN, 0};
+
+    CAVE_TALK_UNUSED(context);
+    plain_syscalls++;
+    poll(&poll_fd, 1U, static_cast<int>(timeout / 1000U));
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static uint64_t PlainSyscalls(void)
+{
+    return plain_syscalls;
+}
+
+static const CaveTalk_LinkHandle_t kPlainLinkHandle = {
+    .send      = PlainSend,
+    .receive   = PlainReceive,
+    .available = PlainAvailable,
+};
+
+struct Result
+{
+    std::size_t frames;
+    double frames_per_second;
+    double syscalls_per_frame;
+    double cpu_ns_per_frame;
+};
+
+struct Backend
+{
+    const CaveTalk_LinkHandle_t *link_handle;
+    std::function<uint64_t()> syscalls;
+    std::function<CaveTalk_Error_t(const CaveTalk_Microseconds_t)> wait;
+    std::function<CaveTalk_Error_t()> flush;
+};
+
+static double CpuSeconds(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_THREAD, &usage);
+
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + (1e-6 * static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec));
+}
+
+/* Connects a pair of TCP sockets over loopback without Nagle's delay */
+static void Connect(int &local, int &peer)
+{
+    const int          listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const int          enable   = 1;
+    struct sockaddr_in address  = {};
+    socklen_t          length   = sizeof(address);
+
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if ((listener < 0) ||
+        (0 != bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address))) ||
+        (0 != listen(listener, 1)) ||
+        (0 != getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length)))
+    {
+        std::perror("listen");
+        std::exit(EXIT_FAILURE);
+    }
+
+    local = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if ((local < 0) || (0 != connect(local, reinterpret_cast<sockaddr *>(&address), sizeof(address))))
+    {
+        std::perror("connect");
+        std::exit(EXIT_FAILURE);
+    }
+
+    peer = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    setsockopt(local, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    close(listener);
+}
+
+static Result Listen(const Backend &backend, const int peer)
+{
+    std::array<uint8_t, UINT8_MAX> data;
+    CaveTalk_Id_t                  id     = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t              length = 0U;
+    std::size_t                    heard  = 0U;
+    const uint64_t                 start  = backend.syscalls();
+    const double                   cpu    = CpuSeconds();
+    const auto                     begin  = std::chrono::steady_clock::now();
+    auto                           last   = begin;
+
+    std::thread sender([peer]() {
+        std::vector<uint8_t> burst;
+
+        for (std::size_t index = 0U; index < kFramesPerBurst; index++)
+        {
+            burst.insert(burst.end(), {CAVE_TALK_VERSION, 1U, kPayloadSize});
+            burst.insert(burst.end(), kPayloadSize + CAVE_TALK_CRC_SIZE, 0U);
+        }
+
+        for (std::size_t sent = 0U; sent < kFrames; sent += kFramesPerBurst)
+        {
+            std::size_t offset = 0U;
+
+            while (offset < burst.size())
+            {
+                const ssize_t result = write(peer, burst.data() + offset, burst.size() - offset);
+                offset += (result > 0) ? static_cast<std::size_t>(result) : 0U;
+            }
+        }
+    });
+
+    /* Frames lost by a backend would never arrive, so give up after a second without any */
+    while ((heard < kFrames) && ((std::chrono::steady_clock::now() - last) < std::chrono::seconds(1)))
+    {
+        if ((CAVE_TALK_ERROR_NONE == CaveTalk_Listen(backend.link_handle, &id, data.data(), data.size(), &length)) && (CAVE_TALK_ID_NONE != id))
+        {
+            heard++;
+            last = std::chrono::steady_clock::now();
+        }
+        else
+        {
+            backend.wait(1000U);
+        }
+    }
+
+    const double                        cpu_seconds = CpuSeconds() - cpu;
+    const std::chrono::duration<double> elapsed     = std::chrono::steady_clock::now() - begin;
+    sender.join();
+
+    return {heard, heard / elapsed.count(), static_cast<double>(backend.syscalls() - start) / heard, 1e9 * cpu_seconds / heard};
+}
+
+static Result Speak(const Backend &backend, const int peer)
+{
+    const std::array<uint8_t, kPayloadSize> payload = {};
+    const uint64_t                          start   = backend.syscalls();
+    const double                            cpu     = CpuSeconds();
+    const auto                              begin   = std::chrono::steady_clock::now();
+
+    std::thread drain([peer]() {
+        std::array<uint8_t, 65536U> buffer;
+        std::size_t                 drained = 0U;
+
+        while (drained < (kFrames * kFrameSize))
+        {
+            const ssize_t result = read(peer, buffer.data(), buffer.size());
+            drained += (result > 0) ? static_cast<std::size_t>(result) : 0U;
+        }
+    });
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        while (CAVE_TALK_ERROR_NONE != CaveTalk_Speak(backend.link_handle, 1U, payload.data(), payload.size()))
+        {
+        }
+    }
+
+    backend.flush();
+
+    const double cpu_seconds = CpuSeconds() - cpu;
+    drain.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    return {kFrames, kFrames / elapsed.count(), static_cast<double>(backend.syscalls() - start) / kFrames, 1e9 * cpu_seconds / kFrames};
+}
+
+static void Report(const char *const name, const Result &result)
+{
+    std::printf("%-20s %8zu frames %12.0f frames/s %8.3f syscalls/frame %8.0f cpu ns/frame\n",
+                name,
+                result.frames,
+                result.frames_per_second,
+                result.syscalls_per_frame,
+                result.cpu_ns_per_frame);
+    std::fflush(stdout);
+}
+
+int main(void)
+{
+    int local = -1;
+    int peer  = -1;
+
+    Connect(local, peer);
+    plain_fd = local;
+
+    const Backend plain = {
+        &kPlainLinkHandle,
+        PlainSyscalls,
+        [](const CaveTalk_Microseconds_t timeout) { return PlainWait(nullptr, timeout); },
+        []() { return CAVE_TALK_ERROR_NONE; },
+    };
+
+    Report("plain listen", Listen(plain, peer));
+    Report("plain speak", Speak(plain, peer));
+    close(local);
+    close(peer);
+
+    for (const std::size_t batch : {1U, CAVE_TALK_URING_BATCH_SIZE_MAX})
+    {
+        std::array<uint8_t, 16384U> buffer;
+        CaveTalk_Uring_t            uring;
+        CaveTalk_LinkHandle_t       link_handle = kCaveTalk_LinkHandleNull;
+        std::array<char, 32U>       name;
+
+        Connect(local, peer);
+
+        if (CAVE_TALK_ERROR_NONE != CaveTalk_UringOpen(&uring, local, batch, buffer.data(), buffer.size(), &link_handle))
+        {
+            std::fprintf(stderr, "Failed to set up io_uring\n");
+            return EXIT_FAILURE;
+        }
+
+        /* Every io_uring_enter the backend makes is counted in its stats, reaping completions makes none */
+        const Backend backend = {
+            &link_handle,
+            [&uring]() { return uring.stats.enters; },
+            [&uring](const CaveTalk_Microseconds_t timeout) { return CaveTalk_UringWait(&uring, timeout); },
+            [&uring]() { return CaveTalk_UringFlush(&uring); },
+        };
+
+        std::snprintf(name.data(), name.size(), "uring listen");
+        Report(name.data(), Listen(backend, peer));
+        std::snprintf(name.data(), name.size(), "uring speak x%zu", batch);
+        Report(name.data(), Speak(backend, peer));
+
+        CaveTalk_UringClose(&uring);
+        close(local);
+        close(peer);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
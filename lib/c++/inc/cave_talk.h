@@ -1,14 +1,38 @@
 #ifndef CAVE_TALK_H
 #define CAVE_TALK_H
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
 #include <cstddef>
-#include <functional>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+#include "camera_movement.pb.h"
+#include "heartbeat.pb.h"
+#include "ids.pb.h"
+#include "lights.pb.h"
+#include "mode.pb.h"
+#include "movement.pb.h"
 #include "ooga_booga.pb.h"
 
+#include "cave_talk_delta.h"
+#include "cave_talk_fragment.h"
+#include "cave_talk_heartbeat.h"
 #include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_negotiation.h"
+#include "cave_talk_pacer.h"
+#include "cave_talk_reliable.h"
+#include "cave_talk_timer.h"
 #include "cave_talk_types.h"
 
 namespace cave_talk
@@ -16,6 +40,116 @@ namespace cave_talk
 
 const std::size_t kMaxPayloadSize = 255;
 
+constexpr std::size_t VarintSize(const uint64_t value)
+{
+    return (value < 0x80U) ? 1U : (1U + VarintSize(value >> 7U));
+}
+
+// Largest protobuf encoding of each field type, every field number is below 16 and takes a one byte tag
+const std::size_t kTagSize         = 1U;
+const std::size_t kDoubleFieldSize = kTagSize + sizeof(double);
+const std::size_t kBoolFieldSize   = kTagSize + 1U;
+const std::size_t kUint64FieldSize = kTagSize + VarintSize(UINT64_MAX);
+
+// Frames below the messages, listed in a Listener's message set so its buffer also fits ACKs and reliable frames,
+// fragment frames of up to kFrameSize bytes, or Hello frames
+struct ReliableFrame {};
+template <std::size_t kFrameSize> struct FragmentFrame {};
+struct HelloFrame {};
+
+// kMaxSize is the largest encoding of a message, kFrameSize the largest frame that is not a message
+template <typename Message> struct MessageTraits;
+
+template <> struct MessageTraits<OogaBooga>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_OOGA;
+    static constexpr std::size_t kMaxSize   = kTagSize + VarintSize(Say_MAX);
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<Movement>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_MOVEMENT;
+    static constexpr std::size_t kMaxSize   = 2U * kDoubleFieldSize;
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<CameraMovement>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_CAMERA_MOVEMENT;
+    static constexpr std::size_t kMaxSize   = 2U * kDoubleFieldSize;
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<Lights>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_LIGHTS;
+    static constexpr std::size_t kMaxSize   = kBoolFieldSize;
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<Mode>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_MODE;
+    static constexpr std::size_t kMaxSize   = kBoolFieldSize;
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<Ping>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_PING;
+    static constexpr std::size_t kMaxSize   = kUint64FieldSize;
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<Pong>
+{
+    static constexpr uint32_t kIds          = 1UL << ID_PONG;
+    static constexpr std::size_t kMaxSize   = 3U * kUint64FieldSize;
+    static constexpr std::size_t kFrameSize = 0U;
+};
+
+template <> struct MessageTraits<ReliableFrame>
+{
+    static constexpr uint32_t kIds          = 0U;
+    static constexpr std::size_t kMaxSize   = 0U;
+    static constexpr std::size_t kFrameSize = CAVE_TALK_RELIABLE_ACK_SIZE;
+};
+
+template <std::size_t kSize> struct MessageTraits<FragmentFrame<kSize>>
+{
+    static constexpr uint32_t kIds          = 0U;
+    static constexpr std::size_t kMaxSize   = 0U;
+    static constexpr std::size_t kFrameSize = kSize;
+};
+
+template <> struct MessageTraits<HelloFrame>
+{
+    static constexpr uint32_t kIds          = 0U;
+    static constexpr std::size_t kMaxSize   = 0U;
+    static constexpr std::size_t kFrameSize = CAVE_TALK_NEGOTIATION_HELLO_SIZE;
+};
+
+template <typename... Messages> struct MessageSet
+{
+    template <typename Message> static constexpr bool kContains = (std::is_same_v<Message, Messages> || ...);
+
+    static constexpr uint32_t kIds             = (MessageTraits<Messages>::kIds | ... | 0U);
+    static constexpr std::size_t kMaxSize      = std::max({std::size_t{0U}, MessageTraits<Messages>::kMaxSize...});
+    static constexpr std::size_t kMaxFrameSize = std::max({std::size_t{0U}, MessageTraits<Messages>::kFrameSize...});
+    static constexpr std::size_t kBufferSize   = std::max(kMaxSize + (kContains<ReliableFrame> ? CAVE_TALK_RELIABLE_HEADER_SIZE : 0U), kMaxFrameSize);
+
+    static_assert(kBufferSize > 0U, "The message set is empty");
+    static_assert(kBufferSize <= kMaxPayloadSize, "A message in the set does not fit in a frame");
+};
+
+// Storage for the Talker and Listener buffers, a base class so it is constructed before the base that uses it
+template <std::size_t kSize> class MessageBuffer
+{
+    protected:
+        std::array<uint8_t, kSize> message_buffer_storage_;
+};
+
 class ListenerCallbacks
 {
     public:
@@ -25,48 +159,578 @@ class ListenerCallbacks
         virtual void HearCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)                     = 0;
         virtual void HearLights(const bool headlights)                                                                 = 0;
         virtual void HearMode(const bool manual)                                                                       = 0;
+        // Fragmented objects are optional, listeners that never take them need not override this
+        virtual void HearObject(const CaveTalk_Id_t /*id*/, const uint8_t *const /*data*/, const std::size_t /*length*/) {}
+};
+
+class Heartbeat
+{
+    public:
+        Heartbeat(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                  CaveTalk_Clock_t clock,
+                  const CaveTalk_Microseconds_t interval);
+        Heartbeat(Heartbeat &heartbeat)                  = delete;
+        Heartbeat(Heartbeat &&heartbeat)                 = delete;
+        Heartbeat &operator=(const Heartbeat &heartbeat) = delete;
+        Heartbeat &operator=(Heartbeat &&heartbeat)      = delete;
+        CaveTalk_Error_t Beat(void);
+        CaveTalk_Error_t HearPing(const CaveTalk_Microseconds_t originate);
+        CaveTalk_Error_t HearPong(const CaveTalk_Microseconds_t originate, const CaveTalk_Microseconds_t receive, const CaveTalk_Microseconds_t transmit);
+        bool Alive(const CaveTalk_Microseconds_t timeout) const;
+        CaveTalk_Microseconds_t RoundTripTime(void) const;
+        CaveTalk_Microseconds_t SmoothedRoundTripTime(void) const;
+        int64_t ClockOffset(void) const;
+
+    private:
+        CaveTalk_LinkHandle_t link_handle_;
+        CaveTalk_Heartbeat_t heartbeat_;
+        std::array<uint8_t, MessageSet<Ping, Pong>::kBufferSize> message_buffer_;
 };
 
-class Listener
+class TimerWheel;
+
+class Reliable
+{
+    public:
+        Reliable(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                 CaveTalk_Clock_t clock,
+                 const std::size_t send_slot_count,
+                 const std::size_t receive_slot_count);
+        Reliable(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                 CaveTalk_Clock_t clock,
+                 const std::size_t send_slot_count,
+                 const std::size_t receive_slot_count,
+                 std::pmr::memory_resource *const memory_resource);
+        Reliable(Reliable &reliable)                  = delete;
+        Reliable(Reliable &&reliable)                 = delete;
+        Reliable &operator=(const Reliable &reliable) = delete;
+        Reliable &operator=(Reliable &&reliable)      = delete;
+        ~Reliable();
+        CaveTalk_Error_t Enable(const CaveTalk_Id_t id, const bool enable);
+        bool Enabled(const CaveTalk_Id_t id) const;
+        CaveTalk_Error_t Speak(const CaveTalk_Id_t id, const void *const data, const CaveTalk_Length_t length);
+        CaveTalk_Error_t Retransmit(void);
+        CaveTalk_Error_t HearAck(const void *const data, const CaveTalk_Length_t length);
+        CaveTalk_Error_t Hear(const void *const data, const CaveTalk_Length_t length, CaveTalk_ReliableFrame_t &frame);
+        bool Next(CaveTalk_ReliableFrame_t &frame);
+        std::size_t InFlight(void) const;
+        bool Deadline(CaveTalk_Microseconds_t &deadline) const;
+        CaveTalk_Error_t Schedule(TimerWheel &timer_wheel);
+        CaveTalk_Microseconds_t RetransmissionTimeout(void) const;
+        CaveTalk_Microseconds_t SmoothedRoundTripTime(void) const;
+        const CaveTalk_ReliableCounters_t &Counters(void) const;
+
+    private:
+        CaveTalk_LinkHandle_t link_handle_;
+        std::pmr::vector<CaveTalk_ReliableSlot_t> send_slots_;
+        std::pmr::vector<CaveTalk_ReliableSlot_t> receive_slots_;
+        CaveTalk_Reliable_t reliable_{};
+};
+
+class Pacer
+{
+    public:
+        Pacer(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+              CaveTalk_Clock_t clock,
+              const uint32_t rate,
+              const uint32_t burst,
+              const std::size_t slot_count);
+        Pacer(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+              CaveTalk_Clock_t clock,
+              const uint32_t rate,
+              const uint32_t burst,
+              const std::size_t slot_count,
+              std::pmr::memory_resource *const memory_resource);
+        ~Pacer();
+        Pacer(Pacer &pacer)                  = delete;
+        Pacer(Pacer &&pacer)                 = delete;
+        Pacer &operator=(const Pacer &pacer) = delete;
+        Pacer &operator=(Pacer &&pacer)      = delete;
+        CaveTalk_Error_t Speak(const CaveTalk_Id_t id, const void *const data, const CaveTalk_Length_t length);
+        CaveTalk_Error_t Drain(void);
+        CaveTalk_Microseconds_t Delay(void) const;
+        const CaveTalk_PacerCounters_t &Counters(void) const;
+        // Give this to the Heartbeat, Reliable, Fragmenter and Negotiation on the same link, so the frames they send
+        // without waiting are charged to the bucket
+        decltype(CaveTalk_LinkHandle_t::send) Send(void) const;
+        CaveTalk_Error_t Error(void) const;
+
+    private:
+        CaveTalk_LinkHandle_t link_handle_;
+        CaveTalk_LinkHandle_t charged_link_handle_;
+        std::pmr::vector<CaveTalk_PacerSlot_t> slots_;
+        CaveTalk_Pacer_t pacer_{};
+        CaveTalk_Error_t error_;
+};
+
+class Negotiation;
+
+class Fragmenter
 {
     public:
-        Listener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
-                 CaveTalk_Error_t (*available)(size_t *const bytes_available),
-                 std::shared_ptr<ListenerCallbacks> listener_callbacks);
-        Listener(Listener &listener)                  = delete;
-        Listener(Listener &&listener)                 = delete;
-        Listener &operator=(const Listener &listener) = delete;
-        Listener &operator=(Listener &&listener)      = delete;
+        Fragmenter(CaveTalk_Error_t (*send)(const void *const data, const size_t size), const uint8_t stream, const std::size_t frame_size);
+        Fragmenter(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                   const uint8_t stream,
+                   const std::size_t frame_size,
+                   std::shared_ptr<Negotiation> negotiation);
+        Fragmenter(Fragmenter &fragmenter)                  = delete;
+        Fragmenter(Fragmenter &&fragmenter)                 = delete;
+        Fragmenter &operator=(const Fragmenter &fragmenter) = delete;
+        Fragmenter &operator=(Fragmenter &&fragmenter)      = delete;
+        CaveTalk_Error_t Start(const CaveTalk_Id_t id, const uint32_t length);
+        std::size_t ChunkSize(void) const;
+        CaveTalk_Error_t Speak(const void *const data, const std::size_t size);
+        void Abort(void);
+        bool Active(void) const;
+
+    private:
+        void Limit(void);
+        CaveTalk_LinkHandle_t link_handle_;
+        CaveTalk_Fragmenter_t fragmenter_;
+        std::shared_ptr<Negotiation> negotiation_;
+};
+
+class Reassembler
+{
+    public:
+        Reassembler(const std::size_t pool_size, const std::size_t slot_count);
+        Reassembler(const std::size_t pool_size, const std::size_t slot_count, std::pmr::memory_resource *const memory_resource);
+        Reassembler(Reassembler &reassembler)                  = delete;
+        Reassembler(Reassembler &&reassembler)                 = delete;
+        Reassembler &operator=(const Reassembler &reassembler) = delete;
+        Reassembler &operator=(Reassembler &&reassembler)      = delete;
+        ~Reassembler();
+        CaveTalk_Error_t Hear(const void *const data, const CaveTalk_Length_t length, CaveTalk_FragmentObject_t &object);
+        bool Deadline(CaveTalk_Microseconds_t &deadline) const;
+        CaveTalk_Error_t Schedule(TimerWheel &timer_wheel, const CaveTalk_Microseconds_t timeout);
+        const CaveTalk_ReassemblerCounters_t &Counters(void) const;
+
+    private:
+        std::pmr::vector<uint8_t> pool_;
+        std::pmr::vector<CaveTalk_ReassemblySlot_t> slots_;
+        CaveTalk_Reassembler_t reassembler_{};
+};
+
+class Delta
+{
+    public:
+        Delta(const double quantum, const uint32_t keyframe_interval);
+        Delta(Delta &delta)                  = delete;
+        Delta(Delta &&delta)                 = delete;
+        Delta &operator=(const Delta &delta) = delete;
+        Delta &operator=(Delta &&delta)      = delete;
+        CaveTalk_Error_t Encode(const CaveTalk_Id_t id, const double first, const double second, std::span<uint8_t> buffer, CaveTalk_Length_t &length);
+        CaveTalk_Error_t Decode(const void *const data, const CaveTalk_Length_t length, CaveTalk_Id_t &id, double &first, double &second);
+        void Keyframe(void);
+        const CaveTalk_DeltaCounters_t &Counters(const CaveTalk_Id_t id) const;
+
+    private:
+        std::array<CaveTalk_DeltaStream_t, 2U> streams_;
+};
+
+class Negotiation
+{
+    public:
+        Negotiation(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                    CaveTalk_Clock_t clock,
+                    const uint32_t capabilities,
+                    const CaveTalk_Length_t max_payload,
+                    const CaveTalk_Microseconds_t retry_interval,
+                    const uint32_t attempts);
+        Negotiation(Negotiation &negotiation)                  = delete;
+        Negotiation(Negotiation &&negotiation)                 = delete;
+        Negotiation &operator=(const Negotiation &negotiation) = delete;
+        Negotiation &operator=(Negotiation &&negotiation)      = delete;
+        void Start(void);
+        CaveTalk_Error_t Poll(void);
+        CaveTalk_Error_t Hear(const void *const data, const CaveTalk_Length_t length);
+        bool Allows(const uint32_t capability) const;
+        CaveTalk_NegotiationState_t State(void) const;
+        uint8_t PeerRevision(void) const;
+        uint32_t AgreedCapabilities(void) const;
+        CaveTalk_Length_t AgreedMaxPayload(void) const;
+
+    private:
+        CaveTalk_LinkHandle_t link_handle_;
+        CaveTalk_Negotiation_t negotiation_;
+};
+
+class TimerWheel
+{
+    public:
+        TimerWheel(CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t tick);
+        TimerWheel(TimerWheel &timer_wheel)                  = delete;
+        TimerWheel(TimerWheel &&timer_wheel)                 = delete;
+        TimerWheel &operator=(const TimerWheel &timer_wheel) = delete;
+        TimerWheel &operator=(TimerWheel &&timer_wheel)      = delete;
+        CaveTalk_Error_t Start(CaveTalk_Timer_t &timer, const CaveTalk_Microseconds_t timeout);
+        CaveTalk_Error_t Cancel(CaveTalk_Timer_t &timer);
+        std::size_t Advance(void);
+        std::size_t Active(void) const;
+        CaveTalk_Error_t Error(void) const;
+        CaveTalk_TimerWheel_t &Wheel(void);
+
+    private:
+        CaveTalk_TimerWheel_t timer_wheel_{};
+        CaveTalk_Error_t error_;
+};
+
+class ListenerBase
+{
+    public:
+        ListenerBase(ListenerBase &listener)                  = delete;
+        ListenerBase(ListenerBase &&listener)                 = delete;
+        ListenerBase &operator=(const ListenerBase &listener) = delete;
+        ListenerBase &operator=(ListenerBase &&listener)      = delete;
         CaveTalk_Error_t Listen(void);
+        CaveTalk_Error_t ListenUntil(CaveTalk_ListenState_t &listen_state, const CaveTalk_Microseconds_t deadline);
+
+    protected:
+        ListenerBase(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                     CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                     std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                     std::shared_ptr<Heartbeat> heartbeat,
+                     std::shared_ptr<Reliable> reliable,
+                     std::shared_ptr<Reassembler> reassembler,
+                     std::shared_ptr<Delta> delta,
+                     std::shared_ptr<Negotiation> negotiation,
+                     std::span<uint8_t> buffer,
+                     const uint32_t ids);
+        ~ListenerBase() = default;
 
     private:
+        CaveTalk_Error_t HandleFrame(const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+        CaveTalk_Error_t Dispatch(const CaveTalk_Id_t id, const CaveTalk_Length_t length) const;
+        CaveTalk_Error_t HandleReliable(const CaveTalk_Length_t length);
+        CaveTalk_Error_t HandleFragment(const CaveTalk_Length_t length);
+        CaveTalk_Error_t HandleDelta(const CaveTalk_Length_t length);
         CaveTalk_Error_t HandleOogaBooga(const CaveTalk_Length_t length) const;
         CaveTalk_Error_t HandleMovement(const CaveTalk_Length_t length) const;
         CaveTalk_Error_t HandleCameraMovement(const CaveTalk_Length_t length) const;
         CaveTalk_Error_t HandleLights(const CaveTalk_Length_t length) const;
         CaveTalk_Error_t HandleMode(const CaveTalk_Length_t length) const;
+        CaveTalk_Error_t HandlePing(const CaveTalk_Length_t length) const;
+        CaveTalk_Error_t HandlePong(const CaveTalk_Length_t length) const;
         CaveTalk_LinkHandle_t link_handle_;
         std::shared_ptr<ListenerCallbacks> listener_callbacks_;
-        std::array<uint8_t, kMaxPayloadSize> buffer_;
+        std::shared_ptr<Heartbeat> heartbeat_;
+        std::shared_ptr<Reliable> reliable_;
+        std::shared_ptr<Reassembler> reassembler_;
+        std::shared_ptr<Delta> delta_;
+        std::shared_ptr<Negotiation> negotiation_;
+        std::span<uint8_t> buffer_;
+        uint32_t ids_;
 };
 
-class Talker
+// A Listener with a buffer sized for exactly the messages it handles, frames of any other message are rejected
+template <typename... Messages>
+class BasicListener : private MessageBuffer<MessageSet<Messages...>::kBufferSize>, public ListenerBase
 {
     public:
-        explicit Talker(CaveTalk_Error_t (*send)(const void *const data, const size_t size));
-        Talker(Talker &talker)                  = delete;
-        Talker(Talker &&talker)                 = delete;
-        Talker &operator=(const Talker &talker) = delete;
-        Talker &operator=(Talker &&talker)      = delete;
+        BasicListener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                      CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                      std::shared_ptr<ListenerCallbacks> listener_callbacks) :
+            BasicListener(receive, available, listener_callbacks, nullptr, nullptr, nullptr)
+        {
+        }
+        BasicListener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                      CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                      std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                      std::shared_ptr<Heartbeat> heartbeat) :
+            BasicListener(receive, available, listener_callbacks, heartbeat, nullptr, nullptr)
+        {
+        }
+        BasicListener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                      CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                      std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                      std::shared_ptr<Heartbeat> heartbeat,
+                      std::shared_ptr<Reliable> reliable) :
+            BasicListener(receive, available, listener_callbacks, heartbeat, reliable, nullptr)
+        {
+        }
+        BasicListener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                      CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                      std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                      std::shared_ptr<Heartbeat> heartbeat,
+                      std::shared_ptr<Reliable> reliable,
+                      std::shared_ptr<Reassembler> reassembler) :
+            BasicListener(receive, available, listener_callbacks, heartbeat, reliable, reassembler, nullptr)
+        {
+        }
+        BasicListener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                      CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                      std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                      std::shared_ptr<Heartbeat> heartbeat,
+                      std::shared_ptr<Reliable> reliable,
+                      std::shared_ptr<Reassembler> reassembler,
+                      std::shared_ptr<Delta> delta) :
+            BasicListener(receive, available, listener_callbacks, heartbeat, reliable, reassembler, delta, nullptr)
+        {
+        }
+        BasicListener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                      CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                      std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                      std::shared_ptr<Heartbeat> heartbeat,
+                      std::shared_ptr<Reliable> reliable,
+                      std::shared_ptr<Reassembler> reassembler,
+                      std::shared_ptr<Delta> delta,
+                      std::shared_ptr<Negotiation> negotiation) :
+            ListenerBase(receive,
+                         available,
+                         listener_callbacks,
+                         heartbeat,
+                         reliable,
+                         reassembler,
+                         delta,
+                         negotiation,
+                         this->message_buffer_storage_,
+                         MessageSet<Messages...>::kIds)
+        {
+        }
+};
+
+using Listener = BasicListener<OogaBooga, Movement, CameraMovement, Lights, Mode, Ping, Pong, ReliableFrame, FragmentFrame<kMaxPayloadSize>, HelloFrame>;
+
+struct DispatcherCounters
+{
+    std::size_t depth                          = 0U;
+    std::size_t max_depth                      = 0U;
+    uint64_t dispatched                        = 0U;
+    uint64_t handled                           = 0U;
+    uint64_t stalls                            = 0U;
+    CaveTalk_Microseconds_t handler_time_total = 0U;
+    CaveTalk_Microseconds_t handler_time_max   = 0U;
+};
+
+/* ListenerCallbacks that run the handlers on a pool of worker threads rather than the listening thread, so a slow
+ * handler for one message does not hold up parsing of the others. Messages of one id are handled one at a time in the
+ * order they were heard, from a queue of at most queue_size messages per id; hearing a message whose queue is full
+ * blocks the listener until its handler catches up. Ids ready to run are spread over the workers, and an idle worker
+ * steals from the back of a busy one's queue. Objects are queued under ID_FRAGMENT. The queues and the copies of objects
+ * are allocated from the memory resource given, the default resource otherwise. */
+class Dispatcher : public ListenerCallbacks
+{
+    public:
+        Dispatcher(std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                   CaveTalk_Clock_t clock,
+                   const std::size_t worker_count,
+                   const std::size_t queue_size);
+        Dispatcher(std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                   CaveTalk_Clock_t clock,
+                   const std::size_t worker_count,
+                   const std::size_t queue_size,
+                   std::pmr::memory_resource *const memory_resource);
+        ~Dispatcher() override;
+        Dispatcher(Dispatcher &dispatcher)                  = delete;
+        Dispatcher(Dispatcher &&dispatcher)                 = delete;
+        Dispatcher &operator=(const Dispatcher &dispatcher) = delete;
+        Dispatcher &operator=(Dispatcher &&dispatcher)      = delete;
+        void HearOogaBooga(const Say ooga_booga) override;
+        void HearMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate) override;
+        void HearCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt) override;
+        void HearLights(const bool headlights) override;
+        void HearMode(const bool manual) override;
+        void HearObject(const CaveTalk_Id_t id, const uint8_t *const data, const std::size_t length) override;
+        void Drain(void);
+        DispatcherCounters Counters(const CaveTalk_Id_t id) const;
+
+    private:
+        // A message waiting for its handler, the fields used depend on the id it is queued under
+        struct Message
+        {
+            explicit Message(std::pmr::memory_resource *const memory_resource) : object(memory_resource)
+            {
+            }
+            Say ooga_booga          = SAY_OOGA;
+            double first            = 0.0;
+            double second           = 0.0;
+            bool value              = false;
+            CaveTalk_Id_t object_id = CAVE_TALK_ID_NONE;
+            std::pmr::vector<uint8_t> object;
+        };
+        struct Strand
+        {
+            using allocator_type = std::pmr::polymorphic_allocator<>;
+            explicit Strand(const allocator_type &allocator) : messages(allocator)
+            {
+            }
+            std::pmr::deque<Message> messages;
+            bool scheduled = false;
+            DispatcherCounters counters;
+        };
+        struct Worker
+        {
+            using allocator_type = std::pmr::polymorphic_allocator<>;
+            explicit Worker(const allocator_type &allocator) : ready(allocator)
+            {
+            }
+            std::mutex mutex;
+            std::pmr::deque<CaveTalk_Id_t> ready;
+        };
+        void Dispatch(const CaveTalk_Id_t id, Message &&message);
+        void Deliver(const CaveTalk_Id_t id, const Message &message);
+        void Schedule(const CaveTalk_Id_t id, const std::size_t worker);
+        bool Take(const std::size_t worker, CaveTalk_Id_t &id);
+        void Work(const std::size_t worker);
+        std::shared_ptr<ListenerCallbacks> listener_callbacks_;
+        CaveTalk_Clock_t clock_;
+        std::size_t queue_size_;
+        std::pmr::memory_resource *memory_resource_;
+        mutable std::mutex mutex_;
+        std::condition_variable space_;
+        std::condition_variable idle_;
+        std::pmr::vector<Strand> strands_;
+        std::size_t pending_;
+        std::pmr::vector<Worker> workers_;
+        std::size_t next_worker_;
+        std::mutex ready_mutex_;
+        std::condition_variable ready_;
+        std::size_t ready_count_;
+        bool stopping_;
+        std::vector<std::thread> threads_;
+};
+
+class TalkerBase
+{
+    public:
+        TalkerBase(TalkerBase &talker)                  = delete;
+        TalkerBase(TalkerBase &&talker)                 = delete;
+        TalkerBase &operator=(const TalkerBase &talker) = delete;
+        TalkerBase &operator=(TalkerBase &&talker)      = delete;
         CaveTalk_Error_t SpeakOogaBooga(const Say ooga_booga);
         CaveTalk_Error_t SpeakMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate);
         CaveTalk_Error_t SpeakCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt);
         CaveTalk_Error_t SpeakLights(const bool headlights);
         CaveTalk_Error_t SpeakMode(const bool manual);
 
+    protected:
+        TalkerBase(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                   std::shared_ptr<Reliable> reliable,
+                   std::shared_ptr<Pacer> pacer,
+                   std::shared_ptr<Delta> delta,
+                   std::shared_ptr<Negotiation> negotiation,
+                   std::span<uint8_t> message_buffer);
+        ~TalkerBase() = default;
+
     private:
+        CaveTalk_Error_t Speak(const google::protobuf::MessageLite &message, const CaveTalk_Id_t id);
+        CaveTalk_Error_t SpeakDelta(const CaveTalk_Id_t id, const double first, const double second);
+        CaveTalk_Error_t SpeakFrame(const CaveTalk_Id_t id, const std::size_t length);
+        bool Allows(const uint32_t capability) const;
         CaveTalk_LinkHandle_t link_handle_;
-        std::array<uint8_t, kMaxPayloadSize> message_buffer_;
+        std::shared_ptr<Reliable> reliable_;
+        std::shared_ptr<Pacer> pacer_;
+        std::shared_ptr<Delta> delta_;
+        std::shared_ptr<Negotiation> negotiation_;
+        std::span<uint8_t> message_buffer_;
+};
+
+// A Talker with a buffer sized for exactly the messages it speaks, speaking any other message does not compile
+template <typename... Messages>
+class BasicTalker : private MessageBuffer<MessageSet<Messages...>::kBufferSize>, public TalkerBase
+{
+    public:
+        explicit BasicTalker(CaveTalk_Error_t (*send)(const void *const data, const size_t size)) : BasicTalker(send, nullptr)
+        {
+        }
+        BasicTalker(CaveTalk_Error_t (*send)(const void *const data, const size_t size), std::shared_ptr<Reliable> reliable) :
+            BasicTalker(send, reliable, nullptr)
+        {
+        }
+        BasicTalker(CaveTalk_Error_t (*send)(const void *const data, const size_t size), std::shared_ptr<Reliable> reliable, std::shared_ptr<Pacer> pacer) :
+            BasicTalker(send, reliable, pacer, nullptr)
+        {
+        }
+        BasicTalker(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                    std::shared_ptr<Reliable> reliable,
+                    std::shared_ptr<Pacer> pacer,
+                    std::shared_ptr<Delta> delta) :
+            BasicTalker(send, reliable, pacer, delta, nullptr)
+        {
+        }
+        BasicTalker(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                    std::shared_ptr<Reliable> reliable,
+                    std::shared_ptr<Pacer> pacer,
+                    std::shared_ptr<Delta> delta,
+                    std::shared_ptr<Negotiation> negotiation) :
+            TalkerBase(send, reliable, pacer, delta, negotiation, this->message_buffer_storage_)
+        {
+        }
+        CaveTalk_Error_t SpeakOogaBooga(const Say ooga_booga)
+        {
+            static_assert(MessageSet<Messages...>::template kContains<OogaBooga>, "OogaBooga is not in the Talker's message set");
+            return TalkerBase::SpeakOogaBooga(ooga_booga);
+        }
+        CaveTalk_Error_t SpeakMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate)
+        {
+            static_assert(MessageSet<Messages...>::template kContains<Movement>, "Movement is not in the Talker's message set");
+            return TalkerBase::SpeakMovement(speed, turn_rate);
+        }
+        CaveTalk_Error_t SpeakCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)
+        {
+            static_assert(MessageSet<Messages...>::template kContains<CameraMovement>, "CameraMovement is not in the Talker's message set");
+            return TalkerBase::SpeakCameraMovement(pan, tilt);
+        }
+        CaveTalk_Error_t SpeakLights(const bool headlights)
+        {
+            static_assert(MessageSet<Messages...>::template kContains<Lights>, "Lights is not in the Talker's message set");
+            return TalkerBase::SpeakLights(headlights);
+        }
+        CaveTalk_Error_t SpeakMode(const bool manual)
+        {
+            static_assert(MessageSet<Messages...>::template kContains<Mode>, "Mode is not in the Talker's message set");
+            return TalkerBase::SpeakMode(manual);
+        }
+};
+
+using Talker = BasicTalker<OogaBooga, Movement, CameraMovement, Lights, Mode>;
+
+struct StateSyncCounters
+{
+    uint64_t frames_sent       = 0U;
+    uint64_t frames_suppressed = 0U;
+    uint64_t keyframes         = 0U;
+    uint64_t bytes_sent        = 0U;
+    uint64_t bytes_saved       = 0U;
+};
+
+/* Send-on-change layer over a Talker for state that rarely changes. Repeated values are suppressed, and Update resends
+ * the full state every keyframe interval, or as soon as the heartbeat sees the peer come alive, so late joiners and
+ * lossy links converge. A keyframe interval of 0 disables periodic keyframes. */
+class StateSync
+{
+    public:
+        StateSync(std::shared_ptr<TalkerBase> talker, CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t keyframe_interval);
+        StateSync(std::shared_ptr<TalkerBase> talker,
+                  CaveTalk_Clock_t clock,
+                  const CaveTalk_Microseconds_t keyframe_interval,
+                  std::shared_ptr<Heartbeat> heartbeat,
+                  const CaveTalk_Microseconds_t timeout);
+        StateSync(StateSync &state_sync)                  = delete;
+        StateSync(StateSync &&state_sync)                 = delete;
+        StateSync &operator=(const StateSync &state_sync) = delete;
+        StateSync &operator=(StateSync &&state_sync)      = delete;
+        CaveTalk_Error_t SpeakLights(const bool headlights);
+        CaveTalk_Error_t SpeakMode(const bool manual);
+        CaveTalk_Error_t Update(void);
+        void ListenerJoined(void);
+        const StateSyncCounters &Counters(void) const;
+
+    private:
+        CaveTalk_Error_t Keyframe(void);
+        static std::size_t BoolMessageSize(const bool value);
+        void Count(const CaveTalk_Error_t error, const std::size_t payload_size, const bool suppressed);
+        std::shared_ptr<TalkerBase> talker_;
+        CaveTalk_Clock_t clock_;
+        CaveTalk_Microseconds_t keyframe_interval_;
+        std::shared_ptr<Heartbeat> heartbeat_;
+        CaveTalk_Microseconds_t timeout_;
+        CaveTalk_Microseconds_t last_keyframe_;
+        bool keyframe_pending_;
+        bool listener_alive_;
+        std::optional<bool> headlights_;
+        std::optional<bool> manual_;
+        StateSyncCounters counters_;
 };
 
 } // namespace cave_talk
@@ -1,31 +1,194 @@
 #include "cave_talk.h"
 
+#include <algorithm>
 #include <cstddef>
-#include <functional>
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
 
 #include "camera_movement.pb.h"
+#include "heartbeat.pb.h"
 #include "ids.pb.h"
 #include "lights.pb.h"
 #include "mode.pb.h"
 #include "movement.pb.h"
 #include "ooga_booga.pb.h"
 
+#include "cave_talk_delta.h"
+#include "cave_talk_fragment.h"
+#include "cave_talk_heartbeat.h"
 #include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_negotiation.h"
+#include "cave_talk_pacer.h"
+#include "cave_talk_reliable.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_trace.h"
 #include "cave_talk_types.h"
 
 namespace cave_talk
 {
 
-Listener::Listener(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
-                   CaveTalk_Error_t (*available)(size_t *const bytes_available),
-                   std::shared_ptr<ListenerCallbacks> listener_callbacks) : listener_callbacks_(listener_callbacks)
+Delta::Delta(const double quantum, const uint32_t keyframe_interval)
+{
+    CaveTalk_DeltaInit(&streams_[0U], static_cast<CaveTalk_Id_t>(ID_MOVEMENT), quantum, keyframe_interval);
+    CaveTalk_DeltaInit(&streams_[1U], static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT), quantum, keyframe_interval);
+}
+
+CaveTalk_Error_t Delta::Encode(const CaveTalk_Id_t id, const double first, const double second, std::span<uint8_t> buffer, CaveTalk_Length_t &length)
+{
+    const double values[CAVE_TALK_DELTA_VALUES] = {first, second};
+
+    for (CaveTalk_DeltaStream_t &stream : streams_)
+    {
+        if (stream.id == id)
+        {
+            return CaveTalk_DeltaEncode(&stream, values, buffer.data(), buffer.size(), &length);
+        }
+    }
+
+    return CAVE_TALK_ERROR_ID;
+}
+
+CaveTalk_Error_t Delta::Decode(const void *const data, const CaveTalk_Length_t length, CaveTalk_Id_t &id, double &first, double &second)
+{
+    double           values[CAVE_TALK_DELTA_VALUES] = {0.0, 0.0};
+    CaveTalk_Error_t error                          = CaveTalk_DeltaDecode(streams_.data(), streams_.size(), static_cast<const uint8_t *>(data), length, &id, values);
+
+    first  = values[0U];
+    second = values[1U];
+
+    return error;
+}
+
+void Delta::Keyframe(void)
+{
+    for (CaveTalk_DeltaStream_t &stream : streams_)
+    {
+        CaveTalk_DeltaKeyframe(&stream);
+    }
+}
+
+const CaveTalk_DeltaCounters_t &Delta::Counters(const CaveTalk_Id_t id) const
+{
+    return (streams_[1U].id == id) ? streams_[1U].counters : streams_[0U].counters;
+}
+
+Negotiation::Negotiation(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                         CaveTalk_Clock_t clock,
+                         const uint32_t capabilities,
+                         const CaveTalk_Length_t max_payload,
+                         const CaveTalk_Microseconds_t retry_interval,
+                         const uint32_t attempts)
+{
+    link_handle_.send      = send;
+    link_handle_.receive   = nullptr;
+    link_handle_.available = nullptr;
+
+    CaveTalk_NegotiationInit(&negotiation_, clock, capabilities, max_payload, retry_interval, attempts);
+}
+
+void Negotiation::Start(void)
+{
+    CaveTalk_NegotiationStart(&negotiation_);
+}
+
+CaveTalk_Error_t Negotiation::Poll(void)
+{
+    return CaveTalk_NegotiationPoll(&negotiation_, &link_handle_);
+}
+
+CaveTalk_Error_t Negotiation::Hear(const void *const data, const CaveTalk_Length_t length)
+{
+    return CaveTalk_NegotiationHear(&negotiation_, &link_handle_, data, length);
+}
+
+bool Negotiation::Allows(const uint32_t capability) const
+{
+    return CaveTalk_NegotiationAllows(&negotiation_, capability);
+}
+
+CaveTalk_NegotiationState_t Negotiation::State(void) const
+{
+    return negotiation_.state;
+}
+
+uint8_t Negotiation::PeerRevision(void) const
+{
+    return negotiation_.peer_revision;
+}
+
+uint32_t Negotiation::AgreedCapabilities(void) const
+{
+    return negotiation_.agreed_capabilities;
+}
+
+CaveTalk_Length_t Negotiation::AgreedMaxPayload(void) const
+{
+    return negotiation_.agreed_max_payload;
+}
+
+TimerWheel::TimerWheel(CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t tick) :
+    error_(CaveTalk_TimerWheelInit(&timer_wheel_, clock, tick))
+{
+}
+
+CaveTalk_Error_t TimerWheel::Start(CaveTalk_Timer_t &timer, const CaveTalk_Microseconds_t timeout)
+{
+    // A wheel whose Init failed has no clock, so timers are refused with the reason it failed
+    return (CAVE_TALK_ERROR_NONE != error_) ? error_ : CaveTalk_TimerStart(&timer_wheel_, &timer, timeout);
+}
+
+CaveTalk_Error_t TimerWheel::Cancel(CaveTalk_Timer_t &timer)
+{
+    return CaveTalk_TimerCancel(&timer_wheel_, &timer);
+}
+
+std::size_t TimerWheel::Advance(void)
+{
+    std::size_t fired = 0U;
+
+    CaveTalk_TimerWheelAdvance(&timer_wheel_, &fired);
+
+    return fired;
+}
+
+std::size_t TimerWheel::Active(void) const
+{
+    return timer_wheel_.active;
+}
+
+CaveTalk_Error_t TimerWheel::Error(void) const
+{
+    return error_;
+}
+
+CaveTalk_TimerWheel_t &TimerWheel::Wheel(void)
+{
+    return timer_wheel_;
+}
+
+ListenerBase::ListenerBase(CaveTalk_Error_t (*receive)(void *const data, const size_t size, size_t *const bytes_received),
+                           CaveTalk_Error_t (*available)(size_t *const bytes_available),
+                           std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                           std::shared_ptr<Heartbeat> heartbeat,
+                           std::shared_ptr<Reliable> reliable,
+                           std::shared_ptr<Reassembler> reassembler,
+                           std::shared_ptr<Delta> delta,
+                           std::shared_ptr<Negotiation> negotiation,
+                           std::span<uint8_t> buffer,
+                           const uint32_t ids) : listener_callbacks_(listener_callbacks), heartbeat_(heartbeat), reliable_(reliable),
+    reassembler_(reassembler), delta_(delta), negotiation_(negotiation), buffer_(buffer), ids_(ids)
 {
     link_handle_.send      = nullptr;
     link_handle_.receive   = receive;
     link_handle_.available = available;
 }
 
-CaveTalk_Error_t Listener::Listen(void)
+CaveTalk_Error_t ListenerBase::Listen(void)
 {
     CaveTalk_Id_t     id     = 0U;
     CaveTalk_Length_t length = 0U;
@@ -33,39 +196,229 @@ CaveTalk_Error_t Listener::Listen(void)
 
     if (CAVE_TALK_ERROR_NONE == error)
     {
-        switch (static_cast<Id>(id))
+        error = HandleFrame(id, length);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t ListenerBase::ListenUntil(CaveTalk_ListenState_t &listen_state, const CaveTalk_Microseconds_t deadline)
+{
+    CaveTalk_Id_t     id     = 0U;
+    CaveTalk_Length_t length = 0U;
+    CaveTalk_Error_t  error  = CaveTalk_ListenUntil(&link_handle_, &listen_state, deadline, &id, buffer_.data(), buffer_.size(), &length);
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        error = HandleFrame(id, length);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t ListenerBase::HandleFrame(const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (ID_RELIABLE == static_cast<Id>(id))
+    {
+        error = HandleReliable(length);
+    }
+    else if (ID_ACK == static_cast<Id>(id))
+    {
+        // Stray ACKs are ignored when reliable delivery is disabled
+        if (reliable_)
+        {
+            error = reliable_->HearAck(buffer_.data(), length);
+        }
+    }
+    else if (ID_FRAGMENT == static_cast<Id>(id))
+    {
+        error = HandleFragment(length);
+    }
+    else if (ID_DELTA == static_cast<Id>(id))
+    {
+        error = HandleDelta(length);
+    }
+    else if (ID_HELLO == static_cast<Id>(id))
+    {
+        // Offers are ignored without negotiation, the peer then falls back to revision 1
+        if (negotiation_)
+        {
+            error = negotiation_->Hear(buffer_.data(), length);
+        }
+    }
+    else
+    {
+        error = Dispatch(id, length);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t ListenerBase::Dispatch(const CaveTalk_Id_t id, const CaveTalk_Length_t length) const
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    CAVE_TALK_TRACE_DECODE(id, length);
+
+    // Messages outside the Listener's message set may not fit its buffer
+    if ((ID_NONE != static_cast<Id>(id)) && ((id >= 32U) || (0U == ((ids_ >> id) & 1U))))
+    {
+        return CAVE_TALK_ERROR_ID;
+    }
+
+    switch (static_cast<Id>(id))
+    {
+    case ID_NONE:
+        if (0U != length)
         {
-        case ID_NONE:
-            if (0U != length)
-            {
-                error = CAVE_TALK_ERROR_ID;
-            }
-            break;
-        case ID_OOGA:
-            error = HandleOogaBooga(length);
-            break;
-        case ID_MOVEMENT:
-            error = HandleMovement(length);
-            break;
-        case ID_CAMERA_MOVEMENT:
-            error = HandleCameraMovement(length);
-            break;
-        case ID_LIGHTS:
-            error = HandleLights(length);
-            break;
-        case ID_MODE:
-            error = HandleMode(length);
-            break;
-        default:
             error = CAVE_TALK_ERROR_ID;
-            break;
         }
+        break;
+    case ID_OOGA:
+        error = HandleOogaBooga(length);
+        break;
+    case ID_MOVEMENT:
+        error = HandleMovement(length);
+        break;
+    case ID_CAMERA_MOVEMENT:
+        error = HandleCameraMovement(length);
+        break;
+    case ID_LIGHTS:
+        error = HandleLights(length);
+        break;
+    case ID_MODE:
+        error = HandleMode(length);
+        break;
+    case ID_PING:
+        error = HandlePing(length);
+        break;
+    case ID_PONG:
+        error = HandlePong(length);
+        break;
+    default:
+        error = CAVE_TALK_ERROR_ID;
+        break;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t ListenerBase::HandleReliable(const CaveTalk_Length_t length)
+{
+    if (!reliable_)
+    {
+        // Reliable delivery disabled, the frame cannot be acknowledged
+        return CAVE_TALK_ERROR_ID;
+    }
+
+    CaveTalk_ReliableFrame_t frame;
+    CaveTalk_Error_t         error = reliable_->Hear(buffer_.data(), length, frame);
+
+    if (CAVE_TALK_ERROR_INCOMPLETE == error)
+    {
+        // Duplicate or buffered until the frames before it arrive
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    if (CAVE_TALK_ERROR_NONE != error)
+    {
+        return error;
+    }
+
+    std::memmove(buffer_.data(), frame.data, frame.length);
+    error = Dispatch(frame.id, frame.length);
+
+    while (reliable_->Next(frame))
+    {
+        CaveTalk_Error_t next_error = CAVE_TALK_ERROR_SIZE;
+
+        if (frame.length <= buffer_.size())
+        {
+            std::memcpy(buffer_.data(), frame.data, frame.length);
+            next_error = Dispatch(frame.id, frame.length);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            error = next_error;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t ListenerBase::HandleFragment(const CaveTalk_Length_t length)
+{
+    if (!reassembler_ || (negotiation_ && !negotiation_->Allows(CAVE_TALK_CAPABILITY_FRAGMENT)))
+    {
+        // Fragmentation disabled, there is no pool to reassemble into or the peer did not offer it
+        return CAVE_TALK_ERROR_ID;
+    }
+
+    CaveTalk_FragmentObject_t object;
+    CaveTalk_Error_t          error = reassembler_->Hear(buffer_.data(), length, object);
+
+    if (CAVE_TALK_ERROR_INCOMPLETE == error)
+    {
+        // More fragments to come, or the object was dropped after a lost fragment
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        CAVE_TALK_TRACE_CALLBACK_ENTRY(object.id);
+        listener_callbacks_->HearObject(object.id, object.data, object.length);
+        CAVE_TALK_TRACE_CALLBACK_EXIT(object.id);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t ListenerBase::HandleDelta(const CaveTalk_Length_t length)
+{
+    if (!delta_)
+    {
+        // Delta encoding disabled, there is no keyframe to apply the delta to
+        return CAVE_TALK_ERROR_ID;
+    }
+
+    CAVE_TALK_TRACE_DECODE(static_cast<CaveTalk_Id_t>(ID_DELTA), length);
+
+    CaveTalk_Id_t    id     = CAVE_TALK_ID_NONE;
+    double           first  = 0.0;
+    double           second = 0.0;
+    CaveTalk_Error_t error  = delta_->Decode(buffer_.data(), length, id, first, second);
+
+    if (CAVE_TALK_ERROR_NONE != error)
+    {
+    }
+    else if ((ID_NONE != static_cast<Id>(id)) && (0U == ((ids_ >> id) & 1U)))
+    {
+        error = CAVE_TALK_ERROR_ID;
+    }
+    else if (ID_MOVEMENT == static_cast<Id>(id))
+    {
+        CAVE_TALK_TRACE_CALLBACK_ENTRY(id);
+        listener_callbacks_->HearMovement(first, second);
+        CAVE_TALK_TRACE_CALLBACK_EXIT(id);
+    }
+    else if (ID_CAMERA_MOVEMENT == static_cast<Id>(id))
+    {
+        CAVE_TALK_TRACE_CALLBACK_ENTRY(id);
+        listener_callbacks_->HearCameraMovement(first, second);
+        CAVE_TALK_TRACE_CALLBACK_EXIT(id);
+    }
+    else
+    {
+        // Dropped, its keyframe was lost
     }
 
     return error;
 }
 
-CaveTalk_Error_t Listener::HandleOogaBooga(CaveTalk_Length_t length) const
+CaveTalk_Error_t ListenerBase::HandleOogaBooga(CaveTalk_Length_t length) const
 {
 
     OogaBooga ooga_booga_message;
@@ -77,12 +430,14 @@ CaveTalk_Error_t Listener::HandleOogaBooga(CaveTalk_Length_t length) const
 
     const Say ooga_booga = ooga_booga_message.ooga_booga();
 
+    CAVE_TALK_TRACE_CALLBACK_ENTRY(static_cast<CaveTalk_Id_t>(ID_OOGA));
     listener_callbacks_->HearOogaBooga(ooga_booga);
+    CAVE_TALK_TRACE_CALLBACK_EXIT(static_cast<CaveTalk_Id_t>(ID_OOGA));
 
     return CAVE_TALK_ERROR_NONE;
 }
 
-CaveTalk_Error_t Listener::HandleMovement(CaveTalk_Length_t length) const
+CaveTalk_Error_t ListenerBase::HandleMovement(CaveTalk_Length_t length) const
 {
 
     Movement movement_message;
@@ -95,12 +450,14 @@ CaveTalk_Error_t Listener::HandleMovement(CaveTalk_Length_t length) const
     const CaveTalk_MetersPerSecond_t  speed     = movement_message.speed_meters_per_second();
     const CaveTalk_RadiansPerSecond_t turn_rate = movement_message.turn_rate_radians_per_second();
 
+    CAVE_TALK_TRACE_CALLBACK_ENTRY(static_cast<CaveTalk_Id_t>(ID_MOVEMENT));
     listener_callbacks_->HearMovement(speed, turn_rate);
+    CAVE_TALK_TRACE_CALLBACK_EXIT(static_cast<CaveTalk_Id_t>(ID_MOVEMENT));
 
     return CAVE_TALK_ERROR_NONE;
 }
 
-CaveTalk_Error_t Listener::HandleCameraMovement(CaveTalk_Length_t length) const
+CaveTalk_Error_t ListenerBase::HandleCameraMovement(CaveTalk_Length_t length) const
 {
 
     CameraMovement camera_movement_message;
@@ -113,12 +470,14 @@ CaveTalk_Error_t Listener::HandleCameraMovement(CaveTalk_Length_t length) const
     const CaveTalk_Radian_t pan  = camera_movement_message.pan_angle_radians();
     const CaveTalk_Radian_t tilt = camera_movement_message.tilt_angle_radians();
 
+    CAVE_TALK_TRACE_CALLBACK_ENTRY(static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT));
     listener_callbacks_->HearCameraMovement(pan, tilt);
+    CAVE_TALK_TRACE_CALLBACK_EXIT(static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT));
 
     return CAVE_TALK_ERROR_NONE;
 }
 
-CaveTalk_Error_t Listener::HandleLights(CaveTalk_Length_t length) const
+CaveTalk_Error_t ListenerBase::HandleLights(CaveTalk_Length_t length) const
 {
 
     Lights lights_message;
@@ -130,12 +489,14 @@ CaveTalk_Error_t Listener::HandleLights(CaveTalk_Length_t length) const
 
     const bool headlights = lights_message.headlights();
 
+    CAVE_TALK_TRACE_CALLBACK_ENTRY(static_cast<CaveTalk_Id_t>(ID_LIGHTS));
     listener_callbacks_->HearLights(headlights);
+    CAVE_TALK_TRACE_CALLBACK_EXIT(static_cast<CaveTalk_Id_t>(ID_LIGHTS));
 
     return CAVE_TALK_ERROR_NONE;
 }
 
-CaveTalk_Error_t Listener::HandleMode(CaveTalk_Length_t length) const
+CaveTalk_Error_t ListenerBase::HandleMode(CaveTalk_Length_t length) const
 {
 
     Mode mode_message;
@@ -147,73 +508,935 @@ CaveTalk_Error_t Listener::HandleMode(CaveTalk_Length_t length) const
 
     const bool manual = mode_message.manual();
 
+    CAVE_TALK_TRACE_CALLBACK_ENTRY(static_cast<CaveTalk_Id_t>(ID_MODE));
     listener_callbacks_->HearMode(manual);
+    CAVE_TALK_TRACE_CALLBACK_EXIT(static_cast<CaveTalk_Id_t>(ID_MODE));
 
     return CAVE_TALK_ERROR_NONE;
 }
 
-Talker::Talker(CaveTalk_Error_t (*send)(const void *const data, const size_t size))
+CaveTalk_Error_t ListenerBase::HandlePing(CaveTalk_Length_t length) const
+{
+
+    Ping ping_message;
+
+    if (!ping_message.ParseFromArray(buffer_.data(), length))
+    {
+        return CAVE_TALK_ERROR_PARSE;
+    }
+
+    if (!heartbeat_)
+    {
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    return heartbeat_->HearPing(ping_message.originate_timestamp_microseconds());
+}
+
+CaveTalk_Error_t ListenerBase::HandlePong(CaveTalk_Length_t length) const
+{
+
+    Pong pong_message;
+
+    if (!pong_message.ParseFromArray(buffer_.data(), length))
+    {
+        return CAVE_TALK_ERROR_PARSE;
+    }
+
+    if (!heartbeat_)
+    {
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    return heartbeat_->HearPong(pong_message.originate_timestamp_microseconds(),
+                                pong_message.receive_timestamp_microseconds(),
+                                pong_message.transmit_timestamp_microseconds());
+}
+
+Heartbeat::Heartbeat(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                     CaveTalk_Clock_t clock,
+                     const CaveTalk_Microseconds_t interval)
 {
     link_handle_.send      = send;
     link_handle_.receive   = nullptr;
     link_handle_.available = nullptr;
+
+    CaveTalk_HeartbeatInit(&heartbeat_, clock, interval);
 }
 
-CaveTalk_Error_t Talker::SpeakOogaBooga(const Say ooga_booga)
+CaveTalk_Error_t Heartbeat::Beat(void)
 {
-    OogaBooga ooga_booga_message;
-    ooga_booga_message.set_ooga_booga(ooga_booga);
+    if (!CaveTalk_HeartbeatDue(&heartbeat_))
+    {
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    Ping ping_message;
+    ping_message.set_originate_timestamp_microseconds(heartbeat_.clock());
 
-    std::size_t length = ooga_booga_message.ByteSizeLong();
-    ooga_booga_message.SerializeToArray(message_buffer_.data(), message_buffer_.max_size());
+    std::size_t length = ping_message.ByteSizeLong();
+    ping_message.SerializeToArray(message_buffer_.data(), message_buffer_.size());
 
-    return CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_OOGA), message_buffer_.data(), length);
+    CaveTalk_Error_t error = CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_PING), message_buffer_.data(), length);
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        CaveTalk_HeartbeatPinged(&heartbeat_, ping_message.originate_timestamp_microseconds());
+    }
+
+    return error;
 }
 
-CaveTalk_Error_t Talker::SpeakMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate)
+CaveTalk_Error_t Heartbeat::HearPing(const CaveTalk_Microseconds_t originate)
 {
-    Movement movement_message;
-    movement_message.set_speed_meters_per_second(speed);
-    movement_message.set_turn_rate_radians_per_second(turn_rate);
+    const CaveTalk_Microseconds_t receive = heartbeat_.clock();
+
+    CaveTalk_HeartbeatHeard(&heartbeat_, receive);
 
-    std::size_t length = movement_message.ByteSizeLong();
-    movement_message.SerializeToArray(message_buffer_.data(), message_buffer_.max_size());
+    Pong pong_message;
+    pong_message.set_originate_timestamp_microseconds(originate);
+    pong_message.set_receive_timestamp_microseconds(receive);
+    pong_message.set_transmit_timestamp_microseconds(heartbeat_.clock());
 
-    return CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_MOVEMENT), message_buffer_.data(), length);
+    std::size_t length = pong_message.ByteSizeLong();
+    pong_message.SerializeToArray(message_buffer_.data(), message_buffer_.size());
+
+    return CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_PONG), message_buffer_.data(), length);
 }
 
-CaveTalk_Error_t Talker::SpeakCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)
+CaveTalk_Error_t Heartbeat::HearPong(const CaveTalk_Microseconds_t originate, const CaveTalk_Microseconds_t receive, const CaveTalk_Microseconds_t transmit)
 {
-    CameraMovement camera_movement_message;
-    camera_movement_message.set_pan_angle_radians(pan);
-    camera_movement_message.set_tilt_angle_radians(tilt);
+    return CaveTalk_HeartbeatPonged(&heartbeat_, originate, receive, transmit, heartbeat_.clock());
+}
+
+bool Heartbeat::Alive(const CaveTalk_Microseconds_t timeout) const
+{
+    return CaveTalk_HeartbeatAlive(&heartbeat_, timeout);
+}
 
-    std::size_t length = camera_movement_message.ByteSizeLong();
-    camera_movement_message.SerializeToArray(message_buffer_.data(), message_buffer_.max_size());
+CaveTalk_Microseconds_t Heartbeat::RoundTripTime(void) const
+{
+    return heartbeat_.round_trip_time;
+}
 
-    return CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT), message_buffer_.data(), length);
+CaveTalk_Microseconds_t Heartbeat::SmoothedRoundTripTime(void) const
+{
+    return heartbeat_.smoothed_round_trip_time;
 }
 
-CaveTalk_Error_t Talker::SpeakLights(const bool headlights)
+int64_t Heartbeat::ClockOffset(void) const
 {
-    Lights lights_message;
-    lights_message.set_headlights(headlights);
+    return heartbeat_.clock_offset;
+}
 
-    std::size_t length = lights_message.ByteSizeLong();
-    lights_message.SerializeToArray(message_buffer_.data(), message_buffer_.max_size());
+Reliable::Reliable(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                   CaveTalk_Clock_t clock,
+                   const std::size_t send_slot_count,
+                   const std::size_t receive_slot_count) :
+    Reliable(send, clock, send_slot_count, receive_slot_count, std::pmr::get_default_resource())
+{
+}
+
+Reliable::Reliable(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                   CaveTalk_Clock_t clock,
+                   const std::size_t send_slot_count,
+                   const std::size_t receive_slot_count,
+                   std::pmr::memory_resource *const memory_resource) : send_slots_(send_slot_count, memory_resource),
+    receive_slots_(receive_slot_count, memory_resource)
+{
+    link_handle_.send      = send;
+    link_handle_.receive   = nullptr;
+    link_handle_.available = nullptr;
 
-    return CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_LIGHTS), message_buffer_.data(), length);
+    CaveTalk_ReliableInit(&reliable_, clock, send_slots_.data(), send_slots_.size(), receive_slots_.data(), receive_slots_.size());
 }
 
-CaveTalk_Error_t Talker::SpeakMode(const bool manual)
+Reliable::~Reliable()
 {
-    Mode mode_message;
-    mode_message.set_manual(manual);
+    CaveTalk_ReliableSchedule(&reliable_, nullptr, nullptr);
+}
+
+CaveTalk_Error_t Reliable::Enable(const CaveTalk_Id_t id, const bool enable)
+{
+    return CaveTalk_ReliableEnable(&reliable_, id, enable);
+}
 
-    std::size_t length = mode_message.ByteSizeLong();
-    mode_message.SerializeToArray(message_buffer_.data(), message_buffer_.max_size());
+bool Reliable::Enabled(const CaveTalk_Id_t id) const
+{
+    return CaveTalk_ReliableEnabled(&reliable_, id);
+}
 
-    return CaveTalk_Speak(&link_handle_, static_cast<CaveTalk_Id_t>(ID_MODE), message_buffer_.data(), length);
+CaveTalk_Error_t Reliable::Speak(const CaveTalk_Id_t id, const void *const data, const CaveTalk_Length_t length)
+{
+    return CaveTalk_ReliableSpeak(&reliable_, &link_handle_, id, data, length);
+}
+
+CaveTalk_Error_t Reliable::Retransmit(void)
+{
+    return CaveTalk_ReliableRetransmit(&reliable_, &link_handle_);
+}
+
+CaveTalk_Error_t Reliable::HearAck(const void *const data, const CaveTalk_Length_t length)
+{
+    return CaveTalk_ReliableHearAck(&reliable_, data, length);
+}
+
+CaveTalk_Error_t Reliable::Hear(const void *const data, const CaveTalk_Length_t length, CaveTalk_ReliableFrame_t &frame)
+{
+    return CaveTalk_ReliableHear(&reliable_, &link_handle_, data, length, &frame);
+}
+
+bool Reliable::Next(CaveTalk_ReliableFrame_t &frame)
+{
+    return CaveTalk_ReliableNext(&reliable_, &frame);
+}
+
+std::size_t Reliable::InFlight(void) const
+{
+    return CaveTalk_ReliableInFlight(&reliable_);
+}
+
+bool Reliable::Deadline(CaveTalk_Microseconds_t &deadline) const
+{
+    return CaveTalk_ReliableDeadline(&reliable_, &deadline);
+}
+
+CaveTalk_Error_t Reliable::Schedule(TimerWheel &timer_wheel)
+{
+    return CaveTalk_ReliableSchedule(&reliable_, &timer_wheel.Wheel(), &link_handle_);
+}
+
+CaveTalk_Microseconds_t Reliable::RetransmissionTimeout(void) const
+{
+    return reliable_.retransmission_timeout;
+}
+
+CaveTalk_Microseconds_t Reliable::SmoothedRoundTripTime(void) const
+{
+    return reliable_.smoothed_round_trip_time;
+}
+
+const CaveTalk_ReliableCounters_t &Reliable::Counters(void) const
+{
+    return reliable_.counters;
+}
+
+Pacer::Pacer(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+             CaveTalk_Clock_t clock,
+             const uint32_t rate,
+             const uint32_t burst,
+             const std::size_t slot_count) : Pacer(send, clock, rate, burst, slot_count, std::pmr::get_default_resource())
+{
+}
+
+Pacer::Pacer(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+             CaveTalk_Clock_t clock,
+             const uint32_t rate,
+             const uint32_t burst,
+             const std::size_t slot_count,
+             std::pmr::memory_resource *const memory_resource) : slots_(slot_count, memory_resource)
+{
+    link_handle_.send      = send;
+    link_handle_.receive   = nullptr;
+    link_handle_.available = nullptr;
+
+    error_ = CaveTalk_PacerInit(&pacer_, clock, rate, burst, slots_.data(), slots_.size());
+
+    // A pacer whose Init failed has no clock to charge against, and without a free binding slot frames sent through
+    // Send() go to the link uncharged
+    if ((CAVE_TALK_ERROR_NONE != error_) ||
+        (CAVE_TALK_ERROR_NONE != CaveTalk_PacerBind(&pacer_, &link_handle_, &charged_link_handle_)))
+    {
+        charged_link_handle_ = link_handle_;
+    }
+}
+
+Pacer::~Pacer()
+{
+    if (CAVE_TALK_ERROR_NONE == error_)
+    {
+        CaveTalk_PacerUnbind(&pacer_);
+    }
+}
+
+CaveTalk_Error_t Pacer::Speak(const CaveTalk_Id_t id, const void *const data, const CaveTalk_Length_t length)
+{
+    return (CAVE_TALK_ERROR_NONE != error_) ? error_ : CaveTalk_PacerSpeak(&pacer_, &link_handle_, id, data, length);
+}
+
+CaveTalk_Error_t Pacer::Drain(void)
+{
+    return (CAVE_TALK_ERROR_NONE != error_) ? error_ : CaveTalk_PacerDrain(&pacer_, &link_handle_);
+}
+
+CaveTalk_Microseconds_t Pacer::Delay(void) const
+{
+    return (CAVE_TALK_ERROR_NONE != error_) ? 0U : CaveTalk_PacerDelay(&pacer_);
+}
+
+const CaveTalk_PacerCounters_t &Pacer::Counters(void) const
+{
+    return pacer_.counters;
+}
+
+decltype(CaveTalk_LinkHandle_t::send) Pacer::Send(void) const
+{
+    return charged_link_handle_.send;
+}
+
+CaveTalk_Error_t Pacer::Error(void) const
+{
+    return error_;
+}
+
+Fragmenter::Fragmenter(CaveTalk_Error_t (*send)(const void *const data, const size_t size), const uint8_t stream, const std::size_t frame_size) :
+    Fragmenter(send, stream, frame_size, nullptr)
+{
+}
+
+Fragmenter::Fragmenter(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                       const uint8_t stream,
+                       const std::size_t frame_size,
+                       std::shared_ptr<Negotiation> negotiation) : negotiation_(negotiation)
+{
+    link_handle_.send      = send;
+    link_handle_.receive   = nullptr;
+    link_handle_.available = nullptr;
+
+    CaveTalk_FragmenterInit(&fragmenter_, stream, frame_size);
+}
+
+CaveTalk_Error_t Fragmenter::Start(const CaveTalk_Id_t id, const uint32_t length)
+{
+    // A peer that did not offer fragments rejects them, so the object is refused before any of it is sent
+    if (negotiation_ && !negotiation_->Allows(CAVE_TALK_CAPABILITY_FRAGMENT))
+    {
+        return CAVE_TALK_ERROR_ID;
+    }
+
+    Limit();
+
+    return CaveTalk_FragmentStart(&fragmenter_, id, length);
+}
+
+std::size_t Fragmenter::ChunkSize(void) const
+{
+    return CaveTalk_FragmentChunkSize(&fragmenter_);
+}
+
+CaveTalk_Error_t Fragmenter::Speak(const void *const data, const std::size_t size)
+{
+    Limit();
+
+    return CaveTalk_FragmentSpeak(&fragmenter_, &link_handle_, data, size);
+}
+
+void Fragmenter::Abort(void)
+{
+    CaveTalk_FragmentAbort(&fragmenter_);
+}
+
+bool Fragmenter::Active(void) const
+{
+    return fragmenter_.active;
+}
+
+// Fragments are cut to the max payload agreed with the peer
+void Fragmenter::Limit(void)
+{
+    if (negotiation_)
+    {
+        CaveTalk_FragmentLimit(&fragmenter_, negotiation_->AgreedMaxPayload());
+    }
+}
+
+Reassembler::Reassembler(const std::size_t pool_size, const std::size_t slot_count) :
+    Reassembler(pool_size, slot_count, std::pmr::get_default_resource())
+{
+}
+
+Reassembler::Reassembler(const std::size_t pool_size, const std::size_t slot_count, std::pmr::memory_resource *const memory_resource) :
+    pool_(pool_size, memory_resource), slots_(slot_count, memory_resource)
+{
+    CaveTalk_ReassemblerInit(&reassembler_, pool_.data(), pool_.size(), slots_.data(), slots_.size());
+}
+
+Reassembler::~Reassembler()
+{
+    CaveTalk_ReassemblerSchedule(&reassembler_, nullptr, 0U);
+}
+
+CaveTalk_Error_t Reassembler::Hear(const void *const data, const CaveTalk_Length_t length, CaveTalk_FragmentObject_t &object)
+{
+    return CaveTalk_ReassemblerHear(&reassembler_, data, length, &object);
+}
+
+bool Reassembler::Deadline(CaveTalk_Microseconds_t &deadline) const
+{
+    return CaveTalk_ReassemblerDeadline(&reassembler_, &deadline);
+}
+
+CaveTalk_Error_t Reassembler::Schedule(TimerWheel &timer_wheel, const CaveTalk_Microseconds_t timeout)
+{
+    return CaveTalk_ReassemblerSchedule(&reassembler_, &timer_wheel.Wheel(), timeout);
+}
+
+const CaveTalk_ReassemblerCounters_t &Reassembler::Counters(void) const
+{
+    return reassembler_.counters;
+}
+
+Dispatcher::Dispatcher(std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                       CaveTalk_Clock_t clock,
+                       const std::size_t worker_count,
+                       const std::size_t queue_size) :
+    Dispatcher(listener_callbacks, clock, worker_count, queue_size, std::pmr::get_default_resource())
+{
+}
+
+Dispatcher::Dispatcher(std::shared_ptr<ListenerCallbacks> listener_callbacks,
+                       CaveTalk_Clock_t clock,
+                       const std::size_t worker_count,
+                       const std::size_t queue_size,
+                       std::pmr::memory_resource *const memory_resource) : listener_callbacks_(listener_callbacks),
+    clock_(clock),
+    queue_size_(std::max<std::size_t>(queue_size, 1U)),
+    memory_resource_(memory_resource),
+    strands_(UINT8_MAX + 1U, memory_resource),
+    pending_(0U),
+    workers_(std::max<std::size_t>(worker_count, 1U), memory_resource),
+    next_worker_(0U),
+    ready_count_(0U),
+    stopping_(false)
+{
+    for (std::size_t worker = 0U; worker < workers_.size(); worker++)
+    {
+        threads_.emplace_back(&Dispatcher::Work, this, worker);
+    }
+}
+
+Dispatcher::~Dispatcher()
+{
+    Drain();
+
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+
+    for (std::thread &thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void Dispatcher::HearOogaBooga(const Say ooga_booga)
+{
+    Message message(memory_resource_);
+
+    message.ooga_booga = ooga_booga;
+
+    Dispatch(static_cast<CaveTalk_Id_t>(ID_OOGA), std::move(message));
+}
+
+void Dispatcher::HearMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate)
+{
+    Message message(memory_resource_);
+
+    message.first  = speed;
+    message.second = turn_rate;
+
+    Dispatch(static_cast<CaveTalk_Id_t>(ID_MOVEMENT), std::move(message));
+}
+
+void Dispatcher::HearCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)
+{
+    Message message(memory_resource_);
+
+    message.first  = pan;
+    message.second = tilt;
+
+    Dispatch(static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT), std::move(message));
+}
+
+void Dispatcher::HearLights(const bool headlights)
+{
+    Message message(memory_resource_);
+
+    message.value = headlights;
+
+    Dispatch(static_cast<CaveTalk_Id_t>(ID_LIGHTS), std::move(message));
+}
+
+void Dispatcher::HearMode(const bool manual)
+{
+    Message message(memory_resource_);
+
+    message.value = manual;
+
+    Dispatch(static_cast<CaveTalk_Id_t>(ID_MODE), std::move(message));
+}
+
+void Dispatcher::HearObject(const CaveTalk_Id_t id, const uint8_t *const data, const std::size_t length)
+{
+    Message message(memory_resource_);
+
+    // The object only lives in the reassembler until this returns
+    message.object_id = id;
+    message.object.assign(data, data + length);
+
+    Dispatch(static_cast<CaveTalk_Id_t>(ID_FRAGMENT), std::move(message));
+}
+
+void Dispatcher::Drain(void)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    idle_.wait(lock, [this]() {
+        return 0U == pending_;
+    });
+}
+
+DispatcherCounters Dispatcher::Counters(const CaveTalk_Id_t id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return strands_[id].counters;
+}
+
+void Dispatcher::Dispatch(const CaveTalk_Id_t id, Message &&message)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    Strand                      &strand = strands_[id];
+    bool                         idle   = false;
+    std::size_t                  worker = 0U;
+
+    if (strand.messages.size() >= queue_size_)
+    {
+        strand.counters.stalls++;
+        space_.wait(lock, [this, &strand]() {
+            return strand.messages.size() < queue_size_;
+        });
+    }
+
+    strand.messages.push_back(std::move(message));
+    strand.counters.depth     = strand.messages.size();
+    strand.counters.max_depth = std::max(strand.counters.max_depth, strand.counters.depth);
+    strand.counters.dispatched++;
+    pending_++;
+
+    // A strand is on at most one worker's queue at a time, which is what keeps its messages in order
+    idle             = !strand.scheduled;
+    strand.scheduled = true;
+
+    // Listeners on several threads may dispatch at once, so the round robin advances under the lock
+    if (idle)
+    {
+        worker = next_worker_++ % workers_.size();
+    }
+    lock.unlock();
+
+    if (idle)
+    {
+        Schedule(id, worker);
+    }
+}
+
+void Dispatcher::Deliver(const CaveTalk_Id_t id, const Message &message)
+{
+    switch (static_cast<Id>(id))
+    {
+    case ID_OOGA:
+        listener_callbacks_->HearOogaBooga(message.ooga_booga);
+        break;
+    case ID_MOVEMENT:
+        listener_callbacks_->HearMovement(message.first, message.second);
+        break;
+    case ID_CAMERA_MOVEMENT:
+        listener_callbacks_->HearCameraMovement(message.first, message.second);
+        break;
+    case ID_LIGHTS:
+        listener_callbacks_->HearLights(message.value);
+        break;
+    case ID_MODE:
+        listener_callbacks_->HearMode(message.value);
+        break;
+    case ID_FRAGMENT:
+        listener_callbacks_->HearObject(message.object_id, message.object.data(), message.object.size());
+        break;
+    default:
+        break;
+    }
+}
+
+void Dispatcher::Schedule(const CaveTalk_Id_t id, const std::size_t worker)
+{
+    {
+        std::lock_guard<std::mutex> lock(workers_[worker].mutex);
+        workers_[worker].ready.push_back(id);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ready_count_++;
+    }
+    ready_.notify_one();
+}
+
+bool Dispatcher::Take(const std::size_t worker, CaveTalk_Id_t &id)
+{
+    bool taken = false;
+
+    // Own queue from the front, others from the back
+    for (std::size_t offset = 0U; !taken && (offset < workers_.size()); offset++)
+    {
+        Worker                     &victim = workers_[(worker + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (!victim.ready.empty())
+        {
+            if (0U == offset)
+            {
+                id = victim.ready.front();
+                victim.ready.pop_front();
+            }
+            else
+            {
+                id = victim.ready.back();
+                victim.ready.pop_back();
+            }
+
+            taken = true;
+        }
+    }
+
+    return taken;
+}
+
+void Dispatcher::Work(const std::size_t worker)
+{
+    for (;;)
+    {
+        CaveTalk_Id_t id = CAVE_TALK_ID_NONE;
+
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex_);
+
+            ready_.wait(lock, [this]() {
+                return stopping_ || (0U != ready_count_);
+            });
+
+            if (0U == ready_count_)
+            {
+                break;
+            }
+
+            ready_count_--;
+        }
+
+        // Every count is a strand on some queue, so this only spins while another worker is moving one
+        while (!Take(worker, id))
+        {
+            std::this_thread::yield();
+        }
+
+        // Moved rather than assigned out of the queue, so an object stays in the memory resource it was copied to
+        std::optional<Message> message;
+        bool                   more = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            message.emplace(std::move(strands_[id].messages.front()));
+            strands_[id].messages.pop_front();
+            strands_[id].counters.depth = strands_[id].messages.size();
+        }
+        space_.notify_all();
+
+        const CaveTalk_Microseconds_t start = clock_();
+        Deliver(id, *message);
+        const CaveTalk_Microseconds_t elapsed = clock_() - start;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Strand                     &strand = strands_[id];
+
+            strand.counters.handled++;
+            strand.counters.handler_time_total += elapsed;
+            strand.counters.handler_time_max    = std::max(strand.counters.handler_time_max, elapsed);
+            strand.scheduled                    = !strand.messages.empty();
+            more                                = strand.scheduled;
+            pending_--;
+        }
+        idle_.notify_all();
+
+        // Back of this worker's own queue, so other ids get a turn and idle workers can steal it
+        if (more)
+        {
+            Schedule(id, worker);
+        }
+    }
+}
+
+TalkerBase::TalkerBase(CaveTalk_Error_t (*send)(const void *const data, const size_t size),
+                       std::shared_ptr<Reliable> reliable,
+                       std::shared_ptr<Pacer> pacer,
+                       std::shared_ptr<Delta> delta,
+                       std::shared_ptr<Negotiation> negotiation,
+                       std::span<uint8_t> message_buffer) : reliable_(reliable), pacer_(pacer), delta_(delta), negotiation_(negotiation),
+    message_buffer_(message_buffer)
+{
+    link_handle_.send      = send;
+    link_handle_.receive   = nullptr;
+    link_handle_.available = nullptr;
+}
+
+CaveTalk_Error_t TalkerBase::SpeakOogaBooga(const Say ooga_booga)
+{
+    OogaBooga ooga_booga_message;
+    ooga_booga_message.set_ooga_booga(ooga_booga);
+
+    return Speak(ooga_booga_message, static_cast<CaveTalk_Id_t>(ID_OOGA));
+}
+
+CaveTalk_Error_t TalkerBase::SpeakMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate)
+{
+    if (delta_ && Allows(CAVE_TALK_CAPABILITY_DELTA))
+    {
+        return SpeakDelta(static_cast<CaveTalk_Id_t>(ID_MOVEMENT), speed, turn_rate);
+    }
+
+    Movement movement_message;
+    movement_message.set_speed_meters_per_second(speed);
+    movement_message.set_turn_rate_radians_per_second(turn_rate);
+
+    return Speak(movement_message, static_cast<CaveTalk_Id_t>(ID_MOVEMENT));
+}
+
+CaveTalk_Error_t TalkerBase::SpeakCameraMovement(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)
+{
+    if (delta_ && Allows(CAVE_TALK_CAPABILITY_DELTA))
+    {
+        return SpeakDelta(static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT), pan, tilt);
+    }
+
+    CameraMovement camera_movement_message;
+    camera_movement_message.set_pan_angle_radians(pan);
+    camera_movement_message.set_tilt_angle_radians(tilt);
+
+    return Speak(camera_movement_message, static_cast<CaveTalk_Id_t>(ID_CAMERA_MOVEMENT));
+}
+
+CaveTalk_Error_t TalkerBase::SpeakLights(const bool headlights)
+{
+    Lights lights_message;
+    lights_message.set_headlights(headlights);
+
+    return Speak(lights_message, static_cast<CaveTalk_Id_t>(ID_LIGHTS));
+}
+
+CaveTalk_Error_t TalkerBase::SpeakMode(const bool manual)
+{
+    Mode mode_message;
+    mode_message.set_manual(manual);
+
+    return Speak(mode_message, static_cast<CaveTalk_Id_t>(ID_MODE));
+}
+
+CaveTalk_Error_t TalkerBase::Speak(const google::protobuf::MessageLite &message, const CaveTalk_Id_t id)
+{
+    const std::size_t length = message.ByteSizeLong();
+
+    CAVE_TALK_TRACE_ENCODE(id);
+
+    // Only fails when called through a TalkerBase for a message outside the set, BasicTalker checks that at compile time
+    if ((length > message_buffer_.size()) || !message.SerializeToArray(message_buffer_.data(), static_cast<int>(message_buffer_.size())))
+    {
+        return CAVE_TALK_ERROR_SIZE;
+    }
+
+    return SpeakFrame(id, length);
+}
+
+CaveTalk_Error_t TalkerBase::SpeakDelta(const CaveTalk_Id_t id, const double first, const double second)
+{
+    CAVE_TALK_TRACE_ENCODE(id);
+
+    CaveTalk_Length_t length = 0U;
+    CaveTalk_Error_t  error  = delta_->Encode(id, first, second, message_buffer_, length);
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        error = SpeakFrame(static_cast<CaveTalk_Id_t>(ID_DELTA), length);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t TalkerBase::SpeakFrame(const CaveTalk_Id_t id, const std::size_t length)
+{
+    if (negotiation_ && (length > negotiation_->AgreedMaxPayload()))
+    {
+        return CAVE_TALK_ERROR_SIZE;
+    }
+
+    // Ids without reliable delivery go straight to the link, or through the pacer when there is one
+    if (reliable_ && reliable_->Enabled(id) && Allows(CAVE_TALK_CAPABILITY_RELIABLE))
+    {
+        return reliable_->Speak(id, message_buffer_.data(), length);
+    }
+
+    if (pacer_)
+    {
+        return pacer_->Speak(id, message_buffer_.data(), length);
+    }
+
+    return CaveTalk_Speak(&link_handle_, id, message_buffer_.data(), length);
+}
+
+// Without negotiation every capability configured is used
+bool TalkerBase::Allows(const uint32_t capability) const
+{
+    return !negotiation_ || negotiation_->Allows(capability);
+}
+
+StateSync::StateSync(std::shared_ptr<TalkerBase> talker, CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t keyframe_interval) :
+    StateSync(talker, clock, keyframe_interval, nullptr, 0U)
+{
+}
+
+StateSync::StateSync(std::shared_ptr<TalkerBase> talker,
+                     CaveTalk_Clock_t clock,
+                     const CaveTalk_Microseconds_t keyframe_interval,
+                     std::shared_ptr<Heartbeat> heartbeat,
+                     const CaveTalk_Microseconds_t timeout) : talker_(talker),
+    clock_(clock),
+    keyframe_interval_(keyframe_interval),
+    heartbeat_(heartbeat),
+    timeout_(timeout),
+    last_keyframe_(clock()),
+    keyframe_pending_(false),
+    listener_alive_(false)
+{
+}
+
+CaveTalk_Error_t StateSync::SpeakLights(const bool headlights)
+{
+    const bool       suppressed = headlights_.has_value() && (headlights == headlights_.value());
+    CaveTalk_Error_t error      = suppressed ? CAVE_TALK_ERROR_NONE : talker_->SpeakLights(headlights);
+
+    if (!suppressed && (CAVE_TALK_ERROR_NONE == error))
+    {
+        headlights_ = headlights;
+    }
+    Count(error, BoolMessageSize(headlights), suppressed);
+
+    return error;
+}
+
+CaveTalk_Error_t StateSync::SpeakMode(const bool manual)
+{
+    const bool       suppressed = manual_.has_value() && (manual == manual_.value());
+    CaveTalk_Error_t error      = suppressed ? CAVE_TALK_ERROR_NONE : talker_->SpeakMode(manual);
+
+    if (!suppressed && (CAVE_TALK_ERROR_NONE == error))
+    {
+        manual_ = manual;
+    }
+    Count(error, BoolMessageSize(manual), suppressed);
+
+    return error;
+}
+
+CaveTalk_Error_t StateSync::Update(void)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (nullptr != heartbeat_)
+    {
+        const bool alive = heartbeat_->Alive(timeout_);
+
+        if (alive && !listener_alive_)
+        {
+            keyframe_pending_ = true;
+        }
+        listener_alive_ = alive;
+    }
+
+    if (keyframe_pending_ || ((0U != keyframe_interval_) && ((clock_() - last_keyframe_) >= keyframe_interval_)))
+    {
+        error = Keyframe();
+    }
+
+    return error;
+}
+
+void StateSync::ListenerJoined(void)
+{
+    keyframe_pending_ = true;
+}
+
+const StateSyncCounters &StateSync::Counters(void) const
+{
+    return counters_;
+}
+
+CaveTalk_Error_t StateSync::Keyframe(void)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (headlights_.has_value())
+    {
+        error = talker_->SpeakLights(headlights_.value());
+        Count(error, BoolMessageSize(headlights_.value()), false);
+    }
+
+    if ((CAVE_TALK_ERROR_NONE == error) && manual_.has_value())
+    {
+        error = talker_->SpeakMode(manual_.value());
+        Count(error, BoolMessageSize(manual_.value()), false);
+    }
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        last_keyframe_    = clock_();
+        keyframe_pending_ = false;
+        if (headlights_.has_value() || manual_.has_value())
+        {
+            counters_.keyframes++;
+        }
+    }
+    else
+    {
+        // Retried on the next update
+        keyframe_pending_ = true;
+    }
+
+    return error;
+}
+
+// Lights and Mode hold a single bool, which is left out of the encoding when false
+std::size_t StateSync::BoolMessageSize(const bool value)
+{
+    static_assert(MessageTraits<Lights>::kMaxSize == MessageTraits<Mode>::kMaxSize);
+
+    return value ? MessageTraits<Lights>::kMaxSize : 0U;
+}
+
+void StateSync::Count(const CaveTalk_Error_t error, const std::size_t payload_size, const bool suppressed)
+{
+    const std::size_t frame_size = CAVE_TALK_HEADER_SIZE + payload_size + CAVE_TALK_CRC_SIZE;
+
+    if (suppressed)
+    {
+        counters_.frames_suppressed++;
+        counters_.bytes_saved += frame_size;
+    }
+    else if (CAVE_TALK_ERROR_NONE == error)
+    {
+        counters_.frames_sent++;
+        counters_.bytes_sent += frame_size;
+    }
 }
 
 } // namespace cave_talk
\ No newline at end of file
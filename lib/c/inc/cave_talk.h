@@ -4,11 +4,37 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "camera_movement.pb.h"
+#include "heartbeat.pb.h"
+#include "lights.pb.h"
+#include "mode.pb.h"
+#include "movement.pb.h"
 #include "ooga_booga.pb.h"
 
+#include "cave_talk_fragment.h"
+#include "cave_talk_heartbeat.h"
 #include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_negotiation.h"
+#include "cave_talk_pacer.h"
+#include "cave_talk_reliable.h"
 #include "cave_talk_types.h"
 
+#define CAVE_TALK_MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+/* Largest encoded message, from the maximum sizes nanopb generates for each message */
+#define CAVE_TALK_MESSAGE_SIZE_MAX                                                                    \
+    CAVE_TALK_MAX(cave_talk_OogaBooga_size,                                                           \
+                  CAVE_TALK_MAX(cave_talk_Movement_size,                                              \
+                                CAVE_TALK_MAX(cave_talk_CameraMovement_size,                          \
+                                              CAVE_TALK_MAX(cave_talk_Lights_size,                    \
+                                                            CAVE_TALK_MAX(cave_talk_Mode_size,        \
+                                                                          CAVE_TALK_MAX(cave_talk_Ping_size, cave_talk_Pong_size))))))
+
+/* Smallest handle buffer that holds any message, also when wrapped in a reliable frame. Fragments need a buffer at least
+ * as large as the peer's fragment frame size. */
+#define CAVE_TALK_BUFFER_SIZE CAVE_TALK_MAX(CAVE_TALK_MESSAGE_SIZE_MAX + CAVE_TALK_RELIABLE_HEADER_SIZE, CAVE_TALK_RELIABLE_ACK_SIZE)
+
 typedef struct
 {
     void (*hear_ooga_booga)(const cave_talk_Say ooga_booga);
@@ -16,6 +42,7 @@ typedef struct
     void (*hear_camera_movement)(const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt);
     void (*hear_lights)(const bool headlights);
     void (*hear_mode)(const bool manual);
+    void (*hear_object)(const CaveTalk_Id_t id, const uint8_t *const data, const size_t length);
 } CaveTalk_ListenCallbacks_t;
 
 typedef struct
@@ -24,21 +51,32 @@ typedef struct
     uint8_t *buffer;
     size_t buffer_size;
     CaveTalk_ListenCallbacks_t listen_callbacks;
+    CaveTalk_Heartbeat_t *heartbeat;
+    CaveTalk_Reliable_t *reliable;
+    CaveTalk_Reassembler_t *reassembler;
+    CaveTalk_Pacer_t *pacer;
+    CaveTalk_Negotiation_t *negotiation;
 } CaveTalk_Handle_t;
 
-const CaveTalk_ListenCallbacks_t kCaveTalk_ListenCallbacksNull = {
+static const CaveTalk_ListenCallbacks_t kCaveTalk_ListenCallbacksNull = {
     .hear_ooga_booga      = NULL,
     .hear_movement        = NULL,
     .hear_camera_movement = NULL,
     .hear_lights          = NULL,
     .hear_mode            = NULL,
+    .hear_object          = NULL,
 };
 
-const CaveTalk_Handle_t kCaveTalk_HandleNull = {
+static const CaveTalk_Handle_t kCaveTalk_HandleNull = {
     .link_handle      = kCaveTalk_LinkHandleNull,
     .buffer           = NULL,
     .buffer_size      = 0U,
     .listen_callbacks = kCaveTalk_ListenCallbacksNull,
+    .heartbeat        = NULL,
+    .reliable         = NULL,
+    .reassembler      = NULL,
+    .pacer            = NULL,
+    .negotiation      = NULL,
 };
 
 #ifdef __cplusplus
@@ -47,11 +85,16 @@ extern "C"
 #endif
 
 CaveTalk_Error_t CaveTalk_Hear(const CaveTalk_Handle_t *const handle);
+CaveTalk_Error_t CaveTalk_HearUntil(const CaveTalk_Handle_t *const handle, CaveTalk_ListenState_t *const listen_state, const CaveTalk_Microseconds_t deadline);
 CaveTalk_Error_t CaveTalk_SpeakOogaBooga(const CaveTalk_Handle_t *const handle, const cave_talk_Say ooga_booga);
 CaveTalk_Error_t CaveTalk_SpeakMovement(const CaveTalk_Handle_t *const handle, const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t turn_rate);
 CaveTalk_Error_t CaveTalk_SpeakCameraMovement(const CaveTalk_Handle_t *const handle, const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt);
 CaveTalk_Error_t CaveTalk_SpeakLights(const CaveTalk_Handle_t *const handle, const bool headlights);
 CaveTalk_Error_t CaveTalk_SpeakMode(const CaveTalk_Handle_t *const handle, const bool manual);
+CaveTalk_Error_t CaveTalk_SpeakHeartbeat(const CaveTalk_Handle_t *const handle);
+CaveTalk_Error_t CaveTalk_SpeakRetransmit(const CaveTalk_Handle_t *const handle);
+CaveTalk_Error_t CaveTalk_SpeakPaced(const CaveTalk_Handle_t *const handle);
+CaveTalk_Error_t CaveTalk_SpeakNegotiation(const CaveTalk_Handle_t *const handle);
 
 #ifdef __cplusplus
 }
@@ -1,8 +1,10 @@
 #include "cave_talk.h"
 
 #include <stdbool.h>
+#include <string.h>
 
 #include "camera_movement.pb.h"
+#include "heartbeat.pb.h"
 #include "ids.pb.h"
 #include "lights.pb.h"
 #include "mode.pb.h"
@@ -11,14 +13,30 @@
 #include "pb_decode.h"
 #include "pb_encode.h"
 
+#include "cave_talk_fragment.h"
+#include "cave_talk_heartbeat.h"
 #include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_negotiation.h"
+#include "cave_talk_pacer.h"
+#include "cave_talk_reliable.h"
+#include "cave_talk_trace.h"
 #include "cave_talk_types.h"
 
-static CaveTalk_Error_t CaveTalk_HandleOogaBooga(const CaveTalk_Handle_t *const handle);
-static CaveTalk_Error_t CaveTalk_HandleMovement(const CaveTalk_Handle_t *const handle);
-static CaveTalk_Error_t CaveTalk_HandleCameraMovement(const CaveTalk_Handle_t *const handle);
-static CaveTalk_Error_t CaveTalk_HandleLights(const CaveTalk_Handle_t *const handle);
-static CaveTalk_Error_t CaveTalk_HandleMode(const CaveTalk_Handle_t *const handle);
+_Static_assert(CAVE_TALK_BUFFER_SIZE <= UINT8_MAX, "A message does not fit in a frame");
+
+static CaveTalk_Error_t CaveTalk_SpeakFrame(const CaveTalk_Handle_t *const handle, const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleFrame(const CaveTalk_Handle_t *const handle, const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_Dispatch(const CaveTalk_Handle_t *const handle, const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleReliable(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleFragment(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleOogaBooga(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleMovement(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleCameraMovement(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleLights(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandleMode(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandlePing(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
+static CaveTalk_Error_t CaveTalk_HandlePong(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length);
 
 CaveTalk_Error_t CaveTalk_Hear(const CaveTalk_Handle_t *const handle)
 {
@@ -39,33 +57,30 @@ CaveTalk_Error_t CaveTalk_Hear(const CaveTalk_Handle_t *const handle)
 
         if (CAVE_TALK_ERROR_NONE == error)
         {
-            switch ((cave_talk_Id)id)
-            {
-            case cave_talk_Id_ID_NONE:
-                if (0U != length)
-                {
-                    error = CAVE_TALK_ERROR_ID;
-                }
-                break;
-            case cave_talk_Id_ID_OOGA:
-                error = CaveTalk_HandleOogaBooga(handle);
-                break;
-            case cave_talk_Id_ID_MOVEMENT:
-                error = CaveTalk_HandleMovement(handle);
-                break;
-            case cave_talk_Id_ID_CAMERA_MOVEMENT:
-                error = CaveTalk_HandleCameraMovement(handle);
-                break;
-            case cave_talk_Id_ID_LIGHTS:
-                error = CaveTalk_HandleLights(handle);
-                break;
-            case cave_talk_Id_ID_MODE:
-                error = CaveTalk_HandleMode(handle);
-                break;
-            default:
-                error = CAVE_TALK_ERROR_ID;
-                break;
-            }
+            error = CaveTalk_HandleFrame(handle, id, length);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_HearUntil(const CaveTalk_Handle_t *const handle, CaveTalk_ListenState_t *const listen_state, const CaveTalk_Microseconds_t deadline)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == handle) || (NULL == handle->buffer) || (NULL == listen_state))
+    {
+    }
+    else
+    {
+        CaveTalk_Id_t     id     = 0U;
+        CaveTalk_Length_t length = 0U;
+
+        error = CaveTalk_ListenUntil(&handle->link_handle, listen_state, deadline, &id, handle->buffer, handle->buffer_size, &length);
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            error = CaveTalk_HandleFrame(handle, id, length);
         }
     }
 
@@ -86,13 +101,14 @@ CaveTalk_Error_t CaveTalk_SpeakOogaBooga(const CaveTalk_Handle_t *const handle,
 
         ooga_booga_message.ooga_booga = ooga_booga;
 
+        CAVE_TALK_TRACE_ENCODE((CaveTalk_Id_t)cave_talk_Id_ID_OOGA);
         if (!pb_encode(&ostream, cave_talk_OogaBooga_fields, &ooga_booga_message))
         {
             error = CAVE_TALK_ERROR_SIZE;
         }
         else
         {
-            error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_OOGA, handle->buffer, ostream.bytes_written);
+            error = CaveTalk_SpeakFrame(handle, (CaveTalk_Id_t)cave_talk_Id_ID_OOGA, ostream.bytes_written);
         }
     }
 
@@ -114,13 +130,14 @@ CaveTalk_Error_t CaveTalk_SpeakMovement(const CaveTalk_Handle_t *const handle, c
         movement_message.speed_meters_per_second      = speed;
         movement_message.turn_rate_radians_per_second = turn_rate;
 
+        CAVE_TALK_TRACE_ENCODE((CaveTalk_Id_t)cave_talk_Id_ID_MOVEMENT);
         if (!pb_encode(&ostream, cave_talk_Movement_fields, &movement_message))
         {
             error = CAVE_TALK_ERROR_SIZE;
         }
         else
         {
-            error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_MOVEMENT, handle->buffer, ostream.bytes_written);
+            error = CaveTalk_SpeakFrame(handle, (CaveTalk_Id_t)cave_talk_Id_ID_MOVEMENT, ostream.bytes_written);
         }
     }
 
@@ -142,13 +159,14 @@ CaveTalk_Error_t CaveTalk_SpeakCameraMovement(const CaveTalk_Handle_t *const han
         camera_movement_message.pan_angle_radians  = pan;
         camera_movement_message.tilt_angle_radians = tilt;
 
+        CAVE_TALK_TRACE_ENCODE((CaveTalk_Id_t)cave_talk_Id_ID_CAMERA_MOVEMENT);
         if (!pb_encode(&ostream, cave_talk_CameraMovement_fields, &camera_movement_message))
         {
             error = CAVE_TALK_ERROR_SIZE;
         }
         else
         {
-            error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_CAMERA_MOVEMENT, handle->buffer, ostream.bytes_written);
+            error = CaveTalk_SpeakFrame(handle, (CaveTalk_Id_t)cave_talk_Id_ID_CAMERA_MOVEMENT, ostream.bytes_written);
         }
     }
 
@@ -169,13 +187,14 @@ CaveTalk_Error_t CaveTalk_SpeakLights(const CaveTalk_Handle_t *const handle, con
 
         lights_message.headlights = headlights;
 
+        CAVE_TALK_TRACE_ENCODE((CaveTalk_Id_t)cave_talk_Id_ID_LIGHTS);
         if (!pb_encode(&ostream, cave_talk_Lights_fields, &lights_message))
         {
             error = CAVE_TALK_ERROR_SIZE;
         }
         else
         {
-            error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_LIGHTS, handle->buffer, ostream.bytes_written);
+            error = CaveTalk_SpeakFrame(handle, (CaveTalk_Id_t)cave_talk_Id_ID_LIGHTS, ostream.bytes_written);
         }
     }
 
@@ -196,20 +215,288 @@ CaveTalk_Error_t CaveTalk_SpeakMode(const CaveTalk_Handle_t *const handle, const
 
         mode_message.manual = manual;
 
+        CAVE_TALK_TRACE_ENCODE((CaveTalk_Id_t)cave_talk_Id_ID_MODE);
         if (!pb_encode(&ostream, cave_talk_Mode_fields, &mode_message))
         {
             error = CAVE_TALK_ERROR_SIZE;
         }
         else
         {
-            error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_MODE, handle->buffer, ostream.bytes_written);
+            error = CaveTalk_SpeakFrame(handle, (CaveTalk_Id_t)cave_talk_Id_ID_MODE, ostream.bytes_written);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_SpeakHeartbeat(const CaveTalk_Handle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == handle) || (NULL == handle->buffer) || (NULL == handle->link_handle.send) || (NULL == handle->heartbeat))
+    {
+    }
+    else if (!CaveTalk_HeartbeatDue(handle->heartbeat) || !CaveTalk_NegotiationAllows(handle->negotiation, CAVE_TALK_CAPABILITY_HEARTBEAT))
+    {
+        error = CAVE_TALK_ERROR_NONE;
+    }
+    else
+    {
+        pb_ostream_t   ostream      = pb_ostream_from_buffer(handle->buffer, handle->buffer_size);
+        cave_talk_Ping ping_message = cave_talk_Ping_init_zero;
+
+        ping_message.originate_timestamp_microseconds = handle->heartbeat->clock();
+
+        CAVE_TALK_TRACE_ENCODE((CaveTalk_Id_t)cave_talk_Id_ID_PING);
+        if (!pb_encode(&ostream, cave_talk_Ping_fields, &ping_message))
+        {
+            error = CAVE_TALK_ERROR_SIZE;
+        }
+        else
+        {
+            error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_PING, handle->buffer, ostream.bytes_written);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            CaveTalk_HeartbeatPinged(handle->heartbeat, ping_message.originate_timestamp_microseconds);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_SpeakRetransmit(const CaveTalk_Handle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == handle) || (NULL == handle->reliable))
+    {
+    }
+    else
+    {
+        error = CaveTalk_ReliableRetransmit(handle->reliable, &handle->link_handle);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_SpeakPaced(const CaveTalk_Handle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == handle) || (NULL == handle->pacer))
+    {
+    }
+    else
+    {
+        error = CaveTalk_PacerDrain(handle->pacer, &handle->link_handle);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_SpeakNegotiation(const CaveTalk_Handle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == handle) || (NULL == handle->negotiation))
+    {
+    }
+    else
+    {
+        error = CaveTalk_NegotiationPoll(handle->negotiation, &handle->link_handle);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_HandleFrame(const CaveTalk_Handle_t *const handle, const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (cave_talk_Id_ID_RELIABLE == (cave_talk_Id)id)
+    {
+        error = CaveTalk_HandleReliable(handle, length);
+    }
+    else if (cave_talk_Id_ID_ACK == (cave_talk_Id)id)
+    {
+        /* Stray ACKs are ignored when reliable delivery is disabled */
+        if (NULL != handle->reliable)
+        {
+            error = CaveTalk_ReliableHearAck(handle->reliable, handle->buffer, length);
+        }
+    }
+    else if (cave_talk_Id_ID_FRAGMENT == (cave_talk_Id)id)
+    {
+        error = CaveTalk_HandleFragment(handle, length);
+    }
+    else if (cave_talk_Id_ID_HELLO == (cave_talk_Id)id)
+    {
+        /* Offers are ignored without negotiation, the peer then falls back to revision 1 */
+        if (NULL != handle->negotiation)
+        {
+            error = CaveTalk_NegotiationHear(handle->negotiation, &handle->link_handle, handle->buffer, length);
         }
     }
+    else
+    {
+        error = CaveTalk_Dispatch(handle, id, length);
+    }
 
     return error;
 }
 
-static CaveTalk_Error_t CaveTalk_HandleOogaBooga(const CaveTalk_Handle_t *const handle)
+static CaveTalk_Error_t CaveTalk_SpeakFrame(const CaveTalk_Handle_t *const handle, const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    /* Ids without reliable delivery go straight to the link, or through the pacer when there is one */
+    if (length > CaveTalk_NegotiationMaxPayload(handle->negotiation))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else if (CaveTalk_ReliableEnabled(handle->reliable, id) && CaveTalk_NegotiationAllows(handle->negotiation, CAVE_TALK_CAPABILITY_RELIABLE))
+    {
+        error = CaveTalk_ReliableSpeak(handle->reliable, &handle->link_handle, id, handle->buffer, length);
+    }
+    else if (NULL != handle->pacer)
+    {
+        error = CaveTalk_PacerSpeak(handle->pacer, &handle->link_handle, id, handle->buffer, length);
+    }
+    else
+    {
+        error = CaveTalk_Speak(&handle->link_handle, id, handle->buffer, length);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_Dispatch(const CaveTalk_Handle_t *const handle, const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    CAVE_TALK_TRACE_DECODE(id, length);
+
+    switch ((cave_talk_Id)id)
+    {
+    case cave_talk_Id_ID_NONE:
+        if (0U != length)
+        {
+            error = CAVE_TALK_ERROR_ID;
+        }
+        break;
+    case cave_talk_Id_ID_OOGA:
+        error = CaveTalk_HandleOogaBooga(handle, length);
+        break;
+    case cave_talk_Id_ID_MOVEMENT:
+        error = CaveTalk_HandleMovement(handle, length);
+        break;
+    case cave_talk_Id_ID_CAMERA_MOVEMENT:
+        error = CaveTalk_HandleCameraMovement(handle, length);
+        break;
+    case cave_talk_Id_ID_LIGHTS:
+        error = CaveTalk_HandleLights(handle, length);
+        break;
+    case cave_talk_Id_ID_MODE:
+        error = CaveTalk_HandleMode(handle, length);
+        break;
+    case cave_talk_Id_ID_PING:
+        error = CaveTalk_HandlePing(handle, length);
+        break;
+    case cave_talk_Id_ID_PONG:
+        error = CaveTalk_HandlePong(handle, length);
+        break;
+    default:
+        error = CAVE_TALK_ERROR_ID;
+        break;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_HandleReliable(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_ID;
+
+    if (NULL == handle->reliable)
+    {
+        /* Reliable delivery disabled, the frame cannot be acknowledged */
+    }
+    else
+    {
+        CaveTalk_ReliableFrame_t frame;
+
+        error = CaveTalk_ReliableHear(handle->reliable, &handle->link_handle, handle->buffer, length, &frame);
+
+        if (CAVE_TALK_ERROR_INCOMPLETE == error)
+        {
+            /* Duplicate or buffered until the frames before it arrive */
+            error = CAVE_TALK_ERROR_NONE;
+        }
+        else if (CAVE_TALK_ERROR_NONE == error)
+        {
+            memmove(handle->buffer, frame.data, frame.length);
+            error = CaveTalk_Dispatch(handle, frame.id, frame.length);
+
+            while (CaveTalk_ReliableNext(handle->reliable, &frame))
+            {
+                CaveTalk_Error_t next_error = CAVE_TALK_ERROR_SIZE;
+
+                if (frame.length <= handle->buffer_size)
+                {
+                    memcpy(handle->buffer, frame.data, frame.length);
+                    next_error = CaveTalk_Dispatch(handle, frame.id, frame.length);
+                }
+
+                if (CAVE_TALK_ERROR_NONE == error)
+                {
+                    error = next_error;
+                }
+            }
+        }
+        else
+        {
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_HandleFragment(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_ID;
+
+    if ((NULL == handle->reassembler) || !CaveTalk_NegotiationAllows(handle->negotiation, CAVE_TALK_CAPABILITY_FRAGMENT))
+    {
+        /* Fragmentation disabled, there is no pool to reassemble into or the peer did not offer it */
+    }
+    else
+    {
+        CaveTalk_FragmentObject_t object;
+
+        error = CaveTalk_ReassemblerHear(handle->reassembler, handle->buffer, length, &object);
+
+        if (CAVE_TALK_ERROR_INCOMPLETE == error)
+        {
+            /* More fragments to come, or the object was dropped after a lost fragment */
+            error = CAVE_TALK_ERROR_NONE;
+        }
+        else if ((CAVE_TALK_ERROR_NONE == error) && (NULL != handle->listen_callbacks.hear_object))
+        {
+            CAVE_TALK_TRACE_CALLBACK_ENTRY(object.id);
+            handle->listen_callbacks.hear_object(object.id, object.data, object.length);
+            CAVE_TALK_TRACE_CALLBACK_EXIT(object.id);
+        }
+        else
+        {
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_HandleOogaBooga(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
 {
     CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
 
@@ -219,7 +506,7 @@ static CaveTalk_Error_t CaveTalk_HandleOogaBooga(const CaveTalk_Handle_t *const
     }
     else
     {
-        pb_istream_t        istream            = pb_istream_from_buffer(handle->buffer, handle->buffer_size);
+        pb_istream_t        istream            = pb_istream_from_buffer(handle->buffer, length);
         cave_talk_OogaBooga ooga_booga_message = cave_talk_OogaBooga_init_zero;
 
         if (!pb_decode(&istream, cave_talk_OogaBooga_fields, &ooga_booga_message))
@@ -228,14 +515,16 @@ static CaveTalk_Error_t CaveTalk_HandleOogaBooga(const CaveTalk_Handle_t *const
         }
         else if (NULL != handle->listen_callbacks.hear_ooga_booga)
         {
+            CAVE_TALK_TRACE_CALLBACK_ENTRY((CaveTalk_Id_t)cave_talk_Id_ID_OOGA);
             handle->listen_callbacks.hear_ooga_booga(ooga_booga_message.ooga_booga);
+            CAVE_TALK_TRACE_CALLBACK_EXIT((CaveTalk_Id_t)cave_talk_Id_ID_OOGA);
         }
     }
 
     return error;
 }
 
-static CaveTalk_Error_t CaveTalk_HandleMovement(const CaveTalk_Handle_t *const handle)
+static CaveTalk_Error_t CaveTalk_HandleMovement(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
 {
     CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
 
@@ -245,7 +534,7 @@ static CaveTalk_Error_t CaveTalk_HandleMovement(const CaveTalk_Handle_t *const h
     }
     else
     {
-        pb_istream_t       istream          = pb_istream_from_buffer(handle->buffer, handle->buffer_size);
+        pb_istream_t       istream          = pb_istream_from_buffer(handle->buffer, length);
         cave_talk_Movement movement_message = cave_talk_Movement_init_zero;
 
         if (!pb_decode(&istream, cave_talk_Movement_fields, &movement_message))
@@ -254,14 +543,16 @@ static CaveTalk_Error_t CaveTalk_HandleMovement(const CaveTalk_Handle_t *const h
         }
         else if (NULL != handle->listen_callbacks.hear_movement)
         {
+            CAVE_TALK_TRACE_CALLBACK_ENTRY((CaveTalk_Id_t)cave_talk_Id_ID_MOVEMENT);
             handle->listen_callbacks.hear_movement(movement_message.speed_meters_per_second, movement_message.turn_rate_radians_per_second);
+            CAVE_TALK_TRACE_CALLBACK_EXIT((CaveTalk_Id_t)cave_talk_Id_ID_MOVEMENT);
         }
     }
 
     return error;
 }
 
-static CaveTalk_Error_t CaveTalk_HandleCameraMovement(const CaveTalk_Handle_t *const handle)
+static CaveTalk_Error_t CaveTalk_HandleCameraMovement(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
 {
     CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
 
@@ -271,7 +562,7 @@ static CaveTalk_Error_t CaveTalk_HandleCameraMovement(const CaveTalk_Handle_t *c
     }
     else
     {
-        pb_istream_t             istream                 = pb_istream_from_buffer(handle->buffer, handle->buffer_size);
+        pb_istream_t             istream                 = pb_istream_from_buffer(handle->buffer, length);
         cave_talk_CameraMovement camera_movement_message = cave_talk_CameraMovement_init_zero;
 
         if (!pb_decode(&istream, cave_talk_CameraMovement_fields, &camera_movement_message))
@@ -280,14 +571,16 @@ static CaveTalk_Error_t CaveTalk_HandleCameraMovement(const CaveTalk_Handle_t *c
         }
         else if (NULL != handle->listen_callbacks.hear_camera_movement)
         {
+            CAVE_TALK_TRACE_CALLBACK_ENTRY((CaveTalk_Id_t)cave_talk_Id_ID_CAMERA_MOVEMENT);
             handle->listen_callbacks.hear_camera_movement(camera_movement_message.pan_angle_radians, camera_movement_message.tilt_angle_radians);
+            CAVE_TALK_TRACE_CALLBACK_EXIT((CaveTalk_Id_t)cave_talk_Id_ID_CAMERA_MOVEMENT);
         }
     }
 
     return error;
 }
 
-static CaveTalk_Error_t CaveTalk_HandleLights(const CaveTalk_Handle_t *const handle)
+static CaveTalk_Error_t CaveTalk_HandleLights(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
 {
     CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
 
@@ -297,7 +590,7 @@ static CaveTalk_Error_t CaveTalk_HandleLights(const CaveTalk_Handle_t *const han
     }
     else
     {
-        pb_istream_t     istream        = pb_istream_from_buffer(handle->buffer, handle->buffer_size);
+        pb_istream_t     istream        = pb_istream_from_buffer(handle->buffer, length);
         cave_talk_Lights lights_message = cave_talk_Lights_init_zero;
 
         if (!pb_decode(&istream, cave_talk_Lights_fields, &lights_message))
@@ -306,14 +599,16 @@ static CaveTalk_Error_t CaveTalk_HandleLights(const CaveTalk_Handle_t *const han
         }
         else if (NULL != handle->listen_callbacks.hear_lights)
         {
+            CAVE_TALK_TRACE_CALLBACK_ENTRY((CaveTalk_Id_t)cave_talk_Id_ID_LIGHTS);
             handle->listen_callbacks.hear_lights(lights_message.headlights);
+            CAVE_TALK_TRACE_CALLBACK_EXIT((CaveTalk_Id_t)cave_talk_Id_ID_LIGHTS);
         }
     }
 
     return error;
 }
 
-static CaveTalk_Error_t CaveTalk_HandleMode(const CaveTalk_Handle_t *const handle)
+static CaveTalk_Error_t CaveTalk_HandleMode(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
 {
     CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
 
@@ -323,7 +618,7 @@ static CaveTalk_Error_t CaveTalk_HandleMode(const CaveTalk_Handle_t *const handl
     }
     else
     {
-        pb_istream_t   istream      = pb_istream_from_buffer(handle->buffer, handle->buffer_size);
+        pb_istream_t   istream      = pb_istream_from_buffer(handle->buffer, length);
         cave_talk_Mode mode_message = cave_talk_Mode_init_zero;
 
         if (!pb_decode(&istream, cave_talk_Mode_fields, &mode_message))
@@ -332,9 +627,96 @@ static CaveTalk_Error_t CaveTalk_HandleMode(const CaveTalk_Handle_t *const handl
         }
         else if (NULL != handle->listen_callbacks.hear_mode)
         {
+            CAVE_TALK_TRACE_CALLBACK_ENTRY((CaveTalk_Id_t)cave_talk_Id_ID_MODE);
             handle->listen_callbacks.hear_mode(mode_message.manual);
+            CAVE_TALK_TRACE_CALLBACK_EXIT((CaveTalk_Id_t)cave_talk_Id_ID_MODE);
         }
     }
 
     return error;
 }
+
+static CaveTalk_Error_t CaveTalk_HandlePing(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if ((NULL == handle) || (NULL == handle->buffer))
+    {
+        error = CAVE_TALK_ERROR_NULL;
+    }
+    else if (NULL == handle->heartbeat)
+    {
+        /* Heartbeat disabled, nothing to answer with */
+    }
+    else
+    {
+        const CaveTalk_Microseconds_t receive      = handle->heartbeat->clock();
+        pb_istream_t                  istream      = pb_istream_from_buffer(handle->buffer, length);
+        cave_talk_Ping                ping_message = cave_talk_Ping_init_zero;
+
+        if (!pb_decode(&istream, cave_talk_Ping_fields, &ping_message))
+        {
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else
+        {
+            CaveTalk_HeartbeatHeard(handle->heartbeat, receive);
+
+            if (NULL != handle->link_handle.send)
+            {
+                pb_ostream_t   ostream      = pb_ostream_from_buffer(handle->buffer, handle->buffer_size);
+                cave_talk_Pong pong_message = cave_talk_Pong_init_zero;
+
+                pong_message.originate_timestamp_microseconds = ping_message.originate_timestamp_microseconds;
+                pong_message.receive_timestamp_microseconds   = receive;
+                pong_message.transmit_timestamp_microseconds  = handle->heartbeat->clock();
+
+                if (!pb_encode(&ostream, cave_talk_Pong_fields, &pong_message))
+                {
+                    error = CAVE_TALK_ERROR_SIZE;
+                }
+                else
+                {
+                    error = CaveTalk_Speak(&handle->link_handle, (CaveTalk_Id_t)cave_talk_Id_ID_PONG, handle->buffer, ostream.bytes_written);
+                }
+            }
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_HandlePong(const CaveTalk_Handle_t *const handle, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if ((NULL == handle) || (NULL == handle->buffer))
+    {
+        error = CAVE_TALK_ERROR_NULL;
+    }
+    else if (NULL == handle->heartbeat)
+    {
+        /* Heartbeat disabled, ignore stray pongs */
+    }
+    else
+    {
+        const CaveTalk_Microseconds_t destination  = handle->heartbeat->clock();
+        pb_istream_t                  istream      = pb_istream_from_buffer(handle->buffer, length);
+        cave_talk_Pong                pong_message = cave_talk_Pong_init_zero;
+
+        if (!pb_decode(&istream, cave_talk_Pong_fields, &pong_message))
+        {
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else
+        {
+            error = CaveTalk_HeartbeatPonged(handle->heartbeat,
+                                             pong_message.originate_timestamp_microseconds,
+                                             pong_message.receive_timestamp_microseconds,
+                                             pong_message.transmit_timestamp_microseconds,
+                                             destination);
+        }
+    }
+
+    return error;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef CAVE_TALK_BOND_H
+#define CAVE_TALK_BOND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_ID_BOND 11U /* See ids.proto */
+
+#define CAVE_TALK_BOND_HEADER_SIZE      7U /* Sequence number u16, sender timestamp u32 and inner id */
+#define CAVE_TALK_BOND_PAYLOAD_SIZE_MAX (UINT8_MAX - CAVE_TALK_BOND_HEADER_SIZE)
+#define CAVE_TALK_BOND_FRAME_SIZE_MAX   (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+#define CAVE_TALK_BOND_PATH_COUNT_MAX   8U
+#define CAVE_TALK_BOND_WINDOW           64U /* Sequence numbers remembered for duplicate detection */
+#define CAVE_TALK_BOND_RX_BUFFER_SIZE   (4U * CAVE_TALK_BOND_FRAME_SIZE_MAX)
+
+/* Latency is the time from the sender's timestamp to arrival, so it includes the offset between the two clocks. The
+ * offset is the same on every path, so paths compare directly, and subtracting the heartbeat's clock offset gives one
+ * way latency. Lag is how long a duplicate arrived after the copy that won. */
+typedef struct
+{
+    uint32_t frames;
+    uint32_t wins;
+    uint32_t duplicates;
+    int32_t latency;
+    int32_t smoothed_latency;
+    int32_t latency_min;
+    int32_t latency_max;
+    uint32_t smoothed_lag;
+} CaveTalk_BondPathStats_t;
+
+typedef struct
+{
+    CaveTalk_LinkHandle_t link_handle;
+    CaveTalk_FrameParser_t parser;
+    uint8_t payload[UINT8_MAX];
+    CaveTalk_BondPathStats_t stats;
+} CaveTalk_BondPath_t;
+
+/* Bonds several links into one link handle. Every frame spoken is wrapped in a Bond frame carrying a sequence number
+ * and sent on every path; received frames are merged and the first copy of each sequence number wins. */
+typedef struct
+{
+    CaveTalk_BondPath_t *paths;
+    size_t path_count;
+    CaveTalk_Clock_t clock;
+    uint16_t tx_sequence;
+    uint8_t tx_frame[CAVE_TALK_BOND_FRAME_SIZE_MAX];
+    size_t tx_length;
+    uint8_t rx_buffer[CAVE_TALK_BOND_RX_BUFFER_SIZE];
+    size_t rx_head;
+    size_t rx_length;
+    bool rx_started;
+    uint16_t rx_newest;
+    uint64_t rx_seen;
+    CaveTalk_Microseconds_t rx_arrivals[CAVE_TALK_BOND_WINDOW];
+    size_t last_winner;
+    CaveTalk_LinkHandle_t link_handle;
+} CaveTalk_Bond_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_BondPathInit(CaveTalk_BondPath_t *const path, const CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_BondOpen(CaveTalk_Bond_t *const bond,
+                                   CaveTalk_BondPath_t *const paths,
+                                   const size_t path_count,
+                                   const CaveTalk_Clock_t clock,
+                                   CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_BondClose(CaveTalk_Bond_t *const bond);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_BOND_H */
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef CAVE_TALK_BULK_H
+#define CAVE_TALK_BULK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Structure of arrays that recorded Movement and CameraMovement frames are decoded into, each message appended at its
+ * count until its capacity. Frames of other ids, and of a message whose columns are NULL, are skipped. Frames laid out
+ * as the encoders lay them out, both fields present in field order, are decoded without looking at the encoding; any
+ * other valid encoding falls back to parsing it field by field. */
+typedef struct
+{
+    double *speed;
+    double *turn_rate;
+    size_t movement_capacity;
+    size_t movement_count;
+    double *pan;
+    double *tilt;
+    size_t camera_movement_capacity;
+    size_t camera_movement_count;
+    uint32_t skipped;
+    uint32_t fallbacks;
+} CaveTalk_BulkColumns_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_BulkDecode(CaveTalk_BulkColumns_t *const columns,
+                                     const uint8_t *const data,
+                                     const size_t size,
+                                     size_t *const consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_BULK_H */
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef CAVE_TALK_DELTA_H
+#define CAVE_TALK_DELTA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+#include "cave_talk_varint.h"
+
+#define CAVE_TALK_ID_DELTA 12U /* See ids.proto */
+
+#define CAVE_TALK_DELTA_VALUES   2U
+#define CAVE_TALK_DELTA_SIZE_MAX (2U + (CAVE_TALK_DELTA_VALUES * CAVE_TALK_VARINT_SIZE_MAX)) /* Inner id, keyframe and values */
+
+typedef struct
+{
+    uint32_t keyframes;
+    uint32_t deltas;
+    uint32_t dropped;
+} CaveTalk_DeltaCounters_t;
+
+/* One stream of value pairs, such as Movement, sent as multiples of quantum. A keyframe carries the values themselves
+ * and each frame after it only their difference from the keyframe, as zigzag varints, so a lost frame never affects
+ * the ones after it. Keyframes are numbered, a delta whose keyframe was lost is dropped until the next keyframe, which
+ * is sent at least every keyframe_interval frames or whenever it would be no larger than the delta. Both ends must use
+ * the same quantum. */
+typedef struct
+{
+    CaveTalk_Id_t id;
+    double quantum;
+    uint32_t keyframe_interval;
+    int32_t reference[CAVE_TALK_DELTA_VALUES];
+    uint8_t keyframe;
+    uint32_t since_keyframe;
+    bool valid;
+    CaveTalk_DeltaCounters_t counters;
+} CaveTalk_DeltaStream_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_DeltaInit(CaveTalk_DeltaStream_t *const stream,
+                                    const CaveTalk_Id_t id,
+                                    const double quantum,
+                                    const uint32_t keyframe_interval);
+void CaveTalk_DeltaKeyframe(CaveTalk_DeltaStream_t *const stream);
+CaveTalk_Error_t CaveTalk_DeltaEncode(CaveTalk_DeltaStream_t *const stream,
+                                      const double values[CAVE_TALK_DELTA_VALUES],
+                                      uint8_t *const data,
+                                      const size_t size,
+                                      CaveTalk_Length_t *const length);
+CaveTalk_Error_t CaveTalk_DeltaDecode(CaveTalk_DeltaStream_t *const streams,
+                                      const size_t stream_count,
+                                      const uint8_t *const data,
+                                      const CaveTalk_Length_t length,
+                                      CaveTalk_Id_t *const id,
+                                      double values[CAVE_TALK_DELTA_VALUES]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_DELTA_H */
\ No newline at end of file
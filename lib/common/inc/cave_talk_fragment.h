@@ -0,0 +1,123 @@
+#ifndef CAVE_TALK_FRAGMENT_H
+#define CAVE_TALK_FRAGMENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+#include "cave_talk_varint.h"
+
+#define CAVE_TALK_ID_FRAGMENT 10U /* See ids.proto */
+
+#define CAVE_TALK_FRAGMENT_HEADER_SIZE_MAX (1U + CAVE_TALK_VARINT_SIZE_MAX + 1U + CAVE_TALK_VARINT_SIZE_MAX)
+#define CAVE_TALK_FRAGMENT_FRAME_SIZE_MIN  (CAVE_TALK_FRAGMENT_HEADER_SIZE_MAX + 1U)
+#define CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX  UINT8_MAX
+#define CAVE_TALK_FRAGMENT_STREAM_COUNT    16U /* Objects that can be in flight at once, one per fragmenter */
+
+/* One fragment frame as found on the wire. The transfer byte holds the sender's stream in its upper nibble and a per
+ * stream object count in its lower nibble. The first fragment of an object (offset 0) also carries the object's id and
+ * its total length, a varint of up to 32 bits. */
+typedef struct
+{
+    uint8_t transfer;
+    uint32_t offset;
+    CaveTalk_Id_t id;
+    uint32_t length;
+    const uint8_t *data;
+    size_t size;
+} CaveTalk_Fragment_t;
+
+/* Sends one object as a stream of fragment frames. Each call to CaveTalk_FragmentSpeak sends exactly one frame, so the
+ * object never has to be held in memory and control frames spoken between calls wait for at most one fragment. */
+typedef struct
+{
+    size_t frame_size;
+    size_t frame_limit; /* Set from the negotiated max payload, fragments are cut to the smaller of the two */
+    uint8_t stream;
+    uint8_t transfer;
+    CaveTalk_Id_t id;
+    uint32_t length;
+    uint32_t offset;
+    bool active;
+    uint8_t frame[CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX];
+} CaveTalk_Fragmenter_t;
+
+typedef struct
+{
+    uint8_t *buffer;
+    uint8_t transfer;
+    CaveTalk_Id_t id;
+    uint32_t length;
+    uint32_t received;
+    uint32_t age;
+    CaveTalk_Microseconds_t heard;
+    bool in_use;
+} CaveTalk_ReassemblySlot_t;
+
+typedef struct
+{
+    CaveTalk_Id_t id;
+    const uint8_t *data;
+    uint32_t length;
+} CaveTalk_FragmentObject_t;
+
+typedef struct
+{
+    uint32_t fragments;
+    uint32_t completed;
+    uint32_t dropped;
+    uint32_t evicted;
+    uint32_t expired;
+} CaveTalk_ReassemblerCounters_t;
+
+/* Reassembles objects into a caller provided pool split evenly between the slots, one object per slot and stream.
+ * Objects larger than a slot are rejected, a fragment out of sequence drops its object and a new object arriving with
+ * every slot busy evicts the one that has been idle the longest. Once scheduled on a timer wheel, an object that hears
+ * no fragment for the timeout is dropped when the wheel is advanced instead of holding its slot until evicted. */
+typedef struct
+{
+    CaveTalk_ReassemblySlot_t *slots;
+    size_t slot_count;
+    size_t slot_size;
+    uint32_t age;
+    CaveTalk_ReassemblerCounters_t counters;
+    CaveTalk_TimerWheel_t *wheel;
+    CaveTalk_Microseconds_t timeout;
+    CaveTalk_Timer_t timer;
+} CaveTalk_Reassembler_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_FragmentParse(const void *const data, const CaveTalk_Length_t length, CaveTalk_Fragment_t *const fragment);
+CaveTalk_Error_t CaveTalk_FragmenterInit(CaveTalk_Fragmenter_t *const fragmenter, const uint8_t stream, const size_t frame_size);
+CaveTalk_Error_t CaveTalk_FragmentStart(CaveTalk_Fragmenter_t *const fragmenter, const CaveTalk_Id_t id, const uint32_t length);
+size_t CaveTalk_FragmentChunkSize(const CaveTalk_Fragmenter_t *const fragmenter);
+CaveTalk_Error_t CaveTalk_FragmentSpeak(CaveTalk_Fragmenter_t *const fragmenter,
+                                        const CaveTalk_LinkHandle_t *const handle,
+                                        const void *const data,
+                                        const size_t size);
+void CaveTalk_FragmentLimit(CaveTalk_Fragmenter_t *const fragmenter, const size_t frame_limit);
+void CaveTalk_FragmentAbort(CaveTalk_Fragmenter_t *const fragmenter);
+CaveTalk_Error_t CaveTalk_ReassemblerInit(CaveTalk_Reassembler_t *const reassembler,
+                                          uint8_t *const pool,
+                                          const size_t pool_size,
+                                          CaveTalk_ReassemblySlot_t *const slots,
+                                          const size_t slot_count);
+CaveTalk_Error_t CaveTalk_ReassemblerHear(CaveTalk_Reassembler_t *const reassembler,
+                                          const void *const data,
+                                          const CaveTalk_Length_t length,
+                                          CaveTalk_FragmentObject_t *const object);
+bool CaveTalk_ReassemblerDeadline(const CaveTalk_Reassembler_t *const reassembler, CaveTalk_Microseconds_t *const deadline);
+CaveTalk_Error_t CaveTalk_ReassemblerSchedule(CaveTalk_Reassembler_t *const reassembler, CaveTalk_TimerWheel_t *const wheel, const CaveTalk_Microseconds_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_FRAGMENT_H */
\ No newline at end of file
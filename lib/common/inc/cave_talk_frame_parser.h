@@ -0,0 +1,45 @@
+#ifndef CAVE_TALK_FRAME_PARSER_H
+#define CAVE_TALK_FRAME_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Incremental parser for frames held in memory (captures, datagrams, relayed streams). Payloads are stored in the
+ * caller's buffer, or discarded when the buffer is NULL, in which case the CRC is not checked. An invalid header drops
+ * its first byte and parsing resumes from the next one, so the parser resynchronizes on its own after corruption. A
+ * frame failing its CRC check is dropped whole. */
+typedef struct
+{
+    uint8_t *buffer;
+    size_t buffer_size;
+    uint8_t header[CAVE_TALK_HEADER_SIZE];
+    uint8_t crc[CAVE_TALK_CRC_SIZE];
+    size_t header_received;
+    size_t payload_received;
+    size_t crc_received;
+} CaveTalk_FrameParser_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_FrameParserInit(CaveTalk_FrameParser_t *const parser, uint8_t *const buffer, const size_t buffer_size);
+void CaveTalk_FrameParserReset(CaveTalk_FrameParser_t *const parser);
+CaveTalk_Error_t CaveTalk_FrameParse(CaveTalk_FrameParser_t *const parser,
+                                     const void *const data,
+                                     const size_t size,
+                                     size_t *const consumed,
+                                     CaveTalk_Id_t *const id,
+                                     CaveTalk_Length_t *const length);
+size_t CaveTalk_FrameParserPending(const CaveTalk_FrameParser_t *const parser);
+size_t CaveTalk_FrameParserNeeded(const CaveTalk_FrameParser_t *const parser);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_FRAME_PARSER_H */
@@ -0,0 +1,49 @@
+#ifndef CAVE_TALK_HEARTBEAT_H
+#define CAVE_TALK_HEARTBEAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_HEARTBEAT_FILTER_SIZE 8U
+
+typedef struct
+{
+    CaveTalk_Clock_t clock;
+    CaveTalk_Microseconds_t interval;
+    CaveTalk_Microseconds_t last_ping;
+    CaveTalk_Microseconds_t last_heard;
+    CaveTalk_Microseconds_t round_trip_time;
+    CaveTalk_Microseconds_t smoothed_round_trip_time;
+    int64_t clock_offset;
+    CaveTalk_Microseconds_t filter_round_trip_time[CAVE_TALK_HEARTBEAT_FILTER_SIZE];
+    int64_t filter_clock_offset[CAVE_TALK_HEARTBEAT_FILTER_SIZE];
+    size_t filter_index;
+    size_t filter_count;
+    uint32_t pings_sent;
+    uint32_t pongs_received;
+} CaveTalk_Heartbeat_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_HeartbeatInit(CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t interval);
+bool CaveTalk_HeartbeatDue(const CaveTalk_Heartbeat_t *const heartbeat);
+void CaveTalk_HeartbeatPinged(CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Microseconds_t originate);
+void CaveTalk_HeartbeatHeard(CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Microseconds_t timestamp);
+CaveTalk_Error_t CaveTalk_HeartbeatPonged(CaveTalk_Heartbeat_t *const heartbeat,
+                                          const CaveTalk_Microseconds_t originate,
+                                          const CaveTalk_Microseconds_t receive,
+                                          const CaveTalk_Microseconds_t transmit,
+                                          const CaveTalk_Microseconds_t destination);
+bool CaveTalk_HeartbeatAlive(const CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Microseconds_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_HEARTBEAT_H */
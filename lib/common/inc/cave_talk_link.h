@@ -1,10 +1,26 @@
 #ifndef CAVE_TALK_LINK_H
 #define CAVE_TALK_LINK_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "cave_talk_types.h"
 
+#define CAVE_TALK_VERSION            1U
+#define CAVE_TALK_ID_NONE            0U /* See ids.proto */
+#define CAVE_TALK_ID_MOVEMENT        2U /* See ids.proto */
+#define CAVE_TALK_ID_CAMERA_MOVEMENT 3U /* See ids.proto */
+#define CAVE_TALK_ID_LIGHTS          4U /* See ids.proto */
+#define CAVE_TALK_ID_MODE            5U /* See ids.proto */
+
+#define CAVE_TALK_VERSION_INDEX 0U
+#define CAVE_TALK_ID_INDEX      (CAVE_TALK_VERSION_INDEX + sizeof(CaveTalk_Version_t))
+#define CAVE_TALK_LENGTH_INDEX  (CAVE_TALK_ID_INDEX + sizeof(CaveTalk_Id_t))
+
+#define CAVE_TALK_HEADER_SIZE (CAVE_TALK_LENGTH_INDEX + 1U)
+#define CAVE_TALK_CRC_SIZE    sizeof(CaveTalk_Crc_t)
+
 typedef struct
 {
     CaveTalk_Error_t (*send)(const void *const data, const size_t size);
@@ -12,7 +28,7 @@ typedef struct
     CaveTalk_Error_t (*available)(size_t *const bytes_available);
 } CaveTalk_LinkHandle_t;
 
-const CaveTalk_LinkHandle_t kCaveTalk_LinkHandleNull = {
+static const CaveTalk_LinkHandle_t kCaveTalk_LinkHandleNull = {
     .send = NULL, .receive = NULL, .available = NULL
 };
 
@@ -31,6 +47,11 @@ CaveTalk_Error_t CaveTalk_Listen(const CaveTalk_LinkHandle_t *const handle,
                                  const size_t size,
                                  CaveTalk_Length_t *const length);
 
+/* Every path that builds or parses frames calculates and checks the CRC through these, the payload is the header's
+ * length in bytes */
+void CaveTalk_CrcWrite(const uint8_t *const header, const void *const data, uint8_t *const crc);
+bool CaveTalk_CrcCheck(const uint8_t *const header, const void *const data, const uint8_t *const crc);
+
 #ifdef __cplusplus
 }
 #endif
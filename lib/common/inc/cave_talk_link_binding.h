@@ -0,0 +1,37 @@
+#ifndef CAVE_TALK_LINK_BINDING_H
+#define CAVE_TALK_LINK_BINDING_H
+
+#include <stddef.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Link callbacks carry no context, so stateful links (adapters, OS backends) are bound to one of a fixed number of
+ * trampoline slots that forward to context aware callbacks. Slots are claimed atomically, so links may be bound and
+ * unbound from any thread. The number of slots caps the links bound at once in a process, override it with 64, 128 or
+ * 256 (CAVETALK_LINK_BINDING_SLOTS in CMake). */
+#ifndef CAVE_TALK_LINK_BINDING_SLOTS
+#define CAVE_TALK_LINK_BINDING_SLOTS 32U
+#endif
+
+typedef struct
+{
+    void *context;
+    CaveTalk_Error_t (*send)(void *const context, const void *const data, const size_t size);
+    CaveTalk_Error_t (*receive)(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+    CaveTalk_Error_t (*available)(void *const context, size_t *const bytes_available);
+} CaveTalk_LinkBinding_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_LinkBind(const CaveTalk_LinkBinding_t *const binding, CaveTalk_LinkHandle_t *const handle);
+CaveTalk_Error_t CaveTalk_LinkUnbind(const CaveTalk_LinkHandle_t *const handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_LINK_BINDING_H */
@@ -0,0 +1,54 @@
+#ifndef CAVE_TALK_LISTEN_H
+#define CAVE_TALK_LISTEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Blocks until the link may have bytes available or the timeout elapses, whichever comes first */
+typedef CaveTalk_Error_t (*CaveTalk_LinkWait_t)(void *const context, const CaveTalk_Microseconds_t timeout);
+
+/* State kept between deadline bounded listens. A frame cut off by the deadline stays in the parser and the next listen
+ * picks it up where it stopped, so the same buffer must be passed until the frame completes. Without a wait callback
+ * listens never block and return as soon as the link has nothing available. */
+typedef struct
+{
+    CaveTalk_Clock_t clock;
+    CaveTalk_LinkWait_t wait;
+    void *wait_context;
+    CaveTalk_FrameParser_t parser;
+    uint32_t expired;
+} CaveTalk_ListenState_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_ListenStateInit(CaveTalk_ListenState_t *const state,
+                                          const CaveTalk_Clock_t clock,
+                                          const CaveTalk_LinkWait_t wait,
+                                          void *const wait_context);
+CaveTalk_Error_t CaveTalk_ListenUntil(const CaveTalk_LinkHandle_t *const handle,
+                                      CaveTalk_ListenState_t *const state,
+                                      const CaveTalk_Microseconds_t deadline,
+                                      CaveTalk_Id_t *const id,
+                                      void *const data,
+                                      const size_t size,
+                                      CaveTalk_Length_t *const length);
+CaveTalk_Error_t CaveTalk_ListenFor(const CaveTalk_LinkHandle_t *const handle,
+                                    CaveTalk_ListenState_t *const state,
+                                    const CaveTalk_Microseconds_t budget,
+                                    CaveTalk_Id_t *const id,
+                                    void *const data,
+                                    const size_t size,
+                                    CaveTalk_Length_t *const length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_LISTEN_H */
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef CAVE_TALK_NEGOTIATION_H
+#define CAVE_TALK_NEGOTIATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_ID_HELLO 13U /* See ids.proto */
+
+#define CAVE_TALK_NEGOTIATION_REVISION   2U /* Revision 1 is every build that does not negotiate */
+#define CAVE_TALK_NEGOTIATION_HELLO_SIZE 7U /* Revision, flags, capabilities u32 and max payload */
+
+#define CAVE_TALK_CAPABILITY_HEARTBEAT (1U << 0U)
+#define CAVE_TALK_CAPABILITY_RELIABLE  (1U << 1U)
+#define CAVE_TALK_CAPABILITY_FRAGMENT  (1U << 2U)
+#define CAVE_TALK_CAPABILITY_DELTA     (1U << 4U) /* Bit 3 is reserved, bonding sits below framing and is set up per link */
+
+typedef enum
+{
+    CAVE_TALK_NEGOTIATION_STATE_IDLE,
+    CAVE_TALK_NEGOTIATION_STATE_OFFERING,
+    CAVE_TALK_NEGOTIATION_STATE_AGREED,
+    CAVE_TALK_NEGOTIATION_STATE_FALLBACK
+} CaveTalk_NegotiationState_t;
+
+/* Each side offers its capabilities in a Hello frame when the link starts and answers every offer it hears with its
+ * own, after which both use the capabilities they have in common and the smaller max payload: frames longer than it
+ * are refused and fragments are cut to fit it, and fragment frames are neither sent nor heard unless both offered
+ * them. Offers are repeated every retry interval, and a peer that answers none of them is taken to predate
+ * negotiation: the link falls back to revision 1, with no optional capabilities. Unknown capability bits and Hello
+ * fields past the known ones are ignored, so later revisions can add both. */
+typedef struct
+{
+    CaveTalk_Clock_t clock;
+    uint32_t capabilities;
+    CaveTalk_Length_t max_payload;
+    CaveTalk_Microseconds_t retry_interval;
+    uint32_t attempts;
+    CaveTalk_NegotiationState_t state;
+    uint32_t offers;
+    CaveTalk_Microseconds_t last_offer;
+    uint8_t peer_revision;
+    uint32_t peer_capabilities;
+    uint32_t agreed_capabilities;
+    CaveTalk_Length_t agreed_max_payload;
+} CaveTalk_Negotiation_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_NegotiationInit(CaveTalk_Negotiation_t *const negotiation,
+                                          const CaveTalk_Clock_t clock,
+                                          const uint32_t capabilities,
+                                          const CaveTalk_Length_t max_payload,
+                                          const CaveTalk_Microseconds_t retry_interval,
+                                          const uint32_t attempts);
+void CaveTalk_NegotiationStart(CaveTalk_Negotiation_t *const negotiation);
+CaveTalk_Error_t CaveTalk_NegotiationPoll(CaveTalk_Negotiation_t *const negotiation, const CaveTalk_LinkHandle_t *const handle);
+CaveTalk_Error_t CaveTalk_NegotiationHear(CaveTalk_Negotiation_t *const negotiation,
+                                          const CaveTalk_LinkHandle_t *const handle,
+                                          const void *const data,
+                                          const CaveTalk_Length_t length);
+bool CaveTalk_NegotiationAllows(const CaveTalk_Negotiation_t *const negotiation, const uint32_t capability);
+CaveTalk_Length_t CaveTalk_NegotiationMaxPayload(const CaveTalk_Negotiation_t *const negotiation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_NEGOTIATION_H */
\ No newline at end of file
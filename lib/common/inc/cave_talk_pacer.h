@@ -0,0 +1,81 @@
+#ifndef CAVE_TALK_PACER_H
+#define CAVE_TALK_PACER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_PACER_FRAME_SIZE_MAX (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+
+/* A frame waiting for tokens */
+typedef struct
+{
+    CaveTalk_Id_t id;
+    CaveTalk_Length_t length;
+    uint8_t payload[UINT8_MAX];
+} CaveTalk_PacerSlot_t;
+
+typedef struct
+{
+    uint32_t sent;
+    uint32_t queued;
+    uint32_t rejected;
+    uint64_t bytes_sent;
+    uint64_t bytes_charged;
+} CaveTalk_PacerCounters_t;
+
+/* Token bucket limiting the bytes a link is given to its rate, so a burst of frames waits here rather than growing the
+ * link's own buffer, e.g. a UART behind a slow radio. Each frame costs its full size including header and CRC, tokens
+ * accrue at rate bytes per second up to burst bytes. Frames that cannot be sent yet are queued in order in the slots,
+ * or rejected with CAVE_TALK_ERROR_RATE when there are no slots free. Frames that must not wait, e.g. reliable frames,
+ * retransmits, acks, pings and fragments, are charged instead when they are sent through the link from
+ * CaveTalk_PacerBind. They may take the bucket below zero, and paced frames then wait until it is repaid. */
+typedef struct
+{
+    CaveTalk_Clock_t clock;
+    uint32_t rate;
+    uint32_t burst;
+    int64_t tokens; /* Bytes scaled by a million, so a microsecond of accrual is a whole number */
+    CaveTalk_Microseconds_t last_refill;
+    CaveTalk_PacerSlot_t *slots;
+    size_t slot_count;
+    size_t slot_head;
+    size_t slots_queued;
+    size_t bytes_queued;
+    CaveTalk_LinkHandle_t link_handle;
+    CaveTalk_LinkHandle_t charged_link_handle;
+    bool speaking;
+    CaveTalk_PacerCounters_t counters;
+} CaveTalk_Pacer_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_PacerInit(CaveTalk_Pacer_t *const pacer,
+                                    const CaveTalk_Clock_t clock,
+                                    const uint32_t rate,
+                                    const uint32_t burst,
+                                    CaveTalk_PacerSlot_t *const slots,
+                                    const size_t slot_count);
+CaveTalk_Error_t CaveTalk_PacerSpeak(CaveTalk_Pacer_t *const pacer,
+                                     const CaveTalk_LinkHandle_t *const link_handle,
+                                     const CaveTalk_Id_t id,
+                                     const void *const data,
+                                     const CaveTalk_Length_t length);
+CaveTalk_Error_t CaveTalk_PacerDrain(CaveTalk_Pacer_t *const pacer, const CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Microseconds_t CaveTalk_PacerDelay(const CaveTalk_Pacer_t *const pacer);
+CaveTalk_Error_t CaveTalk_PacerBind(CaveTalk_Pacer_t *const pacer,
+                                    const CaveTalk_LinkHandle_t *const link_handle,
+                                    CaveTalk_LinkHandle_t *const charged_link_handle);
+CaveTalk_Error_t CaveTalk_PacerUnbind(CaveTalk_Pacer_t *const pacer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_PACER_H */
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef CAVE_TALK_RELIABLE_H
+#define CAVE_TALK_RELIABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_ID_RELIABLE 8U /* See ids.proto */
+#define CAVE_TALK_ID_ACK      9U /* See ids.proto */
+
+#define CAVE_TALK_RELIABLE_WINDOW            32U /* Sequence numbers in flight, one bit each in the selective ACK */
+#define CAVE_TALK_RELIABLE_HEADER_SIZE       3U  /* Sequence number (2) and inner id (1) */
+#define CAVE_TALK_RELIABLE_PAYLOAD_SIZE_MAX  (UINT8_MAX - CAVE_TALK_RELIABLE_HEADER_SIZE)
+#define CAVE_TALK_RELIABLE_ACK_SIZE          6U  /* Cumulative ACK (2) and selective ACK bitmap (4) */
+#define CAVE_TALK_RELIABLE_RTO_INITIAL       250000U
+#define CAVE_TALK_RELIABLE_RTO_MIN           5000U
+#define CAVE_TALK_RELIABLE_RTO_MAX           2000000U
+#define CAVE_TALK_RELIABLE_BACKOFF_MAX       8U  /* Doublings of the RTO for a frame that keeps timing out */
+#define CAVE_TALK_RELIABLE_ID_WORDS          ((UINT8_MAX + 1U) / 32U)
+
+/* A frame waiting for its ACK on the sending side, or waiting for the frames before it on the receiving side */
+typedef struct
+{
+    CaveTalk_Microseconds_t sent;
+    uint16_t sequence;
+    uint8_t transmissions;
+    bool in_use;
+    CaveTalk_Length_t length;
+    uint8_t payload[UINT8_MAX];
+} CaveTalk_ReliableSlot_t;
+
+typedef struct
+{
+    CaveTalk_Id_t id;
+    const uint8_t *data;
+    CaveTalk_Length_t length;
+} CaveTalk_ReliableFrame_t;
+
+typedef struct
+{
+    uint32_t sent;
+    uint32_t retransmitted;
+    uint32_t acknowledged;
+    uint32_t delivered;
+    uint32_t duplicates;
+    uint32_t out_of_order;
+} CaveTalk_ReliableCounters_t;
+
+/* Opt-in ACK/retransmit layer keyed by message id. Frames of enabled ids are wrapped in an ID_RELIABLE frame with a
+ * sequence number, kept in a send slot until acknowledged and retransmitted after an adaptive RTO (RFC 6298, with
+ * exponential backoff per frame). Frames are never given up on, so a full window is reported as a size error. The
+ * receiver delivers frames in sequence order exactly once and answers every reliable frame with an ID_ACK frame
+ * carrying the next expected sequence number and a bitmap of the frames buffered beyond it. Ids that are not enabled
+ * never touch this layer. Retransmits are either polled or, once scheduled on a timer wheel sharing the same clock,
+ * sent from a timer kept on the earliest retransmit deadline. */
+typedef struct
+{
+    CaveTalk_Clock_t clock;
+    uint32_t enabled_ids[CAVE_TALK_RELIABLE_ID_WORDS];
+    CaveTalk_ReliableSlot_t *send_slots;
+    size_t send_slot_count;
+    CaveTalk_ReliableSlot_t *receive_slots;
+    size_t receive_slot_count;
+    uint16_t send_next;
+    uint16_t receive_next;
+    bool round_trip_time_valid;
+    CaveTalk_Microseconds_t smoothed_round_trip_time;
+    CaveTalk_Microseconds_t round_trip_time_variance;
+    CaveTalk_Microseconds_t retransmission_timeout;
+    CaveTalk_ReliableCounters_t counters;
+    CaveTalk_TimerWheel_t *wheel;
+    const CaveTalk_LinkHandle_t *wheel_handle;
+    CaveTalk_Timer_t timer;
+} CaveTalk_Reliable_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_ReliableInit(CaveTalk_Reliable_t *const reliable,
+                                       const CaveTalk_Clock_t clock,
+                                       CaveTalk_ReliableSlot_t *const send_slots,
+                                       const size_t send_slot_count,
+                                       CaveTalk_ReliableSlot_t *const receive_slots,
+                                       const size_t receive_slot_count);
+CaveTalk_Error_t CaveTalk_ReliableEnable(CaveTalk_Reliable_t *const reliable, const CaveTalk_Id_t id, const bool enable);
+bool CaveTalk_ReliableEnabled(const CaveTalk_Reliable_t *const reliable, const CaveTalk_Id_t id);
+CaveTalk_Error_t CaveTalk_ReliableSpeak(CaveTalk_Reliable_t *const reliable,
+                                        const CaveTalk_LinkHandle_t *const handle,
+                                        const CaveTalk_Id_t id,
+                                        const void *const data,
+                                        const CaveTalk_Length_t length);
+CaveTalk_Error_t CaveTalk_ReliableRetransmit(CaveTalk_Reliable_t *const reliable, const CaveTalk_LinkHandle_t *const handle);
+CaveTalk_Error_t CaveTalk_ReliableHearAck(CaveTalk_Reliable_t *const reliable, const void *const data, const CaveTalk_Length_t length);
+CaveTalk_Error_t CaveTalk_ReliableHear(CaveTalk_Reliable_t *const reliable,
+                                       const CaveTalk_LinkHandle_t *const handle,
+                                       const void *const data,
+                                       const CaveTalk_Length_t length,
+                                       CaveTalk_ReliableFrame_t *const frame);
+bool CaveTalk_ReliableNext(CaveTalk_Reliable_t *const reliable, CaveTalk_ReliableFrame_t *const frame);
+size_t CaveTalk_ReliableInFlight(const CaveTalk_Reliable_t *const reliable);
+bool CaveTalk_ReliableDeadline(const CaveTalk_Reliable_t *const reliable, CaveTalk_Microseconds_t *const deadline);
+CaveTalk_Error_t CaveTalk_ReliableSchedule(CaveTalk_Reliable_t *const reliable, CaveTalk_TimerWheel_t *const wheel, const CaveTalk_LinkHandle_t *const handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_RELIABLE_H */
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef CAVE_TALK_ROUTER_H
+#define CAVE_TALK_ROUTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_ROUTER_LINK_COUNT_MAX 32U
+#define CAVE_TALK_ROUTER_FRAME_SIZE_MAX (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+#define CAVE_TALK_ROUTER_ID_ANY         CAVE_TALK_ID_NONE /* Never appears in a frame, so in a rule it matches every id */
+#define CAVE_TALK_ROUTER_LINKS_ALL      UINT32_MAX
+
+/* Frames with the rule's id arriving on any link in sources are forwarded to every link in destinations, both bit masks
+ * of link indices. A frame is never sent back out of the link it arrived on. */
+typedef struct
+{
+    uint32_t sources;
+    CaveTalk_Id_t id;
+    uint32_t destinations;
+} CaveTalk_RouterRule_t;
+
+typedef struct
+{
+    uint32_t frames_in;
+    uint32_t frames_out;
+    uint32_t stalls;
+} CaveTalk_RouterLinkCounters_t;
+
+/* Output frames wait in a caller provided queue of whole frame slots. A frame whose destinations cannot all take it is
+ * held on its source link, which is not read again until the frame is queued, so a slow link pushes back on its sources
+ * rather than losing frames. */
+typedef struct
+{
+    CaveTalk_LinkHandle_t link_handle;
+    uint8_t *queue;
+    size_t queue_slots;
+    size_t queue_head;
+    size_t queue_count;
+    uint8_t held[CAVE_TALK_ROUTER_FRAME_SIZE_MAX];
+    uint32_t held_destinations;
+    CaveTalk_RouterLinkCounters_t counters;
+} CaveTalk_RouterLink_t;
+
+typedef struct
+{
+    uint32_t routed;
+    uint32_t unrouted;
+    uint32_t errors;
+} CaveTalk_RouterCounters_t;
+
+typedef struct
+{
+    CaveTalk_RouterLink_t *links;
+    size_t link_count;
+    const CaveTalk_RouterRule_t *rules;
+    size_t rule_count;
+    size_t budget;
+    uint32_t outputs;
+    CaveTalk_RouterCounters_t counters;
+} CaveTalk_Router_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_RouterLinkInit(CaveTalk_RouterLink_t *const link,
+                                         const CaveTalk_LinkHandle_t *const link_handle,
+                                         uint8_t *const queue,
+                                         const size_t queue_size);
+CaveTalk_Error_t CaveTalk_RouterInit(CaveTalk_Router_t *const router,
+                                     CaveTalk_RouterLink_t *const links,
+                                     const size_t link_count,
+                                     const CaveTalk_RouterRule_t *const rules,
+                                     const size_t rule_count,
+                                     const size_t budget);
+CaveTalk_Error_t CaveTalk_RouterPoll(CaveTalk_Router_t *const router, size_t *const forwarded);
+uint32_t CaveTalk_RouterDestinations(const CaveTalk_Router_t *const router, const size_t source, const CaveTalk_Id_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_ROUTER_H */
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef CAVE_TALK_TIMER_H
+#define CAVE_TALK_TIMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_TIMER_WHEEL_BITS   6U
+#define CAVE_TALK_TIMER_WHEEL_SLOTS  (1U << CAVE_TALK_TIMER_WHEEL_BITS)
+#define CAVE_TALK_TIMER_WHEEL_LEVELS 4U /* 2^24 ticks, about 4.6 hours at 1 ms, longer timeouts wait in the last level */
+
+typedef void (*CaveTalk_TimerCallback_t)(void *const context);
+
+/* Timers are owned by the caller and linked into the wheel while pending, so starting and cancelling never allocate. A
+ * pending timer must not be moved or freed until it fires or is cancelled. */
+typedef struct CaveTalk_Timer
+{
+    struct CaveTalk_Timer *next;
+    struct CaveTalk_Timer **previous;
+    uint64_t expiry;
+    CaveTalk_TimerCallback_t callback;
+    void *context;
+} CaveTalk_Timer_t;
+
+/* Hierarchical timing wheel: level 0 holds timers due in the next 64 ticks one slot per tick, each level above covers
+ * 64 times the span of the one below and is moved down a level as time reaches it. Starting and cancelling are O(1),
+ * and advancing costs one step per elapsed tick plus the timers it moves or fires. Timeouts are rounded up to whole
+ * ticks of the clock. */
+typedef struct
+{
+    CaveTalk_Clock_t clock;
+    CaveTalk_Microseconds_t tick;
+    uint64_t next;
+    size_t active;
+    CaveTalk_Timer_t *slots[CAVE_TALK_TIMER_WHEEL_LEVELS][CAVE_TALK_TIMER_WHEEL_SLOTS];
+} CaveTalk_TimerWheel_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_TimerWheelInit(CaveTalk_TimerWheel_t *const wheel, const CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t tick);
+CaveTalk_Error_t CaveTalk_TimerInit(CaveTalk_Timer_t *const timer, const CaveTalk_TimerCallback_t callback, void *const context);
+CaveTalk_Error_t CaveTalk_TimerStart(CaveTalk_TimerWheel_t *const wheel, CaveTalk_Timer_t *const timer, const CaveTalk_Microseconds_t timeout);
+CaveTalk_Error_t CaveTalk_TimerCancel(CaveTalk_TimerWheel_t *const wheel, CaveTalk_Timer_t *const timer);
+bool CaveTalk_TimerPending(const CaveTalk_Timer_t *const timer);
+CaveTalk_Error_t CaveTalk_TimerWheelAdvance(CaveTalk_TimerWheel_t *const wheel, size_t *const fired);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_TIMER_H */
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef CAVE_TALK_TRACE_H
+#define CAVE_TALK_TRACE_H
+
+#include "cave_talk_types.h"
+
+/* Probe points across the lifetime of a frame, in order: encoding of the payload starts, the frame is written to the
+ * link, its header is received, its payload and CRC are received, decoding of the payload starts, and the listen
+ * callback is entered and returns. Every probe carries the frame's id and length, encode and the callback probes a
+ * length of 0.
+ *
+ * Probes are compiled in with CAVE_TALK_TRACE (the CAVETALK_TRACE CMake option) and expand to nothing otherwise. With
+ * CAVE_TALK_TRACE_USDT they are USDT probes in provider cave_talk, a single nop each until perf or bpftrace attaches.
+ * Without it they call the hook set with CaveTalk_TraceSetHook, for platforms without sys/sdt.h. */
+typedef enum
+{
+    CAVE_TALK_TRACE_PROBE_ENCODE,
+    CAVE_TALK_TRACE_PROBE_SEND,
+    CAVE_TALK_TRACE_PROBE_HEADER,
+    CAVE_TALK_TRACE_PROBE_PAYLOAD,
+    CAVE_TALK_TRACE_PROBE_DECODE,
+    CAVE_TALK_TRACE_PROBE_CALLBACK_ENTRY,
+    CAVE_TALK_TRACE_PROBE_CALLBACK_EXIT
+} CaveTalk_TraceProbe_t;
+
+typedef void (*CaveTalk_TraceHook_t)(const CaveTalk_TraceProbe_t probe, const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+
+#if defined(CAVE_TALK_TRACE_USDT)
+#include <sys/sdt.h>
+#define CAVE_TALK_TRACE_PROBE(name, probe, id, length) DTRACE_PROBE2(cave_talk, name, id, length)
+#elif defined(CAVE_TALK_TRACE)
+#define CAVE_TALK_TRACE_PROBE(name, probe, id, length) CaveTalk_Trace(probe, id, length)
+#else
+#define CAVE_TALK_TRACE_PROBE(name, probe, id, length) ((void)0)
+#endif
+
+#define CAVE_TALK_TRACE_ENCODE(id)          CAVE_TALK_TRACE_PROBE(encode, CAVE_TALK_TRACE_PROBE_ENCODE, id, 0U)
+#define CAVE_TALK_TRACE_SEND(id, length)    CAVE_TALK_TRACE_PROBE(send, CAVE_TALK_TRACE_PROBE_SEND, id, length)
+#define CAVE_TALK_TRACE_HEADER(id, length)  CAVE_TALK_TRACE_PROBE(header, CAVE_TALK_TRACE_PROBE_HEADER, id, length)
+#define CAVE_TALK_TRACE_PAYLOAD(id, length) CAVE_TALK_TRACE_PROBE(payload, CAVE_TALK_TRACE_PROBE_PAYLOAD, id, length)
+#define CAVE_TALK_TRACE_DECODE(id, length)  CAVE_TALK_TRACE_PROBE(decode, CAVE_TALK_TRACE_PROBE_DECODE, id, length)
+#define CAVE_TALK_TRACE_CALLBACK_ENTRY(id)  CAVE_TALK_TRACE_PROBE(callback_entry, CAVE_TALK_TRACE_PROBE_CALLBACK_ENTRY, id, 0U)
+#define CAVE_TALK_TRACE_CALLBACK_EXIT(id)   CAVE_TALK_TRACE_PROBE(callback_exit, CAVE_TALK_TRACE_PROBE_CALLBACK_EXIT, id, 0U)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void CaveTalk_TraceSetHook(const CaveTalk_TraceHook_t hook);
+void CaveTalk_Trace(const CaveTalk_TraceProbe_t probe, const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_TRACE_H */
\ No newline at end of file
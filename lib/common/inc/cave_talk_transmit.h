@@ -0,0 +1,58 @@
+#ifndef CAVE_TALK_TRANSMIT_H
+#define CAVE_TALK_TRANSMIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_TRANSMIT_FRAME_SIZE_MAX (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+
+/* Writes up to size bytes without blocking and reports how many were taken. Taking none, e.g. with a full socket buffer
+ * or UART FIFO, is not an error. */
+typedef CaveTalk_Error_t (*CaveTalk_LinkWrite_t)(void *const context, const void *const data, const size_t size, size_t *const bytes_written);
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t writes;
+    uint32_t partial_writes;
+    uint32_t busy;
+} CaveTalk_TransmitStats_t;
+
+/* Turns a partial write into a link handle that never blocks and never corrupts the stream. The frame spoken is gathered
+ * and written as far as the link takes it, the rest is kept and continued by CaveTalk_TransmitterResume, e.g. when epoll
+ * reports the link writable. A frame is only accepted whole: speaking while one is still pending returns
+ * CAVE_TALK_ERROR_BUSY before anything is taken, and a frame partly written is never dropped, even after a write error.
+ * A frame none of which reached the link before a write error is dropped and the error returned, so it can be spoken
+ * again without going out twice. */
+typedef struct
+{
+    CaveTalk_LinkWrite_t write;
+    void *context;
+    uint8_t frame[CAVE_TALK_TRANSMIT_FRAME_SIZE_MAX];
+    size_t length;
+    size_t written;
+    CaveTalk_TransmitStats_t stats;
+    CaveTalk_LinkHandle_t link_handle;
+} CaveTalk_Transmitter_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_TransmitterOpen(CaveTalk_Transmitter_t *const transmitter,
+                                          const CaveTalk_LinkWrite_t write,
+                                          void *const context,
+                                          CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_TransmitterResume(CaveTalk_Transmitter_t *const transmitter);
+size_t CaveTalk_TransmitterPending(const CaveTalk_Transmitter_t *const transmitter);
+CaveTalk_Error_t CaveTalk_TransmitterClose(CaveTalk_Transmitter_t *const transmitter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_TRANSMIT_H */
\ No newline at end of file
@@ -12,6 +12,7 @@ typedef uint32_t CaveTalk_Crc_t;
 typedef double   CaveTalk_MetersPerSecond_t;
 typedef double   CaveTalk_Radian_t;
 typedef double   CaveTalk_RadiansPerSecond_t;
+typedef uint64_t CaveTalk_Microseconds_t;
 
 typedef enum
 {
@@ -23,7 +24,12 @@ typedef enum
     CAVE_TALK_ERROR_CRC,
     CAVE_TALK_ERROR_VERSION,
     CAVE_TALK_ERROR_ID,
-    CAVE_TALK_ERROR_PARSE
+    CAVE_TALK_ERROR_PARSE,
+    CAVE_TALK_ERROR_IO,
+    CAVE_TALK_ERROR_BUSY,
+    CAVE_TALK_ERROR_RATE
 } CaveTalk_Error_t;
 
+typedef CaveTalk_Microseconds_t (*CaveTalk_Clock_t)(void);
+
 #endif /* CAVE_TALK_TYPES_H */
\ No newline at end of file
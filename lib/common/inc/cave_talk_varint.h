@@ -0,0 +1,24 @@
+#ifndef CAVE_TALK_VARINT_H
+#define CAVE_TALK_VARINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_VARINT_SIZE_MAX 5U /* LEB128 bytes for a uint32_t */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+size_t CaveTalk_VarintSize(const uint32_t value);
+CaveTalk_Error_t CaveTalk_VarintEncode(const uint32_t value, uint8_t *const bytes, const size_t size, size_t *const written);
+CaveTalk_Error_t CaveTalk_VarintDecode(const uint8_t *const bytes, const size_t size, uint32_t *const value, size_t *const read);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_VARINT_H */
\ No newline at end of file
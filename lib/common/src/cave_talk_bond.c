@@ -0,0 +1,399 @@
+#include "cave_talk_bond.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_BOND_SEQUENCE_INDEX  0U
+#define CAVE_TALK_BOND_TIMESTAMP_INDEX 2U
+#define CAVE_TALK_BOND_ID_INDEX        6U
+#define CAVE_TALK_BOND_SMOOTHING_SHIFT 3U /* New samples weigh 1/8 */
+#define CAVE_TALK_BOND_HALF_SEQUENCE   0x8000U
+
+static CaveTalk_Error_t CaveTalk_BondSend(void *const context, const void *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_BondReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_BondAvailable(void *const context, size_t *const bytes_available);
+static CaveTalk_Error_t CaveTalk_BondSpeak(CaveTalk_Bond_t *const bond);
+static CaveTalk_Error_t CaveTalk_BondPump(CaveTalk_Bond_t *const bond);
+static void CaveTalk_BondHear(CaveTalk_Bond_t *const bond, const size_t path_index, const CaveTalk_Id_t id, const CaveTalk_Length_t length);
+static bool CaveTalk_BondFresh(CaveTalk_Bond_t *const bond, const uint16_t sequence);
+static void CaveTalk_BondAppend(CaveTalk_Bond_t *const bond, const CaveTalk_Id_t id, const uint8_t *const payload, const CaveTalk_Length_t length);
+
+CaveTalk_Error_t CaveTalk_BondPathInit(CaveTalk_BondPath_t *const path, const CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == path) || (NULL == link_handle))
+    {
+    }
+    else
+    {
+        path->link_handle = *link_handle;
+        memset(&path->stats, 0, sizeof(path->stats));
+
+        error = CaveTalk_FrameParserInit(&path->parser, path->payload, sizeof(path->payload));
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_BondOpen(CaveTalk_Bond_t *const bond,
+                                   CaveTalk_BondPath_t *const paths,
+                                   const size_t path_count,
+                                   const CaveTalk_Clock_t clock,
+                                   CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == bond) || (NULL == paths) || (NULL == clock) || (NULL == link_handle))
+    {
+    }
+    else if ((0U == path_count) || (path_count > CAVE_TALK_BOND_PATH_COUNT_MAX))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        CaveTalk_LinkBinding_t binding;
+
+        bond->paths       = paths;
+        bond->path_count  = path_count;
+        bond->clock       = clock;
+        bond->tx_sequence = 0U;
+        bond->tx_length   = 0U;
+        bond->rx_head     = 0U;
+        bond->rx_length   = 0U;
+        bond->rx_started  = false;
+        bond->rx_newest   = 0U;
+        bond->rx_seen     = 0U;
+        bond->last_winner = 0U;
+        memset(bond->rx_arrivals, 0, sizeof(bond->rx_arrivals));
+
+        binding.context   = bond;
+        binding.send      = CaveTalk_BondSend;
+        binding.receive   = CaveTalk_BondReceive;
+        binding.available = CaveTalk_BondAvailable;
+
+        error = CaveTalk_LinkBind(&binding, &bond->link_handle);
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *link_handle = bond->link_handle;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_BondClose(CaveTalk_Bond_t *const bond)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == bond)
+    {
+    }
+    else
+    {
+        error = CaveTalk_LinkUnbind(&bond->link_handle);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_BondSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Bond_t *const bond  = (CaveTalk_Bond_t *)context;
+    CaveTalk_Error_t       error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) && (0U != size))
+    {
+    }
+    else if ((bond->tx_length + size) > sizeof(bond->tx_frame))
+    {
+        bond->tx_length = 0U;
+        error           = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Speak sends the header, payload and CRC separately, gather the frame before wrapping it */
+        if (0U != size)
+        {
+            memcpy(&bond->tx_frame[bond->tx_length], data, size);
+            bond->tx_length += size;
+        }
+
+        if ((bond->tx_length >= CAVE_TALK_HEADER_SIZE) &&
+            (bond->tx_length >= (CAVE_TALK_HEADER_SIZE + bond->tx_frame[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE)))
+        {
+            error           = CaveTalk_BondSpeak(bond);
+            bond->tx_length = 0U;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_BondReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Bond_t *const bond  = (CaveTalk_Bond_t *)context;
+    CaveTalk_Error_t       error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) || (NULL == bytes_received))
+    {
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_NONE;
+
+        if ((bond->rx_length - bond->rx_head) < size)
+        {
+            error = CaveTalk_BondPump(bond);
+        }
+
+        *bytes_received = ((bond->rx_length - bond->rx_head) < size) ? (bond->rx_length - bond->rx_head) : size;
+
+        if (0U != *bytes_received)
+        {
+            memcpy(data, &bond->rx_buffer[bond->rx_head], *bytes_received);
+            bond->rx_head += *bytes_received;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_BondAvailable(void *const context, size_t *const bytes_available)
+{
+    CaveTalk_Bond_t *const bond  = (CaveTalk_Bond_t *)context;
+    CaveTalk_Error_t       error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == bytes_available)
+    {
+    }
+    else
+    {
+        error            = CaveTalk_BondPump(bond);
+        *bytes_available = bond->rx_length - bond->rx_head;
+    }
+
+    return error;
+}
+
+/* Wraps the gathered frame in a Bond frame and sends it on every path, succeeding when any path takes it */
+static CaveTalk_Error_t CaveTalk_BondSpeak(CaveTalk_Bond_t *const bond)
+{
+    CaveTalk_Error_t  error  = CAVE_TALK_ERROR_NULL;
+    CaveTalk_Length_t length = bond->tx_frame[CAVE_TALK_LENGTH_INDEX];
+
+    if (length > CAVE_TALK_BOND_PAYLOAD_SIZE_MAX)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        uint8_t        frame[CAVE_TALK_BOND_FRAME_SIZE_MAX];
+        uint8_t *const header    = &frame[CAVE_TALK_HEADER_SIZE];
+        const uint32_t timestamp = (uint32_t)bond->clock();
+        const size_t   size      = CAVE_TALK_HEADER_SIZE + CAVE_TALK_BOND_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+        bool           sent      = false;
+
+        frame[CAVE_TALK_VERSION_INDEX]              = CAVE_TALK_VERSION;
+        frame[CAVE_TALK_ID_INDEX]                   = CAVE_TALK_ID_BOND;
+        frame[CAVE_TALK_LENGTH_INDEX]               = (uint8_t)(CAVE_TALK_BOND_HEADER_SIZE + length);
+        header[CAVE_TALK_BOND_SEQUENCE_INDEX]       = (uint8_t)bond->tx_sequence;
+        header[CAVE_TALK_BOND_SEQUENCE_INDEX + 1U]  = (uint8_t)(bond->tx_sequence >> 8U);
+        header[CAVE_TALK_BOND_TIMESTAMP_INDEX]      = (uint8_t)timestamp;
+        header[CAVE_TALK_BOND_TIMESTAMP_INDEX + 1U] = (uint8_t)(timestamp >> 8U);
+        header[CAVE_TALK_BOND_TIMESTAMP_INDEX + 2U] = (uint8_t)(timestamp >> 16U);
+        header[CAVE_TALK_BOND_TIMESTAMP_INDEX + 3U] = (uint8_t)(timestamp >> 24U);
+        header[CAVE_TALK_BOND_ID_INDEX]             = bond->tx_frame[CAVE_TALK_ID_INDEX];
+        memcpy(&header[CAVE_TALK_BOND_HEADER_SIZE], &bond->tx_frame[CAVE_TALK_HEADER_SIZE], length);
+
+        /* The inner frame's CRC does not cover the Bond header, so the outer frame gets its own */
+        CaveTalk_CrcWrite(frame, header, &header[CAVE_TALK_BOND_HEADER_SIZE + length]);
+
+        bond->tx_sequence++;
+
+        for (size_t index = 0U; index < bond->path_count; index++)
+        {
+            const CaveTalk_LinkHandle_t *const path_handle = &bond->paths[index].link_handle;
+
+            if (NULL != path_handle->send)
+            {
+                const CaveTalk_Error_t path_error = path_handle->send(frame, size);
+
+                sent  = sent || (CAVE_TALK_ERROR_NONE == path_error);
+                error = sent ? CAVE_TALK_ERROR_NONE : path_error;
+            }
+        }
+    }
+
+    return error;
+}
+
+/* Reads each path up to the end of its current frame at most, so every read completes at most one frame and the
+ * merged buffer always has room for it */
+static CaveTalk_Error_t CaveTalk_BondPump(CaveTalk_Bond_t *const bond)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    for (size_t index = 0U; index < bond->path_count; index++)
+    {
+        CaveTalk_BondPath_t *const path    = &bond->paths[index];
+        bool                       reading = (NULL != path->link_handle.receive) && (NULL != path->link_handle.available);
+
+        while (reading && ((sizeof(bond->rx_buffer) - (bond->rx_length - bond->rx_head)) >= CAVE_TALK_BOND_FRAME_SIZE_MAX))
+        {
+            uint8_t           chunk[CAVE_TALK_BOND_FRAME_SIZE_MAX];
+            size_t            available  = 0U;
+            size_t            received   = 0U;
+            size_t            consumed   = 0U;
+            CaveTalk_Id_t     id         = CAVE_TALK_ID_NONE;
+            CaveTalk_Length_t length     = 0U;
+            CaveTalk_Error_t  path_error = path->link_handle.available(&available);
+
+            if ((CAVE_TALK_ERROR_NONE == path_error) && (0U != available))
+            {
+                const size_t needed = CaveTalk_FrameParserNeeded(&path->parser);
+
+                path_error = path->link_handle.receive(chunk, (available < needed) ? available : needed, &received);
+            }
+
+            if ((CAVE_TALK_ERROR_NONE != path_error) || (0U == received))
+            {
+                /* One path failing must not stop the others */
+                error   = (CAVE_TALK_ERROR_NONE != path_error) ? path_error : error;
+                reading = false;
+            }
+            else if (CAVE_TALK_ERROR_NONE == CaveTalk_FrameParse(&path->parser, chunk, received, &consumed, &id, &length))
+            {
+                CaveTalk_BondHear(bond, index, id, length);
+            }
+        }
+    }
+
+    return error;
+}
+
+static void CaveTalk_BondHear(CaveTalk_Bond_t *const bond, const size_t path_index, const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    CaveTalk_BondPath_t *const path    = &bond->paths[path_index];
+    const uint8_t *const       payload = path->payload;
+
+    if ((CAVE_TALK_ID_BOND != id) || (length < CAVE_TALK_BOND_HEADER_SIZE))
+    {
+        /* Frames from peers that do not bond pass through untouched */
+        CaveTalk_BondAppend(bond, id, payload, length);
+    }
+    else
+    {
+        const CaveTalk_Microseconds_t now       = bond->clock();
+        const uint16_t                sequence  = (uint16_t)(payload[CAVE_TALK_BOND_SEQUENCE_INDEX] |
+                                                             ((uint16_t)payload[CAVE_TALK_BOND_SEQUENCE_INDEX + 1U] << 8U));
+        const uint32_t                timestamp = (uint32_t)payload[CAVE_TALK_BOND_TIMESTAMP_INDEX] |
+                                                  ((uint32_t)payload[CAVE_TALK_BOND_TIMESTAMP_INDEX + 1U] << 8U) |
+                                                  ((uint32_t)payload[CAVE_TALK_BOND_TIMESTAMP_INDEX + 2U] << 16U) |
+                                                  ((uint32_t)payload[CAVE_TALK_BOND_TIMESTAMP_INDEX + 3U] << 24U);
+        const int32_t                 latency   = (int32_t)((uint32_t)now - timestamp);
+        const size_t                  slot      = sequence % CAVE_TALK_BOND_WINDOW;
+
+        if (0U == path->stats.frames)
+        {
+            path->stats.smoothed_latency = latency;
+            path->stats.latency_min      = latency;
+            path->stats.latency_max      = latency;
+        }
+        else
+        {
+            path->stats.smoothed_latency += (latency - path->stats.smoothed_latency) / (1 << CAVE_TALK_BOND_SMOOTHING_SHIFT);
+            path->stats.latency_min       = (latency < path->stats.latency_min) ? latency : path->stats.latency_min;
+            path->stats.latency_max       = (latency > path->stats.latency_max) ? latency : path->stats.latency_max;
+        }
+
+        path->stats.frames++;
+        path->stats.latency = latency;
+
+        if (CaveTalk_BondFresh(bond, sequence))
+        {
+            path->stats.wins++;
+            bond->last_winner       = path_index;
+            bond->rx_arrivals[slot] = now;
+
+            CaveTalk_BondAppend(bond, payload[CAVE_TALK_BOND_ID_INDEX], &payload[CAVE_TALK_BOND_HEADER_SIZE], length - CAVE_TALK_BOND_HEADER_SIZE);
+        }
+        else
+        {
+            const uint32_t lag = (uint32_t)(now - bond->rx_arrivals[slot]);
+
+            path->stats.smoothed_lag = (0U == path->stats.duplicates) ?
+                                       lag :
+                                       (path->stats.smoothed_lag - (path->stats.smoothed_lag >> CAVE_TALK_BOND_SMOOTHING_SHIFT) +
+                                        (lag >> CAVE_TALK_BOND_SMOOTHING_SHIFT));
+            path->stats.duplicates++;
+        }
+    }
+}
+
+/* Sequence numbers within the window behind the newest are checked against a bitmap. One further behind means the
+ * sender restarted, so it starts a new window rather than being dropped. */
+static bool CaveTalk_BondFresh(CaveTalk_Bond_t *const bond, const uint16_t sequence)
+{
+    const uint16_t ahead  = (uint16_t)(sequence - bond->rx_newest);
+    const uint16_t behind = (uint16_t)(bond->rx_newest - sequence);
+    bool           fresh  = true;
+
+    if (!bond->rx_started || ((ahead >= CAVE_TALK_BOND_HALF_SEQUENCE) && (behind >= CAVE_TALK_BOND_WINDOW)))
+    {
+        bond->rx_started = true;
+        bond->rx_newest  = sequence;
+        bond->rx_seen    = 1U;
+    }
+    else if (0U == ahead)
+    {
+        fresh = false;
+    }
+    else if (ahead < CAVE_TALK_BOND_HALF_SEQUENCE)
+    {
+        bond->rx_seen   = (ahead >= CAVE_TALK_BOND_WINDOW) ? 1U : ((bond->rx_seen << ahead) | 1U);
+        bond->rx_newest = sequence;
+    }
+    else if (0U != (bond->rx_seen & ((uint64_t)1U << behind)))
+    {
+        fresh = false;
+    }
+    else
+    {
+        bond->rx_seen |= (uint64_t)1U << behind;
+    }
+
+    return fresh;
+}
+
+static void CaveTalk_BondAppend(CaveTalk_Bond_t *const bond, const CaveTalk_Id_t id, const uint8_t *const payload, const CaveTalk_Length_t length)
+{
+    uint8_t *frame = NULL;
+
+    if (0U != bond->rx_head)
+    {
+        memmove(bond->rx_buffer, &bond->rx_buffer[bond->rx_head], bond->rx_length - bond->rx_head);
+        bond->rx_length -= bond->rx_head;
+        bond->rx_head    = 0U;
+    }
+
+    frame                          = &bond->rx_buffer[bond->rx_length];
+    frame[CAVE_TALK_VERSION_INDEX] = CAVE_TALK_VERSION;
+    frame[CAVE_TALK_ID_INDEX]      = id;
+    frame[CAVE_TALK_LENGTH_INDEX]  = length;
+    memcpy(&frame[CAVE_TALK_HEADER_SIZE], payload, length);
+    CaveTalk_CrcWrite(frame, &frame[CAVE_TALK_HEADER_SIZE], &frame[CAVE_TALK_HEADER_SIZE + length]);
+
+    bond->rx_length += CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+}
\ No newline at end of file
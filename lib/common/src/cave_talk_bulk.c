@@ -0,0 +1,306 @@
+#include "cave_talk_bulk.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+#include "cave_talk_varint.h"
+
+#define CAVE_TALK_BULK_WIRE_VARINT     0U
+#define CAVE_TALK_BULK_WIRE_FIXED64    1U
+#define CAVE_TALK_BULK_WIRE_LENGTH     2U
+#define CAVE_TALK_BULK_WIRE_FIXED32    5U
+#define CAVE_TALK_BULK_WIRE_TYPE_BITS  3U
+#define CAVE_TALK_BULK_WIRE_TYPE_MASK  0x07U
+#define CAVE_TALK_BULK_FIXED64_SIZE    8U
+#define CAVE_TALK_BULK_FIXED32_SIZE    4U
+#define CAVE_TALK_BULK_VARINT64_SIZE   10U
+#define CAVE_TALK_BULK_VARINT_CONTINUE 0x80U
+
+/* Both doubles present in field order, the only layout the encoders produce */
+#define CAVE_TALK_BULK_FIRST_TAG    0x09U /* Field 1, fixed64 */
+#define CAVE_TALK_BULK_SECOND_TAG   0x11U /* Field 2, fixed64 */
+#define CAVE_TALK_BULK_FIRST_INDEX  (CAVE_TALK_HEADER_SIZE + 1U)
+#define CAVE_TALK_BULK_SECOND_INDEX (CAVE_TALK_BULK_FIRST_INDEX + CAVE_TALK_BULK_FIXED64_SIZE + 1U)
+#define CAVE_TALK_BULK_PAYLOAD_SIZE (2U * (1U + CAVE_TALK_BULK_FIXED64_SIZE))
+#define CAVE_TALK_BULK_FRAME_SIZE   (CAVE_TALK_HEADER_SIZE + CAVE_TALK_BULK_PAYLOAD_SIZE + CAVE_TALK_CRC_SIZE)
+
+typedef struct
+{
+    double *first;
+    double *second;
+    size_t capacity;
+    size_t *count;
+} CaveTalk_BulkTarget_t;
+
+static bool CaveTalk_BulkTarget(CaveTalk_BulkColumns_t *const columns, const CaveTalk_Id_t id, CaveTalk_BulkTarget_t *const target);
+static bool CaveTalk_BulkFixedLayout(const uint8_t *const frame, const CaveTalk_Id_t id);
+static size_t CaveTalk_BulkRun(const CaveTalk_BulkTarget_t *const target, const CaveTalk_Id_t id, const uint8_t *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_BulkParse(const uint8_t *const payload, const CaveTalk_Length_t length, double *const first, double *const second);
+static double CaveTalk_BulkFixed64(const uint8_t *const bytes);
+
+CaveTalk_Error_t CaveTalk_BulkDecode(CaveTalk_BulkColumns_t *const columns,
+                                     const uint8_t *const data,
+                                     const size_t size,
+                                     size_t *const consumed)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == columns) || (NULL == data) || (NULL == consumed))
+    {
+    }
+    else
+    {
+        size_t offset = 0U;
+        bool   frames = true;
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Stops before a frame cut off at the end of the data, so the caller can carry it over to the next call */
+        while (frames && ((size - offset) >= CAVE_TALK_HEADER_SIZE))
+        {
+            const uint8_t *const    frame      = &data[offset];
+            const CaveTalk_Id_t     id         = frame[CAVE_TALK_ID_INDEX];
+            const CaveTalk_Length_t length     = frame[CAVE_TALK_LENGTH_INDEX];
+            const size_t            frame_size = CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+            CaveTalk_BulkTarget_t   target;
+
+            if (CAVE_TALK_VERSION != frame[CAVE_TALK_VERSION_INDEX])
+            {
+                error  = CAVE_TALK_ERROR_VERSION;
+                frames = false;
+            }
+            else if ((size - offset) < frame_size)
+            {
+                frames = false;
+            }
+            else if (!CaveTalk_BulkTarget(columns, id, &target))
+            {
+                columns->skipped++;
+                offset += frame_size;
+            }
+            else if (*target.count >= target.capacity)
+            {
+                error  = CAVE_TALK_ERROR_SIZE;
+                frames = false;
+            }
+            else
+            {
+                const size_t run = CaveTalk_BulkRun(&target, id, frame, size - offset);
+
+                if (0U != run)
+                {
+                    offset += run * CAVE_TALK_BULK_FRAME_SIZE;
+                }
+                else
+                {
+                    error = CaveTalk_BulkParse(&frame[CAVE_TALK_HEADER_SIZE], length, &target.first[*target.count], &target.second[*target.count]);
+
+                    if (CAVE_TALK_ERROR_NONE == error)
+                    {
+                        (*target.count)++;
+                        columns->fallbacks++;
+                        offset += frame_size;
+                    }
+                    else
+                    {
+                        frames = false;
+                    }
+                }
+            }
+        }
+
+        *consumed = offset;
+    }
+
+    return error;
+}
+
+static bool CaveTalk_BulkTarget(CaveTalk_BulkColumns_t *const columns, const CaveTalk_Id_t id, CaveTalk_BulkTarget_t *const target)
+{
+    bool found = false;
+
+    if ((CAVE_TALK_ID_MOVEMENT == id) && (NULL != columns->speed) && (NULL != columns->turn_rate))
+    {
+        target->first    = columns->speed;
+        target->second   = columns->turn_rate;
+        target->capacity = columns->movement_capacity;
+        target->count    = &columns->movement_count;
+        found            = true;
+    }
+    else if ((CAVE_TALK_ID_CAMERA_MOVEMENT == id) && (NULL != columns->pan) && (NULL != columns->tilt))
+    {
+        target->first    = columns->pan;
+        target->second   = columns->tilt;
+        target->capacity = columns->camera_movement_capacity;
+        target->count    = &columns->camera_movement_count;
+        found            = true;
+    }
+
+    return found;
+}
+
+static bool CaveTalk_BulkFixedLayout(const uint8_t *const frame, const CaveTalk_Id_t id)
+{
+    return (CAVE_TALK_VERSION == frame[CAVE_TALK_VERSION_INDEX]) &&
+           (id == frame[CAVE_TALK_ID_INDEX]) &&
+           (CAVE_TALK_BULK_PAYLOAD_SIZE == frame[CAVE_TALK_LENGTH_INDEX]) &&
+           (CAVE_TALK_BULK_FIRST_TAG == frame[CAVE_TALK_BULK_FIRST_INDEX - 1U]) &&
+           (CAVE_TALK_BULK_SECOND_TAG == frame[CAVE_TALK_BULK_SECOND_INDEX - 1U]);
+}
+
+/* Decodes the run of fixed layout frames of one id at the start of data, as many as fit the columns, two at a time
+ * with SSE2 */
+static size_t CaveTalk_BulkRun(const CaveTalk_BulkTarget_t *const target, const CaveTalk_Id_t id, const uint8_t *const data, const size_t size)
+{
+    const size_t frames    = size / CAVE_TALK_BULK_FRAME_SIZE;
+    const size_t available = target->capacity - *target->count;
+    const size_t limit     = (frames < available) ? frames : available;
+    double *const first    = &target->first[*target->count];
+    double *const second   = &target->second[*target->count];
+    size_t        run      = 0U;
+
+#if defined(__SSE2__)
+    const __m128i signature = _mm_setr_epi8(CAVE_TALK_VERSION, (char)id, CAVE_TALK_BULK_PAYLOAD_SIZE, CAVE_TALK_BULK_FIRST_TAG,
+                                            0, 0, 0, 0, 0, 0, 0, 0, CAVE_TALK_BULK_SECOND_TAG, 0, 0, 0);
+    const int     mask      = (1 << CAVE_TALK_VERSION_INDEX) | (1 << CAVE_TALK_ID_INDEX) | (1 << CAVE_TALK_LENGTH_INDEX) |
+                              (1 << (CAVE_TALK_BULK_FIRST_INDEX - 1U)) | (1 << (CAVE_TALK_BULK_SECOND_INDEX - 1U));
+    bool          pairs     = true;
+
+    /* The first 16 bytes of a frame hold its header, both tags and the first value */
+    while (pairs && ((run + 2U) <= limit))
+    {
+        const uint8_t *const frame_a = &data[run * CAVE_TALK_BULK_FRAME_SIZE];
+        const uint8_t *const frame_b = frame_a + CAVE_TALK_BULK_FRAME_SIZE;
+        const __m128i        head_a  = _mm_loadu_si128((const __m128i *)(const void *)frame_a);
+        const __m128i        head_b  = _mm_loadu_si128((const __m128i *)(const void *)frame_b);
+        const int            match_a = _mm_movemask_epi8(_mm_cmpeq_epi8(head_a, signature)) & mask;
+        const int            match_b = _mm_movemask_epi8(_mm_cmpeq_epi8(head_b, signature)) & mask;
+
+        if ((mask == match_a) && (mask == match_b))
+        {
+            const __m128i firsts  = _mm_unpacklo_epi64(_mm_srli_si128(head_a, CAVE_TALK_BULK_FIRST_INDEX), _mm_srli_si128(head_b, CAVE_TALK_BULK_FIRST_INDEX));
+            const __m128i seconds = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(const void *)&frame_a[CAVE_TALK_BULK_SECOND_INDEX]),
+                                                       _mm_loadl_epi64((const __m128i *)(const void *)&frame_b[CAVE_TALK_BULK_SECOND_INDEX]));
+
+            _mm_storeu_si128((__m128i *)(void *)&first[run], firsts);
+            _mm_storeu_si128((__m128i *)(void *)&second[run], seconds);
+            run += 2U;
+        }
+        else
+        {
+            pairs = false;
+        }
+    }
+#endif
+
+    while ((run < limit) && CaveTalk_BulkFixedLayout(&data[run * CAVE_TALK_BULK_FRAME_SIZE], id))
+    {
+        first[run]  = CaveTalk_BulkFixed64(&data[(run * CAVE_TALK_BULK_FRAME_SIZE) + CAVE_TALK_BULK_FIRST_INDEX]);
+        second[run] = CaveTalk_BulkFixed64(&data[(run * CAVE_TALK_BULK_FRAME_SIZE) + CAVE_TALK_BULK_SECOND_INDEX]);
+        run++;
+    }
+
+    *target->count += run;
+
+    return run;
+}
+
+/* Proto3 leaves out fields that are zero and allows any field order, repeats and unknown fields */
+static CaveTalk_Error_t CaveTalk_BulkParse(const uint8_t *const payload, const CaveTalk_Length_t length, double *const first, double *const second)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+    size_t           index = 0U;
+
+    *first  = 0.0;
+    *second = 0.0;
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (index < length))
+    {
+        uint32_t key  = 0U;
+        uint32_t size = 0U;
+        size_t   read = 0U;
+
+        error  = CaveTalk_VarintDecode(&payload[index], length - index, &key, &read);
+        index += read;
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+        }
+        else if (CAVE_TALK_BULK_WIRE_FIXED64 == (key & CAVE_TALK_BULK_WIRE_TYPE_MASK))
+        {
+            if ((length - index) < CAVE_TALK_BULK_FIXED64_SIZE)
+            {
+                error = CAVE_TALK_ERROR_PARSE;
+            }
+            else if (1U == (key >> CAVE_TALK_BULK_WIRE_TYPE_BITS))
+            {
+                *first = CaveTalk_BulkFixed64(&payload[index]);
+            }
+            else if (2U == (key >> CAVE_TALK_BULK_WIRE_TYPE_BITS))
+            {
+                *second = CaveTalk_BulkFixed64(&payload[index]);
+            }
+
+            index += CAVE_TALK_BULK_FIXED64_SIZE;
+        }
+        else if (CAVE_TALK_BULK_WIRE_VARINT == (key & CAVE_TALK_BULK_WIRE_TYPE_MASK))
+        {
+            const size_t start = index;
+
+            while ((index < length) && ((index - start) < CAVE_TALK_BULK_VARINT64_SIZE) && (0U != (payload[index] & CAVE_TALK_BULK_VARINT_CONTINUE)))
+            {
+                index++;
+            }
+
+            error = ((index < length) && ((index - start) < CAVE_TALK_BULK_VARINT64_SIZE)) ? CAVE_TALK_ERROR_NONE : CAVE_TALK_ERROR_PARSE;
+            index++;
+        }
+        else if (CAVE_TALK_BULK_WIRE_LENGTH == (key & CAVE_TALK_BULK_WIRE_TYPE_MASK))
+        {
+            error  = CaveTalk_VarintDecode(&payload[index], length - index, &size, &read);
+            index += read;
+
+            if ((CAVE_TALK_ERROR_NONE == error) && ((length - index) < size))
+            {
+                error = CAVE_TALK_ERROR_PARSE;
+            }
+
+            index += size;
+        }
+        else if (CAVE_TALK_BULK_WIRE_FIXED32 == (key & CAVE_TALK_BULK_WIRE_TYPE_MASK))
+        {
+            error  = ((length - index) < CAVE_TALK_BULK_FIXED32_SIZE) ? CAVE_TALK_ERROR_PARSE : CAVE_TALK_ERROR_NONE;
+            index += CAVE_TALK_BULK_FIXED32_SIZE;
+        }
+        else
+        {
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+    }
+
+    return (CAVE_TALK_ERROR_NONE == error) ? CAVE_TALK_ERROR_NONE : CAVE_TALK_ERROR_PARSE;
+}
+
+/* Little endian whatever the host */
+static double CaveTalk_BulkFixed64(const uint8_t *const bytes)
+{
+    uint64_t bits  = 0U;
+    double   value = 0.0;
+
+    for (size_t index = CAVE_TALK_BULK_FIXED64_SIZE; index > 0U; index--)
+    {
+        bits = (bits << 8U) | bytes[index - 1U];
+    }
+
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
\ No newline at end of file
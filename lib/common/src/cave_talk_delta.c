@@ -0,0 +1,275 @@
+#include "cave_talk_delta.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+#include "cave_talk_varint.h"
+
+#define CAVE_TALK_DELTA_ID_INDEX       0U
+#define CAVE_TALK_DELTA_KEYFRAME_INDEX 1U
+#define CAVE_TALK_DELTA_VALUES_INDEX   2U
+#define CAVE_TALK_DELTA_KEYFRAME_FLAG  0x01U /* Low bit of the keyframe byte, the keyframe number is above it */
+#define CAVE_TALK_DELTA_KEYFRAME_MASK  0x7FU
+
+static int32_t CaveTalk_DeltaQuantize(const double value, const double quantum);
+static uint32_t CaveTalk_DeltaZigzag(const int64_t value);
+static int64_t CaveTalk_DeltaUnzigzag(const uint32_t value);
+static size_t CaveTalk_DeltaSize(const int64_t values[CAVE_TALK_DELTA_VALUES]);
+
+CaveTalk_Error_t CaveTalk_DeltaInit(CaveTalk_DeltaStream_t *const stream,
+                                    const CaveTalk_Id_t id,
+                                    const double quantum,
+                                    const uint32_t keyframe_interval)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == stream)
+    {
+    }
+    else if (!(quantum > 0.0) || (0U == keyframe_interval))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        stream->id                 = id;
+        stream->quantum            = quantum;
+        stream->keyframe_interval  = keyframe_interval;
+        stream->keyframe           = 0U;
+        stream->since_keyframe     = 0U;
+        stream->valid              = false;
+        stream->counters.keyframes = 0U;
+        stream->counters.deltas    = 0U;
+        stream->counters.dropped   = 0U;
+
+        for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+        {
+            stream->reference[index] = 0;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+/* The next frame encoded is a keyframe, e.g. when the peer has just joined */
+void CaveTalk_DeltaKeyframe(CaveTalk_DeltaStream_t *const stream)
+{
+    if (NULL != stream)
+    {
+        stream->valid = false;
+    }
+}
+
+CaveTalk_Error_t CaveTalk_DeltaEncode(CaveTalk_DeltaStream_t *const stream,
+                                      const double values[CAVE_TALK_DELTA_VALUES],
+                                      uint8_t *const data,
+                                      const size_t size,
+                                      CaveTalk_Length_t *const length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == stream) || (NULL == values) || (NULL == data) || (NULL == length))
+    {
+    }
+    else if (size < CAVE_TALK_DELTA_SIZE_MAX)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        int64_t absolute[CAVE_TALK_DELTA_VALUES];
+        int64_t delta[CAVE_TALK_DELTA_VALUES];
+        bool    keyframe = false;
+        size_t  offset   = CAVE_TALK_DELTA_VALUES_INDEX;
+
+        for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+        {
+            absolute[index] = CaveTalk_DeltaQuantize(values[index], stream->quantum);
+            delta[index]    = absolute[index] - stream->reference[index];
+        }
+
+        keyframe = !stream->valid || (stream->since_keyframe >= stream->keyframe_interval) ||
+                   (CaveTalk_DeltaSize(absolute) <= CaveTalk_DeltaSize(delta));
+
+        if (keyframe)
+        {
+            stream->keyframe       = (uint8_t)((stream->keyframe + 1U) & CAVE_TALK_DELTA_KEYFRAME_MASK);
+            stream->since_keyframe = 0U;
+            stream->valid          = true;
+            stream->counters.keyframes++;
+
+            for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+            {
+                stream->reference[index] = (int32_t)absolute[index];
+                delta[index]             = absolute[index];
+            }
+        }
+        else
+        {
+            stream->counters.deltas++;
+        }
+
+        stream->since_keyframe++;
+
+        data[CAVE_TALK_DELTA_ID_INDEX]       = stream->id;
+        data[CAVE_TALK_DELTA_KEYFRAME_INDEX] = (uint8_t)((stream->keyframe << 1U) | (keyframe ? CAVE_TALK_DELTA_KEYFRAME_FLAG : 0U));
+        error                                = CAVE_TALK_ERROR_NONE;
+
+        for (size_t index = 0U; (CAVE_TALK_ERROR_NONE == error) && (index < CAVE_TALK_DELTA_VALUES); index++)
+        {
+            size_t written = 0U;
+
+            error   = CaveTalk_VarintEncode(CaveTalk_DeltaZigzag(delta[index]), data + offset, size - offset, &written);
+            offset += written;
+        }
+
+        *length = (CaveTalk_Length_t)offset;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_DeltaDecode(CaveTalk_DeltaStream_t *const streams,
+                                      const size_t stream_count,
+                                      const uint8_t *const data,
+                                      const CaveTalk_Length_t length,
+                                      CaveTalk_Id_t *const id,
+                                      double values[CAVE_TALK_DELTA_VALUES])
+{
+    CaveTalk_Error_t        error  = CAVE_TALK_ERROR_NULL;
+    CaveTalk_DeltaStream_t *stream = NULL;
+
+    if ((NULL == streams) || (NULL == data) || (NULL == id) || (NULL == values))
+    {
+    }
+    else if (length < CAVE_TALK_DELTA_VALUES_INDEX)
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        for (size_t index = 0U; (NULL == stream) && (index < stream_count); index++)
+        {
+            if (streams[index].id == data[CAVE_TALK_DELTA_ID_INDEX])
+            {
+                stream = &streams[index];
+            }
+        }
+
+        error = (NULL == stream) ? CAVE_TALK_ERROR_ID : CAVE_TALK_ERROR_NONE;
+        *id   = CAVE_TALK_ID_NONE;
+    }
+
+    if (NULL != stream)
+    {
+        const bool    keyframe = (0U != (data[CAVE_TALK_DELTA_KEYFRAME_INDEX] & CAVE_TALK_DELTA_KEYFRAME_FLAG));
+        const uint8_t number   = (uint8_t)(data[CAVE_TALK_DELTA_KEYFRAME_INDEX] >> 1U);
+        int64_t       decoded[CAVE_TALK_DELTA_VALUES];
+        size_t        offset   = CAVE_TALK_DELTA_VALUES_INDEX;
+
+        for (size_t index = 0U; (CAVE_TALK_ERROR_NONE == error) && (index < CAVE_TALK_DELTA_VALUES); index++)
+        {
+            uint32_t value = 0U;
+            size_t   read  = 0U;
+
+            error          = CaveTalk_VarintDecode(data + offset, length - offset, &value, &read);
+            decoded[index] = CaveTalk_DeltaUnzigzag(value);
+            offset        += read;
+        }
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else if (keyframe)
+        {
+            stream->keyframe = number;
+            stream->valid    = true;
+            stream->counters.keyframes++;
+
+            for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+            {
+                stream->reference[index] = (int32_t)decoded[index];
+            }
+        }
+        else if (!stream->valid || (number != stream->keyframe))
+        {
+            /* Relative to a keyframe that never arrived */
+            stream->counters.dropped++;
+        }
+        else
+        {
+            stream->counters.deltas++;
+
+            for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+            {
+                decoded[index] += stream->reference[index];
+            }
+        }
+
+        if ((CAVE_TALK_ERROR_NONE == error) && stream->valid && (number == stream->keyframe))
+        {
+            *id = stream->id;
+
+            for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+            {
+                values[index] = (double)decoded[index] * stream->quantum;
+            }
+        }
+    }
+
+    return error;
+}
+
+static int32_t CaveTalk_DeltaQuantize(const double value, const double quantum)
+{
+    const double steps     = value / quantum;
+    int32_t      quantized = 0;
+
+    /* Half the range, so the difference of two quantized values always fits as well */
+    if (isnan(steps))
+    {
+    }
+    else if (steps >= (double)(INT32_MAX / 2))
+    {
+        quantized = INT32_MAX / 2;
+    }
+    else if (steps <= (double)(INT32_MIN / 2))
+    {
+        quantized = INT32_MIN / 2;
+    }
+    else
+    {
+        quantized = (int32_t)((steps < 0.0) ? (steps - 0.5) : (steps + 0.5));
+    }
+
+    return quantized;
+}
+
+static uint32_t CaveTalk_DeltaZigzag(const int64_t value)
+{
+    return (value < 0) ? (uint32_t)((-value * 2) - 1) : (uint32_t)(value * 2);
+}
+
+static int64_t CaveTalk_DeltaUnzigzag(const uint32_t value)
+{
+    return (0U != (value & 1U)) ? -(((int64_t)value + 1) / 2) : ((int64_t)value / 2);
+}
+
+static size_t CaveTalk_DeltaSize(const int64_t values[CAVE_TALK_DELTA_VALUES])
+{
+    size_t size = 0U;
+
+    for (size_t index = 0U; index < CAVE_TALK_DELTA_VALUES; index++)
+    {
+        size += CaveTalk_VarintSize(CaveTalk_DeltaZigzag(values[index]));
+    }
+
+    return size;
+}
\ No newline at end of file
@@ -0,0 +1,526 @@
+#include "cave_talk_fragment.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+#include "cave_talk_varint.h"
+
+#define CAVE_TALK_FRAGMENT_TRANSFER_INDEX 0U
+#define CAVE_TALK_FRAGMENT_OFFSET_INDEX   1U
+#define CAVE_TALK_FRAGMENT_STREAM_SHIFT   4U
+#define CAVE_TALK_FRAGMENT_COUNT_MASK     0x0FU
+
+static size_t CaveTalk_FragmentHeaderSize(const CaveTalk_Fragmenter_t *const fragmenter);
+static CaveTalk_ReassemblySlot_t *CaveTalk_ReassemblerFind(CaveTalk_Reassembler_t *const reassembler, const uint8_t stream);
+static CaveTalk_ReassemblySlot_t *CaveTalk_ReassemblerAllocate(CaveTalk_Reassembler_t *const reassembler);
+static void CaveTalk_ReassemblerArm(CaveTalk_Reassembler_t *const reassembler);
+static void CaveTalk_ReassemblerExpired(void *const context);
+
+CaveTalk_Error_t CaveTalk_FragmentParse(const void *const data, const CaveTalk_Length_t length, CaveTalk_Fragment_t *const fragment)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) || (NULL == fragment))
+    {
+    }
+    else if (length <= CAVE_TALK_FRAGMENT_OFFSET_INDEX)
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        const uint8_t *const bytes = (const uint8_t *)data;
+        size_t               index = CAVE_TALK_FRAGMENT_OFFSET_INDEX;
+        size_t               read  = 0U;
+
+        fragment->transfer = bytes[CAVE_TALK_FRAGMENT_TRANSFER_INDEX];
+        fragment->id       = CAVE_TALK_ID_NONE;
+        fragment->length   = 0U;
+
+        error  = CaveTalk_VarintDecode(&bytes[index], length - index, &fragment->offset, &read);
+        index += read;
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+        }
+        else if (0U != fragment->offset)
+        {
+        }
+        else if (index >= length)
+        {
+            error = CAVE_TALK_ERROR_INCOMPLETE;
+        }
+        else
+        {
+            fragment->id = bytes[index++];
+
+            error  = CaveTalk_VarintDecode(&bytes[index], length - index, &fragment->length, &read);
+            index += read;
+        }
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+            /* A fragment is always a whole frame, so a truncated header is malformed */
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else if ((index >= length) ||
+                 ((0U == fragment->offset) && ((0U == fragment->length) || ((length - index) > fragment->length))))
+        {
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else
+        {
+            fragment->data = &bytes[index];
+            fragment->size = length - index;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_FragmenterInit(CaveTalk_Fragmenter_t *const fragmenter, const uint8_t stream, const size_t frame_size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == fragmenter)
+    {
+    }
+    else if ((stream >= CAVE_TALK_FRAGMENT_STREAM_COUNT) ||
+             (frame_size < CAVE_TALK_FRAGMENT_FRAME_SIZE_MIN) ||
+             (frame_size > CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        memset(fragmenter, 0, sizeof(*fragmenter));
+        fragmenter->frame_size  = frame_size;
+        fragmenter->frame_limit = frame_size;
+        fragmenter->stream      = stream;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_FragmentStart(CaveTalk_Fragmenter_t *const fragmenter, const CaveTalk_Id_t id, const uint32_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == fragmenter)
+    {
+    }
+    else if (0U == length)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else if (fragmenter->active)
+    {
+        /* The previous object has not been sent in full */
+        error = CAVE_TALK_ERROR_INCOMPLETE;
+    }
+    else
+    {
+        fragmenter->id     = id;
+        fragmenter->length = length;
+        fragmenter->offset = 0U;
+        fragmenter->active = true;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+size_t CaveTalk_FragmentChunkSize(const CaveTalk_Fragmenter_t *const fragmenter)
+{
+    size_t chunk_size = 0U;
+
+    if ((NULL != fragmenter) && fragmenter->active)
+    {
+        const size_t remaining   = fragmenter->length - fragmenter->offset;
+        const size_t frame_size  = (fragmenter->frame_limit < fragmenter->frame_size) ? fragmenter->frame_limit : fragmenter->frame_size;
+        const size_t header_size = CaveTalk_FragmentHeaderSize(fragmenter);
+
+        /* Every fragment carries its offset, so the limit may change between fragments of one object */
+        chunk_size = (frame_size > header_size) ? (frame_size - header_size) : 0U;
+
+        if (remaining < chunk_size)
+        {
+            chunk_size = remaining;
+        }
+    }
+
+    return chunk_size;
+}
+
+CaveTalk_Error_t CaveTalk_FragmentSpeak(CaveTalk_Fragmenter_t *const fragmenter,
+                                        const CaveTalk_LinkHandle_t *const handle,
+                                        const void *const data,
+                                        const size_t size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == fragmenter) || (NULL == handle) || (NULL == handle->send) || (NULL == data))
+    {
+    }
+    else if ((0U == size) || (size > CaveTalk_FragmentChunkSize(fragmenter)))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        size_t index   = CAVE_TALK_FRAGMENT_OFFSET_INDEX;
+        size_t written = 0U;
+
+        fragmenter->frame[CAVE_TALK_FRAGMENT_TRANSFER_INDEX] = (uint8_t)((fragmenter->stream << CAVE_TALK_FRAGMENT_STREAM_SHIFT) |
+                                                                         (fragmenter->transfer & CAVE_TALK_FRAGMENT_COUNT_MASK));
+
+        (void)CaveTalk_VarintEncode(fragmenter->offset, &fragmenter->frame[index], sizeof(fragmenter->frame) - index, &written);
+        index += written;
+
+        if (0U == fragmenter->offset)
+        {
+            fragmenter->frame[index++] = fragmenter->id;
+            (void)CaveTalk_VarintEncode(fragmenter->length, &fragmenter->frame[index], sizeof(fragmenter->frame) - index, &written);
+            index += written;
+        }
+
+        memcpy(&fragmenter->frame[index], data, size);
+
+        error = CaveTalk_Speak(handle, CAVE_TALK_ID_FRAGMENT, fragmenter->frame, (CaveTalk_Length_t)(index + size));
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            fragmenter->offset += (uint32_t)size;
+
+            if (fragmenter->offset == fragmenter->length)
+            {
+                fragmenter->active = false;
+                fragmenter->transfer++;
+            }
+        }
+    }
+
+    return error;
+}
+
+void CaveTalk_FragmentLimit(CaveTalk_Fragmenter_t *const fragmenter, const size_t frame_limit)
+{
+    if (NULL != fragmenter)
+    {
+        fragmenter->frame_limit = frame_limit;
+    }
+}
+
+void CaveTalk_FragmentAbort(CaveTalk_Fragmenter_t *const fragmenter)
+{
+    if ((NULL != fragmenter) && fragmenter->active)
+    {
+        /* The receiver drops the partial object when the next one on this stream starts or its slot is evicted */
+        fragmenter->active = false;
+        fragmenter->transfer++;
+    }
+}
+
+CaveTalk_Error_t CaveTalk_ReassemblerInit(CaveTalk_Reassembler_t *const reassembler,
+                                          uint8_t *const pool,
+                                          const size_t pool_size,
+                                          CaveTalk_ReassemblySlot_t *const slots,
+                                          const size_t slot_count)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reassembler) || (NULL == pool) || (NULL == slots))
+    {
+    }
+    else if ((0U == slot_count) || (pool_size < slot_count))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        memset(reassembler, 0, sizeof(*reassembler));
+
+        reassembler->slots      = slots;
+        reassembler->slot_count = slot_count;
+        reassembler->slot_size  = pool_size / slot_count;
+
+        for (size_t slot = 0U; slot < slot_count; slot++)
+        {
+            slots[slot].buffer = &pool[slot * reassembler->slot_size];
+            slots[slot].in_use = false;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ReassemblerHear(CaveTalk_Reassembler_t *const reassembler,
+                                          const void *const data,
+                                          const CaveTalk_Length_t length,
+                                          CaveTalk_FragmentObject_t *const object)
+{
+    CaveTalk_Error_t    error    = CAVE_TALK_ERROR_NULL;
+    CaveTalk_Fragment_t fragment = {0};
+
+    if ((NULL == reassembler) || (NULL == data) || (NULL == object))
+    {
+    }
+    else if (CAVE_TALK_ERROR_NONE != CaveTalk_FragmentParse(data, length, &fragment))
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        CaveTalk_ReassemblySlot_t    *slot = CaveTalk_ReassemblerFind(reassembler, fragment.transfer >> CAVE_TALK_FRAGMENT_STREAM_SHIFT);
+        const CaveTalk_Microseconds_t now  = (NULL != reassembler->wheel) ? reassembler->wheel->clock() : 0U;
+
+        reassembler->counters.fragments++;
+        reassembler->age++;
+
+        if ((0U == fragment.offset) && (NULL != slot))
+        {
+            /* The sender aborted the previous object on this stream */
+            slot->in_use = false;
+            reassembler->counters.dropped++;
+        }
+
+        if ((0U == fragment.offset) && (fragment.size == fragment.length))
+        {
+            /* Fits in a single frame, delivered straight from the frame without touching the pool */
+            object->id     = fragment.id;
+            object->data   = fragment.data;
+            object->length = fragment.length;
+            reassembler->counters.completed++;
+            error = CAVE_TALK_ERROR_NONE;
+        }
+        else if ((0U == fragment.offset) && (fragment.length > reassembler->slot_size))
+        {
+            reassembler->counters.dropped++;
+            error = CAVE_TALK_ERROR_SIZE;
+        }
+        else if (0U == fragment.offset)
+        {
+            slot = CaveTalk_ReassemblerAllocate(reassembler);
+
+            memcpy(slot->buffer, fragment.data, fragment.size);
+            slot->transfer = fragment.transfer;
+            slot->id       = fragment.id;
+            slot->length   = fragment.length;
+            slot->received = (uint32_t)fragment.size;
+            slot->age      = reassembler->age;
+            slot->heard    = now;
+            slot->in_use   = true;
+            error          = CAVE_TALK_ERROR_INCOMPLETE;
+        }
+        else if ((NULL == slot) || (fragment.transfer != slot->transfer) || (fragment.offset != slot->received))
+        {
+            /* A fragment was lost, or the first one was dropped or evicted, so the object cannot be completed */
+            if (NULL != slot)
+            {
+                slot->in_use = false;
+            }
+            reassembler->counters.dropped++;
+            error = CAVE_TALK_ERROR_INCOMPLETE;
+        }
+        else if (fragment.size > (slot->length - slot->received))
+        {
+            slot->in_use = false;
+            reassembler->counters.dropped++;
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else
+        {
+            memcpy(&slot->buffer[slot->received], fragment.data, fragment.size);
+            slot->received += (uint32_t)fragment.size;
+            slot->age       = reassembler->age;
+            slot->heard     = now;
+            error           = CAVE_TALK_ERROR_INCOMPLETE;
+
+            if (slot->received == slot->length)
+            {
+                /* The slot is released now but its buffer stays intact until the next call to CaveTalk_ReassemblerHear */
+                object->id     = slot->id;
+                object->data   = slot->buffer;
+                object->length = slot->length;
+                slot->in_use   = false;
+                reassembler->counters.completed++;
+                error = CAVE_TALK_ERROR_NONE;
+            }
+        }
+
+        CaveTalk_ReassemblerArm(reassembler);
+    }
+
+    return error;
+}
+
+bool CaveTalk_ReassemblerDeadline(const CaveTalk_Reassembler_t *const reassembler, CaveTalk_Microseconds_t *const deadline)
+{
+    bool found = false;
+
+    if ((NULL == reassembler) || (NULL == deadline) || (NULL == reassembler->wheel))
+    {
+    }
+    else
+    {
+        for (size_t slot = 0U; slot < reassembler->slot_count; slot++)
+        {
+            const CaveTalk_ReassemblySlot_t *const candidate = &reassembler->slots[slot];
+
+            if (candidate->in_use && (!found || ((candidate->heard + reassembler->timeout) < *deadline)))
+            {
+                *deadline = candidate->heard + reassembler->timeout;
+                found     = true;
+            }
+        }
+    }
+
+    return found;
+}
+
+CaveTalk_Error_t CaveTalk_ReassemblerSchedule(CaveTalk_Reassembler_t *const reassembler, CaveTalk_TimerWheel_t *const wheel, const CaveTalk_Microseconds_t timeout)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reassembler) || ((NULL != wheel) && (NULL == wheel->clock)))
+    {
+    }
+    else if ((NULL != wheel) && (0U == timeout))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        /* A NULL wheel leaves objects in progress until they complete or are evicted */
+        if (NULL != reassembler->wheel)
+        {
+            CaveTalk_TimerCancel(reassembler->wheel, &reassembler->timer);
+        }
+
+        reassembler->wheel   = wheel;
+        reassembler->timeout = timeout;
+        error                = CaveTalk_TimerInit(&reassembler->timer, CaveTalk_ReassemblerExpired, reassembler);
+
+        if (NULL != wheel)
+        {
+            /* Objects already in progress are timed from now */
+            const CaveTalk_Microseconds_t now = wheel->clock();
+
+            for (size_t slot = 0U; slot < reassembler->slot_count; slot++)
+            {
+                reassembler->slots[slot].heard = now;
+            }
+        }
+
+        CaveTalk_ReassemblerArm(reassembler);
+    }
+
+    return error;
+}
+
+static size_t CaveTalk_FragmentHeaderSize(const CaveTalk_Fragmenter_t *const fragmenter)
+{
+    size_t size = CAVE_TALK_FRAGMENT_OFFSET_INDEX + CaveTalk_VarintSize(fragmenter->offset);
+
+    if (0U == fragmenter->offset)
+    {
+        size += sizeof(CaveTalk_Id_t) + CaveTalk_VarintSize(fragmenter->length);
+    }
+
+    return size;
+}
+
+static CaveTalk_ReassemblySlot_t *CaveTalk_ReassemblerFind(CaveTalk_Reassembler_t *const reassembler, const uint8_t stream)
+{
+    CaveTalk_ReassemblySlot_t *found = NULL;
+
+    for (size_t slot = 0U; (slot < reassembler->slot_count) && (NULL == found); slot++)
+    {
+        if (reassembler->slots[slot].in_use && (stream == (reassembler->slots[slot].transfer >> CAVE_TALK_FRAGMENT_STREAM_SHIFT)))
+        {
+            found = &reassembler->slots[slot];
+        }
+    }
+
+    return found;
+}
+
+static CaveTalk_ReassemblySlot_t *CaveTalk_ReassemblerAllocate(CaveTalk_Reassembler_t *const reassembler)
+{
+    CaveTalk_ReassemblySlot_t *found  = NULL;
+    CaveTalk_ReassemblySlot_t *oldest = &reassembler->slots[0];
+
+    for (size_t slot = 0U; (slot < reassembler->slot_count) && (NULL == found); slot++)
+    {
+        CaveTalk_ReassemblySlot_t *const candidate = &reassembler->slots[slot];
+
+        if (!candidate->in_use)
+        {
+            found = candidate;
+        }
+        else if ((uint32_t)(reassembler->age - candidate->age) > (uint32_t)(reassembler->age - oldest->age))
+        {
+            oldest = candidate;
+        }
+        else
+        {
+        }
+    }
+
+    if (NULL == found)
+    {
+        found = oldest;
+        reassembler->counters.evicted++;
+    }
+
+    return found;
+}
+
+/* A fragment only moves its object's deadline later, so a pending timer is left to fire and rearm itself on the
+ * deadline that is earliest by then */
+static void CaveTalk_ReassemblerArm(CaveTalk_Reassembler_t *const reassembler)
+{
+    CaveTalk_Microseconds_t deadline = 0U;
+
+    if ((NULL == reassembler->wheel) || CaveTalk_TimerPending(&reassembler->timer))
+    {
+    }
+    else if (CaveTalk_ReassemblerDeadline(reassembler, &deadline))
+    {
+        const CaveTalk_Microseconds_t now = reassembler->wheel->clock();
+
+        CaveTalk_TimerStart(reassembler->wheel, &reassembler->timer, (deadline > now) ? (deadline - now) : 0U);
+    }
+    else
+    {
+    }
+}
+
+static void CaveTalk_ReassemblerExpired(void *const context)
+{
+    CaveTalk_Reassembler_t *const reassembler = (CaveTalk_Reassembler_t *)context;
+    const CaveTalk_Microseconds_t now         = reassembler->wheel->clock();
+
+    for (size_t slot = 0U; slot < reassembler->slot_count; slot++)
+    {
+        CaveTalk_ReassemblySlot_t *const candidate = &reassembler->slots[slot];
+
+        if (candidate->in_use && ((now - candidate->heard) >= reassembler->timeout))
+        {
+            candidate->in_use = false;
+            reassembler->counters.expired++;
+        }
+    }
+
+    CaveTalk_ReassemblerArm(reassembler);
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "cave_talk_frame_parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_trace.h"
+#include "cave_talk_types.h"
+
+static inline CaveTalk_Error_t CaveTalk_FrameParserCheckHeader(const CaveTalk_FrameParser_t *const parser);
+static inline void CaveTalk_FrameParserResync(CaveTalk_FrameParser_t *const parser);
+static inline size_t CaveTalk_FrameParserMin(const size_t a, const size_t b);
+
+CaveTalk_Error_t CaveTalk_FrameParserInit(CaveTalk_FrameParser_t *const parser, uint8_t *const buffer, const size_t buffer_size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == parser)
+    {
+    }
+    else
+    {
+        parser->buffer      = buffer;
+        parser->buffer_size = (NULL == buffer) ? 0U : buffer_size;
+        CaveTalk_FrameParserReset(parser);
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+void CaveTalk_FrameParserReset(CaveTalk_FrameParser_t *const parser)
+{
+    if (NULL != parser)
+    {
+        parser->header_received  = 0U;
+        parser->payload_received = 0U;
+        parser->crc_received     = 0U;
+    }
+}
+
+CaveTalk_Error_t CaveTalk_FrameParse(CaveTalk_FrameParser_t *const parser,
+                                     const void *const data,
+                                     const size_t size,
+                                     size_t *const consumed,
+                                     CaveTalk_Id_t *const id,
+                                     CaveTalk_Length_t *const length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == parser) || ((NULL == data) && (0U != size)) || (NULL == consumed) || (NULL == id) || (NULL == length))
+    {
+    }
+    else
+    {
+        const uint8_t *const bytes = (const uint8_t *)data;
+
+        *consumed = 0U;
+        error     = CAVE_TALK_ERROR_INCOMPLETE;
+
+        while ((CAVE_TALK_ERROR_INCOMPLETE == error) && (*consumed < size))
+        {
+            if (parser->header_received < CAVE_TALK_HEADER_SIZE)
+            {
+                const size_t chunk = CaveTalk_FrameParserMin(CAVE_TALK_HEADER_SIZE - parser->header_received, size - *consumed);
+
+                memcpy(&parser->header[parser->header_received], &bytes[*consumed], chunk);
+                parser->header_received += chunk;
+                *consumed               += chunk;
+
+                if (CAVE_TALK_HEADER_SIZE == parser->header_received)
+                {
+                    error = CaveTalk_FrameParserCheckHeader(parser);
+
+                    if (CAVE_TALK_ERROR_NONE != error)
+                    {
+                        CaveTalk_FrameParserResync(parser);
+                    }
+                    else
+                    {
+                        CAVE_TALK_TRACE_HEADER(parser->header[CAVE_TALK_ID_INDEX], parser->header[CAVE_TALK_LENGTH_INDEX]);
+                        error = CAVE_TALK_ERROR_INCOMPLETE;
+                    }
+                }
+            }
+            else if (parser->payload_received < parser->header[CAVE_TALK_LENGTH_INDEX])
+            {
+                const size_t chunk = CaveTalk_FrameParserMin(parser->header[CAVE_TALK_LENGTH_INDEX] - parser->payload_received, size - *consumed);
+
+                if (NULL != parser->buffer)
+                {
+                    memcpy(&parser->buffer[parser->payload_received], &bytes[*consumed], chunk);
+                }
+
+                parser->payload_received += chunk;
+                *consumed                += chunk;
+            }
+            else
+            {
+                const size_t chunk = CaveTalk_FrameParserMin(CAVE_TALK_CRC_SIZE - parser->crc_received, size - *consumed);
+
+                memcpy(&parser->crc[parser->crc_received], &bytes[*consumed], chunk);
+                parser->crc_received += chunk;
+                *consumed            += chunk;
+            }
+
+            if ((CAVE_TALK_HEADER_SIZE != parser->header_received) || (CAVE_TALK_CRC_SIZE != parser->crc_received))
+            {
+            }
+            else if ((NULL != parser->buffer) && !CaveTalk_CrcCheck(parser->header, parser->buffer, parser->crc))
+            {
+                CaveTalk_FrameParserReset(parser);
+
+                error = CAVE_TALK_ERROR_CRC;
+            }
+            else
+            {
+                *id     = parser->header[CAVE_TALK_ID_INDEX];
+                *length = parser->header[CAVE_TALK_LENGTH_INDEX];
+                CaveTalk_FrameParserReset(parser);
+                CAVE_TALK_TRACE_PAYLOAD(*id, *length);
+
+                error = CAVE_TALK_ERROR_NONE;
+            }
+        }
+    }
+
+    return error;
+}
+
+size_t CaveTalk_FrameParserPending(const CaveTalk_FrameParser_t *const parser)
+{
+    size_t pending = 0U;
+
+    if (NULL != parser)
+    {
+        pending = parser->header_received + parser->payload_received + parser->crc_received;
+    }
+
+    return pending;
+}
+
+/* Bytes that complete the frame in progress, or its header while the length is not yet known. Feeding no more than
+ * this never consumes bytes of the next frame. */
+size_t CaveTalk_FrameParserNeeded(const CaveTalk_FrameParser_t *const parser)
+{
+    size_t needed = 0U;
+
+    if (NULL == parser)
+    {
+    }
+    else if (parser->header_received < CAVE_TALK_HEADER_SIZE)
+    {
+        needed = CAVE_TALK_HEADER_SIZE - parser->header_received;
+    }
+    else
+    {
+        needed = (parser->header[CAVE_TALK_LENGTH_INDEX] - parser->payload_received) + (CAVE_TALK_CRC_SIZE - parser->crc_received);
+    }
+
+    return needed;
+}
+
+static inline CaveTalk_Error_t CaveTalk_FrameParserCheckHeader(const CaveTalk_FrameParser_t *const parser)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (CAVE_TALK_VERSION != parser->header[CAVE_TALK_VERSION_INDEX])
+    {
+        error = CAVE_TALK_ERROR_VERSION;
+    }
+    else if ((NULL != parser->buffer) && (parser->header[CAVE_TALK_LENGTH_INDEX] > parser->buffer_size))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+
+    return error;
+}
+
+static inline void CaveTalk_FrameParserResync(CaveTalk_FrameParser_t *const parser)
+{
+    /* Drop the first byte of the rejected header, the rest may still start a valid frame */
+    memmove(&parser->header[0], &parser->header[1], CAVE_TALK_HEADER_SIZE - 1U);
+    parser->header_received = CAVE_TALK_HEADER_SIZE - 1U;
+}
+
+static inline size_t CaveTalk_FrameParserMin(const size_t a, const size_t b)
+{
+    return (a < b) ? a : b;
+}
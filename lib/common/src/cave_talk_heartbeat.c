@@ -0,0 +1,151 @@
+#include "cave_talk_heartbeat.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_HEARTBEAT_SMOOTHING_SHIFT 3U /* RTT smoothing gain of 1/8, same as TCP SRTT */
+
+CaveTalk_Error_t CaveTalk_HeartbeatInit(CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t interval)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == heartbeat) || (NULL == clock))
+    {
+    }
+    else
+    {
+        heartbeat->clock                    = clock;
+        heartbeat->interval                 = interval;
+        heartbeat->last_ping                = 0U;
+        heartbeat->last_heard               = 0U;
+        heartbeat->round_trip_time          = 0U;
+        heartbeat->smoothed_round_trip_time = 0U;
+        heartbeat->clock_offset             = 0;
+        heartbeat->filter_index             = 0U;
+        heartbeat->filter_count             = 0U;
+        heartbeat->pings_sent               = 0U;
+        heartbeat->pongs_received           = 0U;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+bool CaveTalk_HeartbeatDue(const CaveTalk_Heartbeat_t *const heartbeat)
+{
+    bool due = false;
+
+    if ((NULL == heartbeat) || (NULL == heartbeat->clock))
+    {
+    }
+    else if (0U == heartbeat->pings_sent)
+    {
+        due = true;
+    }
+    else
+    {
+        due = (heartbeat->clock() - heartbeat->last_ping) >= heartbeat->interval;
+    }
+
+    return due;
+}
+
+void CaveTalk_HeartbeatPinged(CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Microseconds_t originate)
+{
+    if (NULL != heartbeat)
+    {
+        heartbeat->last_ping = originate;
+        heartbeat->pings_sent++;
+    }
+}
+
+void CaveTalk_HeartbeatHeard(CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Microseconds_t timestamp)
+{
+    if (NULL != heartbeat)
+    {
+        heartbeat->last_heard = timestamp;
+    }
+}
+
+CaveTalk_Error_t CaveTalk_HeartbeatPonged(CaveTalk_Heartbeat_t *const heartbeat,
+                                          const CaveTalk_Microseconds_t originate,
+                                          const CaveTalk_Microseconds_t receive,
+                                          const CaveTalk_Microseconds_t transmit,
+                                          const CaveTalk_Microseconds_t destination)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == heartbeat)
+    {
+    }
+    else if ((destination < originate) || (transmit < receive))
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        /* NTP on-wire calculation, remote processing time is excluded from the round trip */
+        const int64_t                 elapsed    = (int64_t)(destination - originate) - (int64_t)(transmit - receive);
+        const int64_t                 offset     = (((int64_t)receive - (int64_t)originate) + ((int64_t)transmit - (int64_t)destination)) / 2;
+        const CaveTalk_Microseconds_t round_trip = (elapsed > 0) ? (CaveTalk_Microseconds_t)elapsed : 0U;
+        size_t                        best       = 0U;
+
+        heartbeat->round_trip_time = round_trip;
+
+        if (0U == heartbeat->pongs_received)
+        {
+            heartbeat->smoothed_round_trip_time = round_trip;
+        }
+        else
+        {
+            heartbeat->smoothed_round_trip_time = heartbeat->smoothed_round_trip_time -
+                                                  (heartbeat->smoothed_round_trip_time >> CAVE_TALK_HEARTBEAT_SMOOTHING_SHIFT) +
+                                                  (round_trip >> CAVE_TALK_HEARTBEAT_SMOOTHING_SHIFT);
+        }
+
+        /* NTP clock filter, the offset of the lowest delay sample is the least affected by queuing */
+        heartbeat->filter_round_trip_time[heartbeat->filter_index] = round_trip;
+        heartbeat->filter_clock_offset[heartbeat->filter_index]    = offset;
+        heartbeat->filter_index                                    = (heartbeat->filter_index + 1U) % CAVE_TALK_HEARTBEAT_FILTER_SIZE;
+
+        if (heartbeat->filter_count < CAVE_TALK_HEARTBEAT_FILTER_SIZE)
+        {
+            heartbeat->filter_count++;
+        }
+
+        for (size_t sample = 1U; sample < heartbeat->filter_count; sample++)
+        {
+            if (heartbeat->filter_round_trip_time[sample] < heartbeat->filter_round_trip_time[best])
+            {
+                best = sample;
+            }
+        }
+
+        heartbeat->clock_offset = heartbeat->filter_clock_offset[best];
+        heartbeat->last_heard   = destination;
+        heartbeat->pongs_received++;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+bool CaveTalk_HeartbeatAlive(const CaveTalk_Heartbeat_t *const heartbeat, const CaveTalk_Microseconds_t timeout)
+{
+    bool alive = false;
+
+    if ((NULL == heartbeat) || (NULL == heartbeat->clock) || (0U == heartbeat->last_heard))
+    {
+    }
+    else
+    {
+        alive = (heartbeat->clock() - heartbeat->last_heard) < timeout;
+    }
+
+    return alive;
+}
@@ -1,19 +1,13 @@
 #include "cave_talk_link.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
+#include "cave_talk_trace.h"
 #include "cave_talk_types.h"
 
-#define CAVE_TALK_VERSION 1U
-#define CAVE_TALK_ID_NONE 0U /* See ids.proto */
-
-#define CAVE_TALK_VERSION_INDEX 0U
-#define CAVE_TALK_ID_INDEX      (CAVE_TALK_VERSION_INDEX + sizeof(CaveTalk_Version_t))
-#define CAVE_TALK_LENGTH_INDEX  (CAVE_TALK_ID_INDEX + sizeof(CaveTalk_Id_t))
-
-#define CAVE_TALK_HEADER_SIZE (CAVE_TALK_LENGTH_INDEX + 1U)
-
 #define CAVE_TALK_CRC_INDEX_0 0U
 #define CAVE_TALK_CRC_INDEX_1 (CAVE_TALK_CRC_INDEX_0 + 1)
 #define CAVE_TALK_CRC_INDEX_2 (CAVE_TALK_CRC_INDEX_0 + 2)
@@ -47,8 +41,10 @@ CaveTalk_Error_t CaveTalk_Speak(const CaveTalk_LinkHandle_t *const handle,
         header[CAVE_TALK_ID_INDEX]      = id;
         header[CAVE_TALK_LENGTH_INDEX]  = length;
 
-        /* TODO SD-164 calculate CRC */
-        CaveTalk_Crc_t crc = 0U;
+        uint8_t crc[CAVE_TALK_CRC_SIZE];
+        CaveTalk_CrcWrite(header, data, crc);
+
+        CAVE_TALK_TRACE_SEND(id, length);
 
         /* TODO SD-182 determine error behavior */
         /* Send header */
@@ -63,7 +59,7 @@ CaveTalk_Error_t CaveTalk_Speak(const CaveTalk_LinkHandle_t *const handle,
         /* Send CRC */
         if (CAVE_TALK_ERROR_NONE == error)
         {
-            error = handle->send(&crc, sizeof(crc));
+            error = handle->send(crc, sizeof(crc));
         }
     }
 
@@ -104,13 +100,12 @@ CaveTalk_Error_t CaveTalk_Listen(const CaveTalk_LinkHandle_t *const handle,
         {
             size_t         bytes_received = 0U;
             uint8_t        header[CAVE_TALK_HEADER_SIZE];
-            CaveTalk_Crc_t crc = 0U;
+            uint8_t        crc[CAVE_TALK_CRC_SIZE];
 
             *id     = CAVE_TALK_ID_NONE;
             *length = 0U;
 
             /* TODO SD-183 determine error behavior */
-            /* TODO SD-184 check version */
             /* Receive header */
             error   = handle->receive(header, sizeof(header), &bytes_received);
             *id     = header[CAVE_TALK_ID_INDEX];
@@ -124,12 +119,17 @@ CaveTalk_Error_t CaveTalk_Listen(const CaveTalk_LinkHandle_t *const handle,
             {
                 error = CAVE_TALK_ERROR_INCOMPLETE;
             }
+            else if (CAVE_TALK_VERSION != header[CAVE_TALK_VERSION_INDEX])
+            {
+                error = CAVE_TALK_ERROR_VERSION;
+            }
             else if (size < *length)
             {
                 error = CAVE_TALK_ERROR_SIZE;
             }
             else
             {
+                CAVE_TALK_TRACE_HEADER(*id, *length);
                 error = handle->receive(data, *length, &bytes_received);
             }
 
@@ -143,7 +143,7 @@ CaveTalk_Error_t CaveTalk_Listen(const CaveTalk_LinkHandle_t *const handle,
             }
             else
             {
-                error = handle->receive(&crc, sizeof(crc), &bytes_received);
+                error = handle->receive(crc, sizeof(crc), &bytes_received);
             }
 
             /* Verify CRC */
@@ -154,9 +154,13 @@ CaveTalk_Error_t CaveTalk_Listen(const CaveTalk_LinkHandle_t *const handle,
             {
                 error = CAVE_TALK_ERROR_INCOMPLETE;
             }
+            else if (!CaveTalk_CrcCheck(header, data, crc))
+            {
+                error = CAVE_TALK_ERROR_CRC;
+            }
             else
             {
-                /* TODO SD-164 check CRC */
+                CAVE_TALK_TRACE_PAYLOAD(*id, *length);
             }
         }
     }
@@ -164,6 +168,25 @@ CaveTalk_Error_t CaveTalk_Listen(const CaveTalk_LinkHandle_t *const handle,
     return error;
 }
 
+void CaveTalk_CrcWrite(const uint8_t *const header, const void *const data, uint8_t *const crc)
+{
+    (void)header;
+    (void)data;
+
+    /* TODO SD-164 calculate CRC */
+    memset(crc, 0, CAVE_TALK_CRC_SIZE);
+}
+
+bool CaveTalk_CrcCheck(const uint8_t *const header, const void *const data, const uint8_t *const crc)
+{
+    (void)header;
+    (void)data;
+    (void)crc;
+
+    /* TODO SD-164 check CRC */
+    return true;
+}
+
 static inline uint8_t CaveTalk_GetUpperByte(const uint16_t value)
 {
     return (uint8_t)((value >> CAVE_TALK_BYTE_BIT_SHIFT) & CAVE_TALK_BYTE_MASK);
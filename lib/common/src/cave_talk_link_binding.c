@@ -0,0 +1,193 @@
+#include "cave_talk_link_binding.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_LINK_BINDING_TRAMPOLINES(slot)                                                                                     \
+    static CaveTalk_Error_t CaveTalk_LinkBindingSend##slot(const void *const data, const size_t size)                                \
+    {                                                                                                                                \
+        return CaveTalk_LinkBindingSend(slot##U, data, size);                                                                        \
+    }                                                                                                                                \
+    static CaveTalk_Error_t CaveTalk_LinkBindingReceive##slot(void *const data, const size_t size, size_t *const bytes_received)     \
+    {                                                                                                                                \
+        return CaveTalk_LinkBindingReceive(slot##U, data, size, bytes_received);                                                     \
+    }                                                                                                                                \
+    static CaveTalk_Error_t CaveTalk_LinkBindingAvailable##slot(size_t *const bytes_available)                                       \
+    {                                                                                                                                \
+        return CaveTalk_LinkBindingAvailable(slot##U, bytes_available);                                                              \
+    }
+
+#define CAVE_TALK_LINK_BINDING_HANDLE(slot)              \
+    {                                                    \
+        .send      = CaveTalk_LinkBindingSend##slot,     \
+        .receive   = CaveTalk_LinkBindingReceive##slot,  \
+        .available = CaveTalk_LinkBindingAvailable##slot \
+    },
+
+/* Slots are numbered in hexadecimal so a block of 16 is generated from its leading digit */
+#define CAVE_TALK_LINK_BINDING_BLOCK(generate, block)                                                            \
+    generate(0x##block##0) generate(0x##block##1) generate(0x##block##2) generate(0x##block##3)                   \
+    generate(0x##block##4) generate(0x##block##5) generate(0x##block##6) generate(0x##block##7)                   \
+    generate(0x##block##8) generate(0x##block##9) generate(0x##block##a) generate(0x##block##b)                   \
+    generate(0x##block##c) generate(0x##block##d) generate(0x##block##e) generate(0x##block##f)
+
+#if (32U != CAVE_TALK_LINK_BINDING_SLOTS) && (64U != CAVE_TALK_LINK_BINDING_SLOTS) && (128U != CAVE_TALK_LINK_BINDING_SLOTS) && (256U != CAVE_TALK_LINK_BINDING_SLOTS)
+#error "CAVE_TALK_LINK_BINDING_SLOTS must be 32, 64, 128 or 256"
+#endif
+
+static CaveTalk_LinkBinding_t CaveTalk_LinkBindings[CAVE_TALK_LINK_BINDING_SLOTS];
+static atomic_bool            CaveTalk_LinkBindingsUsed[CAVE_TALK_LINK_BINDING_SLOTS];
+
+static inline CaveTalk_Error_t CaveTalk_LinkBindingSend(const size_t slot, const void *const data, const size_t size);
+static inline CaveTalk_Error_t CaveTalk_LinkBindingReceive(const size_t slot, void *const data, const size_t size, size_t *const bytes_received);
+static inline CaveTalk_Error_t CaveTalk_LinkBindingAvailable(const size_t slot, size_t *const bytes_available);
+
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 0)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 1)
+#if CAVE_TALK_LINK_BINDING_SLOTS > 32
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 2)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 3)
+#endif
+#if CAVE_TALK_LINK_BINDING_SLOTS > 64
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 4)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 5)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 6)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 7)
+#endif
+#if CAVE_TALK_LINK_BINDING_SLOTS > 128
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 8)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, 9)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, a)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, b)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, c)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, d)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, e)
+CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_TRAMPOLINES, f)
+#endif
+
+static const CaveTalk_LinkHandle_t CaveTalk_LinkBindingHandles[CAVE_TALK_LINK_BINDING_SLOTS] = {
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 0)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 1)
+#if CAVE_TALK_LINK_BINDING_SLOTS > 32
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 2)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 3)
+#endif
+#if CAVE_TALK_LINK_BINDING_SLOTS > 64
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 4)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 5)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 6)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 7)
+#endif
+#if CAVE_TALK_LINK_BINDING_SLOTS > 128
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 8)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, 9)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, a)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, b)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, c)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, d)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, e)
+    CAVE_TALK_LINK_BINDING_BLOCK(CAVE_TALK_LINK_BINDING_HANDLE, f)
+#endif
+};
+
+CaveTalk_Error_t CaveTalk_LinkBind(const CaveTalk_LinkBinding_t *const binding, CaveTalk_LinkHandle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == binding) || (NULL == handle))
+    {
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+
+        for (size_t slot = 0U; slot < CAVE_TALK_LINK_BINDING_SLOTS; slot++)
+        {
+            bool used = false;
+
+            if (atomic_compare_exchange_strong(&CaveTalk_LinkBindingsUsed[slot], &used, true))
+            {
+                CaveTalk_LinkBindings[slot] = *binding;
+
+                /* Leave callbacks the binding does not provide NULL so callers can still detect them */
+                handle->send      = (NULL != binding->send) ? CaveTalk_LinkBindingHandles[slot].send : NULL;
+                handle->receive   = (NULL != binding->receive) ? CaveTalk_LinkBindingHandles[slot].receive : NULL;
+                handle->available = (NULL != binding->available) ? CaveTalk_LinkBindingHandles[slot].available : NULL;
+
+                error = CAVE_TALK_ERROR_NONE;
+                break;
+            }
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_LinkUnbind(const CaveTalk_LinkHandle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == handle)
+    {
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_ID;
+
+        for (size_t slot = 0U; slot < CAVE_TALK_LINK_BINDING_SLOTS; slot++)
+        {
+            if ((CaveTalk_LinkBindingHandles[slot].send == handle->send) ||
+                (CaveTalk_LinkBindingHandles[slot].receive == handle->receive) ||
+                (CaveTalk_LinkBindingHandles[slot].available == handle->available))
+            {
+                if (atomic_exchange(&CaveTalk_LinkBindingsUsed[slot], false))
+                {
+                    error = CAVE_TALK_ERROR_NONE;
+                }
+                break;
+            }
+        }
+    }
+
+    return error;
+}
+
+static inline CaveTalk_Error_t CaveTalk_LinkBindingSend(const size_t slot, const void *const data, const size_t size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL != CaveTalk_LinkBindings[slot].send)
+    {
+        error = CaveTalk_LinkBindings[slot].send(CaveTalk_LinkBindings[slot].context, data, size);
+    }
+
+    return error;
+}
+
+static inline CaveTalk_Error_t CaveTalk_LinkBindingReceive(const size_t slot, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL != CaveTalk_LinkBindings[slot].receive)
+    {
+        error = CaveTalk_LinkBindings[slot].receive(CaveTalk_LinkBindings[slot].context, data, size, bytes_received);
+    }
+
+    return error;
+}
+
+static inline CaveTalk_Error_t CaveTalk_LinkBindingAvailable(const size_t slot, size_t *const bytes_available)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL != CaveTalk_LinkBindings[slot].available)
+    {
+        error = CaveTalk_LinkBindings[slot].available(CaveTalk_LinkBindings[slot].context, bytes_available);
+    }
+
+    return error;
+}
\ No newline at end of file
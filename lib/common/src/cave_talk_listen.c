@@ -0,0 +1,146 @@
+#include "cave_talk_listen.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_LISTEN_CHUNK_SIZE (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+
+CaveTalk_Error_t CaveTalk_ListenStateInit(CaveTalk_ListenState_t *const state,
+                                          const CaveTalk_Clock_t clock,
+                                          const CaveTalk_LinkWait_t wait,
+                                          void *const wait_context)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == state) || (NULL == clock))
+    {
+    }
+    else
+    {
+        state->clock        = clock;
+        state->wait         = wait;
+        state->wait_context = wait_context;
+        state->expired      = 0U;
+
+        error = CaveTalk_FrameParserInit(&state->parser, NULL, 0U);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ListenUntil(const CaveTalk_LinkHandle_t *const handle,
+                                      CaveTalk_ListenState_t *const state,
+                                      const CaveTalk_Microseconds_t deadline,
+                                      CaveTalk_Id_t *const id,
+                                      void *const data,
+                                      const size_t size,
+                                      CaveTalk_Length_t *const length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == handle) ||
+        (NULL == handle->receive) ||
+        (NULL == handle->available) ||
+        (NULL == state) ||
+        (NULL == id) ||
+        (NULL == data) ||
+        (NULL == length))
+    {
+    }
+    else
+    {
+        bool listening = true;
+
+        state->parser.buffer      = (uint8_t *)data;
+        state->parser.buffer_size = size;
+
+        *id     = CAVE_TALK_ID_NONE;
+        *length = 0U;
+        error   = CAVE_TALK_ERROR_NONE;
+
+        /* Bytes are only read up to the end of the frame in progress, so nothing past it is taken from the link. Bytes
+         * already available are read even when the deadline has passed, since that never blocks. */
+        while (listening)
+        {
+            size_t available = 0U;
+
+            error = handle->available(&available);
+
+            if (CAVE_TALK_ERROR_NONE != error)
+            {
+                listening = false;
+            }
+            else if (0U == available)
+            {
+                const CaveTalk_Microseconds_t now = state->clock();
+
+                if ((now >= deadline) || (NULL == state->wait))
+                {
+                    listening = false;
+                }
+                else
+                {
+                    error     = state->wait(state->wait_context, deadline - now);
+                    listening = (CAVE_TALK_ERROR_NONE == error);
+                }
+            }
+            else
+            {
+                uint8_t      chunk[CAVE_TALK_LISTEN_CHUNK_SIZE];
+                const size_t needed   = CaveTalk_FrameParserNeeded(&state->parser);
+                size_t       received = 0U;
+                size_t       consumed = 0U;
+
+                error = handle->receive(chunk, (available < needed) ? available : needed, &received);
+
+                if (CAVE_TALK_ERROR_NONE == error)
+                {
+                    error = CaveTalk_FrameParse(&state->parser, chunk, received, &consumed, id, length);
+                }
+
+                if (CAVE_TALK_ERROR_INCOMPLETE == error)
+                {
+                    error     = CAVE_TALK_ERROR_NONE;
+                    listening = (0U != received) && (state->clock() < deadline);
+                }
+                else
+                {
+                    listening = false;
+                }
+            }
+        }
+
+        if ((CAVE_TALK_ERROR_NONE == error) && (CAVE_TALK_ID_NONE == *id) && (0U != CaveTalk_FrameParserPending(&state->parser)))
+        {
+            state->expired++;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ListenFor(const CaveTalk_LinkHandle_t *const handle,
+                                    CaveTalk_ListenState_t *const state,
+                                    const CaveTalk_Microseconds_t budget,
+                                    CaveTalk_Id_t *const id,
+                                    void *const data,
+                                    const size_t size,
+                                    CaveTalk_Length_t *const length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == state) || (NULL == state->clock))
+    {
+    }
+    else
+    {
+        error = CaveTalk_ListenUntil(handle, state, state->clock() + budget, id, data, size, length);
+    }
+
+    return error;
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "cave_talk_negotiation.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_NEGOTIATION_REVISION_INDEX     0U
+#define CAVE_TALK_NEGOTIATION_FLAGS_INDEX        1U
+#define CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX 2U
+#define CAVE_TALK_NEGOTIATION_MAX_PAYLOAD_INDEX  6U
+#define CAVE_TALK_NEGOTIATION_FLAG_REPLY         0x01U
+
+static CaveTalk_Error_t CaveTalk_NegotiationSpeak(CaveTalk_Negotiation_t *const negotiation, const CaveTalk_LinkHandle_t *const handle, const bool reply);
+
+CaveTalk_Error_t CaveTalk_NegotiationInit(CaveTalk_Negotiation_t *const negotiation,
+                                          const CaveTalk_Clock_t clock,
+                                          const uint32_t capabilities,
+                                          const CaveTalk_Length_t max_payload,
+                                          const CaveTalk_Microseconds_t retry_interval,
+                                          const uint32_t attempts)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == negotiation) || (NULL == clock))
+    {
+    }
+    else if (0U == attempts)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        negotiation->clock               = clock;
+        negotiation->capabilities        = capabilities;
+        negotiation->max_payload         = max_payload;
+        negotiation->retry_interval      = retry_interval;
+        negotiation->attempts            = attempts;
+        negotiation->state               = CAVE_TALK_NEGOTIATION_STATE_IDLE;
+        negotiation->offers              = 0U;
+        negotiation->last_offer          = 0U;
+        negotiation->peer_revision       = 0U;
+        negotiation->peer_capabilities   = 0U;
+        negotiation->agreed_capabilities = 0U;
+        negotiation->agreed_max_payload  = max_payload;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+/* Offers again from the first attempt, e.g. after the link was reconnected */
+void CaveTalk_NegotiationStart(CaveTalk_Negotiation_t *const negotiation)
+{
+    if (NULL != negotiation)
+    {
+        negotiation->state               = CAVE_TALK_NEGOTIATION_STATE_OFFERING;
+        negotiation->offers              = 0U;
+        negotiation->agreed_capabilities = 0U;
+        negotiation->agreed_max_payload  = negotiation->max_payload;
+    }
+}
+
+CaveTalk_Error_t CaveTalk_NegotiationPoll(CaveTalk_Negotiation_t *const negotiation, const CaveTalk_LinkHandle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == negotiation) || (NULL == negotiation->clock) || (NULL == handle))
+    {
+    }
+    else if (CAVE_TALK_NEGOTIATION_STATE_OFFERING != negotiation->state)
+    {
+        error = CAVE_TALK_ERROR_NONE;
+    }
+    else if ((0U != negotiation->offers) && ((negotiation->clock() - negotiation->last_offer) < negotiation->retry_interval))
+    {
+        error = CAVE_TALK_ERROR_NONE;
+    }
+    else if (negotiation->offers >= negotiation->attempts)
+    {
+        /* Nothing answered, the peer does not negotiate */
+        negotiation->state               = CAVE_TALK_NEGOTIATION_STATE_FALLBACK;
+        negotiation->peer_revision       = 1U;
+        negotiation->peer_capabilities   = 0U;
+        negotiation->agreed_capabilities = 0U;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+    else
+    {
+        negotiation->last_offer = negotiation->clock();
+        negotiation->offers++;
+
+        error = CaveTalk_NegotiationSpeak(negotiation, handle, false);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_NegotiationHear(CaveTalk_Negotiation_t *const negotiation,
+                                          const CaveTalk_LinkHandle_t *const handle,
+                                          const void *const data,
+                                          const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == negotiation) || (NULL == handle) || (NULL == data))
+    {
+    }
+    else if (length < CAVE_TALK_NEGOTIATION_HELLO_SIZE)
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        const uint8_t *const hello            = (const uint8_t *)data;
+        const uint8_t        peer_max_payload = hello[CAVE_TALK_NEGOTIATION_MAX_PAYLOAD_INDEX];
+
+        negotiation->peer_revision       = hello[CAVE_TALK_NEGOTIATION_REVISION_INDEX];
+        negotiation->peer_capabilities   = (uint32_t)hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX] |
+                                           ((uint32_t)hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX + 1U] << 8U) |
+                                           ((uint32_t)hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX + 2U] << 16U) |
+                                           ((uint32_t)hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX + 3U] << 24U);
+        negotiation->agreed_capabilities = negotiation->capabilities & negotiation->peer_capabilities;
+        negotiation->agreed_max_payload  = (peer_max_payload < negotiation->max_payload) ? peer_max_payload : negotiation->max_payload;
+        negotiation->state               = CAVE_TALK_NEGOTIATION_STATE_AGREED;
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Offers are answered even once agreed, the peer may have restarted */
+        if (0U == (hello[CAVE_TALK_NEGOTIATION_FLAGS_INDEX] & CAVE_TALK_NEGOTIATION_FLAG_REPLY))
+        {
+            error = CaveTalk_NegotiationSpeak(negotiation, handle, true);
+        }
+    }
+
+    return error;
+}
+
+/* Without negotiation every capability is allowed, as configured. With it only the agreed ones are, and none before
+ * the peer has answered. */
+bool CaveTalk_NegotiationAllows(const CaveTalk_Negotiation_t *const negotiation, const uint32_t capability)
+{
+    bool allows = true;
+
+    if (NULL != negotiation)
+    {
+        allows = (CAVE_TALK_NEGOTIATION_STATE_AGREED == negotiation->state) && (capability == (negotiation->agreed_capabilities & capability));
+    }
+
+    return allows;
+}
+
+/* Without negotiation a frame holds any payload, with it the agreed max payload, the configured one until the peer has
+ * answered */
+CaveTalk_Length_t CaveTalk_NegotiationMaxPayload(const CaveTalk_Negotiation_t *const negotiation)
+{
+    CaveTalk_Length_t max_payload = UINT8_MAX;
+
+    if (NULL != negotiation)
+    {
+        max_payload = negotiation->agreed_max_payload;
+    }
+
+    return max_payload;
+}
+
+static CaveTalk_Error_t CaveTalk_NegotiationSpeak(CaveTalk_Negotiation_t *const negotiation, const CaveTalk_LinkHandle_t *const handle, const bool reply)
+{
+    uint8_t hello[CAVE_TALK_NEGOTIATION_HELLO_SIZE];
+
+    hello[CAVE_TALK_NEGOTIATION_REVISION_INDEX]          = CAVE_TALK_NEGOTIATION_REVISION;
+    hello[CAVE_TALK_NEGOTIATION_FLAGS_INDEX]             = reply ? CAVE_TALK_NEGOTIATION_FLAG_REPLY : 0U;
+    hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX]      = (uint8_t)negotiation->capabilities;
+    hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX + 1U] = (uint8_t)(negotiation->capabilities >> 8U);
+    hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX + 2U] = (uint8_t)(negotiation->capabilities >> 16U);
+    hello[CAVE_TALK_NEGOTIATION_CAPABILITIES_INDEX + 3U] = (uint8_t)(negotiation->capabilities >> 24U);
+    hello[CAVE_TALK_NEGOTIATION_MAX_PAYLOAD_INDEX]       = negotiation->max_payload;
+
+    return CaveTalk_Speak(handle, CAVE_TALK_ID_HELLO, hello, sizeof(hello));
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "cave_talk_pacer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_PACER_TOKEN_SCALE 1000000U /* Tokens per byte, one per microsecond at a rate of one byte per second */
+
+static CaveTalk_Error_t CaveTalk_PacerSend(void *const context, const void *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_PacerReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_PacerAvailable(void *const context, size_t *const bytes_available);
+static void CaveTalk_PacerRefill(CaveTalk_Pacer_t *const pacer);
+static int64_t CaveTalk_PacerTokens(const CaveTalk_Pacer_t *const pacer, const CaveTalk_Microseconds_t now);
+static int64_t CaveTalk_PacerCost(const CaveTalk_Length_t length);
+
+CaveTalk_Error_t CaveTalk_PacerInit(CaveTalk_Pacer_t *const pacer,
+                                    const CaveTalk_Clock_t clock,
+                                    const uint32_t rate,
+                                    const uint32_t burst,
+                                    CaveTalk_PacerSlot_t *const slots,
+                                    const size_t slot_count)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == pacer) || (NULL == clock) || ((NULL == slots) && (0U != slot_count)))
+    {
+    }
+    else if ((0U == rate) || (burst < CAVE_TALK_PACER_FRAME_SIZE_MAX))
+    {
+        /* A burst smaller than the largest frame would hold that frame back forever */
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        memset(pacer, 0, sizeof(*pacer));
+
+        pacer->clock       = clock;
+        pacer->rate        = rate;
+        pacer->burst       = burst;
+        pacer->tokens      = (int64_t)burst * CAVE_TALK_PACER_TOKEN_SCALE;
+        pacer->last_refill = clock();
+        pacer->slots       = slots;
+        pacer->slot_count  = slot_count;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_PacerSpeak(CaveTalk_Pacer_t *const pacer,
+                                     const CaveTalk_LinkHandle_t *const link_handle,
+                                     const CaveTalk_Id_t id,
+                                     const void *const data,
+                                     const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CaveTalk_PacerDrain(pacer, link_handle);
+
+    if (CAVE_TALK_ERROR_NONE != error)
+    {
+    }
+    else if (NULL == data)
+    {
+        error = CAVE_TALK_ERROR_NULL;
+    }
+    else if ((0U == pacer->slots_queued) && (pacer->tokens >= CaveTalk_PacerCost(length)))
+    {
+        /* Paying here rather than in the charged link, so the frame costs the same whichever link it is given */
+        pacer->speaking = true;
+        error           = CaveTalk_Speak(link_handle, id, data, length);
+        pacer->speaking = false;
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            pacer->tokens              -= CaveTalk_PacerCost(length);
+            pacer->counters.bytes_sent += CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+            pacer->counters.sent++;
+        }
+    }
+    else if (pacer->slots_queued < pacer->slot_count)
+    {
+        /* Frames already waiting go first, so a frame is queued whenever any are, to keep the order they were spoken in */
+        CaveTalk_PacerSlot_t *const slot = &pacer->slots[(pacer->slot_head + pacer->slots_queued) % pacer->slot_count];
+
+        slot->id     = id;
+        slot->length = length;
+        memcpy(slot->payload, data, length);
+
+        pacer->slots_queued++;
+        pacer->bytes_queued += CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+        pacer->counters.queued++;
+    }
+    else
+    {
+        pacer->counters.rejected++;
+        error = CAVE_TALK_ERROR_RATE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_PacerDrain(CaveTalk_Pacer_t *const pacer, const CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == pacer) || (NULL == link_handle))
+    {
+    }
+    else
+    {
+        CaveTalk_PacerRefill(pacer);
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        while ((CAVE_TALK_ERROR_NONE == error) && (0U != pacer->slots_queued) &&
+               (pacer->tokens >= CaveTalk_PacerCost(pacer->slots[pacer->slot_head].length)))
+        {
+            const CaveTalk_PacerSlot_t *const slot = &pacer->slots[pacer->slot_head];
+
+            /* A frame the link fails to take stays at the head of the queue */
+            pacer->speaking = true;
+            error           = CaveTalk_Speak(link_handle, slot->id, slot->payload, slot->length);
+            pacer->speaking = false;
+
+            if (CAVE_TALK_ERROR_NONE == error)
+            {
+                pacer->tokens              -= CaveTalk_PacerCost(slot->length);
+                pacer->bytes_queued        -= CAVE_TALK_HEADER_SIZE + slot->length + CAVE_TALK_CRC_SIZE;
+                pacer->counters.bytes_sent += CAVE_TALK_HEADER_SIZE + slot->length + CAVE_TALK_CRC_SIZE;
+                pacer->counters.sent++;
+                pacer->slot_head = (pacer->slot_head + 1U) % pacer->slot_count;
+                pacer->slots_queued--;
+            }
+        }
+    }
+
+    return error;
+}
+
+/* Time until every frame queued now has been sent, what a frame spoken now would wait */
+CaveTalk_Microseconds_t CaveTalk_PacerDelay(const CaveTalk_Pacer_t *const pacer)
+{
+    CaveTalk_Microseconds_t delay = 0U;
+
+    if (NULL != pacer)
+    {
+        const int64_t tokens = CaveTalk_PacerTokens(pacer, pacer->clock());
+        const int64_t needed = (int64_t)pacer->bytes_queued * CAVE_TALK_PACER_TOKEN_SCALE;
+
+        if (needed > tokens)
+        {
+            delay = ((CaveTalk_Microseconds_t)(needed - tokens) + pacer->rate - 1U) / pacer->rate;
+        }
+    }
+
+    return delay;
+}
+
+/* Sends through the charged link spend tokens as they go out, frames the pacer sends itself are paid for once */
+CaveTalk_Error_t CaveTalk_PacerBind(CaveTalk_Pacer_t *const pacer,
+                                    const CaveTalk_LinkHandle_t *const link_handle,
+                                    CaveTalk_LinkHandle_t *const charged_link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == pacer) || (NULL == link_handle) || (NULL == link_handle->send) || (NULL == charged_link_handle))
+    {
+    }
+    else
+    {
+        CaveTalk_LinkBinding_t binding;
+
+        pacer->link_handle = *link_handle;
+
+        binding.context   = pacer;
+        binding.send      = CaveTalk_PacerSend;
+        binding.receive   = (NULL != link_handle->receive) ? CaveTalk_PacerReceive : NULL;
+        binding.available = (NULL != link_handle->available) ? CaveTalk_PacerAvailable : NULL;
+
+        error = CaveTalk_LinkBind(&binding, &pacer->charged_link_handle);
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *charged_link_handle = pacer->charged_link_handle;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_PacerUnbind(CaveTalk_Pacer_t *const pacer)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == pacer)
+    {
+    }
+    else
+    {
+        error = CaveTalk_LinkUnbind(&pacer->charged_link_handle);
+
+        pacer->charged_link_handle = kCaveTalk_LinkHandleNull;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_PacerSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Pacer_t *const pacer = (CaveTalk_Pacer_t *)context;
+    const CaveTalk_Error_t  error = pacer->link_handle.send(data, size);
+
+    if ((CAVE_TALK_ERROR_NONE == error) && !pacer->speaking)
+    {
+        CaveTalk_PacerRefill(pacer);
+
+        pacer->tokens                 -= (int64_t)size * CAVE_TALK_PACER_TOKEN_SCALE;
+        pacer->counters.bytes_charged += size;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_PacerReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    const CaveTalk_Pacer_t *const pacer = (const CaveTalk_Pacer_t *)context;
+
+    return pacer->link_handle.receive(data, size, bytes_received);
+}
+
+static CaveTalk_Error_t CaveTalk_PacerAvailable(void *const context, size_t *const bytes_available)
+{
+    const CaveTalk_Pacer_t *const pacer = (const CaveTalk_Pacer_t *)context;
+
+    return pacer->link_handle.available(bytes_available);
+}
+
+static void CaveTalk_PacerRefill(CaveTalk_Pacer_t *const pacer)
+{
+    const CaveTalk_Microseconds_t now = pacer->clock();
+
+    pacer->tokens      = CaveTalk_PacerTokens(pacer, now);
+    pacer->last_refill = now;
+}
+
+static int64_t CaveTalk_PacerTokens(const CaveTalk_Pacer_t *const pacer, const CaveTalk_Microseconds_t now)
+{
+    const int64_t           capacity = (int64_t)pacer->burst * CAVE_TALK_PACER_TOKEN_SCALE;
+    CaveTalk_Microseconds_t elapsed  = (now > pacer->last_refill) ? (now - pacer->last_refill) : 0U;
+
+    /* Past the time to refill to full the bucket is full, which also keeps the product below from overflowing */
+    if (elapsed > ((CaveTalk_Microseconds_t)(capacity - pacer->tokens) / pacer->rate))
+    {
+        elapsed = (CaveTalk_Microseconds_t)(capacity - pacer->tokens) / pacer->rate;
+    }
+
+    return ((pacer->tokens + (int64_t)(elapsed * pacer->rate)) < capacity) ? (pacer->tokens + (int64_t)(elapsed * pacer->rate)) : capacity;
+}
+
+static int64_t CaveTalk_PacerCost(const CaveTalk_Length_t length)
+{
+    return (int64_t)(CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE) * CAVE_TALK_PACER_TOKEN_SCALE;
+}
\ No newline at end of file
@@ -0,0 +1,591 @@
+#include "cave_talk_reliable.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_RELIABLE_SEQUENCE_INDEX 0U
+#define CAVE_TALK_RELIABLE_ID_INDEX       2U
+#define CAVE_TALK_RELIABLE_BITMAP_INDEX   2U
+#define CAVE_TALK_RELIABLE_ID_WORD_BITS   32U
+#define CAVE_TALK_RELIABLE_BYTE_BITS      8U
+#define CAVE_TALK_RELIABLE_BYTE_MASK      0xFFU
+
+static CaveTalk_Error_t CaveTalk_ReliableSendAck(CaveTalk_Reliable_t *const reliable, const CaveTalk_LinkHandle_t *const handle);
+static void CaveTalk_ReliableMeasure(CaveTalk_Reliable_t *const reliable, const CaveTalk_Microseconds_t sample);
+static void CaveTalk_ReliableRearm(CaveTalk_Reliable_t *const reliable);
+static void CaveTalk_ReliableExpired(void *const context);
+static CaveTalk_ReliableSlot_t *CaveTalk_ReliableFind(CaveTalk_ReliableSlot_t *const slots, const size_t slot_count, const uint16_t sequence);
+static inline CaveTalk_Microseconds_t CaveTalk_ReliableTimeout(const CaveTalk_Reliable_t *const reliable, const uint8_t transmissions);
+static inline void CaveTalk_ReliablePutUint16(uint8_t *const bytes, const uint16_t value);
+static inline uint16_t CaveTalk_ReliableGetUint16(const uint8_t *const bytes);
+
+CaveTalk_Error_t CaveTalk_ReliableInit(CaveTalk_Reliable_t *const reliable,
+                                       const CaveTalk_Clock_t clock,
+                                       CaveTalk_ReliableSlot_t *const send_slots,
+                                       const size_t send_slot_count,
+                                       CaveTalk_ReliableSlot_t *const receive_slots,
+                                       const size_t receive_slot_count)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reliable) || (NULL == clock) || ((NULL == send_slots) && (0U != send_slot_count)) ||
+        ((NULL == receive_slots) && (0U != receive_slot_count)))
+    {
+    }
+    else if ((send_slot_count > CAVE_TALK_RELIABLE_WINDOW) || (receive_slot_count > CAVE_TALK_RELIABLE_WINDOW))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        memset(reliable, 0, sizeof(*reliable));
+
+        reliable->clock                  = clock;
+        reliable->send_slots             = send_slots;
+        reliable->send_slot_count        = send_slot_count;
+        reliable->receive_slots          = receive_slots;
+        reliable->receive_slot_count     = receive_slot_count;
+        reliable->retransmission_timeout = CAVE_TALK_RELIABLE_RTO_INITIAL;
+
+        for (size_t slot = 0U; slot < send_slot_count; slot++)
+        {
+            send_slots[slot].in_use = false;
+        }
+        for (size_t slot = 0U; slot < receive_slot_count; slot++)
+        {
+            receive_slots[slot].in_use = false;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ReliableEnable(CaveTalk_Reliable_t *const reliable, const CaveTalk_Id_t id, const bool enable)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == reliable)
+    {
+    }
+    else if ((CAVE_TALK_ID_RELIABLE == id) || (CAVE_TALK_ID_ACK == id))
+    {
+        error = CAVE_TALK_ERROR_ID;
+    }
+    else
+    {
+        const uint32_t bit = 1UL << (id % CAVE_TALK_RELIABLE_ID_WORD_BITS);
+
+        if (enable)
+        {
+            reliable->enabled_ids[id / CAVE_TALK_RELIABLE_ID_WORD_BITS] |= bit;
+        }
+        else
+        {
+            reliable->enabled_ids[id / CAVE_TALK_RELIABLE_ID_WORD_BITS] &= ~bit;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+bool CaveTalk_ReliableEnabled(const CaveTalk_Reliable_t *const reliable, const CaveTalk_Id_t id)
+{
+    return (NULL != reliable) && (0U != (reliable->enabled_ids[id / CAVE_TALK_RELIABLE_ID_WORD_BITS] & (1UL << (id % CAVE_TALK_RELIABLE_ID_WORD_BITS))));
+}
+
+CaveTalk_Error_t CaveTalk_ReliableSpeak(CaveTalk_Reliable_t *const reliable,
+                                        const CaveTalk_LinkHandle_t *const handle,
+                                        const CaveTalk_Id_t id,
+                                        const void *const data,
+                                        const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reliable) || (NULL == handle) || (NULL == handle->send) || ((NULL == data) && (0U != length)))
+    {
+    }
+    else if (length > CAVE_TALK_RELIABLE_PAYLOAD_SIZE_MAX)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        CaveTalk_ReliableSlot_t *free_slot = NULL;
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        for (size_t slot = 0U; slot < reliable->send_slot_count; slot++)
+        {
+            CaveTalk_ReliableSlot_t *const send_slot = &reliable->send_slots[slot];
+
+            if (!send_slot->in_use)
+            {
+                free_slot = send_slot;
+            }
+            else if ((uint16_t)(reliable->send_next - send_slot->sequence) >= CAVE_TALK_RELIABLE_WINDOW)
+            {
+                /* The oldest unacknowledged frame would fall out of the receiver's selective ACK */
+                error = CAVE_TALK_ERROR_SIZE;
+            }
+            else
+            {
+            }
+        }
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+        }
+        else if (NULL == free_slot)
+        {
+            error = CAVE_TALK_ERROR_SIZE;
+        }
+        else
+        {
+            CaveTalk_ReliablePutUint16(&free_slot->payload[CAVE_TALK_RELIABLE_SEQUENCE_INDEX], reliable->send_next);
+            free_slot->payload[CAVE_TALK_RELIABLE_ID_INDEX] = id;
+            if (0U != length)
+            {
+                memcpy(&free_slot->payload[CAVE_TALK_RELIABLE_HEADER_SIZE], data, length);
+            }
+            free_slot->length = (CaveTalk_Length_t)(length + CAVE_TALK_RELIABLE_HEADER_SIZE);
+
+            error = CaveTalk_Speak(handle, CAVE_TALK_ID_RELIABLE, free_slot->payload, free_slot->length);
+
+            if (CAVE_TALK_ERROR_NONE == error)
+            {
+                free_slot->sequence      = reliable->send_next;
+                free_slot->sent          = reliable->clock();
+                free_slot->transmissions = 1U;
+                free_slot->in_use        = true;
+                reliable->send_next++;
+                reliable->counters.sent++;
+                CaveTalk_ReliableRearm(reliable);
+            }
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ReliableRetransmit(CaveTalk_Reliable_t *const reliable, const CaveTalk_LinkHandle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reliable) || (NULL == handle) || (NULL == handle->send))
+    {
+    }
+    else
+    {
+        const CaveTalk_Microseconds_t now = reliable->clock();
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        for (size_t slot = 0U; (slot < reliable->send_slot_count) && (CAVE_TALK_ERROR_NONE == error); slot++)
+        {
+            CaveTalk_ReliableSlot_t *const send_slot = &reliable->send_slots[slot];
+
+            if (send_slot->in_use && ((now - send_slot->sent) >= CaveTalk_ReliableTimeout(reliable, send_slot->transmissions)))
+            {
+                error = CaveTalk_Speak(handle, CAVE_TALK_ID_RELIABLE, send_slot->payload, send_slot->length);
+
+                if (CAVE_TALK_ERROR_NONE == error)
+                {
+                    send_slot->sent = now;
+                    if (send_slot->transmissions < UINT8_MAX)
+                    {
+                        send_slot->transmissions++;
+                    }
+                    reliable->counters.retransmitted++;
+                }
+            }
+        }
+
+        CaveTalk_ReliableRearm(reliable);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ReliableHearAck(CaveTalk_Reliable_t *const reliable, const void *const data, const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reliable) || (NULL == data))
+    {
+    }
+    else if (CAVE_TALK_RELIABLE_ACK_SIZE != length)
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        const uint8_t *const          bytes      = (const uint8_t *)data;
+        const uint16_t                cumulative = CaveTalk_ReliableGetUint16(&bytes[CAVE_TALK_RELIABLE_SEQUENCE_INDEX]);
+        const CaveTalk_Microseconds_t now        = reliable->clock();
+        uint32_t                      selective  = 0U;
+
+        for (size_t byte = 0U; byte < sizeof(selective); byte++)
+        {
+            selective |= (uint32_t)bytes[CAVE_TALK_RELIABLE_BITMAP_INDEX + byte] << (byte * CAVE_TALK_RELIABLE_BYTE_BITS);
+        }
+
+        for (size_t slot = 0U; slot < reliable->send_slot_count; slot++)
+        {
+            CaveTalk_ReliableSlot_t *const send_slot = &reliable->send_slots[slot];
+            const uint16_t                 distance  = (uint16_t)(send_slot->sequence - cumulative);
+            bool                           acked     = false;
+
+            if (!send_slot->in_use)
+            {
+            }
+            else if (distance >= (UINT16_MAX / 2U))
+            {
+                /* Before the cumulative ACK */
+                acked = true;
+            }
+            else if ((0U != distance) && (distance <= CAVE_TALK_RELIABLE_WINDOW))
+            {
+                acked = 0U != (selective & (1UL << (distance - 1U)));
+            }
+            else
+            {
+            }
+
+            if (acked)
+            {
+                /* Karn's algorithm, only unambiguous samples update the RTO */
+                if (1U == send_slot->transmissions)
+                {
+                    CaveTalk_ReliableMeasure(reliable, now - send_slot->sent);
+                }
+
+                send_slot->in_use = false;
+                reliable->counters.acknowledged++;
+            }
+        }
+
+        /* A new RTO sample can bring the deadlines of the frames still in flight forward */
+        CaveTalk_ReliableRearm(reliable);
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ReliableHear(CaveTalk_Reliable_t *const reliable,
+                                       const CaveTalk_LinkHandle_t *const handle,
+                                       const void *const data,
+                                       const CaveTalk_Length_t length,
+                                       CaveTalk_ReliableFrame_t *const frame)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reliable) || (NULL == handle) || (NULL == data) || (NULL == frame))
+    {
+    }
+    else if (length < CAVE_TALK_RELIABLE_HEADER_SIZE)
+    {
+        error = CAVE_TALK_ERROR_PARSE;
+    }
+    else
+    {
+        const uint8_t *const bytes    = (const uint8_t *)data;
+        const uint16_t       sequence = CaveTalk_ReliableGetUint16(&bytes[CAVE_TALK_RELIABLE_SEQUENCE_INDEX]);
+        const uint16_t       distance = (uint16_t)(sequence - reliable->receive_next);
+        bool                 deliver  = false;
+
+        if (0U == distance)
+        {
+            frame->id     = bytes[CAVE_TALK_RELIABLE_ID_INDEX];
+            frame->data   = &bytes[CAVE_TALK_RELIABLE_HEADER_SIZE];
+            frame->length = (CaveTalk_Length_t)(length - CAVE_TALK_RELIABLE_HEADER_SIZE);
+            deliver       = true;
+
+            reliable->receive_next++;
+            reliable->counters.delivered++;
+        }
+        else if ((distance >= (UINT16_MAX / 2U)) ||
+                 (NULL != CaveTalk_ReliableFind(reliable->receive_slots, reliable->receive_slot_count, sequence)))
+        {
+            /* Already delivered or buffered, the ACK for it was lost */
+            reliable->counters.duplicates++;
+        }
+        else if (distance <= CAVE_TALK_RELIABLE_WINDOW)
+        {
+            for (size_t slot = 0U; slot < reliable->receive_slot_count; slot++)
+            {
+                CaveTalk_ReliableSlot_t *const receive_slot = &reliable->receive_slots[slot];
+
+                if (!receive_slot->in_use)
+                {
+                    memcpy(receive_slot->payload, bytes, length);
+                    receive_slot->length   = length;
+                    receive_slot->sequence = sequence;
+                    receive_slot->in_use   = true;
+                    reliable->counters.out_of_order++;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            /* Beyond the window, not buffered; the cumulative ACK below does not cover it so it is sent again later */
+        }
+
+        error = CaveTalk_ReliableSendAck(reliable, handle);
+
+        if (deliver)
+        {
+            /* A lost ACK is recovered by the sender retransmitting and the duplicate being acknowledged again */
+            error = CAVE_TALK_ERROR_NONE;
+        }
+        else if (CAVE_TALK_ERROR_NONE == error)
+        {
+            error = CAVE_TALK_ERROR_INCOMPLETE;
+        }
+        else
+        {
+        }
+    }
+
+    return error;
+}
+
+bool CaveTalk_ReliableNext(CaveTalk_Reliable_t *const reliable, CaveTalk_ReliableFrame_t *const frame)
+{
+    bool found = false;
+
+    if ((NULL == reliable) || (NULL == frame))
+    {
+    }
+    else
+    {
+        CaveTalk_ReliableSlot_t *const receive_slot = CaveTalk_ReliableFind(reliable->receive_slots, reliable->receive_slot_count, reliable->receive_next);
+
+        if (NULL != receive_slot)
+        {
+            /* The slot is released now but its payload stays intact until the next call to CaveTalk_ReliableHear */
+            frame->id            = receive_slot->payload[CAVE_TALK_RELIABLE_ID_INDEX];
+            frame->data          = &receive_slot->payload[CAVE_TALK_RELIABLE_HEADER_SIZE];
+            frame->length        = (CaveTalk_Length_t)(receive_slot->length - CAVE_TALK_RELIABLE_HEADER_SIZE);
+            receive_slot->in_use = false;
+            found                = true;
+
+            reliable->receive_next++;
+            reliable->counters.delivered++;
+        }
+    }
+
+    return found;
+}
+
+size_t CaveTalk_ReliableInFlight(const CaveTalk_Reliable_t *const reliable)
+{
+    size_t in_flight = 0U;
+
+    if (NULL != reliable)
+    {
+        for (size_t slot = 0U; slot < reliable->send_slot_count; slot++)
+        {
+            in_flight += reliable->send_slots[slot].in_use ? 1U : 0U;
+        }
+    }
+
+    return in_flight;
+}
+
+bool CaveTalk_ReliableDeadline(const CaveTalk_Reliable_t *const reliable, CaveTalk_Microseconds_t *const deadline)
+{
+    bool found = false;
+
+    if ((NULL == reliable) || (NULL == deadline))
+    {
+    }
+    else
+    {
+        for (size_t slot = 0U; slot < reliable->send_slot_count; slot++)
+        {
+            const CaveTalk_ReliableSlot_t *const send_slot = &reliable->send_slots[slot];
+
+            if (send_slot->in_use)
+            {
+                const CaveTalk_Microseconds_t due = send_slot->sent + CaveTalk_ReliableTimeout(reliable, send_slot->transmissions);
+
+                if (!found || (due < *deadline))
+                {
+                    *deadline = due;
+                    found     = true;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+CaveTalk_Error_t CaveTalk_ReliableSchedule(CaveTalk_Reliable_t *const reliable, CaveTalk_TimerWheel_t *const wheel, const CaveTalk_LinkHandle_t *const handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reliable) || ((NULL != wheel) && ((NULL == handle) || (NULL == handle->send))))
+    {
+    }
+    else
+    {
+        /* A NULL wheel goes back to polling CaveTalk_ReliableRetransmit */
+        if (NULL != reliable->wheel)
+        {
+            CaveTalk_TimerCancel(reliable->wheel, &reliable->timer);
+        }
+
+        reliable->wheel        = wheel;
+        reliable->wheel_handle = handle;
+        error                  = CaveTalk_TimerInit(&reliable->timer, CaveTalk_ReliableExpired, reliable);
+
+        CaveTalk_ReliableRearm(reliable);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_ReliableSendAck(CaveTalk_Reliable_t *const reliable, const CaveTalk_LinkHandle_t *const handle)
+{
+    uint8_t  ack[CAVE_TALK_RELIABLE_ACK_SIZE];
+    uint16_t cumulative = reliable->receive_next;
+    uint32_t selective  = 0U;
+
+    /* Frames buffered right after receive_next are delivered by CaveTalk_ReliableNext, so they are already covered */
+    while (NULL != CaveTalk_ReliableFind(reliable->receive_slots, reliable->receive_slot_count, cumulative))
+    {
+        cumulative++;
+    }
+
+    for (size_t slot = 0U; slot < reliable->receive_slot_count; slot++)
+    {
+        const CaveTalk_ReliableSlot_t *const receive_slot = &reliable->receive_slots[slot];
+        const uint16_t                       distance     = (uint16_t)(receive_slot->sequence - cumulative);
+
+        if (receive_slot->in_use && (0U != distance) && (distance <= CAVE_TALK_RELIABLE_WINDOW))
+        {
+            selective |= 1UL << (distance - 1U);
+        }
+    }
+
+    CaveTalk_ReliablePutUint16(&ack[CAVE_TALK_RELIABLE_SEQUENCE_INDEX], cumulative);
+    for (size_t byte = 0U; byte < sizeof(selective); byte++)
+    {
+        ack[CAVE_TALK_RELIABLE_BITMAP_INDEX + byte] = (uint8_t)((selective >> (byte * CAVE_TALK_RELIABLE_BYTE_BITS)) & CAVE_TALK_RELIABLE_BYTE_MASK);
+    }
+
+    return CaveTalk_Speak(handle, CAVE_TALK_ID_ACK, ack, sizeof(ack));
+}
+
+static void CaveTalk_ReliableMeasure(CaveTalk_Reliable_t *const reliable, const CaveTalk_Microseconds_t sample)
+{
+    CaveTalk_Microseconds_t timeout = 0U;
+
+    if (!reliable->round_trip_time_valid)
+    {
+        reliable->smoothed_round_trip_time = sample;
+        reliable->round_trip_time_variance = sample / 2U;
+        reliable->round_trip_time_valid    = true;
+    }
+    else
+    {
+        const CaveTalk_Microseconds_t deviation = (sample > reliable->smoothed_round_trip_time) ?
+                                                  (sample - reliable->smoothed_round_trip_time) :
+                                                  (reliable->smoothed_round_trip_time - sample);
+
+        /* RFC 6298 gains of 1/4 for the variance and 1/8 for the smoothed RTT */
+        reliable->round_trip_time_variance = ((3U * reliable->round_trip_time_variance) + deviation) / 4U;
+        reliable->smoothed_round_trip_time = ((7U * reliable->smoothed_round_trip_time) + sample) / 8U;
+    }
+
+    timeout = reliable->smoothed_round_trip_time + (4U * reliable->round_trip_time_variance);
+
+    if (timeout < CAVE_TALK_RELIABLE_RTO_MIN)
+    {
+        timeout = CAVE_TALK_RELIABLE_RTO_MIN;
+    }
+    else if (timeout > CAVE_TALK_RELIABLE_RTO_MAX)
+    {
+        timeout = CAVE_TALK_RELIABLE_RTO_MAX;
+    }
+    else
+    {
+    }
+
+    reliable->retransmission_timeout = timeout;
+}
+
+/* Keeps the timer on the earliest retransmit deadline, a frame already due is retransmitted on the next tick */
+static void CaveTalk_ReliableRearm(CaveTalk_Reliable_t *const reliable)
+{
+    CaveTalk_Microseconds_t deadline = 0U;
+
+    if (NULL == reliable->wheel)
+    {
+    }
+    else if (CaveTalk_ReliableDeadline(reliable, &deadline))
+    {
+        const CaveTalk_Microseconds_t now = reliable->clock();
+
+        CaveTalk_TimerStart(reliable->wheel, &reliable->timer, (deadline > now) ? (deadline - now) : 0U);
+    }
+    else
+    {
+        CaveTalk_TimerCancel(reliable->wheel, &reliable->timer);
+    }
+}
+
+static void CaveTalk_ReliableExpired(void *const context)
+{
+    CaveTalk_Reliable_t *const reliable = (CaveTalk_Reliable_t *)context;
+
+    CaveTalk_ReliableRetransmit(reliable, reliable->wheel_handle);
+}
+
+static CaveTalk_ReliableSlot_t *CaveTalk_ReliableFind(CaveTalk_ReliableSlot_t *const slots, const size_t slot_count, const uint16_t sequence)
+{
+    CaveTalk_ReliableSlot_t *found = NULL;
+
+    for (size_t slot = 0U; (slot < slot_count) && (NULL == found); slot++)
+    {
+        if (slots[slot].in_use && (sequence == slots[slot].sequence))
+        {
+            found = &slots[slot];
+        }
+    }
+
+    return found;
+}
+
+static inline CaveTalk_Microseconds_t CaveTalk_ReliableTimeout(const CaveTalk_Reliable_t *const reliable, const uint8_t transmissions)
+{
+    const uint8_t           backoff = (transmissions > CAVE_TALK_RELIABLE_BACKOFF_MAX) ? CAVE_TALK_RELIABLE_BACKOFF_MAX : (uint8_t)(transmissions - 1U);
+    CaveTalk_Microseconds_t timeout = reliable->retransmission_timeout << backoff;
+
+    return (timeout > CAVE_TALK_RELIABLE_RTO_MAX) ? CAVE_TALK_RELIABLE_RTO_MAX : timeout;
+}
+
+static inline void CaveTalk_ReliablePutUint16(uint8_t *const bytes, const uint16_t value)
+{
+    bytes[0] = (uint8_t)(value & CAVE_TALK_RELIABLE_BYTE_MASK);
+    bytes[1] = (uint8_t)((value >> CAVE_TALK_RELIABLE_BYTE_BITS) & CAVE_TALK_RELIABLE_BYTE_MASK);
+}
+
+static inline uint16_t CaveTalk_ReliableGetUint16(const uint8_t *const bytes)
+{
+    return (uint16_t)(bytes[0] | ((uint16_t)bytes[1] << CAVE_TALK_RELIABLE_BYTE_BITS));
+}
\ No newline at end of file
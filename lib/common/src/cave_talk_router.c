@@ -0,0 +1,264 @@
+#include "cave_talk_router.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static void CaveTalk_RouterIngress(CaveTalk_Router_t *const router, const size_t source);
+static size_t CaveTalk_RouterEgress(CaveTalk_RouterLink_t *const link);
+static bool CaveTalk_RouterEnqueue(CaveTalk_Router_t *const router, CaveTalk_RouterLink_t *const source);
+static inline size_t CaveTalk_RouterFrameSize(const uint8_t *const frame);
+
+CaveTalk_Error_t CaveTalk_RouterLinkInit(CaveTalk_RouterLink_t *const link,
+                                         const CaveTalk_LinkHandle_t *const link_handle,
+                                         uint8_t *const queue,
+                                         const size_t queue_size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == link) || (NULL == link_handle) || ((NULL == queue) && (0U != queue_size)))
+    {
+    }
+    else if ((NULL != link_handle->send) && (queue_size < CAVE_TALK_ROUTER_FRAME_SIZE_MAX))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        link->link_handle       = *link_handle;
+        link->queue             = queue;
+        link->queue_slots       = queue_size / CAVE_TALK_ROUTER_FRAME_SIZE_MAX;
+        link->queue_head        = 0U;
+        link->queue_count       = 0U;
+        link->held_destinations = 0U;
+        memset(&link->counters, 0, sizeof(link->counters));
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_RouterInit(CaveTalk_Router_t *const router,
+                                     CaveTalk_RouterLink_t *const links,
+                                     const size_t link_count,
+                                     const CaveTalk_RouterRule_t *const rules,
+                                     const size_t rule_count,
+                                     const size_t budget)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == router) || (NULL == links) || ((NULL == rules) && (0U != rule_count)))
+    {
+    }
+    else if ((0U == link_count) || (link_count > CAVE_TALK_ROUTER_LINK_COUNT_MAX) || (0U == budget))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        router->links      = links;
+        router->link_count = link_count;
+        router->rules      = rules;
+        router->rule_count = rule_count;
+        router->budget     = budget;
+        router->outputs    = 0U;
+        memset(&router->counters, 0, sizeof(router->counters));
+
+        for (size_t index = 0U; index < link_count; index++)
+        {
+            if ((NULL != links[index].link_handle.send) && (0U != links[index].queue_slots))
+            {
+                router->outputs |= (uint32_t)1U << index;
+            }
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_RouterPoll(CaveTalk_Router_t *const router, size_t *const forwarded)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == router) || (NULL == forwarded))
+    {
+    }
+    else
+    {
+        *forwarded = 0U;
+
+        /* Take in up to a budget of frames per link so a busy link cannot starve the others, then send out what was
+         * queued in the same pass */
+        for (size_t index = 0U; index < router->link_count; index++)
+        {
+            CaveTalk_RouterIngress(router, index);
+        }
+
+        for (size_t index = 0U; index < router->link_count; index++)
+        {
+            *forwarded += CaveTalk_RouterEgress(&router->links[index]);
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+uint32_t CaveTalk_RouterDestinations(const CaveTalk_Router_t *const router, const size_t source, const CaveTalk_Id_t id)
+{
+    uint32_t destinations = 0U;
+
+    if ((NULL != router) && (source < router->link_count))
+    {
+        const uint32_t source_mask = (uint32_t)1U << source;
+
+        for (size_t index = 0U; index < router->rule_count; index++)
+        {
+            const CaveTalk_RouterRule_t *const rule = &router->rules[index];
+
+            if ((0U != (rule->sources & source_mask)) && ((CAVE_TALK_ROUTER_ID_ANY == rule->id) || (id == rule->id)))
+            {
+                destinations |= rule->destinations;
+            }
+        }
+
+        destinations &= router->outputs & ~source_mask;
+    }
+
+    return destinations;
+}
+
+static void CaveTalk_RouterIngress(CaveTalk_Router_t *const router, const size_t source)
+{
+    CaveTalk_RouterLink_t *const link  = &router->links[source];
+    bool                         ready = (NULL != link->link_handle.receive) && (NULL != link->link_handle.available);
+
+    for (size_t count = 0U; ready && (count < router->budget); count++)
+    {
+        /* A held frame goes first, nothing more is read from the link until it has been queued */
+        if (0U == link->held_destinations)
+        {
+            CaveTalk_Id_t     id     = CAVE_TALK_ID_NONE;
+            CaveTalk_Length_t length = 0U;
+            CaveTalk_Error_t  error  = CaveTalk_Listen(&link->link_handle,
+                                                       &id,
+                                                       &link->held[CAVE_TALK_HEADER_SIZE],
+                                                       sizeof(link->held) - CAVE_TALK_HEADER_SIZE - CAVE_TALK_CRC_SIZE,
+                                                       &length);
+
+            if (CAVE_TALK_ERROR_NONE != error)
+            {
+                router->counters.errors++;
+                ready = false;
+            }
+            else if (CAVE_TALK_ID_NONE == id)
+            {
+                ready = false;
+            }
+            else
+            {
+                /* The payload is forwarded as is, only the header and CRC are rebuilt */
+                link->held[CAVE_TALK_VERSION_INDEX] = CAVE_TALK_VERSION;
+                link->held[CAVE_TALK_ID_INDEX]      = id;
+                link->held[CAVE_TALK_LENGTH_INDEX]  = length;
+                CaveTalk_CrcWrite(link->held, &link->held[CAVE_TALK_HEADER_SIZE], &link->held[CAVE_TALK_HEADER_SIZE + length]);
+
+                link->counters.frames_in++;
+                link->held_destinations = CaveTalk_RouterDestinations(router, source, id);
+
+                if (0U == link->held_destinations)
+                {
+                    router->counters.unrouted++;
+                }
+            }
+        }
+
+        if (!ready || (0U == link->held_destinations))
+        {
+        }
+        else if (CaveTalk_RouterEnqueue(router, link))
+        {
+            router->counters.routed++;
+        }
+        else
+        {
+            link->counters.stalls++;
+            ready = false;
+        }
+    }
+}
+
+static size_t CaveTalk_RouterEgress(CaveTalk_RouterLink_t *const link)
+{
+    size_t sent    = 0U;
+    bool   writing = true;
+
+    while (writing && (0U != link->queue_count))
+    {
+        const uint8_t *const frame = &link->queue[link->queue_head * CAVE_TALK_ROUTER_FRAME_SIZE_MAX];
+
+        /* A link that refuses a frame is full, the frame stays at the head of its queue for the next pass */
+        if (CAVE_TALK_ERROR_NONE == link->link_handle.send(frame, CaveTalk_RouterFrameSize(frame)))
+        {
+            link->queue_head = (link->queue_head + 1U) % link->queue_slots;
+            link->queue_count--;
+            link->counters.frames_out++;
+            sent++;
+        }
+        else
+        {
+            link->counters.stalls++;
+            writing = false;
+        }
+    }
+
+    return sent;
+}
+
+/* All or nothing, so every destination sees frames in the order they arrived */
+static bool CaveTalk_RouterEnqueue(CaveTalk_Router_t *const router, CaveTalk_RouterLink_t *const source)
+{
+    bool room = true;
+
+    for (size_t index = 0U; room && (index < router->link_count); index++)
+    {
+        if ((0U != (source->held_destinations & ((uint32_t)1U << index))) &&
+            (router->links[index].queue_count == router->links[index].queue_slots))
+        {
+            room = false;
+        }
+    }
+
+    for (size_t index = 0U; room && (index < router->link_count); index++)
+    {
+        CaveTalk_RouterLink_t *const destination = &router->links[index];
+
+        if (0U != (source->held_destinations & ((uint32_t)1U << index)))
+        {
+            const size_t slot = (destination->queue_head + destination->queue_count) % destination->queue_slots;
+
+            memcpy(&destination->queue[slot * CAVE_TALK_ROUTER_FRAME_SIZE_MAX], source->held, CaveTalk_RouterFrameSize(source->held));
+            destination->queue_count++;
+        }
+    }
+
+    if (room)
+    {
+        source->held_destinations = 0U;
+    }
+
+    return room;
+}
+
+static inline size_t CaveTalk_RouterFrameSize(const uint8_t *const frame)
+{
+    return CAVE_TALK_HEADER_SIZE + frame[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE;
+}
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "cave_talk_timer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_TIMER_WHEEL_MASK ((uint64_t)CAVE_TALK_TIMER_WHEEL_SLOTS - 1U)
+#define CAVE_TALK_TIMER_WHEEL_SPAN ((uint64_t)1U << (CAVE_TALK_TIMER_WHEEL_BITS * CAVE_TALK_TIMER_WHEEL_LEVELS))
+
+static void CaveTalk_TimerLink(CaveTalk_Timer_t **const slot, CaveTalk_Timer_t *const timer);
+static void CaveTalk_TimerUnlink(CaveTalk_Timer_t *const timer);
+static void CaveTalk_TimerWheelInsert(CaveTalk_TimerWheel_t *const wheel, CaveTalk_Timer_t *const timer);
+static void CaveTalk_TimerWheelCascade(CaveTalk_TimerWheel_t *const wheel, const size_t level, const size_t slot);
+
+CaveTalk_Error_t CaveTalk_TimerWheelInit(CaveTalk_TimerWheel_t *const wheel, const CaveTalk_Clock_t clock, const CaveTalk_Microseconds_t tick)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == wheel) || (NULL == clock))
+    {
+    }
+    else if (0U == tick)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        wheel->clock  = clock;
+        wheel->tick   = tick;
+        wheel->next   = clock() / tick;
+        wheel->active = 0U;
+
+        for (size_t level = 0U; level < CAVE_TALK_TIMER_WHEEL_LEVELS; level++)
+        {
+            for (size_t slot = 0U; slot < CAVE_TALK_TIMER_WHEEL_SLOTS; slot++)
+            {
+                wheel->slots[level][slot] = NULL;
+            }
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_TimerInit(CaveTalk_Timer_t *const timer, const CaveTalk_TimerCallback_t callback, void *const context)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == timer) || (NULL == callback))
+    {
+    }
+    else
+    {
+        timer->next     = NULL;
+        timer->previous = NULL;
+        timer->expiry   = 0U;
+        timer->callback = callback;
+        timer->context  = context;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_TimerStart(CaveTalk_TimerWheel_t *const wheel, CaveTalk_Timer_t *const timer, const CaveTalk_Microseconds_t timeout)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == wheel) || (NULL == wheel->clock) || (NULL == timer) || (NULL == timer->callback))
+    {
+    }
+    else
+    {
+        const CaveTalk_Microseconds_t now = wheel->clock();
+        const CaveTalk_Microseconds_t due = (timeout > (UINT64_MAX - now - wheel->tick)) ? (UINT64_MAX - wheel->tick) : (now + timeout);
+
+        /* Starting a pending timer restarts it */
+        if (CaveTalk_TimerPending(timer))
+        {
+            CaveTalk_TimerUnlink(timer);
+            wheel->active--;
+        }
+
+        /* An empty wheel is only caught up when next advanced, so after idle time it is brought to the current tick
+         * before placing the timer rather than have the next advance step through every idle tick */
+        if ((0U == wheel->active) && ((now / wheel->tick) > wheel->next))
+        {
+            wheel->next = now / wheel->tick;
+        }
+
+        timer->expiry = (due + wheel->tick - 1U) / wheel->tick;
+        CaveTalk_TimerWheelInsert(wheel, timer);
+        wheel->active++;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_TimerCancel(CaveTalk_TimerWheel_t *const wheel, CaveTalk_Timer_t *const timer)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == wheel) || (NULL == timer))
+    {
+    }
+    else
+    {
+        if (CaveTalk_TimerPending(timer))
+        {
+            CaveTalk_TimerUnlink(timer);
+            wheel->active--;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+bool CaveTalk_TimerPending(const CaveTalk_Timer_t *const timer)
+{
+    return (NULL != timer) && (NULL != timer->previous);
+}
+
+CaveTalk_Error_t CaveTalk_TimerWheelAdvance(CaveTalk_TimerWheel_t *const wheel, size_t *const fired)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == wheel) || (NULL == wheel->clock) || (NULL == fired))
+    {
+    }
+    else
+    {
+        const uint64_t target = wheel->clock() / wheel->tick;
+
+        *fired = 0U;
+
+        while (wheel->next <= target)
+        {
+            const size_t      index   = (size_t)(wheel->next & CAVE_TALK_TIMER_WHEEL_MASK);
+            CaveTalk_Timer_t *expired = NULL;
+
+            /* An empty wheel has nothing to move down or fire, so idle time is skipped in one step */
+            if (0U == wheel->active)
+            {
+                wheel->next = target + 1U;
+            }
+            else
+            {
+                if (0U == index)
+                {
+                    size_t level = 1U;
+                    size_t slot  = 0U;
+
+                    do
+                    {
+                        slot = (size_t)((wheel->next >> (CAVE_TALK_TIMER_WHEEL_BITS * level)) & CAVE_TALK_TIMER_WHEEL_MASK);
+                        CaveTalk_TimerWheelCascade(wheel, level, slot);
+                        level++;
+                    } while ((level < CAVE_TALK_TIMER_WHEEL_LEVELS) && (0U == slot));
+                }
+
+                /* The slot is taken off the wheel before its callbacks run, so timers they start land in later ticks
+                 * and timers they cancel are unlinked from the taken list */
+                expired                 = wheel->slots[0U][index];
+                wheel->slots[0U][index] = NULL;
+                wheel->next++;
+
+                if (NULL != expired)
+                {
+                    expired->previous = &expired;
+                }
+
+                while (NULL != expired)
+                {
+                    CaveTalk_Timer_t *const timer = expired;
+
+                    CaveTalk_TimerUnlink(timer);
+                    wheel->active--;
+                    (*fired)++;
+
+                    timer->callback(timer->context);
+                }
+            }
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+static void CaveTalk_TimerLink(CaveTalk_Timer_t **const slot, CaveTalk_Timer_t *const timer)
+{
+    timer->next     = *slot;
+    timer->previous = slot;
+
+    if (NULL != timer->next)
+    {
+        timer->next->previous = &timer->next;
+    }
+
+    *slot = timer;
+}
+
+static void CaveTalk_TimerUnlink(CaveTalk_Timer_t *const timer)
+{
+    *timer->previous = timer->next;
+
+    if (NULL != timer->next)
+    {
+        timer->next->previous = timer->previous;
+    }
+
+    timer->next     = NULL;
+    timer->previous = NULL;
+}
+
+/* Places a timer by how far its expiry is from the next tick, in the lowest level whose span reaches it. Timers
+ * beyond the whole wheel wait in the last slot it reaches and are placed again each time that slot moves down. */
+static void CaveTalk_TimerWheelInsert(CaveTalk_TimerWheel_t *const wheel, CaveTalk_Timer_t *const timer)
+{
+    uint64_t expiry = (timer->expiry > wheel->next) ? timer->expiry : wheel->next;
+    size_t   level  = 0U;
+
+    if ((expiry - wheel->next) >= CAVE_TALK_TIMER_WHEEL_SPAN)
+    {
+        expiry = wheel->next + CAVE_TALK_TIMER_WHEEL_SPAN - 1U;
+    }
+
+    while ((expiry - wheel->next) >= ((uint64_t)1U << (CAVE_TALK_TIMER_WHEEL_BITS * (level + 1U))))
+    {
+        level++;
+    }
+
+    CaveTalk_TimerLink(&wheel->slots[level][(expiry >> (CAVE_TALK_TIMER_WHEEL_BITS * level)) & CAVE_TALK_TIMER_WHEEL_MASK], timer);
+}
+
+static void CaveTalk_TimerWheelCascade(CaveTalk_TimerWheel_t *const wheel, const size_t level, const size_t slot)
+{
+    CaveTalk_Timer_t *moving = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+
+    if (NULL != moving)
+    {
+        moving->previous = &moving;
+    }
+
+    while (NULL != moving)
+    {
+        CaveTalk_Timer_t *const timer = moving;
+
+        CaveTalk_TimerUnlink(timer);
+        CaveTalk_TimerWheelInsert(wheel, timer);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "cave_talk_trace.h"
+
+#include <stddef.h>
+
+#include "cave_talk_types.h"
+
+static CaveTalk_TraceHook_t trace_hook = NULL;
+
+void CaveTalk_TraceSetHook(const CaveTalk_TraceHook_t hook)
+{
+    trace_hook = hook;
+}
+
+void CaveTalk_Trace(const CaveTalk_TraceProbe_t probe, const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    if (NULL != trace_hook)
+    {
+        trace_hook(probe, id, length);
+    }
+}
\ No newline at end of file
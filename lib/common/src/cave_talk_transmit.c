@@ -0,0 +1,194 @@
+#include "cave_talk_transmit.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+static CaveTalk_Error_t CaveTalk_TransmitterSend(void *const context, const void *const data, const size_t size);
+static bool CaveTalk_TransmitterComplete(const CaveTalk_Transmitter_t *const transmitter);
+
+CaveTalk_Error_t CaveTalk_TransmitterOpen(CaveTalk_Transmitter_t *const transmitter,
+                                          const CaveTalk_LinkWrite_t write,
+                                          void *const context,
+                                          CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == transmitter) || (NULL == write) || (NULL == link_handle))
+    {
+    }
+    else
+    {
+        CaveTalk_LinkBinding_t binding;
+
+        transmitter->write   = write;
+        transmitter->context = context;
+        transmitter->length  = 0U;
+        transmitter->written = 0U;
+        memset(&transmitter->stats, 0, sizeof(transmitter->stats));
+
+        binding.context   = transmitter;
+        binding.send      = CaveTalk_TransmitterSend;
+        binding.receive   = NULL;
+        binding.available = NULL;
+
+        error = CaveTalk_LinkBind(&binding, &transmitter->link_handle);
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *link_handle = transmitter->link_handle;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_TransmitterResume(CaveTalk_Transmitter_t *const transmitter)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == transmitter)
+    {
+    }
+    else
+    {
+        bool writing = CaveTalk_TransmitterComplete(transmitter);
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        while (writing)
+        {
+            const size_t remaining     = transmitter->length - transmitter->written;
+            size_t       bytes_written = 0U;
+
+            error = transmitter->write(transmitter->context, transmitter->frame + transmitter->written, remaining, &bytes_written);
+            transmitter->stats.writes++;
+
+            if (CAVE_TALK_ERROR_NONE != error)
+            {
+                writing = false;
+            }
+            else if (bytes_written == remaining)
+            {
+                transmitter->length  = 0U;
+                transmitter->written = 0U;
+                transmitter->stats.frames++;
+                writing = false;
+            }
+            else if (0U == bytes_written)
+            {
+                /* The link is full, the rest waits for the next resume */
+                writing = false;
+            }
+            else
+            {
+                transmitter->written += bytes_written;
+                transmitter->stats.partial_writes++;
+            }
+        }
+    }
+
+    return error;
+}
+
+size_t CaveTalk_TransmitterPending(const CaveTalk_Transmitter_t *const transmitter)
+{
+    size_t pending = 0U;
+
+    if ((NULL != transmitter) && CaveTalk_TransmitterComplete(transmitter))
+    {
+        pending = transmitter->length - transmitter->written;
+    }
+
+    return pending;
+}
+
+CaveTalk_Error_t CaveTalk_TransmitterClose(CaveTalk_Transmitter_t *const transmitter)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == transmitter)
+    {
+    }
+    else
+    {
+        error = CaveTalk_LinkUnbind(&transmitter->link_handle);
+
+        transmitter->length  = 0U;
+        transmitter->written = 0U;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_TransmitterSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Transmitter_t *const transmitter = (CaveTalk_Transmitter_t *)context;
+    CaveTalk_Error_t              error       = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) && (0U != size))
+    {
+        /* The frame being gathered is abandoned rather than left for the next one to land behind */
+        if (!CaveTalk_TransmitterComplete(transmitter))
+        {
+            transmitter->length = 0U;
+        }
+    }
+    else
+    {
+        /* Speak sends the header first, so a frame that cannot be taken is refused before any of it is */
+        error = CaveTalk_TransmitterResume(transmitter);
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+        }
+        else if (CaveTalk_TransmitterComplete(transmitter))
+        {
+            transmitter->stats.busy++;
+            error = CAVE_TALK_ERROR_BUSY;
+        }
+        else if ((transmitter->length + size) > sizeof(transmitter->frame))
+        {
+            transmitter->length = 0U;
+            error               = CAVE_TALK_ERROR_SIZE;
+        }
+        else
+        {
+            if (0U != size)
+            {
+                memcpy(transmitter->frame + transmitter->length, data, size);
+                transmitter->length += size;
+            }
+
+            /* The whole frame is in, whatever the link does not take now is pending, not lost */
+            error = CaveTalk_TransmitterResume(transmitter);
+
+            if ((CAVE_TALK_ERROR_NONE == error) || !CaveTalk_TransmitterComplete(transmitter))
+            {
+            }
+            else if (0U == transmitter->written)
+            {
+                /* None of it reached the link, so the frame is refused and speaking it again sends it once */
+                transmitter->length = 0U;
+            }
+            else
+            {
+                /* Part of it is on the wire, so it stays queued and the error is reported by the next resume */
+                error = CAVE_TALK_ERROR_NONE;
+            }
+        }
+    }
+
+    return error;
+}
+
+static bool CaveTalk_TransmitterComplete(const CaveTalk_Transmitter_t *const transmitter)
+{
+    return (transmitter->length >= CAVE_TALK_HEADER_SIZE) &&
+           (transmitter->length >= (CAVE_TALK_HEADER_SIZE + transmitter->frame[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE));
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "cave_talk_varint.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_VARINT_CONTINUE 0x80U
+#define CAVE_TALK_VARINT_MASK     0x7FU
+#define CAVE_TALK_VARINT_SHIFT    7U
+
+size_t CaveTalk_VarintSize(const uint32_t value)
+{
+    size_t   size      = 1U;
+    uint32_t remaining = value >> CAVE_TALK_VARINT_SHIFT;
+
+    while (0U != remaining)
+    {
+        remaining >>= CAVE_TALK_VARINT_SHIFT;
+        size++;
+    }
+
+    return size;
+}
+
+CaveTalk_Error_t CaveTalk_VarintEncode(const uint32_t value, uint8_t *const bytes, const size_t size, size_t *const written)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == bytes) || (NULL == written))
+    {
+    }
+    else if (size < CaveTalk_VarintSize(value))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        uint32_t remaining = value;
+        size_t   index     = 0U;
+
+        while (remaining > CAVE_TALK_VARINT_MASK)
+        {
+            bytes[index++]   = (uint8_t)((remaining & CAVE_TALK_VARINT_MASK) | CAVE_TALK_VARINT_CONTINUE);
+            remaining      >>= CAVE_TALK_VARINT_SHIFT;
+        }
+        bytes[index++] = (uint8_t)remaining;
+
+        *written = index;
+        error    = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_VarintDecode(const uint8_t *const bytes, const size_t size, uint32_t *const value, size_t *const read)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == bytes) || (NULL == value) || (NULL == read))
+    {
+    }
+    else
+    {
+        uint32_t decoded = 0U;
+        size_t   index   = 0U;
+
+        error = CAVE_TALK_ERROR_INCOMPLETE;
+
+        while ((index < size) && (index < CAVE_TALK_VARINT_SIZE_MAX) && (CAVE_TALK_ERROR_INCOMPLETE == error))
+        {
+            const uint8_t byte = bytes[index];
+
+            decoded |= (uint32_t)(byte & CAVE_TALK_VARINT_MASK) << (index * CAVE_TALK_VARINT_SHIFT);
+            index++;
+
+            if (0U == (byte & CAVE_TALK_VARINT_CONTINUE))
+            {
+                error = CAVE_TALK_ERROR_NONE;
+            }
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *value = decoded;
+            *read  = index;
+        }
+        else if (index >= CAVE_TALK_VARINT_SIZE_MAX)
+        {
+            /* Longer than any uint32_t */
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else
+        {
+        }
+    }
+
+    return error;
+}
\ No newline at end of file
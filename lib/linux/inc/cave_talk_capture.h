@@ -0,0 +1,116 @@
+#ifndef CAVE_TALK_CAPTURE_H
+#define CAVE_TALK_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_CAPTURE_BLOCK_SIZE_DEFAULT 65536U
+#define CAVE_TALK_CAPTURE_BLOCK_SIZE_MIN     256U
+#define CAVE_TALK_CAPTURE_FRAME_SIZE_MAX     (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+
+typedef enum
+{
+    CAVE_TALK_CAPTURE_DIRECTION_TX,
+    CAVE_TALK_CAPTURE_DIRECTION_RX
+} CaveTalk_CaptureDirection_t;
+
+typedef struct
+{
+    CaveTalk_Microseconds_t timestamp;
+    CaveTalk_CaptureDirection_t direction;
+    const uint8_t *data;
+    size_t length;
+} CaveTalk_CaptureRecord_t;
+
+typedef struct
+{
+    uint64_t block;
+    size_t offset;
+} CaveTalk_CaptureCursor_t;
+
+/* Bytes of a frame passing through the recording link, recorded together once the frame is whole */
+typedef struct
+{
+    uint8_t bytes[CAVE_TALK_CAPTURE_FRAME_SIZE_MAX];
+    size_t length;
+} CaveTalk_CaptureFrame_t;
+
+typedef struct
+{
+    CaveTalk_LinkHandle_t link_handle;
+    CaveTalk_LinkHandle_t recording_link_handle;
+    CaveTalk_Clock_t clock;
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    size_t block_size;
+    uint64_t block_count;
+    CaveTalk_CaptureFrame_t tx_frame;
+    CaveTalk_CaptureFrame_t rx_frame;
+} CaveTalk_Capture_t;
+
+typedef struct
+{
+    int fd;
+    const uint8_t *map;
+    size_t map_size;
+    size_t block_size;
+    uint64_t block_count;
+} CaveTalk_CaptureReader_t;
+
+typedef struct
+{
+    CaveTalk_CaptureReader_t reader;
+    CaveTalk_CaptureCursor_t cursor;
+    CaveTalk_CaptureDirection_t direction;
+    CaveTalk_Clock_t clock;
+    CaveTalk_Microseconds_t clock_start;
+    CaveTalk_Microseconds_t capture_start;
+    CaveTalk_CaptureRecord_t record;
+    size_t record_offset;
+    CaveTalk_LinkHandle_t link_handle;
+} CaveTalk_Replay_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_CaptureOpen(CaveTalk_Capture_t *const capture,
+                                      const char *const path,
+                                      const size_t block_size,
+                                      const CaveTalk_LinkHandle_t *const link_handle,
+                                      const CaveTalk_Clock_t clock,
+                                      CaveTalk_LinkHandle_t *const recording_link_handle);
+CaveTalk_Error_t CaveTalk_CaptureAppend(CaveTalk_Capture_t *const capture,
+                                        const CaveTalk_CaptureDirection_t direction,
+                                        const CaveTalk_Microseconds_t timestamp,
+                                        const void *const data,
+                                        const size_t length);
+CaveTalk_Error_t CaveTalk_CaptureClose(CaveTalk_Capture_t *const capture);
+
+CaveTalk_Error_t CaveTalk_CaptureReaderOpen(CaveTalk_CaptureReader_t *const reader, const char *const path);
+CaveTalk_Error_t CaveTalk_CaptureReaderClose(CaveTalk_CaptureReader_t *const reader);
+CaveTalk_Error_t CaveTalk_CaptureSeek(const CaveTalk_CaptureReader_t *const reader,
+                                      const CaveTalk_Microseconds_t timestamp,
+                                      CaveTalk_CaptureCursor_t *const cursor);
+bool CaveTalk_CaptureNext(const CaveTalk_CaptureReader_t *const reader, CaveTalk_CaptureCursor_t *const cursor, CaveTalk_CaptureRecord_t *const record);
+
+CaveTalk_Error_t CaveTalk_ReplayOpen(CaveTalk_Replay_t *const replay,
+                                     const char *const path,
+                                     const CaveTalk_CaptureDirection_t direction,
+                                     const CaveTalk_Clock_t clock,
+                                     CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_ReplaySeek(CaveTalk_Replay_t *const replay, const CaveTalk_Microseconds_t timestamp);
+bool CaveTalk_ReplayDone(CaveTalk_Replay_t *const replay);
+CaveTalk_Error_t CaveTalk_ReplayClose(CaveTalk_Replay_t *const replay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_CAPTURE_H */
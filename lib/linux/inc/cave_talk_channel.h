@@ -0,0 +1,89 @@
+#ifndef CAVE_TALK_CHANNEL_H
+#define CAVE_TALK_CHANNEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_CHANNEL_NAME_SIZE_MAX 64U /* Including the leading '/' and the terminator, see shm_open */
+
+/* A decoded message as the Listener heard it, id is one of the message ids in ids.proto */
+typedef struct
+{
+    CaveTalk_Microseconds_t timestamp;
+    uint64_t sequence;
+    CaveTalk_Id_t id;
+    union
+    {
+        struct
+        {
+            CaveTalk_MetersPerSecond_t speed;
+            CaveTalk_RadiansPerSecond_t turn_rate;
+        } movement;
+        struct
+        {
+            CaveTalk_Radian_t pan;
+            CaveTalk_Radian_t tilt;
+        } camera_movement;
+        struct
+        {
+            bool headlights;
+        } lights;
+        struct
+        {
+            bool manual;
+        } mode;
+    } message;
+} CaveTalk_ChannelRecord_t;
+
+/* Publishing side of a ring of decoded messages in shared memory, with a single writer that never waits for readers.
+ * A channel without a name is private to the process and its children. */
+typedef struct
+{
+    char name[CAVE_TALK_CHANNEL_NAME_SIZE_MAX];
+    void *map;
+    size_t map_size;
+    size_t slot_count;
+    CaveTalk_Clock_t clock;
+} CaveTalk_Channel_t;
+
+/* Each reader keeps its own cursor, so readers never contend with each other or with the writer. A reader that falls a
+ * whole ring behind skips to the oldest record still held and counts what it missed in overruns. */
+typedef struct
+{
+    const void *map;
+    size_t map_size;
+    size_t slot_count;
+    bool mapped;
+    uint64_t cursor;
+    uint64_t overruns;
+} CaveTalk_ChannelReader_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_ChannelOpen(CaveTalk_Channel_t *const channel, const char *const name, const size_t slot_count, const CaveTalk_Clock_t clock);
+CaveTalk_Error_t CaveTalk_ChannelClose(CaveTalk_Channel_t *const channel);
+CaveTalk_Error_t CaveTalk_ChannelPublish(CaveTalk_Channel_t *const channel, const CaveTalk_ChannelRecord_t *const record);
+CaveTalk_Error_t CaveTalk_ChannelPublishMovement(CaveTalk_Channel_t *const channel,
+                                                 const CaveTalk_MetersPerSecond_t speed,
+                                                 const CaveTalk_RadiansPerSecond_t turn_rate);
+CaveTalk_Error_t CaveTalk_ChannelPublishCameraMovement(CaveTalk_Channel_t *const channel, const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt);
+CaveTalk_Error_t CaveTalk_ChannelPublishLights(CaveTalk_Channel_t *const channel, const bool headlights);
+CaveTalk_Error_t CaveTalk_ChannelPublishMode(CaveTalk_Channel_t *const channel, const bool manual);
+CaveTalk_Error_t CaveTalk_ChannelReaderOpen(CaveTalk_ChannelReader_t *const reader, const char *const name);
+CaveTalk_Error_t CaveTalk_ChannelReaderAttach(CaveTalk_ChannelReader_t *const reader, const CaveTalk_Channel_t *const channel);
+CaveTalk_Error_t CaveTalk_ChannelReaderClose(CaveTalk_ChannelReader_t *const reader);
+CaveTalk_Error_t CaveTalk_ChannelRead(CaveTalk_ChannelReader_t *const reader, CaveTalk_ChannelRecord_t *const record);
+CaveTalk_Error_t CaveTalk_ChannelReadLatest(CaveTalk_ChannelReader_t *const reader, CaveTalk_ChannelRecord_t *const record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_CHANNEL_H */
\ No newline at end of file
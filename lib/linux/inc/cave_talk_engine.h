@@ -0,0 +1,83 @@
+#ifndef CAVE_TALK_ENGINE_H
+#define CAVE_TALK_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_ENGINE_SHARD_COUNT_MAX  64U
+#define CAVE_TALK_ENGINE_FRAME_SIZE_MAX   (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+#define CAVE_TALK_ENGINE_OUTPUT_SIZE      4096U /* Bytes queued per link while its socket is full, frames past it are dropped */
+#define CAVE_TALK_ENGINE_LINK_BITS        20U   /* Low bits of a link id, its engine wide index, the rest its generation */
+#define CAVE_TALK_ENGINE_LINK_COUNT_MAX   (1UL << CAVE_TALK_ENGINE_LINK_BITS)
+#define CAVE_TALK_ENGINE_LINK_INDEX(link) ((uint32_t)(link) & (uint32_t)(CAVE_TALK_ENGINE_LINK_COUNT_MAX - 1U))
+
+typedef struct CaveTalk_Engine CaveTalk_Engine_t;
+
+/* Called on the shard's thread for every frame heard on one of its links, link is the id returned when the link was
+ * attached */
+typedef void (*CaveTalk_EngineHandler_t)(void *const context,
+                                         CaveTalk_Engine_t *const engine,
+                                         const size_t shard,
+                                         const uint32_t link,
+                                         const CaveTalk_Id_t id,
+                                         const uint8_t *const payload,
+                                         const CaveTalk_Length_t length);
+
+typedef struct
+{
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t handed_off;
+    uint64_t dropped;
+    uint32_t links;
+} CaveTalk_EngineCounters_t;
+
+/* Links are file descriptors of stream sockets, pipes or serial ports spread over shards, each a thread with its own
+ * epoll reactor, frame parsers and buffers, optionally pinned to a core. Everything a shard touches while running is
+ * its own; a frame sent to a link of another shard is handed off through a lock free single producer ring for that
+ * pair of shards and the other shard woken through its eventfd. Attached descriptors belong to the engine, which closes
+ * them when the peer hangs up or the engine closes. Sends are only made from a handler, passing the shard it was
+ * called on. A link id carries the generation of its slot, counted up each time the slot is attached, so frames sent to
+ * a link that has since closed are dropped rather than written to whatever descriptor was attached in its place. */
+struct CaveTalk_Engine
+{
+    void *map;
+    size_t map_size;
+    size_t shard_count;
+    size_t links_per_shard;
+    size_t handoff_slots;
+    CaveTalk_EngineHandler_t handler;
+    void *context;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_EngineOpen(CaveTalk_Engine_t *const engine,
+                                     const size_t shard_count,
+                                     const size_t links_per_shard,
+                                     const size_t handoff_slots,
+                                     const bool pin,
+                                     const CaveTalk_EngineHandler_t handler,
+                                     void *const context);
+CaveTalk_Error_t CaveTalk_EngineClose(CaveTalk_Engine_t *const engine);
+CaveTalk_Error_t CaveTalk_EngineAttach(CaveTalk_Engine_t *const engine, const int fd, uint32_t *const link);
+CaveTalk_Error_t CaveTalk_EngineSend(CaveTalk_Engine_t *const engine,
+                                     const size_t shard,
+                                     const uint32_t link,
+                                     const CaveTalk_Id_t id,
+                                     const void *const data,
+                                     const CaveTalk_Length_t length);
+CaveTalk_Error_t CaveTalk_EngineCounters(const CaveTalk_Engine_t *const engine, const size_t shard, CaveTalk_EngineCounters_t *const counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_ENGINE_H */
\ No newline at end of file
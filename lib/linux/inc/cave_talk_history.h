@@ -0,0 +1,81 @@
+#ifndef CAVE_TALK_HISTORY_H
+#define CAVE_TALK_HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_channel.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_HISTORY_FIELDS_MAX 2U /* Movement and CameraMovement, Lights and Mode have one */
+
+/* Telemetry received from the Listener, kept per message id as column arrays of timestamps and fields in a ring of
+ * fixed size chunks. Memory is fixed when the history is opened: once every chunk of an id is in use the oldest is
+ * dropped, as is any chunk whose newest row is older than max_age (0 keeps chunks until their space is needed).
+ * Booleans are stored as 0 and 1, so a downsampled mean is the fraction of the window they were set. A history with a
+ * path is a file mapped into memory and picks up where it left off when opened again with the same chunk sizes.
+ * Timestamps must not go backwards within an id. */
+typedef struct
+{
+    void *map;
+    size_t map_size;
+    size_t chunk_rows;
+    size_t chunk_count;
+    CaveTalk_Microseconds_t max_age;
+    CaveTalk_Clock_t clock;
+} CaveTalk_History_t;
+
+/* Rows of one id in [start, start + window), fields past the id's field count are left zero */
+typedef struct
+{
+    CaveTalk_Microseconds_t start;
+    uint32_t count;
+    double mean[CAVE_TALK_HISTORY_FIELDS_MAX];
+    double min[CAVE_TALK_HISTORY_FIELDS_MAX];
+    double max[CAVE_TALK_HISTORY_FIELDS_MAX];
+} CaveTalk_HistoryWindow_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_HistoryOpen(CaveTalk_History_t *const history,
+                                      const char *const path,
+                                      const size_t chunk_rows,
+                                      const size_t chunk_count,
+                                      const CaveTalk_Microseconds_t max_age,
+                                      const CaveTalk_Clock_t clock);
+CaveTalk_Error_t CaveTalk_HistoryClose(CaveTalk_History_t *const history);
+CaveTalk_Error_t CaveTalk_HistoryAppend(CaveTalk_History_t *const history, const CaveTalk_ChannelRecord_t *const record);
+CaveTalk_Error_t CaveTalk_HistoryRecordMovement(CaveTalk_History_t *const history,
+                                                const CaveTalk_MetersPerSecond_t speed,
+                                                const CaveTalk_RadiansPerSecond_t turn_rate);
+CaveTalk_Error_t CaveTalk_HistoryRecordCameraMovement(CaveTalk_History_t *const history, const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt);
+CaveTalk_Error_t CaveTalk_HistoryRecordLights(CaveTalk_History_t *const history, const bool headlights);
+CaveTalk_Error_t CaveTalk_HistoryRecordMode(CaveTalk_History_t *const history, const bool manual);
+CaveTalk_Error_t CaveTalk_HistoryRows(const CaveTalk_History_t *const history, const CaveTalk_Id_t id, size_t *const rows);
+CaveTalk_Error_t CaveTalk_HistoryRange(const CaveTalk_History_t *const history,
+                                       const CaveTalk_Id_t id,
+                                       const CaveTalk_Microseconds_t begin,
+                                       const CaveTalk_Microseconds_t end,
+                                       CaveTalk_Microseconds_t *const timestamps,
+                                       double *const first,
+                                       double *const second,
+                                       const size_t capacity,
+                                       size_t *const count);
+CaveTalk_Error_t CaveTalk_HistoryDownsample(const CaveTalk_History_t *const history,
+                                            const CaveTalk_Id_t id,
+                                            const CaveTalk_Microseconds_t begin,
+                                            const CaveTalk_Microseconds_t end,
+                                            const CaveTalk_Microseconds_t window,
+                                            CaveTalk_HistoryWindow_t *const windows,
+                                            const size_t capacity,
+                                            size_t *const count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_HISTORY_H */
\ No newline at end of file
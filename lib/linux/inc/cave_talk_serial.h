@@ -0,0 +1,78 @@
+#ifndef CAVE_TALK_SERIAL_H
+#define CAVE_TALK_SERIAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <termios.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_SERIAL_FRAME_SIZE_MAX    (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+#define CAVE_TALK_SERIAL_BUFFER_SIZE_MIN   (2U * CAVE_TALK_SERIAL_FRAME_SIZE_MAX)
+#define CAVE_TALK_SERIAL_BAUD_RATE_DEFAULT 115200U
+
+/* With vmin and vtime both zero reads never block. Otherwise reads block with the usual termios semantics, e.g. vmin 0
+ * and vtime 1 waits up to 100 ms for the first byte. */
+typedef struct
+{
+    uint32_t baud_rate;
+    uint8_t vmin;
+    uint8_t vtime;
+    bool low_latency;
+} CaveTalk_SerialConfig_t;
+
+typedef struct
+{
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+} CaveTalk_SerialStats_t;
+
+typedef struct
+{
+    int fd;
+    struct termios attributes;
+    uint8_t *rx_buffers[2];
+    size_t rx_buffer_size;
+    size_t rx_lengths[2];
+    size_t rx_head;
+    uint8_t rx_consume;
+    size_t rx_frame_offset;
+    size_t rx_frame_size;
+    uint8_t tx_buffer[CAVE_TALK_SERIAL_FRAME_SIZE_MAX];
+    size_t tx_length;
+    CaveTalk_SerialStats_t stats;
+    CaveTalk_LinkHandle_t link_handle;
+} CaveTalk_Serial_t;
+
+static const CaveTalk_SerialConfig_t kCaveTalk_SerialConfigDefault = {
+    .baud_rate   = CAVE_TALK_SERIAL_BAUD_RATE_DEFAULT,
+    .vmin        = 0U,
+    .vtime       = 0U,
+    .low_latency = true,
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+CaveTalk_Error_t CaveTalk_SerialOpen(CaveTalk_Serial_t *const serial,
+                                     const char *const path,
+                                     const CaveTalk_SerialConfig_t *const config,
+                                     void *const buffer,
+                                     const size_t buffer_size,
+                                     CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_SerialFlush(CaveTalk_Serial_t *const serial);
+CaveTalk_Error_t CaveTalk_SerialWait(void *const serial, const CaveTalk_Microseconds_t timeout);
+CaveTalk_Error_t CaveTalk_SerialTryWrite(void *const serial, const void *const data, const size_t size, size_t *const bytes_written);
+CaveTalk_Error_t CaveTalk_SerialClose(CaveTalk_Serial_t *const serial);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_SERIAL_H */
\ No newline at end of file
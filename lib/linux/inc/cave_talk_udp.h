@@ -0,0 +1,73 @@
+#ifndef CAVE_TALK_UDP_H
+#define CAVE_TALK_UDP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_UDP_DATAGRAM_SIZE_MAX (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+#define CAVE_TALK_UDP_BATCH_SIZE_MAX    16U
+
+typedef struct
+{
+    uint64_t send_calls;
+    uint64_t receive_calls;
+    uint64_t datagrams_sent;
+    uint64_t datagrams_received;
+    uint64_t datagrams_dropped;
+} CaveTalk_UdpStats_t;
+
+/* Each frame is one datagram so a lost datagram loses exactly one frame. Frames are queued until batch of them are
+ * pending and then sent with a single sendmmsg, received datagrams are taken in up to a full batch per recvmmsg. */
+typedef struct
+{
+    int fd;
+    struct sockaddr_storage peer_address;
+    socklen_t peer_address_length;
+    bool connected;
+    size_t batch;
+    uint8_t rx_datagrams[CAVE_TALK_UDP_BATCH_SIZE_MAX][CAVE_TALK_UDP_DATAGRAM_SIZE_MAX];
+    struct sockaddr_storage rx_addresses[CAVE_TALK_UDP_BATCH_SIZE_MAX];
+    struct iovec rx_iovecs[CAVE_TALK_UDP_BATCH_SIZE_MAX];
+    struct mmsghdr rx_messages[CAVE_TALK_UDP_BATCH_SIZE_MAX];
+    size_t rx_count;
+    size_t rx_next;
+    size_t rx_current;
+    size_t rx_offset;
+    size_t rx_length;
+    uint8_t tx_datagrams[CAVE_TALK_UDP_BATCH_SIZE_MAX][CAVE_TALK_UDP_DATAGRAM_SIZE_MAX];
+    size_t tx_lengths[CAVE_TALK_UDP_BATCH_SIZE_MAX];
+    struct iovec tx_iovecs[CAVE_TALK_UDP_BATCH_SIZE_MAX];
+    struct mmsghdr tx_messages[CAVE_TALK_UDP_BATCH_SIZE_MAX];
+    size_t tx_count;
+    CaveTalk_UdpStats_t stats;
+    CaveTalk_LinkHandle_t link_handle;
+} CaveTalk_Udp_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Without a peer address frames are sent to the source of the last valid datagram heard */
+CaveTalk_Error_t CaveTalk_UdpOpen(CaveTalk_Udp_t *const udp,
+                                  const struct sockaddr *const local_address,
+                                  const socklen_t local_address_length,
+                                  const struct sockaddr *const peer_address,
+                                  const socklen_t peer_address_length,
+                                  const size_t batch,
+                                  CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_UdpFlush(CaveTalk_Udp_t *const udp);
+CaveTalk_Error_t CaveTalk_UdpWait(void *const udp, const CaveTalk_Microseconds_t timeout);
+CaveTalk_Error_t CaveTalk_UdpClose(CaveTalk_Udp_t *const udp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_UDP_H */
\ No newline at end of file
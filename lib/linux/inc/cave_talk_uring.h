@@ -0,0 +1,100 @@
+#ifndef CAVE_TALK_URING_H
+#define CAVE_TALK_URING_H
+
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_URING_FRAME_SIZE_MAX  (CAVE_TALK_HEADER_SIZE + UINT8_MAX + CAVE_TALK_CRC_SIZE)
+#define CAVE_TALK_URING_BUFFER_COUNT    16U /* Provided receive buffers, a power of two */
+#define CAVE_TALK_URING_BUFFER_SIZE_MIN (CAVE_TALK_URING_BUFFER_COUNT * 64U)
+#define CAVE_TALK_URING_BATCH_SIZE_MAX  16U
+
+typedef struct
+{
+    uint64_t enters;
+    uint64_t submissions;
+    uint64_t completions;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+} CaveTalk_UringStats_t;
+
+/* Receives are a single multishot request that the kernel completes into buffers taken from a ring of provided
+ * buffers, so once armed, reading costs no system calls: completions are taken from shared memory and fed through a
+ * frame parser, and each buffer goes back to the ring as soon as it is parsed. Frames are coalesced into one of two
+ * send buffers, and once batch frames are queued the whole buffer goes out as one send while the next batch fills the
+ * other. */
+typedef struct
+{
+    int fd;
+    int ring_fd;
+    bool socket;
+    bool receiving;
+    bool closed;
+    void *rings;
+    size_t rings_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_array;
+    uint32_t sq_mask;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t cq_mask;
+    struct io_uring_cqe *cqes;
+    uint32_t pending_submissions;
+    struct io_uring_buf_ring *buffer_ring;
+    size_t buffer_ring_size;
+    uint8_t *buffers;
+    size_t buffer_size;
+    uint16_t buffer_tail;
+    uint16_t rx_ids[CAVE_TALK_URING_BUFFER_COUNT];
+    uint32_t rx_lengths[CAVE_TALK_URING_BUFFER_COUNT];
+    size_t rx_first;
+    size_t rx_count;
+    size_t rx_offset;
+    CaveTalk_FrameParser_t parser;
+    uint8_t rx_frame[CAVE_TALK_URING_FRAME_SIZE_MAX];
+    size_t rx_frame_size;
+    size_t rx_frame_offset;
+    size_t batch;
+    uint8_t tx_buffers[2][CAVE_TALK_URING_BATCH_SIZE_MAX * CAVE_TALK_URING_FRAME_SIZE_MAX];
+    size_t tx_lengths[2];
+    size_t tx_sent[2];
+    bool tx_in_flight[2];
+    uint8_t tx_fill;
+    size_t tx_frame_start;
+    size_t tx_frames;
+    CaveTalk_Error_t tx_error;
+    CaveTalk_UringStats_t stats;
+    CaveTalk_LinkHandle_t link_handle;
+} CaveTalk_Uring_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* The descriptor is a connected stream socket or a serial device already configured by the caller, who keeps it and
+ * closes it after CaveTalk_UringClose */
+CaveTalk_Error_t CaveTalk_UringOpen(CaveTalk_Uring_t *const uring,
+                                    const int fd,
+                                    const size_t batch,
+                                    void *const buffer,
+                                    const size_t buffer_size,
+                                    CaveTalk_LinkHandle_t *const link_handle);
+CaveTalk_Error_t CaveTalk_UringFlush(CaveTalk_Uring_t *const uring);
+CaveTalk_Error_t CaveTalk_UringWait(void *const uring, const CaveTalk_Microseconds_t timeout);
+CaveTalk_Error_t CaveTalk_UringClose(CaveTalk_Uring_t *const uring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAVE_TALK_URING_H */
\ No newline at end of file
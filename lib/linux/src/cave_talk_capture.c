@@ -0,0 +1,780 @@
+#include "cave_talk_capture.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_CAPTURE_VERSION        1U
+#define CAVE_TALK_CAPTURE_MAGIC          "CVTKCAP"
+#define CAVE_TALK_CAPTURE_GROWTH_BLOCKS  64U
+#define CAVE_TALK_CAPTURE_ALIGNMENT      8U
+#define CAVE_TALK_REPLAY_LOOKAHEAD_BYTES 4096U
+
+/* Block 0 holds the file header, data blocks follow. Every data block starts with a block header so the first
+ * timestamp of any block is at a fixed offset, making the block headers a time index that can be binary searched. */
+typedef struct
+{
+    uint8_t magic[8];
+    uint32_t version;
+    uint32_t block_size;
+    uint64_t block_count;
+} CaveTalk_CaptureHeader_t;
+
+typedef struct
+{
+    uint64_t first_timestamp;
+    uint64_t last_timestamp;
+    uint32_t used;
+    uint32_t record_count;
+} CaveTalk_CaptureBlockHeader_t;
+
+typedef struct
+{
+    uint64_t timestamp;
+    uint32_t length;
+    uint8_t direction;
+    uint8_t reserved[3];
+} CaveTalk_CaptureRecordHeader_t;
+
+static CaveTalk_Error_t CaveTalk_CaptureSend(void *const context, const void *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_CaptureReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_CaptureAvailable(void *const context, size_t *const bytes_available);
+static CaveTalk_Error_t CaveTalk_CaptureFrame(CaveTalk_Capture_t *const capture,
+                                              const CaveTalk_CaptureDirection_t direction,
+                                              const void *const data,
+                                              const size_t size);
+static CaveTalk_Error_t CaveTalk_CaptureReserve(CaveTalk_Capture_t *const capture, const uint64_t block_count);
+static CaveTalk_Error_t CaveTalk_ReplayReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_ReplayAvailable(void *const context, size_t *const bytes_available);
+static bool CaveTalk_ReplayLoad(CaveTalk_Replay_t *const replay);
+static bool CaveTalk_ReplayReleased(const CaveTalk_Replay_t *const replay, const CaveTalk_CaptureRecord_t *const record);
+static inline size_t CaveTalk_CaptureAlign(const size_t size);
+static inline uint8_t *CaveTalk_CaptureBlock(const uint8_t *const map, const size_t block_size, const uint64_t block);
+
+CaveTalk_Error_t CaveTalk_CaptureOpen(CaveTalk_Capture_t *const capture,
+                                      const char *const path,
+                                      const size_t block_size,
+                                      const CaveTalk_LinkHandle_t *const link_handle,
+                                      const CaveTalk_Clock_t clock,
+                                      CaveTalk_LinkHandle_t *const recording_link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == capture) || (NULL == path) || (NULL == link_handle) || (NULL == clock) || (NULL == recording_link_handle))
+    {
+    }
+    else if ((0U != block_size) &&
+             ((block_size < CAVE_TALK_CAPTURE_BLOCK_SIZE_MIN) || (block_size > UINT32_MAX) || (0U != (block_size % CAVE_TALK_CAPTURE_ALIGNMENT))))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        capture->link_handle = *link_handle;
+        capture->clock       = clock;
+        capture->fd          = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        capture->map         = NULL;
+        capture->map_size    = 0U;
+        capture->block_size  = (0U == block_size) ? CAVE_TALK_CAPTURE_BLOCK_SIZE_DEFAULT : block_size;
+        capture->block_count = 0U;
+
+        capture->tx_frame.length = 0U;
+        capture->rx_frame.length = 0U;
+
+        if (capture->fd < 0)
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            error = CaveTalk_CaptureReserve(capture, 1U);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            CaveTalk_CaptureHeader_t header;
+            CaveTalk_LinkBinding_t   binding;
+
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, CAVE_TALK_CAPTURE_MAGIC, sizeof(CAVE_TALK_CAPTURE_MAGIC));
+            header.version     = CAVE_TALK_CAPTURE_VERSION;
+            header.block_size  = (uint32_t)capture->block_size;
+            header.block_count = 0U;
+            memcpy(capture->map, &header, sizeof(header));
+
+            binding.context   = capture;
+            binding.send      = (NULL != link_handle->send) ? CaveTalk_CaptureSend : NULL;
+            binding.receive   = (NULL != link_handle->receive) ? CaveTalk_CaptureReceive : NULL;
+            binding.available = (NULL != link_handle->available) ? CaveTalk_CaptureAvailable : NULL;
+
+            error = CaveTalk_LinkBind(&binding, &capture->recording_link_handle);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *recording_link_handle = capture->recording_link_handle;
+        }
+        else if (capture->fd >= 0)
+        {
+            if (NULL != capture->map)
+            {
+                munmap(capture->map, capture->map_size);
+                capture->map = NULL;
+            }
+            close(capture->fd);
+            capture->fd = -1;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_CaptureAppend(CaveTalk_Capture_t *const capture,
+                                        const CaveTalk_CaptureDirection_t direction,
+                                        const CaveTalk_Microseconds_t timestamp,
+                                        const void *const data,
+                                        const size_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == capture) || (NULL == capture->map) || ((NULL == data) && (0U != length)))
+    {
+    }
+    else
+    {
+        const uint8_t *bytes     = (const uint8_t *)data;
+        size_t         remaining = length;
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Records never straddle blocks, large writes are split into several records with the same timestamp */
+        do
+        {
+            CaveTalk_CaptureBlockHeader_t block_header;
+            uint8_t                      *block = NULL;
+            size_t                        space = 0U;
+
+            if (0U == capture->block_count)
+            {
+                error = CaveTalk_CaptureReserve(capture, 2U);
+                memset(&block_header, 0, sizeof(block_header));
+            }
+            else
+            {
+                memcpy(&block_header, CaveTalk_CaptureBlock(capture->map, capture->block_size, capture->block_count), sizeof(block_header));
+                space = capture->block_size - sizeof(block_header) - block_header.used;
+
+                if (space < (sizeof(CaveTalk_CaptureRecordHeader_t) + CAVE_TALK_CAPTURE_ALIGNMENT))
+                {
+                    error = CaveTalk_CaptureReserve(capture, capture->block_count + 2U);
+                    memset(&block_header, 0, sizeof(block_header));
+                }
+            }
+
+            if (CAVE_TALK_ERROR_NONE == error)
+            {
+                if (0U == block_header.used)
+                {
+                    CaveTalk_CaptureHeader_t header;
+
+                    capture->block_count++;
+                    memcpy(&header, capture->map, sizeof(header));
+                    header.block_count = capture->block_count;
+                    memcpy(capture->map, &header, sizeof(header));
+
+                    block_header.first_timestamp = timestamp;
+                    space                        = capture->block_size - sizeof(block_header);
+                }
+
+                CaveTalk_CaptureRecordHeader_t record_header;
+                const size_t                   chunk = ((remaining + sizeof(record_header)) > space) ?
+                                                       ((space - sizeof(record_header)) & ~(size_t)(CAVE_TALK_CAPTURE_ALIGNMENT - 1U)) :
+                                                       remaining;
+
+                block = CaveTalk_CaptureBlock(capture->map, capture->block_size, capture->block_count);
+
+                memset(&record_header, 0, sizeof(record_header));
+                record_header.timestamp = timestamp;
+                record_header.length    = (uint32_t)chunk;
+                record_header.direction = (uint8_t)direction;
+
+                memcpy(block + sizeof(block_header) + block_header.used, &record_header, sizeof(record_header));
+                if (0U != chunk)
+                {
+                    memcpy(block + sizeof(block_header) + block_header.used + sizeof(record_header), bytes, chunk);
+                }
+
+                /* Publish the record by updating the block header last */
+                block_header.last_timestamp = timestamp;
+                block_header.used          += (uint32_t)(sizeof(record_header) + CaveTalk_CaptureAlign(chunk));
+                block_header.record_count++;
+                memcpy(block, &block_header, sizeof(block_header));
+
+                bytes     += chunk;
+                remaining -= chunk;
+            }
+        } while ((CAVE_TALK_ERROR_NONE == error) && (0U != remaining));
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_CaptureClose(CaveTalk_Capture_t *const capture)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == capture) || (capture->fd < 0))
+    {
+    }
+    else
+    {
+        error = CaveTalk_LinkUnbind(&capture->recording_link_handle);
+
+        /* Keep the bytes of frames cut off by closing */
+        if (0U != capture->tx_frame.length)
+        {
+            CaveTalk_CaptureAppend(capture, CAVE_TALK_CAPTURE_DIRECTION_TX, capture->clock(), capture->tx_frame.bytes, capture->tx_frame.length);
+        }
+        if (0U != capture->rx_frame.length)
+        {
+            CaveTalk_CaptureAppend(capture, CAVE_TALK_CAPTURE_DIRECTION_RX, capture->clock(), capture->rx_frame.bytes, capture->rx_frame.length);
+        }
+
+        if (NULL != capture->map)
+        {
+            msync(capture->map, capture->map_size, MS_SYNC);
+            munmap(capture->map, capture->map_size);
+            capture->map = NULL;
+        }
+
+        /* Drop the preallocated tail */
+        if (0 != ftruncate(capture->fd, (off_t)((capture->block_count + 1U) * capture->block_size)))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+
+        close(capture->fd);
+        capture->fd = -1;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_CaptureReaderOpen(CaveTalk_CaptureReader_t *const reader, const char *const path)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (NULL == path))
+    {
+    }
+    else
+    {
+        struct stat status;
+
+        reader->fd          = open(path, O_RDONLY | O_CLOEXEC);
+        reader->map         = NULL;
+        reader->map_size    = 0U;
+        reader->block_size  = 0U;
+        reader->block_count = 0U;
+
+        if ((reader->fd < 0) || (0 != fstat(reader->fd, &status)))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else if ((size_t)status.st_size < sizeof(CaveTalk_CaptureHeader_t))
+        {
+            error = CAVE_TALK_ERROR_SIZE;
+        }
+        else
+        {
+            void *map = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, reader->fd, 0);
+
+            if (MAP_FAILED == map)
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+            else
+            {
+                CaveTalk_CaptureHeader_t header;
+
+                reader->map      = (const uint8_t *)map;
+                reader->map_size = (size_t)status.st_size;
+                memcpy(&header, reader->map, sizeof(header));
+
+                if ((0 != memcmp(header.magic, CAVE_TALK_CAPTURE_MAGIC, sizeof(CAVE_TALK_CAPTURE_MAGIC))) ||
+                    (CAVE_TALK_CAPTURE_VERSION != header.version))
+                {
+                    error = CAVE_TALK_ERROR_VERSION;
+                }
+                else if ((header.block_size < CAVE_TALK_CAPTURE_BLOCK_SIZE_MIN) || (0U != (header.block_size % CAVE_TALK_CAPTURE_ALIGNMENT)))
+                {
+                    error = CAVE_TALK_ERROR_SIZE;
+                }
+                else
+                {
+                    const uint64_t mapped_blocks = (reader->map_size / header.block_size) - 1U;
+
+                    reader->block_size  = header.block_size;
+                    reader->block_count = (header.block_count < mapped_blocks) ? header.block_count : mapped_blocks;
+
+                    madvise(map, reader->map_size, MADV_SEQUENTIAL);
+
+                    error = CAVE_TALK_ERROR_NONE;
+                }
+            }
+        }
+
+        if ((CAVE_TALK_ERROR_NONE != error) && (reader->fd >= 0))
+        {
+            CaveTalk_CaptureReaderClose(reader);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_CaptureReaderClose(CaveTalk_CaptureReader_t *const reader)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (reader->fd < 0))
+    {
+    }
+    else
+    {
+        if (NULL != reader->map)
+        {
+            munmap((void *)reader->map, reader->map_size);
+            reader->map = NULL;
+        }
+
+        close(reader->fd);
+        reader->fd = -1;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_CaptureSeek(const CaveTalk_CaptureReader_t *const reader,
+                                      const CaveTalk_Microseconds_t timestamp,
+                                      CaveTalk_CaptureCursor_t *const cursor)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (NULL == reader->map) || (NULL == cursor))
+    {
+    }
+    else
+    {
+        uint64_t low  = 0U;
+        uint64_t high = reader->block_count;
+
+        /* Find the last block starting before the timestamp, records with equal timestamps may begin in it */
+        while ((high - low) > 1U)
+        {
+            const uint64_t                middle = low + ((high - low) / 2U);
+            CaveTalk_CaptureBlockHeader_t block_header;
+
+            memcpy(&block_header, CaveTalk_CaptureBlock(reader->map, reader->block_size, middle + 1U), sizeof(block_header));
+
+            if (block_header.first_timestamp < timestamp)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        cursor->block  = low;
+        cursor->offset = 0U;
+
+        /* Then walk to the first record at or after the timestamp */
+        CaveTalk_CaptureCursor_t previous = *cursor;
+        CaveTalk_CaptureRecord_t record;
+
+        while (CaveTalk_CaptureNext(reader, cursor, &record))
+        {
+            if (record.timestamp >= timestamp)
+            {
+                *cursor = previous;
+                break;
+            }
+
+            previous = *cursor;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+bool CaveTalk_CaptureNext(const CaveTalk_CaptureReader_t *const reader, CaveTalk_CaptureCursor_t *const cursor, CaveTalk_CaptureRecord_t *const record)
+{
+    bool found = false;
+
+    if ((NULL == reader) || (NULL == reader->map) || (NULL == cursor) || (NULL == record))
+    {
+    }
+    else
+    {
+        while (!found && (cursor->block < reader->block_count))
+        {
+            const uint8_t                 *block = CaveTalk_CaptureBlock(reader->map, reader->block_size, cursor->block + 1U);
+            CaveTalk_CaptureBlockHeader_t  block_header;
+            CaveTalk_CaptureRecordHeader_t record_header;
+
+            memcpy(&block_header, block, sizeof(block_header));
+
+            if ((block_header.used > (reader->block_size - sizeof(block_header))) ||
+                ((cursor->offset + sizeof(record_header)) > block_header.used))
+            {
+                cursor->block++;
+                cursor->offset = 0U;
+            }
+            else
+            {
+                memcpy(&record_header, block + sizeof(block_header) + cursor->offset, sizeof(record_header));
+
+                if ((cursor->offset + sizeof(record_header) + record_header.length) > block_header.used)
+                {
+                    /* Truncated record, skip the rest of the block */
+                    cursor->block++;
+                    cursor->offset = 0U;
+                }
+                else
+                {
+                    record->timestamp = record_header.timestamp;
+                    record->direction = (CaveTalk_CaptureDirection_t)record_header.direction;
+                    record->data      = block + sizeof(block_header) + cursor->offset + sizeof(record_header);
+                    record->length    = record_header.length;
+
+                    cursor->offset += sizeof(record_header) + CaveTalk_CaptureAlign(record_header.length);
+                    found           = true;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+CaveTalk_Error_t CaveTalk_ReplayOpen(CaveTalk_Replay_t *const replay,
+                                     const char *const path,
+                                     const CaveTalk_CaptureDirection_t direction,
+                                     const CaveTalk_Clock_t clock,
+                                     CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == replay) || (NULL == path) || (NULL == link_handle))
+    {
+    }
+    else
+    {
+        replay->direction     = direction;
+        replay->clock         = clock;
+        replay->record_offset = 0U;
+        replay->record.length = 0U;
+        replay->record.data   = NULL;
+
+        error = CaveTalk_CaptureReaderOpen(&replay->reader, path);
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            CaveTalk_LinkBinding_t binding;
+
+            binding.context   = replay;
+            binding.send      = NULL;
+            binding.receive   = CaveTalk_ReplayReceive;
+            binding.available = CaveTalk_ReplayAvailable;
+
+            error = CaveTalk_LinkBind(&binding, &replay->link_handle);
+
+            if (CAVE_TALK_ERROR_NONE != error)
+            {
+                CaveTalk_CaptureReaderClose(&replay->reader);
+            }
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *link_handle = replay->link_handle;
+            error        = CaveTalk_ReplaySeek(replay, 0U);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ReplaySeek(CaveTalk_Replay_t *const replay, const CaveTalk_Microseconds_t timestamp)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == replay)
+    {
+    }
+    else
+    {
+        error = CaveTalk_CaptureSeek(&replay->reader, timestamp, &replay->cursor);
+
+        replay->record_offset = 0U;
+        replay->record.length = 0U;
+        replay->record.data   = NULL;
+
+        /* Real time replay starts from the first record at or after the seek point */
+        if ((CAVE_TALK_ERROR_NONE == error) && CaveTalk_ReplayLoad(replay))
+        {
+            replay->capture_start = replay->record.timestamp;
+        }
+        else
+        {
+            replay->capture_start = timestamp;
+        }
+
+        replay->clock_start = (NULL != replay->clock) ? replay->clock() : 0U;
+    }
+
+    return error;
+}
+
+bool CaveTalk_ReplayDone(CaveTalk_Replay_t *const replay)
+{
+    return (NULL == replay) || !CaveTalk_ReplayLoad(replay);
+}
+
+CaveTalk_Error_t CaveTalk_ReplayClose(CaveTalk_Replay_t *const replay)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == replay)
+    {
+    }
+    else
+    {
+        CaveTalk_LinkUnbind(&replay->link_handle);
+        error = CaveTalk_CaptureReaderClose(&replay->reader);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_CaptureSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Capture_t *const capture = (CaveTalk_Capture_t *)context;
+    CaveTalk_Error_t          error   = capture->link_handle.send(data, size);
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        error = CaveTalk_CaptureFrame(capture, CAVE_TALK_CAPTURE_DIRECTION_TX, data, size);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_CaptureReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Capture_t *const capture = (CaveTalk_Capture_t *)context;
+    CaveTalk_Error_t          error   = capture->link_handle.receive(data, size, bytes_received);
+
+    if ((CAVE_TALK_ERROR_NONE == error) && (0U != *bytes_received))
+    {
+        error = CaveTalk_CaptureFrame(capture, CAVE_TALK_CAPTURE_DIRECTION_RX, data, *bytes_received);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_CaptureAvailable(void *const context, size_t *const bytes_available)
+{
+    const CaveTalk_Capture_t *const capture = (const CaveTalk_Capture_t *)context;
+
+    return capture->link_handle.available(bytes_available);
+}
+
+/* Links send and receive frames in pieces, records hold whole frames so replay never releases half of one */
+static CaveTalk_Error_t CaveTalk_CaptureFrame(CaveTalk_Capture_t *const capture,
+                                              const CaveTalk_CaptureDirection_t direction,
+                                              const void *const data,
+                                              const size_t size)
+{
+    CaveTalk_Error_t               error = CAVE_TALK_ERROR_NONE;
+    CaveTalk_CaptureFrame_t *const frame = (CAVE_TALK_CAPTURE_DIRECTION_TX == direction) ? &capture->tx_frame : &capture->rx_frame;
+    const uint8_t                 *bytes = (const uint8_t *)data;
+    size_t                         left  = size;
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (0U != left))
+    {
+        const size_t frame_size = (frame->length < CAVE_TALK_HEADER_SIZE) ?
+                                  CAVE_TALK_HEADER_SIZE :
+                                  (CAVE_TALK_HEADER_SIZE + frame->bytes[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE);
+        const size_t needed     = frame_size - frame->length;
+        const size_t chunk      = (left < needed) ? left : needed;
+
+        memcpy(&frame->bytes[frame->length], bytes, chunk);
+        frame->length += chunk;
+        bytes         += chunk;
+        left          -= chunk;
+
+        if ((frame->length >= CAVE_TALK_HEADER_SIZE) &&
+            (frame->length == (CAVE_TALK_HEADER_SIZE + frame->bytes[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE)))
+        {
+            error         = CaveTalk_CaptureAppend(capture, direction, capture->clock(), frame->bytes, frame->length);
+            frame->length = 0U;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_CaptureReserve(CaveTalk_Capture_t *const capture, const uint64_t block_count)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+    const size_t     size  = (size_t)block_count * capture->block_size;
+
+    if (size > capture->map_size)
+    {
+        /* Grow in large steps so remapping is rare */
+        const size_t map_size = size + (CAVE_TALK_CAPTURE_GROWTH_BLOCKS * capture->block_size);
+        void        *map      = MAP_FAILED;
+
+        if (0 != ftruncate(capture->fd, (off_t)map_size))
+        {
+        }
+        else if (NULL == capture->map)
+        {
+            map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, capture->fd, 0);
+        }
+        else
+        {
+            map = mremap(capture->map, capture->map_size, map_size, MREMAP_MAYMOVE);
+        }
+
+        if (MAP_FAILED == map)
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            capture->map      = (uint8_t *)map;
+            capture->map_size = map_size;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_ReplayReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Replay_t *const replay = (CaveTalk_Replay_t *)context;
+    CaveTalk_Error_t         error  = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) || (NULL == bytes_received))
+    {
+    }
+    else
+    {
+        uint8_t *const bytes = (uint8_t *)data;
+
+        *bytes_received = 0U;
+
+        while ((*bytes_received < size) && CaveTalk_ReplayLoad(replay) && CaveTalk_ReplayReleased(replay, &replay->record))
+        {
+            const size_t record_remaining = replay->record.length - replay->record_offset;
+            const size_t chunk            = ((size - *bytes_received) < record_remaining) ? (size - *bytes_received) : record_remaining;
+
+            memcpy(bytes + *bytes_received, replay->record.data + replay->record_offset, chunk);
+            replay->record_offset += chunk;
+            *bytes_received       += chunk;
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_ReplayAvailable(void *const context, size_t *const bytes_available)
+{
+    CaveTalk_Replay_t *const replay = (CaveTalk_Replay_t *)context;
+    CaveTalk_Error_t         error  = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == bytes_available)
+    {
+    }
+    else
+    {
+        *bytes_available = 0U;
+
+        /* Only look ahead far enough to cover a frame rather than summing the rest of the capture */
+        if (CaveTalk_ReplayLoad(replay) && CaveTalk_ReplayReleased(replay, &replay->record))
+        {
+            CaveTalk_CaptureCursor_t cursor = replay->cursor;
+            CaveTalk_CaptureRecord_t record;
+
+            *bytes_available = replay->record.length - replay->record_offset;
+
+            while ((*bytes_available < CAVE_TALK_REPLAY_LOOKAHEAD_BYTES) &&
+                   CaveTalk_CaptureNext(&replay->reader, &cursor, &record) &&
+                   CaveTalk_ReplayReleased(replay, &record))
+            {
+                if (replay->direction == record.direction)
+                {
+                    *bytes_available += record.length;
+                }
+            }
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+static bool CaveTalk_ReplayLoad(CaveTalk_Replay_t *const replay)
+{
+    bool loaded = replay->record_offset < replay->record.length;
+
+    while (!loaded && CaveTalk_CaptureNext(&replay->reader, &replay->cursor, &replay->record))
+    {
+        replay->record_offset = 0U;
+        loaded                = (replay->direction == replay->record.direction) && (0U != replay->record.length);
+    }
+
+    return loaded;
+}
+
+static bool CaveTalk_ReplayReleased(const CaveTalk_Replay_t *const replay, const CaveTalk_CaptureRecord_t *const record)
+{
+    bool released = true;
+
+    if ((NULL != replay->clock) && (record->timestamp > replay->capture_start))
+    {
+        released = (record->timestamp - replay->capture_start) <= (replay->clock() - replay->clock_start);
+    }
+
+    return released;
+}
+
+static inline size_t CaveTalk_CaptureAlign(const size_t size)
+{
+    return (size + (CAVE_TALK_CAPTURE_ALIGNMENT - 1U)) & ~(size_t)(CAVE_TALK_CAPTURE_ALIGNMENT - 1U);
+}
+
+static inline uint8_t *CaveTalk_CaptureBlock(const uint8_t *const map, const size_t block_size, const uint64_t block)
+{
+    return (uint8_t *)(map + (block * block_size));
+}
@@ -0,0 +1,433 @@
+#include "cave_talk_channel.h"
+
+#include <fcntl.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_CHANNEL_VERSION    1U
+#define CAVE_TALK_CHANNEL_MAGIC      "CVTKCHN"
+#define CAVE_TALK_CHANNEL_CACHE_LINE 64U
+
+/* The writer's index and every slot sit on their own cache lines so readers polling for new records never share a
+ * line with the slot being written. A slot's sequence is odd while it is written and 2 * (index + 1) once it holds
+ * the record published at index, so readers detect both unwritten and overwritten slots without locks. */
+typedef struct
+{
+    uint8_t magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t slot_count;
+} CaveTalk_ChannelHeader_t;
+
+typedef struct
+{
+    alignas(CAVE_TALK_CHANNEL_CACHE_LINE) atomic_uint_least64_t sequence;
+    CaveTalk_ChannelRecord_t record;
+} CaveTalk_ChannelSlot_t;
+
+typedef struct
+{
+    CaveTalk_ChannelHeader_t header;
+    alignas(CAVE_TALK_CHANNEL_CACHE_LINE) atomic_uint_least64_t head;
+    CaveTalk_ChannelSlot_t slots[];
+} CaveTalk_ChannelShared_t;
+
+static CaveTalk_Error_t CaveTalk_ChannelPublishId(CaveTalk_Channel_t *const channel, CaveTalk_ChannelRecord_t *const record, const CaveTalk_Id_t id);
+static inline size_t CaveTalk_ChannelMapSize(const size_t slot_count);
+
+CaveTalk_Error_t CaveTalk_ChannelOpen(CaveTalk_Channel_t *const channel, const char *const name, const size_t slot_count, const CaveTalk_Clock_t clock)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == channel) || (NULL == clock))
+    {
+    }
+    else if ((0U == slot_count) || (0U != (slot_count & (slot_count - 1U))) ||
+             ((NULL != name) && (strlen(name) >= CAVE_TALK_CHANNEL_NAME_SIZE_MAX)))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        int fd = -1;
+
+        memset(channel->name, 0, sizeof(channel->name));
+        channel->map        = MAP_FAILED;
+        channel->map_size   = CaveTalk_ChannelMapSize(slot_count);
+        channel->slot_count = slot_count;
+        channel->clock      = clock;
+
+        /* Without a name the ring is anonymous shared memory, still visible to children forked after this */
+        if (NULL == name)
+        {
+            channel->map = mmap(NULL, channel->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        }
+        else
+        {
+            memcpy(channel->name, name, strlen(name) + 1U);
+            fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if ((fd >= 0) && (0 == ftruncate(fd, (off_t)channel->map_size)))
+            {
+                channel->map = mmap(NULL, channel->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+
+        if (MAP_FAILED == channel->map)
+        {
+            if (NULL != name)
+            {
+                shm_unlink(name);
+            }
+
+            channel->map = NULL;
+            error        = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            CaveTalk_ChannelShared_t *const shared = (CaveTalk_ChannelShared_t *)channel->map;
+
+            memcpy(shared->header.magic, CAVE_TALK_CHANNEL_MAGIC, sizeof(CAVE_TALK_CHANNEL_MAGIC));
+            shared->header.version     = CAVE_TALK_CHANNEL_VERSION;
+            shared->header.record_size = sizeof(CaveTalk_ChannelRecord_t);
+            shared->header.slot_count  = slot_count;
+            atomic_init(&shared->head, 0U);
+
+            for (size_t index = 0U; index < slot_count; index++)
+            {
+                atomic_init(&shared->slots[index].sequence, 0U);
+            }
+
+            error = CAVE_TALK_ERROR_NONE;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelClose(CaveTalk_Channel_t *const channel)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == channel) || (NULL == channel->map))
+    {
+    }
+    else
+    {
+        munmap(channel->map, channel->map_size);
+        channel->map = NULL;
+
+        /* Readers that already mapped the ring keep it until they close */
+        if ('\0' != channel->name[0])
+        {
+            shm_unlink(channel->name);
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelPublish(CaveTalk_Channel_t *const channel, const CaveTalk_ChannelRecord_t *const record)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == channel) || (NULL == channel->map) || (NULL == record))
+    {
+    }
+    else
+    {
+        CaveTalk_ChannelShared_t *const shared = (CaveTalk_ChannelShared_t *)channel->map;
+        const uint64_t                  index  = atomic_load_explicit(&shared->head, memory_order_relaxed);
+        CaveTalk_ChannelSlot_t *const   slot   = &shared->slots[index & (channel->slot_count - 1U)];
+
+        atomic_store_explicit(&slot->sequence, (2U * index) + 1U, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        slot->record           = *record;
+        slot->record.timestamp = channel->clock();
+        slot->record.sequence  = index;
+
+        atomic_store_explicit(&slot->sequence, 2U * (index + 1U), memory_order_release);
+        atomic_store_explicit(&shared->head, index + 1U, memory_order_release);
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelPublishMovement(CaveTalk_Channel_t *const channel,
+                                                 const CaveTalk_MetersPerSecond_t speed,
+                                                 const CaveTalk_RadiansPerSecond_t turn_rate)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.movement.speed     = speed;
+    record.message.movement.turn_rate = turn_rate;
+
+    return CaveTalk_ChannelPublishId(channel, &record, CAVE_TALK_ID_MOVEMENT);
+}
+
+CaveTalk_Error_t CaveTalk_ChannelPublishCameraMovement(CaveTalk_Channel_t *const channel, const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.camera_movement.pan  = pan;
+    record.message.camera_movement.tilt = tilt;
+
+    return CaveTalk_ChannelPublishId(channel, &record, CAVE_TALK_ID_CAMERA_MOVEMENT);
+}
+
+CaveTalk_Error_t CaveTalk_ChannelPublishLights(CaveTalk_Channel_t *const channel, const bool headlights)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.lights.headlights = headlights;
+
+    return CaveTalk_ChannelPublishId(channel, &record, CAVE_TALK_ID_LIGHTS);
+}
+
+CaveTalk_Error_t CaveTalk_ChannelPublishMode(CaveTalk_Channel_t *const channel, const bool manual)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.mode.manual = manual;
+
+    return CaveTalk_ChannelPublishId(channel, &record, CAVE_TALK_ID_MODE);
+}
+
+CaveTalk_Error_t CaveTalk_ChannelReaderOpen(CaveTalk_ChannelReader_t *const reader, const char *const name)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (NULL == name))
+    {
+    }
+    else
+    {
+        const int   fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+        struct stat status;
+
+        reader->map        = NULL;
+        reader->map_size   = 0U;
+        reader->slot_count = 0U;
+        reader->mapped     = false;
+        reader->cursor     = 0U;
+        reader->overruns   = 0U;
+
+        if ((fd < 0) || (0 != fstat(fd, &status)))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else if ((size_t)status.st_size < sizeof(CaveTalk_ChannelShared_t))
+        {
+            error = CAVE_TALK_ERROR_SIZE;
+        }
+        else
+        {
+            const void *const map = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+            if (MAP_FAILED == map)
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+            else
+            {
+                const CaveTalk_ChannelShared_t *const shared = (const CaveTalk_ChannelShared_t *)map;
+
+                reader->map      = map;
+                reader->map_size = (size_t)status.st_size;
+                reader->mapped   = true;
+
+                if ((0 != memcmp(shared->header.magic, CAVE_TALK_CHANNEL_MAGIC, sizeof(CAVE_TALK_CHANNEL_MAGIC))) ||
+                    (CAVE_TALK_CHANNEL_VERSION != shared->header.version) ||
+                    (sizeof(CaveTalk_ChannelRecord_t) != shared->header.record_size))
+                {
+                    error = CAVE_TALK_ERROR_VERSION;
+                }
+                else if ((0U == shared->header.slot_count) || (CaveTalk_ChannelMapSize(shared->header.slot_count) > reader->map_size))
+                {
+                    error = CAVE_TALK_ERROR_SIZE;
+                }
+                else
+                {
+                    /* Readers start at the newest record rather than replaying the whole ring */
+                    reader->slot_count = shared->header.slot_count;
+                    reader->cursor     = atomic_load_explicit(&((CaveTalk_ChannelShared_t *)map)->head, memory_order_acquire);
+
+                    error = CAVE_TALK_ERROR_NONE;
+                }
+            }
+        }
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+
+        if ((CAVE_TALK_ERROR_NONE != error) && reader->mapped)
+        {
+            CaveTalk_ChannelReaderClose(reader);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelReaderAttach(CaveTalk_ChannelReader_t *const reader, const CaveTalk_Channel_t *const channel)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (NULL == channel) || (NULL == channel->map))
+    {
+    }
+    else
+    {
+        reader->map        = channel->map;
+        reader->map_size   = channel->map_size;
+        reader->slot_count = channel->slot_count;
+        reader->mapped     = false;
+        reader->cursor     = atomic_load_explicit(&((CaveTalk_ChannelShared_t *)channel->map)->head, memory_order_acquire);
+        reader->overruns   = 0U;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelReaderClose(CaveTalk_ChannelReader_t *const reader)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == reader)
+    {
+    }
+    else
+    {
+        if (reader->mapped)
+        {
+            munmap((void *)reader->map, reader->map_size);
+        }
+
+        reader->map    = NULL;
+        reader->mapped = false;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelRead(CaveTalk_ChannelReader_t *const reader, CaveTalk_ChannelRecord_t *const record)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (NULL == reader->map) || (NULL == record))
+    {
+    }
+    else
+    {
+        CaveTalk_ChannelShared_t *const shared  = (CaveTalk_ChannelShared_t *)reader->map;
+        bool                            reading = true;
+
+        record->id = CAVE_TALK_ID_NONE;
+
+        while (reading)
+        {
+            const uint64_t head = atomic_load_explicit(&shared->head, memory_order_acquire);
+
+            if (reader->cursor >= head)
+            {
+                reading = false;
+            }
+            else
+            {
+                const CaveTalk_ChannelSlot_t *slot     = NULL;
+                uint64_t                      sequence = 0U;
+
+                if ((head - reader->cursor) > reader->slot_count)
+                {
+                    reader->overruns += head - reader->cursor - reader->slot_count;
+                    reader->cursor    = head - reader->slot_count;
+                }
+
+                slot     = &shared->slots[reader->cursor & (reader->slot_count - 1U)];
+                sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+                if (sequence == (2U * (reader->cursor + 1U)))
+                {
+                    *record = slot->record;
+                    atomic_thread_fence(memory_order_acquire);
+                    reading = (sequence != atomic_load_explicit(&slot->sequence, memory_order_relaxed));
+                }
+
+                /* The copy is only kept if the writer did not start on the slot while it was being taken, otherwise
+                 * the writer has lapped this reader and the record is lost */
+                if (reading)
+                {
+                    record->id = CAVE_TALK_ID_NONE;
+                    reader->overruns++;
+                }
+
+                reader->cursor++;
+            }
+        }
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_ChannelReadLatest(CaveTalk_ChannelReader_t *const reader, CaveTalk_ChannelRecord_t *const record)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == reader) || (NULL == reader->map) || (NULL == record))
+    {
+    }
+    else
+    {
+        const uint64_t head = atomic_load_explicit(&((CaveTalk_ChannelShared_t *)reader->map)->head, memory_order_acquire);
+
+        /* Records skipped on purpose are not overruns */
+        if ((head - reader->cursor) > 1U)
+        {
+            reader->cursor = head - 1U;
+        }
+
+        error = CaveTalk_ChannelRead(reader, record);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_ChannelPublishId(CaveTalk_Channel_t *const channel, CaveTalk_ChannelRecord_t *const record, const CaveTalk_Id_t id)
+{
+    record->id = id;
+
+    return CaveTalk_ChannelPublish(channel, record);
+}
+
+static inline size_t CaveTalk_ChannelMapSize(const size_t slot_count)
+{
+    return sizeof(CaveTalk_ChannelShared_t) + (slot_count * sizeof(CaveTalk_ChannelSlot_t));
+}
\ No newline at end of file
@@ -0,0 +1,764 @@
+#include "cave_talk_engine.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_ENGINE_CACHE_LINE 64U
+#define CAVE_TALK_ENGINE_INPUT_SIZE 16384U
+#define CAVE_TALK_ENGINE_EVENTS     64U
+#define CAVE_TALK_ENGINE_EVENT_WAKE UINT64_MAX
+#define CAVE_TALK_ENGINE_READ       (EPOLLIN | EPOLLRDHUP)
+#define CAVE_TALK_ENGINE_GENERATION (UINT32_MAX >> CAVE_TALK_ENGINE_LINK_BITS)
+
+typedef enum
+{
+    CAVE_TALK_ENGINE_LINK_FREE,
+    CAVE_TALK_ENGINE_LINK_ATTACHING,
+    CAVE_TALK_ENGINE_LINK_ACTIVE,
+    CAVE_TALK_ENGINE_LINK_CLOSING,
+} CaveTalk_EngineLinkState_t;
+
+/* Written by the attaching thread while free or attaching and only by its shard once active */
+typedef struct
+{
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) atomic_int state;
+    int fd;
+    uint32_t generation;
+    bool dirty;
+    bool writable_wait;
+    CaveTalk_FrameParser_t parser;
+    uint8_t payload[UINT8_MAX];
+    size_t output_length;
+    uint8_t output[CAVE_TALK_ENGINE_OUTPUT_SIZE];
+} CaveTalk_EngineLink_t;
+
+/* Counters have a single writer, their shard, so they are bumped with relaxed loads and stores rather than read,
+ * modify, write operations */
+typedef struct
+{
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) CaveTalk_Engine_t *engine;
+    size_t index;
+    pthread_t thread;
+    bool started;
+    int epoll_fd;
+    int event_fd;
+    atomic_bool stopping;
+    uint32_t *dirty;
+    size_t dirty_count;
+    atomic_uint_least64_t frames_in;
+    atomic_uint_least64_t frames_out;
+    atomic_uint_least64_t handed_off;
+    atomic_uint_least64_t dropped;
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) atomic_bool signalled;
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) atomic_uint_least32_t links;
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) uint8_t input[CAVE_TALK_ENGINE_INPUT_SIZE];
+} CaveTalk_EngineShard_t;
+
+/* Head is written by the source shard and tail by the destination, each on its own cache line */
+typedef struct
+{
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) atomic_size_t head;
+    alignas(CAVE_TALK_ENGINE_CACHE_LINE) atomic_size_t tail;
+} CaveTalk_EngineRing_t;
+
+typedef struct
+{
+    uint32_t slot;
+    uint32_t generation;
+    uint32_t size;
+    uint8_t frame[CAVE_TALK_ENGINE_FRAME_SIZE_MAX];
+} CaveTalk_EngineHandoff_t;
+
+static size_t CaveTalk_EngineDirtySize(const size_t shard_count, const size_t links_per_shard);
+static CaveTalk_EngineShard_t *CaveTalk_EngineShard(const CaveTalk_Engine_t *const engine, const size_t shard);
+static CaveTalk_EngineLink_t *CaveTalk_EngineLink(const CaveTalk_Engine_t *const engine, const size_t shard, const size_t slot);
+static CaveTalk_EngineRing_t *CaveTalk_EngineRing(const CaveTalk_Engine_t *const engine, const size_t source, const size_t destination);
+static CaveTalk_EngineHandoff_t *CaveTalk_EngineHandoff(const CaveTalk_Engine_t *const engine,
+                                                        const size_t source,
+                                                        const size_t destination,
+                                                        const size_t index);
+static inline uint32_t CaveTalk_EngineLinkId(const CaveTalk_Engine_t *const engine, const size_t shard, const size_t slot, const uint32_t generation);
+static void CaveTalk_EngineFrame(uint8_t *const frame, const CaveTalk_Id_t id, const void *const data, const CaveTalk_Length_t length);
+static void *CaveTalk_EngineRun(void *const argument);
+static void CaveTalk_EngineRead(CaveTalk_EngineShard_t *const shard, const size_t slot);
+static void CaveTalk_EngineDrain(CaveTalk_EngineShard_t *const shard);
+static CaveTalk_Error_t CaveTalk_EngineQueue(CaveTalk_EngineShard_t *const shard,
+                                             const size_t slot,
+                                             const uint32_t generation,
+                                             const uint8_t *const frame,
+                                             const size_t size);
+static void CaveTalk_EngineMarkDirty(CaveTalk_EngineShard_t *const shard, CaveTalk_EngineLink_t *const link, const size_t slot);
+static void CaveTalk_EngineFlush(CaveTalk_EngineShard_t *const shard);
+static void CaveTalk_EngineCloseLink(CaveTalk_EngineShard_t *const shard, CaveTalk_EngineLink_t *const link);
+static void CaveTalk_EngineFreeLink(CaveTalk_EngineShard_t *const shard, CaveTalk_EngineLink_t *const link);
+static inline void CaveTalk_EngineCount(atomic_uint_least64_t *const counter);
+
+CaveTalk_Error_t CaveTalk_EngineOpen(CaveTalk_Engine_t *const engine,
+                                     const size_t shard_count,
+                                     const size_t links_per_shard,
+                                     const size_t handoff_slots,
+                                     const bool pin,
+                                     const CaveTalk_EngineHandler_t handler,
+                                     void *const context)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == engine) || (NULL == handler))
+    {
+    }
+    else if ((0U == shard_count) ||
+             (shard_count > CAVE_TALK_ENGINE_SHARD_COUNT_MAX) ||
+             (0U == links_per_shard) ||
+             (links_per_shard > (CAVE_TALK_ENGINE_LINK_COUNT_MAX / shard_count)) ||
+             (0U == handoff_slots) ||
+             (0U != (handoff_slots & (handoff_slots - 1U))))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        /* Shards, then links by shard, then each shard's dirty list, then rings and their handoff slots by source and
+         * destination shard */
+        engine->shard_count     = shard_count;
+        engine->links_per_shard = links_per_shard;
+        engine->handoff_slots   = handoff_slots;
+        engine->handler         = handler;
+        engine->context         = context;
+        engine->map_size        = (shard_count * sizeof(CaveTalk_EngineShard_t)) +
+                           (shard_count * links_per_shard * sizeof(CaveTalk_EngineLink_t)) +
+                           CaveTalk_EngineDirtySize(shard_count, links_per_shard) +
+                           (shard_count * shard_count * sizeof(CaveTalk_EngineRing_t)) +
+                           (shard_count * shard_count * handoff_slots * sizeof(CaveTalk_EngineHandoff_t));
+        engine->map = mmap(NULL, engine->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        error       = CAVE_TALK_ERROR_NONE;
+
+        if (MAP_FAILED == engine->map)
+        {
+            engine->map = NULL;
+            error       = CAVE_TALK_ERROR_IO;
+        }
+
+        /* Every shard is set up even after a failure, so closing only touches descriptors the engine opened */
+        for (size_t index = 0U; (NULL != engine->map) && (index < shard_count); index++)
+        {
+            CaveTalk_EngineShard_t *const shard = CaveTalk_EngineShard(engine, index);
+            struct epoll_event            event;
+
+            shard->engine      = engine;
+            shard->index       = index;
+            shard->started     = false;
+            shard->epoll_fd    = epoll_create1(EPOLL_CLOEXEC);
+            shard->event_fd    = eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+            shard->dirty       = (uint32_t *)(void *)CaveTalk_EngineLink(engine, shard_count, 0U) + (index * links_per_shard);
+            shard->dirty_count = 0U;
+            atomic_init(&shard->stopping, false);
+            atomic_init(&shard->signalled, false);
+            atomic_init(&shard->links, 0U);
+            atomic_init(&shard->frames_in, 0U);
+            atomic_init(&shard->frames_out, 0U);
+            atomic_init(&shard->handed_off, 0U);
+            atomic_init(&shard->dropped, 0U);
+
+            for (size_t slot = 0U; slot < links_per_shard; slot++)
+            {
+                CaveTalk_EngineLink_t *const link = CaveTalk_EngineLink(engine, index, slot);
+
+                atomic_init(&link->state, CAVE_TALK_ENGINE_LINK_FREE);
+                link->fd         = -1;
+                link->generation = 0U;
+            }
+
+            for (size_t source = 0U; source < shard_count; source++)
+            {
+                atomic_init(&CaveTalk_EngineRing(engine, source, index)->head, 0U);
+                atomic_init(&CaveTalk_EngineRing(engine, source, index)->tail, 0U);
+            }
+
+            event.events   = EPOLLIN;
+            event.data.u64 = CAVE_TALK_ENGINE_EVENT_WAKE;
+
+            if ((shard->epoll_fd < 0) || (shard->event_fd < 0) || (0 != epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, shard->event_fd, &event)))
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+        }
+
+        /* No shard starts before all are set up, so handoffs never reach a shard that is not there yet */
+        for (size_t index = 0U; (CAVE_TALK_ERROR_NONE == error) && (index < shard_count); index++)
+        {
+            CaveTalk_EngineShard_t *const shard = CaveTalk_EngineShard(engine, index);
+
+            if (0 != pthread_create(&shard->thread, NULL, CaveTalk_EngineRun, shard))
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+            else
+            {
+                shard->started = true;
+
+                /* Pinning is best effort, a shard that cannot be pinned still runs */
+                if (pin && (cpus > 0))
+                {
+                    cpu_set_t cpu_set;
+
+                    CPU_ZERO(&cpu_set);
+                    CPU_SET(index % (size_t)cpus, &cpu_set);
+                    pthread_setaffinity_np(shard->thread, sizeof(cpu_set), &cpu_set);
+                }
+            }
+        }
+
+        if ((CAVE_TALK_ERROR_NONE != error) && (NULL != engine->map))
+        {
+            CaveTalk_EngineClose(engine);
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_EngineClose(CaveTalk_Engine_t *const engine)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == engine) || (NULL == engine->map))
+    {
+    }
+    else
+    {
+        const uint64_t wake = 1U;
+
+        for (size_t index = 0U; index < engine->shard_count; index++)
+        {
+            CaveTalk_EngineShard_t *const shard = CaveTalk_EngineShard(engine, index);
+
+            if (shard->started)
+            {
+                atomic_store_explicit(&shard->stopping, true, memory_order_release);
+                CAVE_TALK_UNUSED(write(shard->event_fd, &wake, sizeof(wake)));
+                pthread_join(shard->thread, NULL);
+                shard->started = false;
+            }
+        }
+
+        for (size_t index = 0U; index < engine->shard_count; index++)
+        {
+            CaveTalk_EngineShard_t *const shard = CaveTalk_EngineShard(engine, index);
+
+            for (size_t slot = 0U; slot < engine->links_per_shard; slot++)
+            {
+                CaveTalk_EngineLink_t *const link = CaveTalk_EngineLink(engine, index, slot);
+
+                if (link->fd >= 0)
+                {
+                    close(link->fd);
+                }
+            }
+
+            if (shard->epoll_fd >= 0)
+            {
+                close(shard->epoll_fd);
+            }
+
+            if (shard->event_fd >= 0)
+            {
+                close(shard->event_fd);
+            }
+        }
+
+        munmap(engine->map, engine->map_size);
+        engine->map = NULL;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_EngineAttach(CaveTalk_Engine_t *const engine, const int fd, uint32_t *const link)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == engine) || (NULL == engine->map) || (NULL == link))
+    {
+    }
+    else
+    {
+        CaveTalk_EngineShard_t *shard = CaveTalk_EngineShard(engine, 0U);
+        size_t                  slot  = 0U;
+        int                     state = CAVE_TALK_ENGINE_LINK_FREE;
+
+        /* New links go to the shard with the fewest */
+        for (size_t index = 1U; index < engine->shard_count; index++)
+        {
+            CaveTalk_EngineShard_t *const candidate = CaveTalk_EngineShard(engine, index);
+
+            if (atomic_load_explicit(&candidate->links, memory_order_relaxed) < atomic_load_explicit(&shard->links, memory_order_relaxed))
+            {
+                shard = candidate;
+            }
+        }
+
+        while ((slot < engine->links_per_shard) &&
+               !atomic_compare_exchange_strong_explicit(&CaveTalk_EngineLink(engine, shard->index, slot)->state,
+                                                        &state,
+                                                        CAVE_TALK_ENGINE_LINK_ATTACHING,
+                                                        memory_order_acquire,
+                                                        memory_order_relaxed))
+        {
+            state = CAVE_TALK_ENGINE_LINK_FREE;
+            slot++;
+        }
+
+        if (slot >= engine->links_per_shard)
+        {
+            error = CAVE_TALK_ERROR_SIZE;
+        }
+        else
+        {
+            CaveTalk_EngineLink_t *const attached = CaveTalk_EngineLink(engine, shard->index, slot);
+            const int                    flags    = fcntl(fd, F_GETFL);
+            struct epoll_event           event;
+
+            event.events   = CAVE_TALK_ENGINE_READ;
+            event.data.u64 = slot;
+
+            if ((flags < 0) || (0 != fcntl(fd, F_SETFL, flags | O_NONBLOCK)))
+            {
+                atomic_store_explicit(&attached->state, CAVE_TALK_ENGINE_LINK_FREE, memory_order_release);
+                error = CAVE_TALK_ERROR_IO;
+            }
+            else
+            {
+                attached->fd            = fd;
+                attached->generation    = (attached->generation + 1U) & CAVE_TALK_ENGINE_GENERATION;
+                attached->output_length = 0U;
+                CaveTalk_FrameParserInit(&attached->parser, attached->payload, sizeof(attached->payload));
+
+                /* The shard sees the link only once it is in its epoll set, after everything above is published */
+                atomic_store_explicit(&attached->state, CAVE_TALK_ENGINE_LINK_ACTIVE, memory_order_release);
+                atomic_fetch_add_explicit(&shard->links, 1U, memory_order_relaxed);
+
+                if (0 != epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, fd, &event))
+                {
+                    attached->fd = -1;
+                    atomic_fetch_sub_explicit(&shard->links, 1U, memory_order_relaxed);
+                    atomic_store_explicit(&attached->state, CAVE_TALK_ENGINE_LINK_FREE, memory_order_release);
+                    error = CAVE_TALK_ERROR_IO;
+                }
+                else
+                {
+                    *link = CaveTalk_EngineLinkId(engine, shard->index, slot, attached->generation);
+                    error = CAVE_TALK_ERROR_NONE;
+                }
+            }
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_EngineSend(CaveTalk_Engine_t *const engine,
+                                     const size_t shard,
+                                     const uint32_t link,
+                                     const CaveTalk_Id_t id,
+                                     const void *const data,
+                                     const CaveTalk_Length_t length)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == engine) || (NULL == engine->map) || ((NULL == data) && (0U != length)))
+    {
+    }
+    else if ((shard >= engine->shard_count) || (CAVE_TALK_ENGINE_LINK_INDEX(link) >= (engine->shard_count * engine->links_per_shard)))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        CaveTalk_EngineShard_t *const source      = CaveTalk_EngineShard(engine, shard);
+        const size_t                  destination = CAVE_TALK_ENGINE_LINK_INDEX(link) / engine->links_per_shard;
+        const size_t                  slot        = CAVE_TALK_ENGINE_LINK_INDEX(link) % engine->links_per_shard;
+        const uint32_t                generation  = link >> CAVE_TALK_ENGINE_LINK_BITS;
+        const size_t                  size        = CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+
+        if (destination == shard)
+        {
+            uint8_t frame[CAVE_TALK_ENGINE_FRAME_SIZE_MAX];
+
+            CaveTalk_EngineFrame(frame, id, data, length);
+            error = CaveTalk_EngineQueue(source, slot, generation, frame, size);
+        }
+        else
+        {
+            CaveTalk_EngineRing_t *const  ring   = CaveTalk_EngineRing(engine, shard, destination);
+            CaveTalk_EngineShard_t *const target = CaveTalk_EngineShard(engine, destination);
+            const size_t                  head   = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+            if ((head - atomic_load_explicit(&ring->tail, memory_order_acquire)) >= engine->handoff_slots)
+            {
+                CaveTalk_EngineCount(&source->dropped);
+                error = CAVE_TALK_ERROR_BUSY;
+            }
+            else
+            {
+                CaveTalk_EngineHandoff_t *const handoff = CaveTalk_EngineHandoff(engine, shard, destination, head & (engine->handoff_slots - 1U));
+                const uint64_t                  wake    = 1U;
+
+                handoff->slot       = (uint32_t)slot;
+                handoff->generation = generation;
+                handoff->size       = (uint32_t)size;
+                CaveTalk_EngineFrame(handoff->frame, id, data, length);
+
+                atomic_store_explicit(&ring->head, head + 1U, memory_order_seq_cst);
+                CaveTalk_EngineCount(&source->handed_off);
+
+                /* Only the first handoff since the target last woke writes its eventfd. Publishing the head, this
+                 * exchange and the target clearing the flag before it drains are totally ordered, so the target either
+                 * sees the flag still set and drains the handoff or is woken again. */
+                if (!atomic_exchange_explicit(&target->signalled, true, memory_order_seq_cst))
+                {
+                    CAVE_TALK_UNUSED(write(target->event_fd, &wake, sizeof(wake)));
+                }
+
+                error = CAVE_TALK_ERROR_NONE;
+            }
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_EngineCounters(const CaveTalk_Engine_t *const engine, const size_t shard, CaveTalk_EngineCounters_t *const counters)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == engine) || (NULL == engine->map) || (NULL == counters))
+    {
+    }
+    else if (shard >= engine->shard_count)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        CaveTalk_EngineShard_t *const source = CaveTalk_EngineShard(engine, shard);
+
+        counters->frames_in  = atomic_load_explicit(&source->frames_in, memory_order_relaxed);
+        counters->frames_out = atomic_load_explicit(&source->frames_out, memory_order_relaxed);
+        counters->handed_off = atomic_load_explicit(&source->handed_off, memory_order_relaxed);
+        counters->dropped    = atomic_load_explicit(&source->dropped, memory_order_relaxed);
+        counters->links      = atomic_load_explicit(&source->links, memory_order_relaxed);
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+static size_t CaveTalk_EngineDirtySize(const size_t shard_count, const size_t links_per_shard)
+{
+    const size_t size = shard_count * links_per_shard * sizeof(uint32_t);
+
+    return ((size + CAVE_TALK_ENGINE_CACHE_LINE - 1U) / CAVE_TALK_ENGINE_CACHE_LINE) * CAVE_TALK_ENGINE_CACHE_LINE;
+}
+
+static CaveTalk_EngineShard_t *CaveTalk_EngineShard(const CaveTalk_Engine_t *const engine, const size_t shard)
+{
+    return &((CaveTalk_EngineShard_t *)engine->map)[shard];
+}
+
+static CaveTalk_EngineLink_t *CaveTalk_EngineLink(const CaveTalk_Engine_t *const engine, const size_t shard, const size_t slot)
+{
+    CaveTalk_EngineLink_t *const links = (CaveTalk_EngineLink_t *)(void *)CaveTalk_EngineShard(engine, engine->shard_count);
+
+    return &links[(shard * engine->links_per_shard) + slot];
+}
+
+static CaveTalk_EngineRing_t *CaveTalk_EngineRing(const CaveTalk_Engine_t *const engine, const size_t source, const size_t destination)
+{
+    uint8_t *const rings = (uint8_t *)CaveTalk_EngineLink(engine, engine->shard_count, 0U) +
+                           CaveTalk_EngineDirtySize(engine->shard_count, engine->links_per_shard);
+
+    return &((CaveTalk_EngineRing_t *)(void *)rings)[(source * engine->shard_count) + destination];
+}
+
+static CaveTalk_EngineHandoff_t *CaveTalk_EngineHandoff(const CaveTalk_Engine_t *const engine,
+                                                        const size_t source,
+                                                        const size_t destination,
+                                                        const size_t index)
+{
+    CaveTalk_EngineHandoff_t *const handoffs = (CaveTalk_EngineHandoff_t *)(void *)CaveTalk_EngineRing(engine, engine->shard_count, 0U);
+
+    return &handoffs[(((source * engine->shard_count) + destination) * engine->handoff_slots) + index];
+}
+
+static inline uint32_t CaveTalk_EngineLinkId(const CaveTalk_Engine_t *const engine, const size_t shard, const size_t slot, const uint32_t generation)
+{
+    return (uint32_t)((shard * engine->links_per_shard) + slot) | (generation << CAVE_TALK_ENGINE_LINK_BITS);
+}
+
+static void CaveTalk_EngineFrame(uint8_t *const frame, const CaveTalk_Id_t id, const void *const data, const CaveTalk_Length_t length)
+{
+    frame[CAVE_TALK_VERSION_INDEX] = CAVE_TALK_VERSION;
+    frame[CAVE_TALK_ID_INDEX]      = id;
+    frame[CAVE_TALK_LENGTH_INDEX]  = length;
+
+    if (0U != length)
+    {
+        memcpy(&frame[CAVE_TALK_HEADER_SIZE], data, length);
+    }
+
+    CaveTalk_CrcWrite(frame, &frame[CAVE_TALK_HEADER_SIZE], &frame[CAVE_TALK_HEADER_SIZE + length]);
+}
+
+static void *CaveTalk_EngineRun(void *const argument)
+{
+    CaveTalk_EngineShard_t *const shard = (CaveTalk_EngineShard_t *)argument;
+    struct epoll_event            events[CAVE_TALK_ENGINE_EVENTS];
+
+    while (!atomic_load_explicit(&shard->stopping, memory_order_acquire))
+    {
+        const int count = epoll_wait(shard->epoll_fd, events, CAVE_TALK_ENGINE_EVENTS, -1);
+
+        for (int index = 0; index < count; index++)
+        {
+            if (CAVE_TALK_ENGINE_EVENT_WAKE == events[index].data.u64)
+            {
+                uint64_t wakes = 0U;
+
+                CAVE_TALK_UNUSED(read(shard->event_fd, &wakes, sizeof(wakes)));
+                atomic_store_explicit(&shard->signalled, false, memory_order_seq_cst);
+                CaveTalk_EngineDrain(shard);
+            }
+            else
+            {
+                const size_t                 slot = (size_t)events[index].data.u64;
+                CaveTalk_EngineLink_t *const link = CaveTalk_EngineLink(shard->engine, shard->index, slot);
+
+                if (CAVE_TALK_ENGINE_LINK_ACTIVE != atomic_load_explicit(&link->state, memory_order_acquire))
+                {
+                }
+                else
+                {
+                    if (0U != (events[index].events & EPOLLOUT))
+                    {
+                        CaveTalk_EngineMarkDirty(shard, link, slot);
+                    }
+
+                    if (0U != (events[index].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+                    {
+                        CaveTalk_EngineRead(shard, slot);
+                    }
+                }
+            }
+        }
+
+        /* Everything queued while handling the events goes out in one write per link */
+        CaveTalk_EngineFlush(shard);
+    }
+
+    return NULL;
+}
+
+/* One read per readiness event, so a busy link cannot starve the others on its shard */
+static void CaveTalk_EngineRead(CaveTalk_EngineShard_t *const shard, const size_t slot)
+{
+    CaveTalk_Engine_t *const     engine   = shard->engine;
+    CaveTalk_EngineLink_t *const link     = CaveTalk_EngineLink(engine, shard->index, slot);
+    const ssize_t                received = read(link->fd, shard->input, sizeof(shard->input));
+
+    if (received > 0)
+    {
+        size_t offset = 0U;
+
+        while (offset < (size_t)received)
+        {
+            size_t            consumed = 0U;
+            CaveTalk_Id_t     id       = CAVE_TALK_ID_NONE;
+            CaveTalk_Length_t length   = 0U;
+
+            if (CAVE_TALK_ERROR_NONE == CaveTalk_FrameParse(&link->parser, &shard->input[offset], (size_t)received - offset, &consumed, &id, &length))
+            {
+                CaveTalk_EngineCount(&shard->frames_in);
+                engine->handler(engine->context, engine, shard->index, CaveTalk_EngineLinkId(engine, shard->index, slot, link->generation), id, link->payload, length);
+            }
+
+            offset += consumed;
+        }
+    }
+    else if ((0 == received) || ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)))
+    {
+        CaveTalk_EngineCloseLink(shard, link);
+    }
+}
+
+static void CaveTalk_EngineDrain(CaveTalk_EngineShard_t *const shard)
+{
+    CaveTalk_Engine_t *const engine = shard->engine;
+
+    for (size_t source = 0U; source < engine->shard_count; source++)
+    {
+        CaveTalk_EngineRing_t *const ring = CaveTalk_EngineRing(engine, source, shard->index);
+        const size_t                 head = atomic_load_explicit(&ring->head, memory_order_seq_cst);
+        size_t                       tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+        while (tail != head)
+        {
+            const CaveTalk_EngineHandoff_t *const handoff = CaveTalk_EngineHandoff(engine, source, shard->index, tail & (engine->handoff_slots - 1U));
+
+            CaveTalk_EngineQueue(shard, handoff->slot, handoff->generation, handoff->frame, handoff->size);
+            tail++;
+        }
+
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+}
+
+/* A frame for a link that closed, or whose slot has been attached again since the id was handed out, is dropped */
+static CaveTalk_Error_t CaveTalk_EngineQueue(CaveTalk_EngineShard_t *const shard,
+                                             const size_t slot,
+                                             const uint32_t generation,
+                                             const uint8_t *const frame,
+                                             const size_t size)
+{
+    CaveTalk_Error_t             error = CAVE_TALK_ERROR_NONE;
+    CaveTalk_EngineLink_t *const link  = CaveTalk_EngineLink(shard->engine, shard->index, slot);
+
+    if ((CAVE_TALK_ENGINE_LINK_ACTIVE != atomic_load_explicit(&link->state, memory_order_acquire)) || (generation != link->generation))
+    {
+        CaveTalk_EngineCount(&shard->dropped);
+        error = CAVE_TALK_ERROR_IO;
+    }
+    else if ((link->output_length + size) > sizeof(link->output))
+    {
+        CaveTalk_EngineCount(&shard->dropped);
+        error = CAVE_TALK_ERROR_BUSY;
+    }
+    else
+    {
+        memcpy(&link->output[link->output_length], frame, size);
+        link->output_length += size;
+        CaveTalk_EngineCount(&shard->frames_out);
+        CaveTalk_EngineMarkDirty(shard, link, slot);
+    }
+
+    return error;
+}
+
+static void CaveTalk_EngineMarkDirty(CaveTalk_EngineShard_t *const shard, CaveTalk_EngineLink_t *const link, const size_t slot)
+{
+    if (!link->dirty)
+    {
+        link->dirty                        = true;
+        shard->dirty[shard->dirty_count++] = (uint32_t)slot;
+    }
+}
+
+static void CaveTalk_EngineFlush(CaveTalk_EngineShard_t *const shard)
+{
+    for (size_t index = 0U; index < shard->dirty_count; index++)
+    {
+        CaveTalk_EngineLink_t *const link = CaveTalk_EngineLink(shard->engine, shard->index, shard->dirty[index]);
+
+        link->dirty = false;
+
+        if (CAVE_TALK_ENGINE_LINK_ACTIVE != atomic_load_explicit(&link->state, memory_order_relaxed))
+        {
+            CaveTalk_EngineFreeLink(shard, link);
+        }
+        else
+        {
+            ssize_t sent = 0;
+
+            if (0U != link->output_length)
+            {
+                sent = send(link->fd, link->output, link->output_length, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+                if ((sent < 0) && (ENOTSOCK == errno))
+                {
+                    sent = write(link->fd, link->output, link->output_length);
+                }
+            }
+
+            if ((sent < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+            {
+                CaveTalk_EngineCloseLink(shard, link);
+            }
+            else
+            {
+                if (sent > 0)
+                {
+                    link->output_length -= (size_t)sent;
+                    memmove(link->output, &link->output[sent], link->output_length);
+                }
+
+                /* A link with bytes left over is watched for space until they are out */
+                if ((0U != link->output_length) != link->writable_wait)
+                {
+                    struct epoll_event event;
+
+                    link->writable_wait = (0U != link->output_length);
+                    event.events        = CAVE_TALK_ENGINE_READ | (link->writable_wait ? EPOLLOUT : 0U);
+                    event.data.u64      = shard->dirty[index];
+                    epoll_ctl(shard->epoll_fd, EPOLL_CTL_MOD, link->fd, &event);
+                }
+            }
+        }
+    }
+
+    shard->dirty_count = 0U;
+}
+
+/* A closed link still on the dirty list is freed by the flush, so a link attached to its slot meanwhile is never
+ * handed what was left of the old one */
+static void CaveTalk_EngineCloseLink(CaveTalk_EngineShard_t *const shard, CaveTalk_EngineLink_t *const link)
+{
+    if (CAVE_TALK_ENGINE_LINK_ACTIVE == atomic_load_explicit(&link->state, memory_order_relaxed))
+    {
+        epoll_ctl(shard->epoll_fd, EPOLL_CTL_DEL, link->fd, NULL);
+        close(link->fd);
+        link->fd = -1;
+        atomic_store_explicit(&link->state, CAVE_TALK_ENGINE_LINK_CLOSING, memory_order_relaxed);
+
+        if (!link->dirty)
+        {
+            CaveTalk_EngineFreeLink(shard, link);
+        }
+    }
+}
+
+static void CaveTalk_EngineFreeLink(CaveTalk_EngineShard_t *const shard, CaveTalk_EngineLink_t *const link)
+{
+    if (CAVE_TALK_ENGINE_LINK_CLOSING == atomic_load_explicit(&link->state, memory_order_relaxed))
+    {
+        link->output_length = 0U;
+        link->writable_wait = false;
+        atomic_fetch_sub_explicit(&shard->links, 1U, memory_order_relaxed);
+        atomic_store_explicit(&link->state, CAVE_TALK_ENGINE_LINK_FREE, memory_order_release);
+    }
+}
+
+static inline void CaveTalk_EngineCount(atomic_uint_least64_t *const counter)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1U, memory_order_relaxed);
+}
\ No newline at end of file
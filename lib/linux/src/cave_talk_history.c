@@ -0,0 +1,626 @@
+#include "cave_talk_history.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cave_talk_channel.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_HISTORY_VERSION     1U
+#define CAVE_TALK_HISTORY_MAGIC       "CVTKHST"
+#define CAVE_TALK_HISTORY_SERIES      4U
+#define CAVE_TALK_HISTORY_COLUMN_SIZE sizeof(uint64_t) /* Timestamps and fields are both 8 bytes wide */
+
+/* Each id's chunks hold a timestamp column followed by one column per field, a chunk at sequence number s lives at
+ * s % chunk_count. The newest chunk of an id is the only one that is not full and holds at least one row, unless the
+ * id has no rows at all. */
+typedef struct
+{
+    uint8_t magic[8];
+    uint32_t version;
+    uint32_t series;
+    uint64_t chunk_rows;
+    uint64_t chunk_count;
+} CaveTalk_HistoryHeader_t;
+
+typedef struct
+{
+    uint64_t oldest;
+    uint64_t newest;
+    uint64_t rows;
+} CaveTalk_HistorySeries_t;
+
+typedef struct
+{
+    CaveTalk_HistoryHeader_t header;
+    CaveTalk_HistorySeries_t series[CAVE_TALK_HISTORY_SERIES];
+} CaveTalk_HistoryShared_t;
+
+typedef struct
+{
+    CaveTalk_Id_t id;
+    size_t fields;
+} CaveTalk_HistoryLayout_t;
+
+static const CaveTalk_HistoryLayout_t kCaveTalk_HistoryLayouts[CAVE_TALK_HISTORY_SERIES] = {
+    {.id = CAVE_TALK_ID_MOVEMENT, .fields = 2U},
+    {.id = CAVE_TALK_ID_CAMERA_MOVEMENT, .fields = 2U},
+    {.id = CAVE_TALK_ID_LIGHTS, .fields = 1U},
+    {.id = CAVE_TALK_ID_MODE, .fields = 1U},
+};
+
+static size_t CaveTalk_HistorySeriesIndex(const CaveTalk_Id_t id);
+static size_t CaveTalk_HistoryMapSize(const size_t chunk_rows, const size_t chunk_count);
+static uint8_t *CaveTalk_HistoryColumn(const CaveTalk_History_t *const history, const size_t series, const uint64_t chunk, const size_t column);
+static size_t CaveTalk_HistoryChunkRows(const CaveTalk_History_t *const history, const CaveTalk_HistorySeries_t *const state, const uint64_t chunk);
+static size_t CaveTalk_HistoryLowerBound(const CaveTalk_Microseconds_t *const timestamps, size_t low, size_t high, const CaveTalk_Microseconds_t timestamp);
+static void CaveTalk_HistoryFind(const CaveTalk_History_t *const history,
+                                 const size_t series,
+                                 const CaveTalk_Microseconds_t begin,
+                                 uint64_t *const chunk,
+                                 size_t *const row);
+static CaveTalk_Error_t CaveTalk_HistoryRecordId(CaveTalk_History_t *const history, CaveTalk_ChannelRecord_t *const record, const CaveTalk_Id_t id);
+
+CaveTalk_Error_t CaveTalk_HistoryOpen(CaveTalk_History_t *const history,
+                                      const char *const path,
+                                      const size_t chunk_rows,
+                                      const size_t chunk_count,
+                                      const CaveTalk_Microseconds_t max_age,
+                                      const CaveTalk_Clock_t clock)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == clock))
+    {
+    }
+    else if ((0U == chunk_rows) || (chunk_count < 2U) || (chunk_rows > ((SIZE_MAX / 64U) / chunk_count)))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        bool resume = false;
+
+        history->map         = MAP_FAILED;
+        history->map_size    = CaveTalk_HistoryMapSize(chunk_rows, chunk_count);
+        history->chunk_rows  = chunk_rows;
+        history->chunk_count = chunk_count;
+        history->max_age     = max_age;
+        history->clock       = clock;
+
+        /* Without a path the history lives in anonymous memory, only the pages of chunks written to are ever backed */
+        if (NULL == path)
+        {
+            history->map = mmap(NULL, history->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        else
+        {
+            const int   fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            struct stat status;
+
+            if ((fd >= 0) && (0 == fstat(fd, &status)))
+            {
+                resume = ((size_t)status.st_size == history->map_size);
+
+                if (resume || ((0 == ftruncate(fd, 0)) && (0 == ftruncate(fd, (off_t)history->map_size))))
+                {
+                    history->map = mmap(NULL, history->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                }
+            }
+
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+
+        if (MAP_FAILED == history->map)
+        {
+            history->map = NULL;
+            error        = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            CaveTalk_HistoryShared_t *const shared = (CaveTalk_HistoryShared_t *)history->map;
+
+            resume = resume &&
+                     (0 == memcmp(shared->header.magic, CAVE_TALK_HISTORY_MAGIC, sizeof(CAVE_TALK_HISTORY_MAGIC))) &&
+                     (CAVE_TALK_HISTORY_VERSION == shared->header.version) &&
+                     (CAVE_TALK_HISTORY_SERIES == shared->header.series) &&
+                     (chunk_rows == shared->header.chunk_rows) &&
+                     (chunk_count == shared->header.chunk_count);
+
+            /* A file written with other chunk sizes, or not by a history at all, is started over */
+            if (!resume)
+            {
+                memset(shared, 0, sizeof(*shared));
+                memcpy(shared->header.magic, CAVE_TALK_HISTORY_MAGIC, sizeof(CAVE_TALK_HISTORY_MAGIC));
+                shared->header.version     = CAVE_TALK_HISTORY_VERSION;
+                shared->header.series      = CAVE_TALK_HISTORY_SERIES;
+                shared->header.chunk_rows  = chunk_rows;
+                shared->header.chunk_count = chunk_count;
+            }
+
+            error = CAVE_TALK_ERROR_NONE;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_HistoryClose(CaveTalk_History_t *const history)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == history->map))
+    {
+    }
+    else
+    {
+        munmap(history->map, history->map_size);
+        history->map = NULL;
+
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_HistoryAppend(CaveTalk_History_t *const history, const CaveTalk_ChannelRecord_t *const record)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == history->map) || (NULL == record))
+    {
+    }
+    else if (CAVE_TALK_HISTORY_SERIES == CaveTalk_HistorySeriesIndex(record->id))
+    {
+        error = CAVE_TALK_ERROR_ID;
+    }
+    else
+    {
+        const size_t                    series = CaveTalk_HistorySeriesIndex(record->id);
+        CaveTalk_HistorySeries_t *const state  = &((CaveTalk_HistoryShared_t *)history->map)->series[series];
+        double                          fields[CAVE_TALK_HISTORY_FIELDS_MAX];
+
+        if ((0U != state->rows) &&
+            (record->timestamp < ((const CaveTalk_Microseconds_t *)CaveTalk_HistoryColumn(history, series, state->newest, 0U))[state->rows - 1U]))
+        {
+            error = CAVE_TALK_ERROR_PARSE;
+        }
+        else
+        {
+            switch (record->id)
+            {
+            case CAVE_TALK_ID_MOVEMENT:
+                fields[0U] = record->message.movement.speed;
+                fields[1U] = record->message.movement.turn_rate;
+                break;
+            case CAVE_TALK_ID_CAMERA_MOVEMENT:
+                fields[0U] = record->message.camera_movement.pan;
+                fields[1U] = record->message.camera_movement.tilt;
+                break;
+            case CAVE_TALK_ID_LIGHTS:
+                fields[0U] = record->message.lights.headlights ? 1.0 : 0.0;
+                break;
+            default:
+                fields[0U] = record->message.mode.manual ? 1.0 : 0.0;
+                break;
+            }
+
+            if (history->chunk_rows == state->rows)
+            {
+                state->newest++;
+                state->rows = 0U;
+
+                if ((state->newest - state->oldest) >= history->chunk_count)
+                {
+                    state->oldest++;
+                }
+            }
+
+            memcpy(&CaveTalk_HistoryColumn(history, series, state->newest, 0U)[state->rows * CAVE_TALK_HISTORY_COLUMN_SIZE],
+                   &record->timestamp,
+                   CAVE_TALK_HISTORY_COLUMN_SIZE);
+
+            for (size_t field = 0U; field < kCaveTalk_HistoryLayouts[series].fields; field++)
+            {
+                memcpy(&CaveTalk_HistoryColumn(history, series, state->newest, field + 1U)[state->rows * CAVE_TALK_HISTORY_COLUMN_SIZE],
+                       &fields[field],
+                       CAVE_TALK_HISTORY_COLUMN_SIZE);
+            }
+
+            state->rows++;
+
+            /* Only whole chunks are dropped for age, the newest one always stays */
+            if ((0U != history->max_age) && (record->timestamp > history->max_age))
+            {
+                const CaveTalk_Microseconds_t cutoff = record->timestamp - history->max_age;
+
+                while ((state->oldest < state->newest) &&
+                       (((const CaveTalk_Microseconds_t *)CaveTalk_HistoryColumn(history, series, state->oldest, 0U))[history->chunk_rows - 1U] < cutoff))
+                {
+                    state->oldest++;
+                }
+            }
+
+            error = CAVE_TALK_ERROR_NONE;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_HistoryRecordMovement(CaveTalk_History_t *const history,
+                                                const CaveTalk_MetersPerSecond_t speed,
+                                                const CaveTalk_RadiansPerSecond_t turn_rate)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.movement.speed     = speed;
+    record.message.movement.turn_rate = turn_rate;
+
+    return CaveTalk_HistoryRecordId(history, &record, CAVE_TALK_ID_MOVEMENT);
+}
+
+CaveTalk_Error_t CaveTalk_HistoryRecordCameraMovement(CaveTalk_History_t *const history, const CaveTalk_Radian_t pan, const CaveTalk_Radian_t tilt)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.camera_movement.pan  = pan;
+    record.message.camera_movement.tilt = tilt;
+
+    return CaveTalk_HistoryRecordId(history, &record, CAVE_TALK_ID_CAMERA_MOVEMENT);
+}
+
+CaveTalk_Error_t CaveTalk_HistoryRecordLights(CaveTalk_History_t *const history, const bool headlights)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.lights.headlights = headlights;
+
+    return CaveTalk_HistoryRecordId(history, &record, CAVE_TALK_ID_LIGHTS);
+}
+
+CaveTalk_Error_t CaveTalk_HistoryRecordMode(CaveTalk_History_t *const history, const bool manual)
+{
+    CaveTalk_ChannelRecord_t record;
+
+    record.message.mode.manual = manual;
+
+    return CaveTalk_HistoryRecordId(history, &record, CAVE_TALK_ID_MODE);
+}
+
+CaveTalk_Error_t CaveTalk_HistoryRows(const CaveTalk_History_t *const history, const CaveTalk_Id_t id, size_t *const rows)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == history->map) || (NULL == rows))
+    {
+    }
+    else if (CAVE_TALK_HISTORY_SERIES == CaveTalk_HistorySeriesIndex(id))
+    {
+        error = CAVE_TALK_ERROR_ID;
+    }
+    else
+    {
+        const CaveTalk_HistorySeries_t *const state = &((const CaveTalk_HistoryShared_t *)history->map)->series[CaveTalk_HistorySeriesIndex(id)];
+
+        *rows = ((state->newest - state->oldest) * history->chunk_rows) + state->rows;
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_HistoryRange(const CaveTalk_History_t *const history,
+                                       const CaveTalk_Id_t id,
+                                       const CaveTalk_Microseconds_t begin,
+                                       const CaveTalk_Microseconds_t end,
+                                       CaveTalk_Microseconds_t *const timestamps,
+                                       double *const first,
+                                       double *const second,
+                                       const size_t capacity,
+                                       size_t *const count)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == history->map) || (NULL == count))
+    {
+    }
+    else if (CAVE_TALK_HISTORY_SERIES == CaveTalk_HistorySeriesIndex(id))
+    {
+        error = CAVE_TALK_ERROR_ID;
+    }
+    else
+    {
+        const size_t                          series                                = CaveTalk_HistorySeriesIndex(id);
+        const CaveTalk_HistorySeries_t *const state                                 = &((const CaveTalk_HistoryShared_t *)history->map)->series[series];
+        double *const                         columns[CAVE_TALK_HISTORY_FIELDS_MAX] = {first, second};
+        uint64_t                              chunk                                 = 0U;
+        size_t                                row                                   = 0U;
+        bool                                  copying                               = true;
+
+        *count = 0U;
+        error  = CAVE_TALK_ERROR_NONE;
+
+        CaveTalk_HistoryFind(history, series, begin, &chunk, &row);
+
+        /* Whole runs of rows are copied a column at a time, each chunk's end of range found by binary search */
+        while (copying)
+        {
+            const size_t                         rows   = CaveTalk_HistoryChunkRows(history, state, chunk);
+            const CaveTalk_Microseconds_t *const times  = (const CaveTalk_Microseconds_t *)CaveTalk_HistoryColumn(history, series, chunk, 0U);
+            const size_t                         last   = CaveTalk_HistoryLowerBound(times, row, rows, end);
+            size_t                               copied = last - row;
+
+            if (copied > (capacity - *count))
+            {
+                copied  = capacity - *count;
+                error   = CAVE_TALK_ERROR_SIZE;
+                copying = false;
+            }
+
+            if (NULL != timestamps)
+            {
+                memcpy(&timestamps[*count], &times[row], copied * CAVE_TALK_HISTORY_COLUMN_SIZE);
+            }
+
+            for (size_t field = 0U; field < kCaveTalk_HistoryLayouts[series].fields; field++)
+            {
+                if (NULL != columns[field])
+                {
+                    memcpy(&columns[field][*count],
+                           &CaveTalk_HistoryColumn(history, series, chunk, field + 1U)[row * CAVE_TALK_HISTORY_COLUMN_SIZE],
+                           copied * CAVE_TALK_HISTORY_COLUMN_SIZE);
+                }
+            }
+
+            *count += copied;
+
+            if ((last < rows) || (chunk >= state->newest))
+            {
+                copying = false;
+            }
+            else
+            {
+                chunk++;
+                row = 0U;
+            }
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_HistoryDownsample(const CaveTalk_History_t *const history,
+                                            const CaveTalk_Id_t id,
+                                            const CaveTalk_Microseconds_t begin,
+                                            const CaveTalk_Microseconds_t end,
+                                            const CaveTalk_Microseconds_t window,
+                                            CaveTalk_HistoryWindow_t *const windows,
+                                            const size_t capacity,
+                                            size_t *const count)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == history->map) || (NULL == windows) || (NULL == count))
+    {
+    }
+    else if (CAVE_TALK_HISTORY_SERIES == CaveTalk_HistorySeriesIndex(id))
+    {
+        error = CAVE_TALK_ERROR_ID;
+    }
+    else if (0U == window)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        const size_t                          series   = CaveTalk_HistorySeriesIndex(id);
+        const size_t                          fields   = kCaveTalk_HistoryLayouts[series].fields;
+        const CaveTalk_HistorySeries_t *const state    = &((const CaveTalk_HistoryShared_t *)history->map)->series[series];
+        CaveTalk_HistoryWindow_t             *current  = NULL;
+        uint64_t                              chunk    = 0U;
+        size_t                                row      = 0U;
+        size_t                                rows     = 0U;
+        bool                                  sampling = true;
+
+        *count = 0U;
+        error  = CAVE_TALK_ERROR_NONE;
+
+        CaveTalk_HistoryFind(history, series, begin, &chunk, &row);
+        rows = CaveTalk_HistoryChunkRows(history, state, chunk);
+
+        /* Windows are aligned to begin and only those holding rows are returned, means are sums until closed */
+        while (sampling)
+        {
+            if ((row >= rows) && (chunk < state->newest))
+            {
+                chunk++;
+                row  = 0U;
+                rows = CaveTalk_HistoryChunkRows(history, state, chunk);
+            }
+
+            if (row >= rows)
+            {
+                sampling = false;
+            }
+            else
+            {
+                const CaveTalk_Microseconds_t timestamp = ((const CaveTalk_Microseconds_t *)CaveTalk_HistoryColumn(history, series, chunk, 0U))[row];
+
+                if (timestamp >= end)
+                {
+                    sampling = false;
+                }
+                else
+                {
+                    const CaveTalk_Microseconds_t start = begin + (((timestamp - begin) / window) * window);
+
+                    if ((NULL == current) || (start != current->start))
+                    {
+                        if (*count >= capacity)
+                        {
+                            error    = CAVE_TALK_ERROR_SIZE;
+                            sampling = false;
+                        }
+                        else
+                        {
+                            current = &windows[*count];
+                            memset(current, 0, sizeof(*current));
+                            current->start = start;
+                            (*count)++;
+                        }
+                    }
+
+                    if (sampling)
+                    {
+                        for (size_t field = 0U; field < fields; field++)
+                        {
+                            const double value = ((const double *)CaveTalk_HistoryColumn(history, series, chunk, field + 1U))[row];
+
+                            current->mean[field] += value;
+                            current->min[field]   = ((0U == current->count) || (value < current->min[field])) ? value : current->min[field];
+                            current->max[field]   = ((0U == current->count) || (value > current->max[field])) ? value : current->max[field];
+                        }
+
+                        current->count++;
+                        row++;
+                    }
+                }
+            }
+        }
+
+        for (size_t index = 0U; index < *count; index++)
+        {
+            for (size_t field = 0U; field < fields; field++)
+            {
+                windows[index].mean[field] /= windows[index].count;
+            }
+        }
+    }
+
+    return error;
+}
+
+static size_t CaveTalk_HistorySeriesIndex(const CaveTalk_Id_t id)
+{
+    size_t series = 0U;
+
+    while ((series < CAVE_TALK_HISTORY_SERIES) && (id != kCaveTalk_HistoryLayouts[series].id))
+    {
+        series++;
+    }
+
+    return series;
+}
+
+static size_t CaveTalk_HistoryMapSize(const size_t chunk_rows, const size_t chunk_count)
+{
+    size_t columns = 0U;
+
+    for (size_t series = 0U; series < CAVE_TALK_HISTORY_SERIES; series++)
+    {
+        columns += 1U + kCaveTalk_HistoryLayouts[series].fields;
+    }
+
+    return sizeof(CaveTalk_HistoryShared_t) + (columns * chunk_count * chunk_rows * CAVE_TALK_HISTORY_COLUMN_SIZE);
+}
+
+static uint8_t *CaveTalk_HistoryColumn(const CaveTalk_History_t *const history, const size_t series, const uint64_t chunk, const size_t column)
+{
+    const size_t column_size = history->chunk_rows * CAVE_TALK_HISTORY_COLUMN_SIZE;
+    size_t       offset      = sizeof(CaveTalk_HistoryShared_t);
+
+    for (size_t index = 0U; index < series; index++)
+    {
+        offset += (1U + kCaveTalk_HistoryLayouts[index].fields) * history->chunk_count * column_size;
+    }
+
+    offset += (((size_t)(chunk % history->chunk_count) * (1U + kCaveTalk_HistoryLayouts[series].fields)) + column) * column_size;
+
+    return &((uint8_t *)history->map)[offset];
+}
+
+static size_t CaveTalk_HistoryChunkRows(const CaveTalk_History_t *const history, const CaveTalk_HistorySeries_t *const state, const uint64_t chunk)
+{
+    return (chunk == state->newest) ? (size_t)state->rows : history->chunk_rows;
+}
+
+static size_t CaveTalk_HistoryLowerBound(const CaveTalk_Microseconds_t *const timestamps, size_t low, size_t high, const CaveTalk_Microseconds_t timestamp)
+{
+    while (low < high)
+    {
+        const size_t middle = low + ((high - low) / 2U);
+
+        if (timestamps[middle] < timestamp)
+        {
+            low = middle + 1U;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/* Finds the first row at or after begin by binary search over the chunks' newest rows and then within the chunk,
+ * landing past the newest row when there is none */
+static void CaveTalk_HistoryFind(const CaveTalk_History_t *const history,
+                                 const size_t series,
+                                 const CaveTalk_Microseconds_t begin,
+                                 uint64_t *const chunk,
+                                 size_t *const row)
+{
+    const CaveTalk_HistorySeries_t *const state = &((const CaveTalk_HistoryShared_t *)history->map)->series[series];
+    uint64_t                              low   = state->oldest;
+    uint64_t                              high  = state->newest;
+
+    while (low < high)
+    {
+        const uint64_t middle = low + ((high - low) / 2U);
+
+        if (((const CaveTalk_Microseconds_t *)CaveTalk_HistoryColumn(history, series, middle, 0U))[history->chunk_rows - 1U] < begin)
+        {
+            low = middle + 1U;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    *chunk = low;
+    *row   = CaveTalk_HistoryLowerBound((const CaveTalk_Microseconds_t *)CaveTalk_HistoryColumn(history, series, low, 0U),
+                                        0U,
+                                        CaveTalk_HistoryChunkRows(history, state, low),
+                                        begin);
+}
+
+static CaveTalk_Error_t CaveTalk_HistoryRecordId(CaveTalk_History_t *const history, CaveTalk_ChannelRecord_t *const record, const CaveTalk_Id_t id)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == history) || (NULL == history->clock))
+    {
+    }
+    else
+    {
+        record->id        = id;
+        record->timestamp = history->clock();
+        record->sequence  = 0U;
+
+        error = CaveTalk_HistoryAppend(history, record);
+    }
+
+    return error;
+}
\ No newline at end of file
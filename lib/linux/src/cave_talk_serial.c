@@ -0,0 +1,546 @@
+#include "cave_talk_serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+typedef struct
+{
+    uint32_t baud_rate;
+    speed_t speed;
+} CaveTalk_SerialSpeed_t;
+
+static const CaveTalk_SerialSpeed_t kCaveTalk_SerialSpeeds[] = {
+    {1200U, B1200},       {2400U, B2400},       {4800U, B4800},       {9600U, B9600},       {19200U, B19200},
+    {38400U, B38400},     {57600U, B57600},     {115200U, B115200},   {230400U, B230400},   {460800U, B460800},
+    {500000U, B500000},   {576000U, B576000},   {921600U, B921600},   {1000000U, B1000000}, {1152000U, B1152000},
+    {1500000U, B1500000}, {2000000U, B2000000}, {2500000U, B2500000}, {3000000U, B3000000}, {4000000U, B4000000},
+};
+
+static CaveTalk_Error_t CaveTalk_SerialSend(void *const context, const void *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_SerialReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_SerialAvailable(void *const context, size_t *const bytes_available);
+static CaveTalk_Error_t CaveTalk_SerialConfigure(CaveTalk_Serial_t *const serial, const CaveTalk_SerialConfig_t *const config);
+static CaveTalk_Error_t CaveTalk_SerialWrite(CaveTalk_Serial_t *const serial, const uint8_t *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_SerialFill(CaveTalk_Serial_t *const serial);
+static void CaveTalk_SerialSwap(CaveTalk_Serial_t *const serial);
+static size_t CaveTalk_SerialBuffered(const CaveTalk_Serial_t *const serial);
+static void CaveTalk_SerialAdvance(CaveTalk_Serial_t *const serial, const uint8_t *const bytes, const size_t count);
+static size_t CaveTalk_SerialFrameRemaining(const CaveTalk_Serial_t *const serial);
+static bool CaveTalk_SerialLookupSpeed(const uint32_t baud_rate, speed_t *const speed);
+
+CaveTalk_Error_t CaveTalk_SerialOpen(CaveTalk_Serial_t *const serial,
+                                     const char *const path,
+                                     const CaveTalk_SerialConfig_t *const config,
+                                     void *const buffer,
+                                     const size_t buffer_size,
+                                     CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+    speed_t          speed = B0;
+
+    if ((NULL == serial) || (NULL == path) || (NULL == config) || (NULL == buffer) || (NULL == link_handle))
+    {
+    }
+    else if ((buffer_size < CAVE_TALK_SERIAL_BUFFER_SIZE_MIN) || !CaveTalk_SerialLookupSpeed(config->baud_rate, &speed))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        /* Two halves, one is consumed from memory while the next read lands in the other */
+        serial->fd              = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        serial->rx_buffers[0]   = (uint8_t *)buffer;
+        serial->rx_buffers[1]   = (uint8_t *)buffer + (buffer_size / 2U);
+        serial->rx_buffer_size  = buffer_size / 2U;
+        serial->rx_lengths[0]   = 0U;
+        serial->rx_lengths[1]   = 0U;
+        serial->rx_head         = 0U;
+        serial->rx_consume      = 0U;
+        serial->rx_frame_offset = 0U;
+        serial->rx_frame_size   = 0U;
+        serial->tx_length       = 0U;
+        memset(&serial->stats, 0, sizeof(serial->stats));
+
+        if ((serial->fd < 0) || (0 != tcgetattr(serial->fd, &serial->attributes)))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            error = CaveTalk_SerialConfigure(serial, config);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            CaveTalk_LinkBinding_t binding;
+
+            binding.context   = serial;
+            binding.send      = CaveTalk_SerialSend;
+            binding.receive   = CaveTalk_SerialReceive;
+            binding.available = CaveTalk_SerialAvailable;
+
+            error = CaveTalk_LinkBind(&binding, &serial->link_handle);
+
+            if (CAVE_TALK_ERROR_NONE != error)
+            {
+                tcsetattr(serial->fd, TCSANOW, &serial->attributes);
+            }
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *link_handle = serial->link_handle;
+        }
+        else if (serial->fd >= 0)
+        {
+            close(serial->fd);
+            serial->fd = -1;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_SerialFlush(CaveTalk_Serial_t *const serial)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == serial) || (serial->fd < 0))
+    {
+    }
+    else
+    {
+        error = CaveTalk_SerialWrite(serial, serial->tx_buffer, serial->tx_length);
+
+        serial->tx_length = 0U;
+    }
+
+    return error;
+}
+
+/* Matches CaveTalk_LinkWait_t so deadline bounded listens can sleep on the device */
+CaveTalk_Error_t CaveTalk_SerialWait(void *const serial, const CaveTalk_Microseconds_t timeout)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == serial) || (((CaveTalk_Serial_t *)serial)->fd < 0))
+    {
+    }
+    else
+    {
+        struct pollfd         poll_fd  = {.fd = ((CaveTalk_Serial_t *)serial)->fd, .events = POLLIN, .revents = 0};
+        const struct timespec duration = {.tv_sec = (time_t)(timeout / 1000000U), .tv_nsec = (long)((timeout % 1000000U) * 1000U)};
+
+        /* An interrupted wait returns early, the caller checks its deadline again */
+        error = ((ppoll(&poll_fd, 1U, &duration, NULL) < 0) && (EINTR != errno)) ? CAVE_TALK_ERROR_IO : CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+/* Matches CaveTalk_LinkWrite_t, writes straight to the device without coalescing and never waits for it to drain */
+CaveTalk_Error_t CaveTalk_SerialTryWrite(void *const serial, const void *const data, const size_t size, size_t *const bytes_written)
+{
+    CaveTalk_Serial_t *const device = (CaveTalk_Serial_t *)serial;
+    CaveTalk_Error_t         error  = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == device) || (device->fd < 0) || ((NULL == data) && (0U != size)) || (NULL == bytes_written))
+    {
+    }
+    else
+    {
+        const ssize_t result = (0U == size) ? 0 : write(device->fd, data, size);
+
+        *bytes_written = 0U;
+        error          = CAVE_TALK_ERROR_NONE;
+        device->stats.writes++;
+
+        if (result > 0)
+        {
+            *bytes_written               = (size_t)result;
+            device->stats.bytes_written += (uint64_t)result;
+        }
+        else if ((result < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_SerialClose(CaveTalk_Serial_t *const serial)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == serial) || (serial->fd < 0))
+    {
+    }
+    else
+    {
+        error = CaveTalk_SerialFlush(serial);
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            error = CaveTalk_LinkUnbind(&serial->link_handle);
+        }
+        else
+        {
+            CaveTalk_LinkUnbind(&serial->link_handle);
+        }
+
+        /* Restore the attributes the device had before it was opened */
+        tcdrain(serial->fd);
+        tcsetattr(serial->fd, TCSANOW, &serial->attributes);
+
+        close(serial->fd);
+        serial->fd = -1;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_SerialSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Serial_t *const serial = (CaveTalk_Serial_t *)context;
+    CaveTalk_Error_t         error  = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) && (0U != size))
+    {
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_NONE;
+
+        if ((serial->tx_length + size) > sizeof(serial->tx_buffer))
+        {
+            error = CaveTalk_SerialFlush(serial);
+        }
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+        }
+        else if (size > sizeof(serial->tx_buffer))
+        {
+            error = CaveTalk_SerialWrite(serial, (const uint8_t *)data, size);
+        }
+        else
+        {
+            /* Speak sends the header, payload and CRC separately, coalesce them so each frame is a single write */
+            if (0U != size)
+            {
+                memcpy(serial->tx_buffer + serial->tx_length, data, size);
+                serial->tx_length += size;
+            }
+
+            if ((serial->tx_length >= CAVE_TALK_HEADER_SIZE) &&
+                (serial->tx_length >= (CAVE_TALK_HEADER_SIZE + serial->tx_buffer[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE)))
+            {
+                error = CaveTalk_SerialFlush(serial);
+            }
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_SerialReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Serial_t *const serial = (CaveTalk_Serial_t *)context;
+    CaveTalk_Error_t         error  = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) || (NULL == bytes_received))
+    {
+    }
+    else
+    {
+        uint8_t *const bytes = (uint8_t *)data;
+        size_t         count = 0U;
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        if (CaveTalk_SerialBuffered(serial) < size)
+        {
+            error = CaveTalk_SerialFill(serial);
+        }
+
+        count           = CaveTalk_SerialBuffered(serial);
+        count           = (count < size) ? count : size;
+        *bytes_received = 0U;
+
+        while (*bytes_received < count)
+        {
+            const uint8_t consume = serial->rx_consume;
+            const size_t  chunk   = ((serial->rx_lengths[consume] - serial->rx_head) < (count - *bytes_received)) ?
+                                    (serial->rx_lengths[consume] - serial->rx_head) :
+                                    (count - *bytes_received);
+
+            memcpy(bytes + *bytes_received, serial->rx_buffers[consume] + serial->rx_head, chunk);
+            serial->rx_head += chunk;
+            *bytes_received += chunk;
+
+            CaveTalk_SerialSwap(serial);
+        }
+
+        CaveTalk_SerialAdvance(serial, bytes, *bytes_received);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_SerialAvailable(void *const context, size_t *const bytes_available)
+{
+    CaveTalk_Serial_t *const serial = (CaveTalk_Serial_t *)context;
+    CaveTalk_Error_t         error  = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == bytes_available)
+    {
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Only go to the device when the rest of the frame is not buffered, a single read then picks up everything that
+         * arrived */
+        if (CaveTalk_SerialBuffered(serial) < CaveTalk_SerialFrameRemaining(serial))
+        {
+            error = CaveTalk_SerialFill(serial);
+        }
+
+        /* Report nothing until the frame is complete so Listen never consumes half a frame. Once part of a frame has been
+         * received this counts from where the reader left off, not from a frame boundary. */
+        *bytes_available = (CaveTalk_SerialBuffered(serial) < CaveTalk_SerialFrameRemaining(serial)) ? 0U : CaveTalk_SerialBuffered(serial);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_SerialConfigure(CaveTalk_Serial_t *const serial, const CaveTalk_SerialConfig_t *const config)
+{
+    CaveTalk_Error_t error      = CAVE_TALK_ERROR_NONE;
+    struct termios   attributes = serial->attributes;
+    speed_t          speed      = B0;
+
+    CaveTalk_SerialLookupSpeed(config->baud_rate, &speed);
+
+    cfmakeraw(&attributes);
+    attributes.c_cflag    |= CLOCAL | CREAD;
+    attributes.c_cc[VMIN]  = config->vmin;
+    attributes.c_cc[VTIME] = config->vtime;
+
+    if ((0 != cfsetispeed(&attributes, speed)) || (0 != cfsetospeed(&attributes, speed)) || (0 != tcsetattr(serial->fd, TCSANOW, &attributes)))
+    {
+        error = CAVE_TALK_ERROR_IO;
+    }
+    else
+    {
+        /* VMIN and VTIME only apply to blocking reads */
+        if ((0U != config->vmin) || (0U != config->vtime))
+        {
+            const int flags = fcntl(serial->fd, F_GETFL);
+
+            if ((flags < 0) || (0 != fcntl(serial->fd, F_SETFL, flags & ~O_NONBLOCK)))
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+        }
+
+        /* Best effort, pseudo terminals and USB adapters without the flag do not support it */
+        if (config->low_latency)
+        {
+            struct serial_struct serial_info;
+
+            if (0 == ioctl(serial->fd, TIOCGSERIAL, &serial_info))
+            {
+                serial_info.flags |= ASYNC_LOW_LATENCY;
+                ioctl(serial->fd, TIOCSSERIAL, &serial_info);
+            }
+        }
+
+        tcflush(serial->fd, TCIOFLUSH);
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+            tcsetattr(serial->fd, TCSANOW, &serial->attributes);
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_SerialWrite(CaveTalk_Serial_t *const serial, const uint8_t *const data, const size_t size)
+{
+    CaveTalk_Error_t error   = CAVE_TALK_ERROR_NONE;
+    size_t           written = 0U;
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (written < size))
+    {
+        const ssize_t result = write(serial->fd, data + written, size - written);
+
+        serial->stats.writes++;
+
+        if (result > 0)
+        {
+            written                     += (size_t)result;
+            serial->stats.bytes_written += (uint64_t)result;
+        }
+        else if ((result < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+        {
+            struct pollfd poll_fd = {.fd = serial->fd, .events = POLLOUT, .revents = 0};
+
+            if ((poll(&poll_fd, 1U, -1) < 0) && (EINTR != errno))
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+        }
+        else if ((result < 0) && (EINTR == errno))
+        {
+        }
+        else
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_SerialFill(CaveTalk_Serial_t *const serial)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+    uint8_t          fill  = 0U;
+
+    CaveTalk_SerialSwap(serial);
+    fill = serial->rx_consume ^ 1U;
+
+    if (serial->rx_lengths[fill] < serial->rx_buffer_size)
+    {
+        const ssize_t result = read(serial->fd,
+                                    serial->rx_buffers[fill] + serial->rx_lengths[fill],
+                                    serial->rx_buffer_size - serial->rx_lengths[fill]);
+
+        serial->stats.reads++;
+
+        if (result > 0)
+        {
+            serial->rx_lengths[fill] += (size_t)result;
+            serial->stats.bytes_read += (uint64_t)result;
+        }
+        else if ((0 == result) || (EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno))
+        {
+        }
+        else
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+
+        CaveTalk_SerialSwap(serial);
+    }
+
+    return error;
+}
+
+static void CaveTalk_SerialSwap(CaveTalk_Serial_t *const serial)
+{
+    if (serial->rx_head == serial->rx_lengths[serial->rx_consume])
+    {
+        serial->rx_lengths[serial->rx_consume] = 0U;
+        serial->rx_head                        = 0U;
+        serial->rx_consume                    ^= 1U;
+    }
+}
+
+static size_t CaveTalk_SerialBuffered(const CaveTalk_Serial_t *const serial)
+{
+    return (serial->rx_lengths[serial->rx_consume] - serial->rx_head) + serial->rx_lengths[serial->rx_consume ^ 1U];
+}
+
+static void CaveTalk_SerialAdvance(CaveTalk_Serial_t *const serial, const uint8_t *const bytes, const size_t count)
+{
+    size_t index = 0U;
+
+    /* Follows the frames the reader has taken so far, the length byte of each one fixes where the next begins */
+    while (index < count)
+    {
+        size_t step = 0U;
+
+        if (serial->rx_frame_offset <= CAVE_TALK_LENGTH_INDEX)
+        {
+            step = ((CAVE_TALK_LENGTH_INDEX + 1U - serial->rx_frame_offset) < (count - index)) ?
+                   (CAVE_TALK_LENGTH_INDEX + 1U - serial->rx_frame_offset) :
+                   (count - index);
+
+            if ((serial->rx_frame_offset + step) > CAVE_TALK_LENGTH_INDEX)
+            {
+                serial->rx_frame_size = CAVE_TALK_HEADER_SIZE + bytes[index + step - 1U] + CAVE_TALK_CRC_SIZE;
+            }
+        }
+        else
+        {
+            step = ((serial->rx_frame_size - serial->rx_frame_offset) < (count - index)) ?
+                   (serial->rx_frame_size - serial->rx_frame_offset) :
+                   (count - index);
+        }
+
+        serial->rx_frame_offset += step;
+        index                   += step;
+
+        if ((serial->rx_frame_offset > CAVE_TALK_LENGTH_INDEX) && (serial->rx_frame_offset == serial->rx_frame_size))
+        {
+            serial->rx_frame_offset = 0U;
+        }
+    }
+}
+
+static size_t CaveTalk_SerialFrameRemaining(const CaveTalk_Serial_t *const serial)
+{
+    size_t remaining = CAVE_TALK_HEADER_SIZE - serial->rx_frame_offset;
+
+    if (serial->rx_frame_offset > CAVE_TALK_LENGTH_INDEX)
+    {
+        remaining = serial->rx_frame_size - serial->rx_frame_offset;
+    }
+    else if (CaveTalk_SerialBuffered(serial) >= remaining)
+    {
+        const uint8_t consume = serial->rx_consume;
+        const size_t  first   = serial->rx_lengths[consume] - serial->rx_head;
+        const size_t  index   = CAVE_TALK_LENGTH_INDEX - serial->rx_frame_offset;
+        const uint8_t length  = (index < first) ?
+                                serial->rx_buffers[consume][serial->rx_head + index] :
+                                serial->rx_buffers[consume ^ 1U][index - first];
+
+        remaining += length + CAVE_TALK_CRC_SIZE;
+    }
+
+    return remaining;
+}
+
+static bool CaveTalk_SerialLookupSpeed(const uint32_t baud_rate, speed_t *const speed)
+{
+    bool found = false;
+
+    for (size_t index = 0U; !found && (index < (sizeof(kCaveTalk_SerialSpeeds) / sizeof(kCaveTalk_SerialSpeeds[0]))); index++)
+    {
+        if (baud_rate == kCaveTalk_SerialSpeeds[index].baud_rate)
+        {
+            *speed = kCaveTalk_SerialSpeeds[index].speed;
+            found  = true;
+        }
+    }
+
+    return found;
+}
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include "cave_talk_udp.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+static CaveTalk_Error_t CaveTalk_UdpSend(void *const context, const void *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_UdpReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_UdpAvailable(void *const context, size_t *const bytes_available);
+static CaveTalk_Error_t CaveTalk_UdpNext(CaveTalk_Udp_t *const udp);
+static CaveTalk_Error_t CaveTalk_UdpReceiveBatch(CaveTalk_Udp_t *const udp);
+static bool CaveTalk_UdpValid(const uint8_t *const datagram, const size_t length);
+
+CaveTalk_Error_t CaveTalk_UdpOpen(CaveTalk_Udp_t *const udp,
+                                  const struct sockaddr *const local_address,
+                                  const socklen_t local_address_length,
+                                  const struct sockaddr *const peer_address,
+                                  const socklen_t peer_address_length,
+                                  const size_t batch,
+                                  CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == udp) || (NULL == local_address) || (NULL == link_handle))
+    {
+    }
+    else if ((0U == batch) ||
+             (batch > CAVE_TALK_UDP_BATCH_SIZE_MAX) ||
+             (local_address_length > sizeof(udp->peer_address)) ||
+             (peer_address_length > sizeof(udp->peer_address)))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        udp->fd                  = socket(local_address->sa_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        udp->peer_address_length = 0U;
+        udp->connected           = (NULL != peer_address);
+        udp->batch               = batch;
+        udp->rx_count            = 0U;
+        udp->rx_next             = 0U;
+        udp->rx_current          = 0U;
+        udp->rx_offset           = 0U;
+        udp->rx_length           = 0U;
+        udp->tx_count            = 0U;
+        memset(&udp->stats, 0, sizeof(udp->stats));
+        memset(udp->tx_lengths, 0, sizeof(udp->tx_lengths));
+
+        for (size_t index = 0U; index < CAVE_TALK_UDP_BATCH_SIZE_MAX; index++)
+        {
+            udp->rx_iovecs[index].iov_base = udp->rx_datagrams[index];
+            udp->rx_iovecs[index].iov_len  = CAVE_TALK_UDP_DATAGRAM_SIZE_MAX;
+            udp->tx_iovecs[index].iov_base = udp->tx_datagrams[index];
+            udp->tx_iovecs[index].iov_len  = 0U;
+        }
+
+        if ((udp->fd < 0) ||
+            (0 != bind(udp->fd, local_address, local_address_length)) ||
+            (udp->connected && (0 != connect(udp->fd, peer_address, peer_address_length))))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            CaveTalk_LinkBinding_t binding;
+
+            if (udp->connected)
+            {
+                memcpy(&udp->peer_address, peer_address, peer_address_length);
+                udp->peer_address_length = peer_address_length;
+            }
+
+            binding.context   = udp;
+            binding.send      = CaveTalk_UdpSend;
+            binding.receive   = CaveTalk_UdpReceive;
+            binding.available = CaveTalk_UdpAvailable;
+
+            error = CaveTalk_LinkBind(&binding, &udp->link_handle);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            *link_handle = udp->link_handle;
+        }
+        else if (udp->fd >= 0)
+        {
+            close(udp->fd);
+            udp->fd = -1;
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_UdpFlush(CaveTalk_Udp_t *const udp)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == udp) || (udp->fd < 0))
+    {
+    }
+    else if (0U == udp->peer_address_length)
+    {
+        /* Nobody to send to until a peer is heard, queued frames are dropped like on a lossy link */
+        error = (0U == udp->tx_count) ? CAVE_TALK_ERROR_NONE : CAVE_TALK_ERROR_SOCKET_CLOSED;
+
+        udp->tx_count      = 0U;
+        udp->tx_lengths[0] = 0U;
+    }
+    else
+    {
+        size_t sent = 0U;
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        for (size_t index = 0U; index < udp->tx_count; index++)
+        {
+            memset(&udp->tx_messages[index], 0, sizeof(udp->tx_messages[index]));
+            udp->tx_iovecs[index].iov_len               = udp->tx_lengths[index];
+            udp->tx_messages[index].msg_hdr.msg_iov     = &udp->tx_iovecs[index];
+            udp->tx_messages[index].msg_hdr.msg_iovlen  = 1U;
+            udp->tx_messages[index].msg_hdr.msg_name    = udp->connected ? NULL : &udp->peer_address;
+            udp->tx_messages[index].msg_hdr.msg_namelen = udp->connected ? 0U : udp->peer_address_length;
+        }
+
+        while ((CAVE_TALK_ERROR_NONE == error) && (sent < udp->tx_count))
+        {
+            const int result = sendmmsg(udp->fd, &udp->tx_messages[sent], (unsigned int)(udp->tx_count - sent), 0);
+
+            udp->stats.send_calls++;
+
+            if (result > 0)
+            {
+                sent                      += (size_t)result;
+                udp->stats.datagrams_sent += (uint64_t)result;
+            }
+            else if ((result < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+            {
+                struct pollfd poll_fd = {.fd = udp->fd, .events = POLLOUT, .revents = 0};
+
+                if ((poll(&poll_fd, 1U, -1) < 0) && (EINTR != errno))
+                {
+                    error = CAVE_TALK_ERROR_IO;
+                }
+            }
+            else if ((result < 0) && (EINTR == errno))
+            {
+            }
+            else if ((result < 0) && (ECONNREFUSED == errno))
+            {
+                /* The peer is not up yet, the datagram is lost like any other */
+                sent++;
+            }
+            else
+            {
+                error = CAVE_TALK_ERROR_IO;
+            }
+        }
+
+        udp->tx_count      = 0U;
+        udp->tx_lengths[0] = 0U;
+    }
+
+    return error;
+}
+
+/* Matches CaveTalk_LinkWait_t so deadline bounded listens can sleep on the socket */
+CaveTalk_Error_t CaveTalk_UdpWait(void *const udp, const CaveTalk_Microseconds_t timeout)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == udp) || (((CaveTalk_Udp_t *)udp)->fd < 0))
+    {
+    }
+    else
+    {
+        struct pollfd         poll_fd  = {.fd = ((CaveTalk_Udp_t *)udp)->fd, .events = POLLIN, .revents = 0};
+        const struct timespec duration = {.tv_sec = (time_t)(timeout / 1000000U), .tv_nsec = (long)((timeout % 1000000U) * 1000U)};
+
+        /* An interrupted wait returns early, the caller checks its deadline again */
+        error = ((ppoll(&poll_fd, 1U, &duration, NULL) < 0) && (EINTR != errno)) ? CAVE_TALK_ERROR_IO : CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_UdpClose(CaveTalk_Udp_t *const udp)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == udp) || (udp->fd < 0))
+    {
+    }
+    else
+    {
+        error = CaveTalk_UdpFlush(udp);
+
+        if (CAVE_TALK_ERROR_SOCKET_CLOSED == error)
+        {
+            error = CAVE_TALK_ERROR_NONE;
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            error = CaveTalk_LinkUnbind(&udp->link_handle);
+        }
+        else
+        {
+            CaveTalk_LinkUnbind(&udp->link_handle);
+        }
+
+        close(udp->fd);
+        udp->fd = -1;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UdpSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Udp_t *const udp   = (CaveTalk_Udp_t *)context;
+    CaveTalk_Error_t      error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) && (0U != size))
+    {
+    }
+    else if ((udp->tx_lengths[udp->tx_count] + size) > CAVE_TALK_UDP_DATAGRAM_SIZE_MAX)
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        uint8_t *const datagram = udp->tx_datagrams[udp->tx_count];
+
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Speak sends the header, payload and CRC separately, they are gathered into one datagram */
+        if (0U != size)
+        {
+            memcpy(datagram + udp->tx_lengths[udp->tx_count], data, size);
+            udp->tx_lengths[udp->tx_count] += size;
+        }
+
+        if ((udp->tx_lengths[udp->tx_count] >= CAVE_TALK_HEADER_SIZE) &&
+            (udp->tx_lengths[udp->tx_count] >= (CAVE_TALK_HEADER_SIZE + datagram[CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE)))
+        {
+            udp->tx_count++;
+
+            if (udp->tx_count >= udp->batch)
+            {
+                error = CaveTalk_UdpFlush(udp);
+            }
+            else
+            {
+                udp->tx_lengths[udp->tx_count] = 0U;
+            }
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UdpReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Udp_t *const udp   = (CaveTalk_Udp_t *)context;
+    CaveTalk_Error_t      error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) || (NULL == bytes_received))
+    {
+    }
+    else
+    {
+        error = CaveTalk_UdpNext(udp);
+
+        /* Reads never cross into the next datagram, so a truncated frame cannot swallow the start of the next one */
+        *bytes_received = ((udp->rx_length - udp->rx_offset) < size) ? (udp->rx_length - udp->rx_offset) : size;
+
+        if (0U != *bytes_received)
+        {
+            memcpy(data, &udp->rx_datagrams[udp->rx_current][udp->rx_offset], *bytes_received);
+            udp->rx_offset += *bytes_received;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UdpAvailable(void *const context, size_t *const bytes_available)
+{
+    CaveTalk_Udp_t *const udp   = (CaveTalk_Udp_t *)context;
+    CaveTalk_Error_t      error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == bytes_available)
+    {
+    }
+    else
+    {
+        error            = CaveTalk_UdpNext(udp);
+        *bytes_available = udp->rx_length - udp->rx_offset;
+    }
+
+    return error;
+}
+
+/* Moves on to the next valid datagram once the current one is consumed, receiving a new batch when none are left */
+static CaveTalk_Error_t CaveTalk_UdpNext(CaveTalk_Udp_t *const udp)
+{
+    CaveTalk_Error_t error   = CAVE_TALK_ERROR_NONE;
+    bool             fetched = false;
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (udp->rx_offset == udp->rx_length) && ((udp->rx_next < udp->rx_count) || !fetched))
+    {
+        if (udp->rx_next < udp->rx_count)
+        {
+            const struct msghdr *const header = &udp->rx_messages[udp->rx_next].msg_hdr;
+            const size_t               length = udp->rx_messages[udp->rx_next].msg_len;
+
+            udp->rx_current = udp->rx_next;
+            udp->rx_offset  = 0U;
+            udp->rx_length  = 0U;
+            udp->rx_next++;
+
+            if ((0U != (header->msg_flags & MSG_TRUNC)) || !CaveTalk_UdpValid(udp->rx_datagrams[udp->rx_current], length))
+            {
+                udp->stats.datagrams_dropped++;
+            }
+            else
+            {
+                udp->rx_length = length;
+
+                if (!udp->connected)
+                {
+                    memcpy(&udp->peer_address, header->msg_name, header->msg_namelen);
+                    udp->peer_address_length = header->msg_namelen;
+                }
+            }
+        }
+        else
+        {
+            error   = CaveTalk_UdpReceiveBatch(udp);
+            fetched = true;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UdpReceiveBatch(CaveTalk_Udp_t *const udp)
+{
+    CaveTalk_Error_t error  = CAVE_TALK_ERROR_NONE;
+    int              result = 0;
+
+    for (size_t index = 0U; index < CAVE_TALK_UDP_BATCH_SIZE_MAX; index++)
+    {
+        memset(&udp->rx_messages[index], 0, sizeof(udp->rx_messages[index]));
+        udp->rx_messages[index].msg_hdr.msg_iov     = &udp->rx_iovecs[index];
+        udp->rx_messages[index].msg_hdr.msg_iovlen  = 1U;
+        udp->rx_messages[index].msg_hdr.msg_name    = &udp->rx_addresses[index];
+        udp->rx_messages[index].msg_hdr.msg_namelen = sizeof(udp->rx_addresses[index]);
+    }
+
+    result = recvmmsg(udp->fd, udp->rx_messages, CAVE_TALK_UDP_BATCH_SIZE_MAX, MSG_DONTWAIT, NULL);
+
+    udp->stats.receive_calls++;
+    udp->rx_next = 0U;
+
+    if (result > 0)
+    {
+        udp->rx_count                  = (size_t)result;
+        udp->stats.datagrams_received += (uint64_t)result;
+    }
+    else
+    {
+        udp->rx_count = 0U;
+
+        if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno) && (ECONNREFUSED != errno))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+    }
+
+    return error;
+}
+
+/* A datagram is accepted only when it holds whole frames and nothing else */
+static bool CaveTalk_UdpValid(const uint8_t *const datagram, const size_t length)
+{
+    CaveTalk_FrameParser_t parser;
+    CaveTalk_Error_t       error  = CAVE_TALK_ERROR_NONE;
+    size_t                 offset = 0U;
+
+    CaveTalk_FrameParserInit(&parser, NULL, 0U);
+
+    while ((CAVE_TALK_ERROR_NONE == error) && (offset < length))
+    {
+        size_t            consumed = 0U;
+        CaveTalk_Id_t     id       = CAVE_TALK_ID_NONE;
+        CaveTalk_Length_t payload  = 0U;
+
+        error   = CaveTalk_FrameParse(&parser, datagram + offset, length - offset, &consumed, &id, &payload);
+        offset += consumed;
+    }
+
+    return (0U != length) && (CAVE_TALK_ERROR_NONE == error);
+}
\ No newline at end of file
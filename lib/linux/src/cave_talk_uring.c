@@ -0,0 +1,654 @@
+#include "cave_talk_uring.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+#define CAVE_TALK_URING_ENTRIES      8U
+#define CAVE_TALK_URING_BUFFER_GROUP 0U
+#define CAVE_TALK_URING_RECEIVE      0U
+#define CAVE_TALK_URING_SEND         1U /* Plus the send buffer index */
+#define CAVE_TALK_URING_READ         49U /* IORING_OP_READ_MULTISHOT from Linux 6.7, older headers lack it */
+
+static CaveTalk_Error_t CaveTalk_UringSend(void *const context, const void *const data, const size_t size);
+static CaveTalk_Error_t CaveTalk_UringReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received);
+static CaveTalk_Error_t CaveTalk_UringAvailable(void *const context, size_t *const bytes_available);
+static CaveTalk_Error_t CaveTalk_UringSetup(CaveTalk_Uring_t *const uring);
+static void CaveTalk_UringTeardown(CaveTalk_Uring_t *const uring);
+static struct io_uring_sqe *CaveTalk_UringSqe(CaveTalk_Uring_t *const uring);
+static CaveTalk_Error_t CaveTalk_UringEnter(CaveTalk_Uring_t *const uring, const uint32_t wait_for, const void *const argument, const size_t argument_size);
+static void CaveTalk_UringReap(CaveTalk_Uring_t *const uring);
+static void CaveTalk_UringArm(CaveTalk_Uring_t *const uring);
+static void CaveTalk_UringProvide(CaveTalk_Uring_t *const uring, const uint16_t id);
+static bool CaveTalk_UringParse(CaveTalk_Uring_t *const uring);
+static void CaveTalk_UringQueueSend(CaveTalk_Uring_t *const uring, const uint8_t half);
+static CaveTalk_Error_t CaveTalk_UringSendBuffered(CaveTalk_Uring_t *const uring, const size_t size);
+
+CaveTalk_Error_t CaveTalk_UringOpen(CaveTalk_Uring_t *const uring,
+                                    const int fd,
+                                    const size_t batch,
+                                    void *const buffer,
+                                    const size_t buffer_size,
+                                    CaveTalk_LinkHandle_t *const link_handle)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == uring) || (NULL == buffer) || (NULL == link_handle))
+    {
+    }
+    else if ((buffer_size < CAVE_TALK_URING_BUFFER_SIZE_MIN) || (0U == batch) || (batch > CAVE_TALK_URING_BATCH_SIZE_MAX))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        struct stat status;
+
+        memset(uring, 0, sizeof(*uring));
+        uring->fd          = fd;
+        uring->ring_fd     = -1;
+        uring->buffers     = (uint8_t *)buffer;
+        uring->buffer_size = buffer_size / CAVE_TALK_URING_BUFFER_COUNT;
+        uring->batch       = batch;
+        uring->tx_error    = CAVE_TALK_ERROR_NONE;
+        CaveTalk_FrameParserInit(&uring->parser, &uring->rx_frame[CAVE_TALK_HEADER_SIZE], UINT8_MAX);
+
+        if ((fd < 0) || (0 != fstat(fd, &status)))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            uring->socket = S_ISSOCK(status.st_mode);
+
+            error = CaveTalk_UringSetup(uring);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            CaveTalk_LinkBinding_t binding;
+
+            binding.context   = uring;
+            binding.send      = CaveTalk_UringSend;
+            binding.receive   = CaveTalk_UringReceive;
+            binding.available = CaveTalk_UringAvailable;
+
+            error = CaveTalk_LinkBind(&binding, &uring->link_handle);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            CaveTalk_UringArm(uring);
+            error        = CaveTalk_UringEnter(uring, 0U, NULL, 0U);
+            *link_handle = uring->link_handle;
+        }
+
+        if (CAVE_TALK_ERROR_NONE != error)
+        {
+            CaveTalk_LinkUnbind(&uring->link_handle);
+            CaveTalk_UringTeardown(uring);
+        }
+    }
+
+    return error;
+}
+
+/* Sends everything queued, including any bytes that do not complete a frame */
+CaveTalk_Error_t CaveTalk_UringFlush(CaveTalk_Uring_t *const uring)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == uring) || (uring->ring_fd < 0))
+    {
+    }
+    else
+    {
+        error = CaveTalk_UringSendBuffered(uring, uring->tx_lengths[uring->tx_fill]);
+    }
+
+    return error;
+}
+
+/* Matches CaveTalk_LinkWait_t so deadline bounded listens can sleep until the multishot receive completes */
+CaveTalk_Error_t CaveTalk_UringWait(void *const uring, const CaveTalk_Microseconds_t timeout)
+{
+    CaveTalk_Uring_t *const link  = (CaveTalk_Uring_t *)uring;
+    CaveTalk_Error_t        error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == link) || (link->ring_fd < 0))
+    {
+    }
+    else
+    {
+        struct __kernel_timespec      duration = {.tv_sec = (int64_t)(timeout / 1000000U), .tv_nsec = (long long)((timeout % 1000000U) * 1000U)};
+        struct io_uring_getevents_arg argument;
+
+        memset(&argument, 0, sizeof(argument));
+        argument.sigmask_sz = _NSIG / 8;
+        argument.ts         = (uint64_t)(uintptr_t)&duration;
+
+        CaveTalk_UringReap(link);
+        CaveTalk_UringArm(link);
+        error = CAVE_TALK_ERROR_NONE;
+
+        /* Nothing to wait for when bytes are already buffered or the peer is gone */
+        if ((0U == link->rx_count) && (link->rx_frame_offset >= link->rx_frame_size) && !link->closed)
+        {
+            error = CaveTalk_UringEnter(link, 1U, &argument, sizeof(argument));
+        }
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t CaveTalk_UringClose(CaveTalk_Uring_t *const uring)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == uring) || (uring->ring_fd < 0))
+    {
+    }
+    else
+    {
+        error = CaveTalk_UringFlush(uring);
+
+        /* Wait for the last send, the buffer it reads from goes away with the ring */
+        while (uring->tx_in_flight[uring->tx_fill ^ 1U] && (CAVE_TALK_ERROR_NONE == CaveTalk_UringEnter(uring, 1U, NULL, 0U)))
+        {
+            CaveTalk_UringReap(uring);
+        }
+
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            error = CaveTalk_LinkUnbind(&uring->link_handle);
+        }
+        else
+        {
+            CaveTalk_LinkUnbind(&uring->link_handle);
+        }
+
+        CaveTalk_UringTeardown(uring);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UringSend(void *const context, const void *const data, const size_t size)
+{
+    CaveTalk_Uring_t *const uring = (CaveTalk_Uring_t *)context;
+    CaveTalk_Error_t        error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) && (0U != size))
+    {
+    }
+    else if (size > sizeof(uring->tx_buffers[0]))
+    {
+        error = CAVE_TALK_ERROR_SIZE;
+    }
+    else
+    {
+        /* A failed send is reported by the next one */
+        error           = uring->tx_error;
+        uring->tx_error = CAVE_TALK_ERROR_NONE;
+
+        /* Whole frames go out first, and everything queued if that still leaves no room */
+        while ((CAVE_TALK_ERROR_NONE == error) && ((uring->tx_lengths[uring->tx_fill] + size) > sizeof(uring->tx_buffers[0])))
+        {
+            error = CaveTalk_UringSendBuffered(uring, (0U == uring->tx_frame_start) ? uring->tx_lengths[uring->tx_fill] : uring->tx_frame_start);
+        }
+
+        if ((CAVE_TALK_ERROR_NONE == error) && (0U != size))
+        {
+            uint8_t *const buffer = uring->tx_buffers[uring->tx_fill];
+            bool           whole  = true;
+
+            memcpy(&buffer[uring->tx_lengths[uring->tx_fill]], data, size);
+            uring->tx_lengths[uring->tx_fill] += size;
+
+            /* Speak sends the header, payload and CRC separately, only whole frames count towards the batch */
+            while (whole)
+            {
+                const size_t queued = uring->tx_lengths[uring->tx_fill] - uring->tx_frame_start;
+
+                whole = (queued >= CAVE_TALK_HEADER_SIZE) &&
+                        (queued >= (CAVE_TALK_HEADER_SIZE + buffer[uring->tx_frame_start + CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE));
+
+                if (whole)
+                {
+                    uring->tx_frame_start += CAVE_TALK_HEADER_SIZE + buffer[uring->tx_frame_start + CAVE_TALK_LENGTH_INDEX] + CAVE_TALK_CRC_SIZE;
+                    uring->tx_frames++;
+                }
+            }
+
+            if (uring->tx_frames >= uring->batch)
+            {
+                error = CaveTalk_UringSendBuffered(uring, uring->tx_frame_start);
+            }
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UringReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    CaveTalk_Uring_t *const uring = (CaveTalk_Uring_t *)context;
+    CaveTalk_Error_t        error = CAVE_TALK_ERROR_NULL;
+
+    if ((NULL == data) || (NULL == bytes_received))
+    {
+    }
+    else
+    {
+        size_t available = 0U;
+
+        error = CaveTalk_UringAvailable(uring, &available);
+
+        *bytes_received = (available < size) ? available : size;
+
+        if (0U != *bytes_received)
+        {
+            memcpy(data, &uring->rx_frame[uring->rx_frame_offset], *bytes_received);
+            uring->rx_frame_offset += *bytes_received;
+        }
+    }
+
+    return error;
+}
+
+/* Reports the rest of the frame being received, parsing the next one out of the completed buffers when there is none.
+ * Nothing is reported until a frame is complete, so Listen never consumes half a frame. */
+static CaveTalk_Error_t CaveTalk_UringAvailable(void *const context, size_t *const bytes_available)
+{
+    CaveTalk_Uring_t *const uring = (CaveTalk_Uring_t *)context;
+    CaveTalk_Error_t        error = CAVE_TALK_ERROR_NULL;
+
+    if (NULL == bytes_available)
+    {
+    }
+    else
+    {
+        error = CAVE_TALK_ERROR_NONE;
+
+        if ((uring->rx_frame_offset >= uring->rx_frame_size) && !CaveTalk_UringParse(uring))
+        {
+            CaveTalk_UringReap(uring);
+
+            if (!CaveTalk_UringParse(uring))
+            {
+                CaveTalk_UringArm(uring);
+            }
+
+            /* Rearming and resending after a short write are the only submissions made while listening */
+            if (0U != uring->pending_submissions)
+            {
+                error = CaveTalk_UringEnter(uring, 0U, NULL, 0U);
+            }
+        }
+
+        *bytes_available = uring->rx_frame_size - uring->rx_frame_offset;
+
+        if ((CAVE_TALK_ERROR_NONE == error) && (0U == *bytes_available) && uring->closed && (0U == uring->rx_count))
+        {
+            error = CAVE_TALK_ERROR_SOCKET_CLOSED;
+        }
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t CaveTalk_UringSetup(CaveTalk_Uring_t *const uring)
+{
+    CaveTalk_Error_t       error = CAVE_TALK_ERROR_NONE;
+    struct io_uring_params params;
+
+    memset(&params, 0, sizeof(params));
+    uring->ring_fd     = (int)syscall(__NR_io_uring_setup, CAVE_TALK_URING_ENTRIES, &params);
+    uring->rings       = MAP_FAILED;
+    uring->sqes        = MAP_FAILED;
+    uring->buffer_ring = MAP_FAILED;
+
+    /* Kernels without a single mapping for both rings also lack multishot receives */
+    if ((uring->ring_fd < 0) || (0U == (params.features & IORING_FEAT_SINGLE_MMAP)))
+    {
+        error = CAVE_TALK_ERROR_IO;
+    }
+    else
+    {
+        const size_t sq_size = params.sq_off.array + (params.sq_entries * sizeof(uint32_t));
+        const size_t cq_size = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+
+        uring->rings_size       = (sq_size > cq_size) ? sq_size : cq_size;
+        uring->sqes_size        = params.sq_entries * sizeof(struct io_uring_sqe);
+        uring->buffer_ring_size = CAVE_TALK_URING_BUFFER_COUNT * sizeof(struct io_uring_buf);
+        uring->rings            = mmap(NULL, uring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQ_RING);
+        uring->sqes             = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQES);
+        uring->buffer_ring      = mmap(NULL, uring->buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+
+    if ((CAVE_TALK_ERROR_NONE != error) || (MAP_FAILED == uring->rings) || (MAP_FAILED == uring->sqes) || (MAP_FAILED == uring->buffer_ring))
+    {
+        error = CAVE_TALK_ERROR_IO;
+    }
+    else
+    {
+        uint8_t *const          rings = (uint8_t *)uring->rings;
+        struct io_uring_buf_reg registration;
+
+        uring->sq_head  = (uint32_t *)(void *)(rings + params.sq_off.head);
+        uring->sq_tail  = (uint32_t *)(void *)(rings + params.sq_off.tail);
+        uring->sq_array = (uint32_t *)(void *)(rings + params.sq_off.array);
+        uring->sq_mask  = *(uint32_t *)(void *)(rings + params.sq_off.ring_mask);
+        uring->cq_head  = (uint32_t *)(void *)(rings + params.cq_off.head);
+        uring->cq_tail  = (uint32_t *)(void *)(rings + params.cq_off.tail);
+        uring->cq_mask  = *(uint32_t *)(void *)(rings + params.cq_off.ring_mask);
+        uring->cqes     = (struct io_uring_cqe *)(void *)(rings + params.cq_off.cqes);
+
+        memset(&registration, 0, sizeof(registration));
+        registration.ring_addr    = (uint64_t)(uintptr_t)uring->buffer_ring;
+        registration.ring_entries = CAVE_TALK_URING_BUFFER_COUNT;
+        registration.bgid         = CAVE_TALK_URING_BUFFER_GROUP;
+
+        if (0 != syscall(__NR_io_uring_register, uring->ring_fd, IORING_REGISTER_PBUF_RING, &registration, 1U))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+        else
+        {
+            for (uint16_t id = 0U; id < CAVE_TALK_URING_BUFFER_COUNT; id++)
+            {
+                CaveTalk_UringProvide(uring, id);
+            }
+        }
+    }
+
+    return error;
+}
+
+static void CaveTalk_UringTeardown(CaveTalk_Uring_t *const uring)
+{
+    /* Closing the ring cancels the multishot receive */
+    if (uring->ring_fd >= 0)
+    {
+        close(uring->ring_fd);
+        uring->ring_fd = -1;
+    }
+
+    if (MAP_FAILED != uring->rings)
+    {
+        munmap(uring->rings, uring->rings_size);
+        uring->rings = MAP_FAILED;
+    }
+
+    if (MAP_FAILED != (void *)uring->sqes)
+    {
+        munmap(uring->sqes, uring->sqes_size);
+        uring->sqes = MAP_FAILED;
+    }
+
+    if (MAP_FAILED != (void *)uring->buffer_ring)
+    {
+        munmap(uring->buffer_ring, uring->buffer_ring_size);
+        uring->buffer_ring = MAP_FAILED;
+    }
+}
+
+/* At most a receive and one send are in flight, so the submission queue never fills */
+static struct io_uring_sqe *CaveTalk_UringSqe(CaveTalk_Uring_t *const uring)
+{
+    const uint32_t             tail = *uring->sq_tail;
+    struct io_uring_sqe *const sqe  = &uring->sqes[tail & uring->sq_mask];
+
+    memset(sqe, 0, sizeof(*sqe));
+    uring->sq_array[tail & uring->sq_mask] = tail & uring->sq_mask;
+    atomic_store_explicit((atomic_uint_least32_t *)uring->sq_tail, tail + 1U, memory_order_release);
+    uring->pending_submissions++;
+
+    return sqe;
+}
+
+static CaveTalk_Error_t CaveTalk_UringEnter(CaveTalk_Uring_t *const uring, const uint32_t wait_for, const void *const argument, const size_t argument_size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+    const uint32_t   flags = ((0U == wait_for) ? 0U : IORING_ENTER_GETEVENTS) | ((NULL == argument) ? 0U : IORING_ENTER_EXT_ARG);
+
+    if ((0U != uring->pending_submissions) || (0U != wait_for))
+    {
+        const long result = syscall(__NR_io_uring_enter, uring->ring_fd, uring->pending_submissions, wait_for, flags, argument, argument_size);
+
+        uring->stats.enters++;
+
+        if (result >= 0)
+        {
+            uring->stats.submissions   += (uint64_t)result;
+            uring->pending_submissions -= ((uint32_t)result < uring->pending_submissions) ? (uint32_t)result : uring->pending_submissions;
+        }
+        else if ((EINTR != errno) && (ETIME != errno) && (EAGAIN != errno) && (EBUSY != errno))
+        {
+            error = CAVE_TALK_ERROR_IO;
+        }
+    }
+
+    return error;
+}
+
+/* Completions are read from shared memory, reaping never makes a system call */
+static void CaveTalk_UringReap(CaveTalk_Uring_t *const uring)
+{
+    uint32_t       head = *uring->cq_head;
+    const uint32_t tail = atomic_load_explicit((atomic_uint_least32_t *)uring->cq_tail, memory_order_acquire);
+
+    while (head != tail)
+    {
+        const struct io_uring_cqe *const cqe = &uring->cqes[head & uring->cq_mask];
+
+        uring->stats.completions++;
+
+        if (CAVE_TALK_URING_RECEIVE == cqe->user_data)
+        {
+            if (0U != (cqe->flags & IORING_CQE_F_BUFFER))
+            {
+                const uint16_t id = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+
+                if (cqe->res > 0)
+                {
+                    const size_t last = (uring->rx_first + uring->rx_count) % CAVE_TALK_URING_BUFFER_COUNT;
+
+                    uring->rx_ids[last]      = id;
+                    uring->rx_lengths[last]  = (uint32_t)cqe->res;
+                    uring->rx_count         += 1U;
+                    uring->stats.bytes_read += (uint64_t)cqe->res;
+                }
+                else
+                {
+                    CaveTalk_UringProvide(uring, id);
+                }
+            }
+
+            /* Running out of buffers ends the receive until some are parsed and provided again, any other end than
+             * that means the peer is gone */
+            if ((0 == cqe->res) || ((cqe->res < 0) && (-ENOBUFS != cqe->res)))
+            {
+                uring->closed = true;
+            }
+
+            if (0U == (cqe->flags & IORING_CQE_F_MORE))
+            {
+                uring->receiving = false;
+            }
+        }
+        else
+        {
+            const uint8_t half = (uint8_t)(cqe->user_data - CAVE_TALK_URING_SEND);
+
+            if (cqe->res > 0)
+            {
+                uring->tx_sent[half]       += (size_t)cqe->res;
+                uring->stats.bytes_written += (uint64_t)cqe->res;
+            }
+            else if ((-EAGAIN != cqe->res) && (-EINTR != cqe->res))
+            {
+                uring->tx_sent[half] = uring->tx_lengths[half];
+                uring->tx_error      = CAVE_TALK_ERROR_IO;
+            }
+
+            /* A short send is resubmitted from where it stopped, it is the only send in flight so order is kept */
+            if (uring->tx_sent[half] < uring->tx_lengths[half])
+            {
+                CaveTalk_UringQueueSend(uring, half);
+            }
+            else
+            {
+                uring->tx_lengths[half]   = 0U;
+                uring->tx_sent[half]      = 0U;
+                uring->tx_in_flight[half] = false;
+            }
+        }
+
+        head++;
+    }
+
+    atomic_store_explicit((atomic_uint_least32_t *)uring->cq_head, head, memory_order_release);
+}
+
+/* Rearms the multishot receive once it has ended, as long as there are buffers for it to complete into */
+static void CaveTalk_UringArm(CaveTalk_Uring_t *const uring)
+{
+    if (!uring->receiving && !uring->closed && (uring->rx_count < CAVE_TALK_URING_BUFFER_COUNT))
+    {
+        struct io_uring_sqe *const sqe = CaveTalk_UringSqe(uring);
+
+        sqe->opcode    = uring->socket ? IORING_OP_RECV : CAVE_TALK_URING_READ;
+        sqe->fd        = uring->fd;
+        sqe->ioprio    = uring->socket ? IORING_RECV_MULTISHOT : 0U;
+        sqe->flags     = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = CAVE_TALK_URING_BUFFER_GROUP;
+        sqe->user_data = CAVE_TALK_URING_RECEIVE;
+
+        uring->receiving = true;
+    }
+}
+
+static void CaveTalk_UringProvide(CaveTalk_Uring_t *const uring, const uint16_t id)
+{
+    struct io_uring_buf *const buffer = &uring->buffer_ring->bufs[uring->buffer_tail & (CAVE_TALK_URING_BUFFER_COUNT - 1U)];
+
+    buffer->addr = (uint64_t)(uintptr_t)&uring->buffers[id * uring->buffer_size];
+    buffer->len  = (uint32_t)uring->buffer_size;
+    buffer->bid  = id;
+    uring->buffer_tail++;
+
+    atomic_store_explicit((atomic_uint_least16_t *)&uring->buffer_ring->tail, uring->buffer_tail, memory_order_release);
+}
+
+/* Feeds completed buffers through the frame parser until a frame completes, giving back each buffer once parsed */
+static bool CaveTalk_UringParse(CaveTalk_Uring_t *const uring)
+{
+    bool complete = false;
+
+    while (!complete && (0U != uring->rx_count))
+    {
+        const uint16_t    id       = uring->rx_ids[uring->rx_first];
+        const uint32_t    length   = uring->rx_lengths[uring->rx_first];
+        size_t            consumed = 0U;
+        CaveTalk_Id_t     frame_id = CAVE_TALK_ID_NONE;
+        CaveTalk_Length_t payload  = 0U;
+
+        complete = (CAVE_TALK_ERROR_NONE == CaveTalk_FrameParse(&uring->parser,
+                                                                &uring->buffers[(id * uring->buffer_size) + uring->rx_offset],
+                                                                length - uring->rx_offset,
+                                                                &consumed,
+                                                                &frame_id,
+                                                                &payload));
+        uring->rx_offset += consumed;
+
+        if (uring->rx_offset >= length)
+        {
+            CaveTalk_UringProvide(uring, id);
+            uring->rx_first   = (uring->rx_first + 1U) % CAVE_TALK_URING_BUFFER_COUNT;
+            uring->rx_count  -= 1U;
+            uring->rx_offset  = 0U;
+        }
+
+        /* The payload was parsed in place, the header and CRC are put back around it */
+        if (complete)
+        {
+            memcpy(uring->rx_frame, uring->parser.header, CAVE_TALK_HEADER_SIZE);
+            memcpy(&uring->rx_frame[CAVE_TALK_HEADER_SIZE + payload], uring->parser.crc, CAVE_TALK_CRC_SIZE);
+            uring->rx_frame_size   = CAVE_TALK_HEADER_SIZE + payload + CAVE_TALK_CRC_SIZE;
+            uring->rx_frame_offset = 0U;
+        }
+    }
+
+    return complete;
+}
+
+static void CaveTalk_UringQueueSend(CaveTalk_Uring_t *const uring, const uint8_t half)
+{
+    struct io_uring_sqe *const sqe = CaveTalk_UringSqe(uring);
+
+    sqe->opcode    = uring->socket ? IORING_OP_SEND : IORING_OP_WRITE;
+    sqe->fd        = uring->fd;
+    sqe->addr      = (uint64_t)(uintptr_t)&uring->tx_buffers[half][uring->tx_sent[half]];
+    sqe->len       = (uint32_t)(uring->tx_lengths[half] - uring->tx_sent[half]);
+    sqe->off       = uring->socket ? 0U : (uint64_t)-1;
+    sqe->msg_flags = uring->socket ? MSG_NOSIGNAL : 0U;
+    sqe->user_data = CAVE_TALK_URING_SEND + half;
+}
+
+/* Submits the first size bytes of the buffer being filled and carries the rest over to the other buffer. Only one send
+ * is ever in flight, the previous one is waited for first since the kernel does not order independent requests. */
+static CaveTalk_Error_t CaveTalk_UringSendBuffered(CaveTalk_Uring_t *const uring, const size_t size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+    const uint8_t    half  = uring->tx_fill;
+    const uint8_t    next  = half ^ 1U;
+
+    CaveTalk_UringReap(uring);
+
+    while ((CAVE_TALK_ERROR_NONE == error) && uring->tx_in_flight[next])
+    {
+        error = CaveTalk_UringEnter(uring, 1U, NULL, 0U);
+        CaveTalk_UringReap(uring);
+    }
+
+    if ((CAVE_TALK_ERROR_NONE == error) && (0U != size))
+    {
+        const size_t rest = uring->tx_lengths[half] - size;
+
+        memcpy(uring->tx_buffers[next], &uring->tx_buffers[half][size], rest);
+        uring->tx_lengths[next]   = rest;
+        uring->tx_lengths[half]   = size;
+        uring->tx_sent[half]      = 0U;
+        uring->tx_in_flight[half] = true;
+        uring->tx_fill            = next;
+        uring->tx_frame_start     = 0U;
+        uring->tx_frames          = 0U;
+
+        CaveTalk_UringQueueSend(uring, half);
+        error = CaveTalk_UringEnter(uring, 0U, NULL, 0U);
+    }
+
+    if (CAVE_TALK_ERROR_NONE == error)
+    {
+        error           = uring->tx_error;
+        uring->tx_error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <new>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk.h"
+#include "cave_talk_link.h"
+#include "cave_talk_negotiation.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+// Every allocation in the test binary goes through here, those made on a thread while it is counting are counted
+static thread_local bool counting          = false;
+static thread_local std::size_t allocations = 0U;
+
+void *operator new(std::size_t size)
+{
+    void *const pointer = std::malloc((0U == size) ? 1U : size);
+
+    if (nullptr == pointer)
+    {
+        throw std::bad_alloc();
+    }
+
+    if (counting)
+    {
+        allocations++;
+    }
+
+    return pointer;
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    const std::size_t align   = static_cast<std::size_t>(alignment);
+    void *const       pointer = std::aligned_alloc(align, ((size + align - 1U) / align) * align);
+
+    if (nullptr == pointer)
+    {
+        throw std::bad_alloc();
+    }
+
+    if (counting)
+    {
+        allocations++;
+    }
+
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+static RingBuffer<uint8_t, 1024U> allocation_link;
+static CaveTalk_Microseconds_t allocation_now = 0U;
+
+static CaveTalk_Microseconds_t AllocationClock(void)
+{
+    return allocation_now;
+}
+
+static CaveTalk_Error_t AllocationSend(const void *const data, const size_t size)
+{
+    return (size == allocation_link.Write(static_cast<const uint8_t *>(data), size)) ? CAVE_TALK_ERROR_NONE : CAVE_TALK_ERROR_INCOMPLETE;
+}
+
+static CaveTalk_Error_t AllocationReceive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received = allocation_link.Read(static_cast<uint8_t *>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t AllocationAvailable(size_t *const bytes_available)
+{
+    *bytes_available = allocation_link.Size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+// Handlers may run on several Dispatcher workers at once
+class CountingCallbacks : public cave_talk::ListenerCallbacks
+{
+    public:
+        void HearOogaBooga(const cave_talk::Say) override
+        {
+            heard++;
+        }
+        void HearMovement(const CaveTalk_MetersPerSecond_t, const CaveTalk_RadiansPerSecond_t) override
+        {
+            heard++;
+        }
+        void HearCameraMovement(const CaveTalk_Radian_t, const CaveTalk_Radian_t) override
+        {
+            heard++;
+        }
+        void HearLights(const bool) override
+        {
+            heard++;
+        }
+        void HearMode(const bool) override
+        {
+            heard++;
+        }
+        void HearObject(const CaveTalk_Id_t, const uint8_t *const, const std::size_t) override
+        {
+            heard++;
+        }
+        std::atomic<std::size_t> heard = 0U;
+};
+
+// One of every message each round, spoken and heard back through reliable delivery, pacing, delta encoding and heartbeats
+static void SpeakAndListen(cave_talk::Talker &talker, cave_talk::Listener &listener, cave_talk::Heartbeat &heartbeat, const std::size_t rounds)
+{
+    for (std::size_t round = 0U; round < rounds; round++)
+    {
+        allocation_now += 1000U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, talker.SpeakOogaBooga(cave_talk::SAY_OOGA));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, talker.SpeakMovement(0.001 * static_cast<double>(round), -0.5));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, talker.SpeakCameraMovement(0.25, 0.001 * static_cast<double>(round)));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, talker.SpeakLights(0U == (round % 2U)));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, talker.SpeakMode(0U == (round % 3U)));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, heartbeat.Beat());
+
+        while (0U != allocation_link.Size())
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, listener.Listen());
+        }
+    }
+}
+
+TEST(CaveTalkCppAllocationTests, SteadyState)
+{
+    std::shared_ptr<CountingCallbacks>      callbacks = std::make_shared<CountingCallbacks>();
+    std::shared_ptr<cave_talk::Heartbeat>   heartbeat = std::make_shared<cave_talk::Heartbeat>(AllocationSend, AllocationClock, 1000U);
+    std::shared_ptr<cave_talk::Reliable>    reliable  = std::make_shared<cave_talk::Reliable>(AllocationSend, AllocationClock, 8U, 8U);
+    std::shared_ptr<cave_talk::Pacer>       pacer     = std::make_shared<cave_talk::Pacer>(AllocationSend, AllocationClock, 1000000U, 1024U, 4U);
+    std::shared_ptr<cave_talk::Delta>       delta     = std::make_shared<cave_talk::Delta>(0.001, 8U);
+    std::shared_ptr<cave_talk::Delta>       undelta   = std::make_shared<cave_talk::Delta>(0.001, 8U);
+    std::shared_ptr<cave_talk::Reassembler> reassembler = std::make_shared<cave_talk::Reassembler>(1024U, 2U);
+    cave_talk::Talker                       talker(AllocationSend, reliable, pacer, delta);
+    cave_talk::Listener                     listener(AllocationReceive, AllocationAvailable, callbacks, heartbeat, reliable, reassembler, undelta);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, reliable->Enable(static_cast<CaveTalk_Id_t>(cave_talk::ID_MODE), true));
+    allocation_link.Clear();
+    allocation_now = 1000U;
+
+    // Anything set up lazily is set up in the first rounds
+    SpeakAndListen(talker, listener, *heartbeat, 10U);
+
+    counting    = true;
+    allocations = 0U;
+    SpeakAndListen(talker, listener, *heartbeat, 1000U);
+    counting = false;
+
+    ASSERT_EQ(0U, allocations);
+    ASSERT_EQ(5U * 1010U, callbacks->heard);
+}
+
+TEST(CaveTalkCppAllocationTests, MemoryResource)
+{
+    static std::array<std::byte, 64U * 1024U> storage;
+    std::pmr::monotonic_buffer_resource       pool(storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+    // Whatever the classes keep is taken from the pool, which cannot go to the heap
+    counting    = true;
+    allocations = 0U;
+    {
+        cave_talk::Reliable    reliable(AllocationSend, AllocationClock, 16U, 16U, &pool);
+        cave_talk::Pacer       pacer(AllocationSend, AllocationClock, 1000U, 1024U, 16U, &pool);
+        cave_talk::Reassembler reassembler(4096U, 4U, &pool);
+
+        ASSERT_EQ(0U, reliable.InFlight());
+    }
+    counting = false;
+
+    ASSERT_EQ(0U, allocations);
+}
+
+TEST(CaveTalkCppAllocationTests, Dispatcher)
+{
+    static std::array<std::byte, 1024U * 1024U> storage;
+    std::pmr::monotonic_buffer_resource        upstream(storage.data(), storage.size(), std::pmr::null_memory_resource());
+    std::pmr::synchronized_pool_resource       pool(&upstream);
+    std::shared_ptr<CountingCallbacks>         callbacks = std::make_shared<CountingCallbacks>();
+    cave_talk::Dispatcher                      dispatcher(callbacks, AllocationClock, 2U, 64U, &pool);
+    const uint8_t                              object[] = {1U, 2U, 3U};
+
+    for (std::size_t index = 0U; index < 100U; index++)
+    {
+        dispatcher.HearMovement(0.0, 0.0);
+        dispatcher.HearObject(42U, object, sizeof(object));
+    }
+    dispatcher.Drain();
+
+    // Queued messages and copies of objects come from the pool, so handing them over does not touch the heap
+    counting    = true;
+    allocations = 0U;
+    for (std::size_t index = 0U; index < 10000U; index++)
+    {
+        dispatcher.HearMovement(0.0, 0.0);
+        dispatcher.HearMode(true);
+        dispatcher.HearObject(42U, object, sizeof(object));
+    }
+    counting = false;
+    dispatcher.Drain();
+
+    ASSERT_EQ(0U, allocations);
+    ASSERT_EQ(200U + 30000U, callbacks->heard);
+}
\ No newline at end of file
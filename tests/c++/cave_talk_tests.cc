@@ -1,5 +1,10 @@
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -26,6 +31,13 @@ class MockListenerCallbacks : public cave_talk::ListenerCallbacks
         MOCK_METHOD(void, HearMode, (const bool), (override));
 };
 
+// Listeners that take objects override HearObject, the rest keep the empty default
+class MockObjectListenerCallbacks : public MockListenerCallbacks
+{
+    public:
+        MOCK_METHOD(void, HearObject, ((const CaveTalk_Id_t), (const uint8_t *const), (const std::size_t)), (override));
+};
+
 
 CaveTalk_Error_t Send(const void *const data, const size_t size)
 {    
@@ -195,4 +207,616 @@ TEST(CaveTalkCppTests, SpeakListenMode){
     EXPECT_CALL(*mock_listen_callbacks.get(), HearMode(false)).Times(1);
     ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
     
+}
+
+static CaveTalk_Microseconds_t now = 0U;
+
+CaveTalk_Microseconds_t OperatorClock(void)
+{
+    return now;
+}
+
+CaveTalk_Microseconds_t RoverClock(void)
+{
+    return now + 5000U;
+}
+
+TEST(CaveTalkCppTests, HeartbeatPingPong){
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    std::shared_ptr<cave_talk::Heartbeat> operator_heartbeat = std::make_shared<cave_talk::Heartbeat>(Send, OperatorClock, 1000U);
+    std::shared_ptr<cave_talk::Heartbeat> rover_heartbeat = std::make_shared<cave_talk::Heartbeat>(Send, RoverClock, 1000U);
+    cave_talk::Listener operatorEars(Receive, Available, mock_listen_callbacks, operator_heartbeat);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks, rover_heartbeat);
+
+    ring_buffer.Clear();
+
+    now = 1000U;
+    ASSERT_FALSE(operator_heartbeat->Alive(3000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operator_heartbeat->Beat());
+    ASSERT_NE(0U, ring_buffer.Size());
+
+    // Not due again until the interval elapses
+    std::size_t size = ring_buffer.Size();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operator_heartbeat->Beat());
+    ASSERT_EQ(size, ring_buffer.Size());
+
+    now = 1200U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_TRUE(rover_heartbeat->Alive(3000U));
+
+    now = 1400U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorEars.Listen());
+    ASSERT_EQ(0U, ring_buffer.Size());
+    ASSERT_TRUE(operator_heartbeat->Alive(3000U));
+    ASSERT_EQ(400U, operator_heartbeat->RoundTripTime());
+    ASSERT_EQ(400U, operator_heartbeat->SmoothedRoundTripTime());
+    ASSERT_EQ(5000, operator_heartbeat->ClockOffset());
+
+    now = 5000U;
+    ASSERT_FALSE(operator_heartbeat->Alive(3000U));
+}
+
+TEST(CaveTalkCppTests, HeartbeatDisabled){
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    cave_talk::Heartbeat heartbeat(Send, OperatorClock, 1000U);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks);
+
+    ring_buffer.Clear();
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, heartbeat.Beat());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(0U, ring_buffer.Size());
+}
+
+TEST(CaveTalkCppTests, StateSyncSuppressAndKeyframe){
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    std::shared_ptr<cave_talk::Talker> operatorMouth = std::make_shared<cave_talk::Talker>(Send);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks);
+
+    ring_buffer.Clear();
+
+    now = 0U;
+    cave_talk::StateSync state_sync(operatorMouth, OperatorClock, 10000U);
+
+    // Nothing is known yet, so there is no keyframe to send
+    now = 20000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.SpeakLights(true));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.SpeakMode(false));
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearLights(true)).Times(1);
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMode(false)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    for (int tick = 0; tick < 10; tick++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.SpeakLights(true));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.SpeakMode(false));
+    }
+    ASSERT_EQ(0U, ring_buffer.Size());
+    ASSERT_EQ(2U, state_sync.Counters().frames_sent);
+    ASSERT_EQ(20U, state_sync.Counters().frames_suppressed);
+    ASSERT_EQ(10U * (CAVE_TALK_HEADER_SIZE + 2U + CAVE_TALK_CRC_SIZE) + 10U * (CAVE_TALK_HEADER_SIZE + CAVE_TALK_CRC_SIZE), state_sync.Counters().bytes_saved);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.SpeakLights(false));
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearLights(false)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+
+    // Keyframe once the interval has elapsed since the last one
+    now = 25000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    ASSERT_EQ(0U, ring_buffer.Size());
+    now = 30000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearLights(false)).Times(1);
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMode(false)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(0U, ring_buffer.Size());
+    ASSERT_EQ(1U, state_sync.Counters().keyframes);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    ASSERT_EQ(0U, ring_buffer.Size());
+}
+
+TEST(CaveTalkCppTests, StateSyncListenerJoined){
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    std::shared_ptr<cave_talk::Talker> operatorMouth = std::make_shared<cave_talk::Talker>(Send);
+    std::shared_ptr<cave_talk::Heartbeat> operator_heartbeat = std::make_shared<cave_talk::Heartbeat>(Send, OperatorClock, 1000U);
+    std::shared_ptr<cave_talk::Heartbeat> rover_heartbeat = std::make_shared<cave_talk::Heartbeat>(Send, RoverClock, 1000U);
+    cave_talk::Listener operatorEars(Receive, Available, mock_listen_callbacks, operator_heartbeat);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks, rover_heartbeat);
+
+    ring_buffer.Clear();
+
+    now = 0U;
+    cave_talk::StateSync state_sync(operatorMouth, OperatorClock, 0U, operator_heartbeat, 3000U);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.SpeakMode(true));
+    ring_buffer.Clear();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    // The rover comes up and answers a ping, which resends the state it missed
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operator_heartbeat->Beat());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorEars.Listen());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMode(true)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    // Only once per join
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    state_sync.ListenerJoined();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, state_sync.Update());
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMode(true)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(2U, state_sync.Counters().keyframes);
+}
+
+TEST(CaveTalkCppTests, SpeakListenFragmented){
+
+    std::shared_ptr<MockObjectListenerCallbacks> mock_listen_callbacks = std::make_shared<MockObjectListenerCallbacks>();
+    std::shared_ptr<cave_talk::Reassembler> reassembler = std::make_shared<cave_talk::Reassembler>(1024U, 2U);
+    cave_talk::Talker operatorMouth(Send);
+    cave_talk::Fragmenter operatorFragmenter(Send, 0U, 64U);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks, nullptr, nullptr, reassembler);
+
+    std::vector<uint8_t> object(300U);
+    std::vector<uint8_t> heard;
+    std::size_t offset = 0U;
+
+    for (std::size_t index = 0U; index < object.size(); index++)
+    {
+        object[index] = static_cast<uint8_t>(index);
+    }
+
+    ring_buffer.Clear();
+
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearLights(true)).Times(5);
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearObject(0x42U, testing::_, object.size())).WillOnce([&heard](const CaveTalk_Id_t, const uint8_t *const data, const std::size_t length) {
+        heard.assign(data, data + length);
+    });
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorFragmenter.Start(0x42U, object.size()));
+    while (operatorFragmenter.Active())
+    {
+        const std::size_t chunk_size = operatorFragmenter.ChunkSize();
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorMouth.SpeakLights(true));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorFragmenter.Speak(&object[offset], chunk_size));
+        offset += chunk_size;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    }
+
+    ASSERT_EQ(object, heard);
+    ASSERT_EQ(1U, reassembler->Counters().completed);
+}
+
+TEST(CaveTalkCppTests, MessageTraitsMaxSize){
+
+    cave_talk::OogaBooga ooga_booga_message;
+    ooga_booga_message.set_ooga_booga(cave_talk::SAY_BOOGA);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::OogaBooga>::kMaxSize, ooga_booga_message.ByteSizeLong());
+
+    cave_talk::Movement movement_message;
+    movement_message.set_speed_meters_per_second(-1.0);
+    movement_message.set_turn_rate_radians_per_second(1.0);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::Movement>::kMaxSize, movement_message.ByteSizeLong());
+
+    cave_talk::CameraMovement camera_movement_message;
+    camera_movement_message.set_pan_angle_radians(-1.0);
+    camera_movement_message.set_tilt_angle_radians(1.0);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::CameraMovement>::kMaxSize, camera_movement_message.ByteSizeLong());
+
+    cave_talk::Lights lights_message;
+    lights_message.set_headlights(true);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::Lights>::kMaxSize, lights_message.ByteSizeLong());
+
+    cave_talk::Mode mode_message;
+    mode_message.set_manual(true);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::Mode>::kMaxSize, mode_message.ByteSizeLong());
+
+    cave_talk::Ping ping_message;
+    ping_message.set_originate_timestamp_microseconds(UINT64_MAX);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::Ping>::kMaxSize, ping_message.ByteSizeLong());
+
+    cave_talk::Pong pong_message;
+    pong_message.set_originate_timestamp_microseconds(UINT64_MAX);
+    pong_message.set_receive_timestamp_microseconds(UINT64_MAX);
+    pong_message.set_transmit_timestamp_microseconds(UINT64_MAX);
+    ASSERT_EQ(cave_talk::MessageTraits<cave_talk::Pong>::kMaxSize, pong_message.ByteSizeLong());
+
+    static_assert(18U == cave_talk::MessageSet<cave_talk::OogaBooga, cave_talk::Movement, cave_talk::CameraMovement, cave_talk::Lights, cave_talk::Mode>::kBufferSize);
+    static_assert(36U == cave_talk::MessageSet<cave_talk::Ping, cave_talk::Pong, cave_talk::ReliableFrame>::kBufferSize);
+    static_assert(64U == cave_talk::MessageSet<cave_talk::Movement, cave_talk::ReliableFrame, cave_talk::FragmentFrame<64U>>::kBufferSize);
+}
+
+TEST(CaveTalkCppTests, BasicTalkerListener){
+
+    using MovementTalker   = cave_talk::BasicTalker<cave_talk::Movement>;
+    using MovementListener = cave_talk::BasicListener<cave_talk::Movement, cave_talk::Lights>;
+
+    static_assert(sizeof(cave_talk::BasicTalker<cave_talk::Lights, cave_talk::Mode>) < sizeof(cave_talk::Talker));
+    static_assert(sizeof(MovementListener) < sizeof(cave_talk::Listener));
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    MovementTalker operatorMouth(Send);
+    cave_talk::Talker fullMouth(Send);
+    MovementListener roverEars(Receive, Available, mock_listen_callbacks);
+
+    ring_buffer.Clear();
+
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMovement(1.5, -0.5)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorMouth.SpeakMovement(1.5, -0.5));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearLights(true)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, fullMouth.SpeakLights(true));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+
+    // Outside the listener's message set
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMode(testing::_)).Times(0);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, fullMouth.SpeakMode(true));
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, roverEars.Listen());
+}
+
+TEST(CaveTalkCppTests, TalkerPaced){
+
+    std::shared_ptr<cave_talk::Pacer> pacer = std::make_shared<cave_talk::Pacer>(Send, OperatorClock, 1000U, 262U, 2U);
+    cave_talk::Talker roverMouth(Send, nullptr, pacer);
+    const std::size_t frame_size = CAVE_TALK_HEADER_SIZE + cave_talk::MessageTraits<cave_talk::Movement>::kMaxSize + CAVE_TALK_CRC_SIZE;
+
+    ring_buffer.Clear();
+    now = 1000U;
+
+    // Frames past the burst are queued, then rejected once the slots are full
+    std::size_t sent = 0U;
+    while (CAVE_TALK_ERROR_NONE == roverMouth.SpeakMovement(1.0, 0.5))
+    {
+        sent++;
+    }
+    ASSERT_EQ(262U / frame_size + 2U, sent);
+    ASSERT_EQ(CAVE_TALK_ERROR_RATE, roverMouth.SpeakMovement(1.0, 0.5));
+    ASSERT_EQ(2U, pacer->Counters().queued);
+    ASSERT_EQ((262U / frame_size) * frame_size, ring_buffer.Size());
+    ASSERT_LT(0U, pacer->Delay());
+
+    // Once the delay has passed every queued frame has gone out
+    ring_buffer.Clear();
+    now += pacer->Delay();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, pacer->Drain());
+    ASSERT_EQ(0U, pacer->Delay());
+    ASSERT_EQ(sent, pacer->Counters().sent);
+}
+
+TEST(CaveTalkCppTests, TalkerPacedCharged){
+
+    std::shared_ptr<cave_talk::Pacer> pacer = std::make_shared<cave_talk::Pacer>(Send, OperatorClock, 1000U, 262U, 2U);
+    cave_talk::Heartbeat heartbeat(pacer->Send(), OperatorClock, 1000U);
+    cave_talk::Talker roverMouth(Send, nullptr, pacer);
+    const std::size_t frame_size = CAVE_TALK_HEADER_SIZE + cave_talk::MessageTraits<cave_talk::Movement>::kMaxSize + CAVE_TALK_CRC_SIZE;
+
+    ring_buffer.Clear();
+    now = 1000U;
+
+    // Pings sent through the pacer's link go out at once but spend tokens the paced frames then wait for
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, heartbeat.Beat());
+    const std::size_t ping_size = ring_buffer.Size();
+    ASSERT_LT(0U, ping_size);
+    ASSERT_EQ(ping_size, pacer->Counters().bytes_charged);
+    ring_buffer.Clear();
+
+    std::size_t sent = 0U;
+    while (0U == pacer->Counters().queued)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverMouth.SpeakMovement(1.0, 0.5));
+        sent++;
+    }
+    ASSERT_EQ((262U - ping_size) / frame_size + 1U, sent);
+    ASSERT_EQ(ping_size, pacer->Counters().bytes_charged);
+}
+
+TEST(CaveTalkCppTests, TalkerPacedBroken){
+
+    // A burst below the largest frame could never send it, so the pacer is left unset and says why
+    std::shared_ptr<cave_talk::Pacer> pacer = std::make_shared<cave_talk::Pacer>(Send, OperatorClock, 1000U, 100U, 4U);
+    cave_talk::Talker roverMouth(Send, nullptr, pacer);
+
+    ring_buffer.Clear();
+    now = 1000U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, pacer->Error());
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, roverMouth.SpeakMovement(1.0, 0.5));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, pacer->Drain());
+    ASSERT_EQ(0U, pacer->Delay());
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    // Frames sent around the pacer still reach the link, just uncharged
+    ASSERT_EQ(&Send, pacer->Send());
+    ASSERT_EQ(0U, pacer->Counters().bytes_charged);
+}
+
+
+// Records what was heard from the dispatcher's workers, camera movements wait until released
+class RecordingCallbacks : public cave_talk::ListenerCallbacks
+{
+    public:
+        void HearOogaBooga(const cave_talk::Say) override {}
+        void HearMovement(const CaveTalk_MetersPerSecond_t speed, const CaveTalk_RadiansPerSecond_t) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            speeds.push_back(speed);
+        }
+        void HearCameraMovement(const CaveTalk_Radian_t, const CaveTalk_Radian_t) override
+        {
+            while (!released)
+            {
+                std::this_thread::yield();
+            }
+        }
+        void HearLights(const bool) override {}
+        void HearMode(const bool) override
+        {
+            modes++;
+        }
+        void HearObject(const CaveTalk_Id_t, const uint8_t *const data, const std::size_t length) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            object.assign(data, data + length);
+        }
+
+        std::mutex mutex;
+        std::vector<CaveTalk_MetersPerSecond_t> speeds;
+        std::vector<uint8_t> object;
+        std::atomic<bool> released = false;
+        std::atomic<std::size_t> modes = 0U;
+};
+
+static CaveTalk_Microseconds_t SteadyClock(void)
+{
+    return static_cast<CaveTalk_Microseconds_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static bool Eventually(const std::function<bool(void)> &condition)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (!condition() && (std::chrono::steady_clock::now() < deadline))
+    {
+        std::this_thread::yield();
+    }
+
+    return condition();
+}
+
+TEST(CaveTalkCppTests, DispatcherOrdered){
+
+    std::shared_ptr<RecordingCallbacks> callbacks = std::make_shared<RecordingCallbacks>();
+    std::shared_ptr<cave_talk::Dispatcher> dispatcher = std::make_shared<cave_talk::Dispatcher>(callbacks, SteadyClock, 4U, 16U);
+    cave_talk::Talker roverMouth(Send);
+    cave_talk::Listener operatorEars(Receive, Available, dispatcher);
+    const uint8_t object[] = {1U, 2U, 3U};
+
+    ring_buffer.Clear();
+
+    // Handlers run on four workers, but one id is always handled in the order heard
+    for (std::size_t index = 0U; index < 2000U; index++)
+    {
+        dispatcher->HearMovement(static_cast<double>(index), 0.0);
+    }
+    dispatcher->HearObject(42U, object, sizeof(object));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverMouth.SpeakMovement(2000.0, 0.0));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorEars.Listen());
+    dispatcher->Drain();
+
+    ASSERT_EQ(2001U, callbacks->speeds.size());
+    for (std::size_t index = 0U; index < callbacks->speeds.size(); index++)
+    {
+        ASSERT_EQ(static_cast<double>(index), callbacks->speeds[index]);
+    }
+    ASSERT_THAT(callbacks->object, ::testing::ElementsAre(1U, 2U, 3U));
+
+    const cave_talk::DispatcherCounters counters = dispatcher->Counters(static_cast<CaveTalk_Id_t>(cave_talk::ID_MOVEMENT));
+    ASSERT_EQ(2001U, counters.dispatched);
+    ASSERT_EQ(2001U, counters.handled);
+    ASSERT_EQ(0U, counters.depth);
+    ASSERT_GE(16U, counters.max_depth);
+}
+
+TEST(CaveTalkCppTests, DispatcherSlowHandler){
+
+    std::shared_ptr<RecordingCallbacks> callbacks = std::make_shared<RecordingCallbacks>();
+    cave_talk::Dispatcher dispatcher(callbacks, SteadyClock, 2U, 2U);
+    const CaveTalk_Id_t camera = static_cast<CaveTalk_Id_t>(cave_talk::ID_CAMERA_MOVEMENT);
+
+    // A camera handler stuck on the gimbal holds up neither the listener nor other ids
+    dispatcher.HearCameraMovement(0.0, 0.0);
+    dispatcher.HearMode(true);
+    ASSERT_TRUE(Eventually([&]() { return 1U == callbacks->modes; }));
+
+    // Until its queue is full, then hearing another camera movement waits for the handler
+    dispatcher.HearCameraMovement(0.0, 0.0);
+    dispatcher.HearCameraMovement(0.0, 0.0);
+    std::thread listener([&]() {
+        dispatcher.HearCameraMovement(0.0, 0.0);
+    });
+    ASSERT_TRUE(Eventually([&]() { return 1U == dispatcher.Counters(camera).stalls; }));
+    ASSERT_EQ(2U, dispatcher.Counters(camera).depth);
+
+    callbacks->released = true;
+    listener.join();
+    dispatcher.Drain();
+    ASSERT_EQ(4U, dispatcher.Counters(camera).handled);
+    ASSERT_LT(0U, dispatcher.Counters(camera).handler_time_max);
+}
+
+TEST(CaveTalkCppTests, TalkerListenerDelta){
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    std::shared_ptr<cave_talk::Delta> operator_delta = std::make_shared<cave_talk::Delta>(0.001, 8U);
+    std::shared_ptr<cave_talk::Delta> rover_delta = std::make_shared<cave_talk::Delta>(0.001, 8U);
+    cave_talk::Talker roverMouth(Send, nullptr, nullptr, operator_delta);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks, nullptr, nullptr, nullptr, rover_delta);
+    cave_talk::Listener plainEars(Receive, Available, mock_listen_callbacks);
+
+    ring_buffer.Clear();
+
+    // The first Movement is a keyframe, the next only its difference from it
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMovement(testing::DoubleNear(1.5, 0.0005), testing::DoubleNear(-0.25, 0.0005))).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverMouth.SpeakMovement(1.5, -0.25));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMovement(testing::DoubleNear(1.502, 0.0005), testing::DoubleNear(-0.25, 0.0005))).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverMouth.SpeakMovement(1.502, -0.25));
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE + 4U + CAVE_TALK_CRC_SIZE, ring_buffer.Size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearCameraMovement(testing::DoubleNear(0.3, 0.0005), testing::DoubleNear(0.1, 0.0005))).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverMouth.SpeakCameraMovement(0.3, 0.1));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+
+    ASSERT_EQ(1U, operator_delta->Counters(static_cast<CaveTalk_Id_t>(cave_talk::ID_MOVEMENT)).deltas);
+    ASSERT_EQ(1U, rover_delta->Counters(static_cast<CaveTalk_Id_t>(cave_talk::ID_CAMERA_MOVEMENT)).keyframes);
+
+    // A listener without delta decoding rejects the frame
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverMouth.SpeakMovement(1.503, -0.25));
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, plainEars.Listen());
+}
+
+TEST(CaveTalkCppTests, TalkerListenerNegotiation){
+
+    std::shared_ptr<MockListenerCallbacks> mock_listen_callbacks = std::make_shared<MockListenerCallbacks>();
+    std::shared_ptr<cave_talk::Delta> operator_delta = std::make_shared<cave_talk::Delta>(0.001, 8U);
+    std::shared_ptr<cave_talk::Delta> rover_delta = std::make_shared<cave_talk::Delta>(0.001, 8U);
+    std::shared_ptr<cave_talk::Negotiation> operator_negotiation = std::make_shared<cave_talk::Negotiation>(Send, OperatorClock, CAVE_TALK_CAPABILITY_DELTA, 255U, 1000U, 3U);
+    std::shared_ptr<cave_talk::Negotiation> rover_negotiation = std::make_shared<cave_talk::Negotiation>(Send, RoverClock, CAVE_TALK_CAPABILITY_DELTA, 64U, 1000U, 3U);
+    cave_talk::Talker operatorMouth(Send, nullptr, nullptr, operator_delta, operator_negotiation);
+    cave_talk::Fragmenter operatorFragmenter(Send, 0U, 255U, operator_negotiation);
+    cave_talk::Listener operatorEars(Receive, Available, mock_listen_callbacks, nullptr, nullptr, nullptr, nullptr, operator_negotiation);
+    cave_talk::Listener roverEars(Receive, Available, mock_listen_callbacks, nullptr, nullptr, nullptr, rover_delta, rover_negotiation);
+
+    ring_buffer.Clear();
+    now = 1000U;
+
+    // Until the rover agrees to delta encoding Movement goes out whole
+    operator_negotiation->Start();
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMovement(1.5, -0.25)).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorMouth.SpeakMovement(1.5, -0.25));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(0U, operator_delta->Counters(static_cast<CaveTalk_Id_t>(cave_talk::ID_MOVEMENT)).keyframes);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operator_negotiation->Poll());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorEars.Listen());
+    ASSERT_EQ(0U, ring_buffer.Size());
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_AGREED, operator_negotiation->State());
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_REVISION, operator_negotiation->PeerRevision());
+    ASSERT_EQ(CAVE_TALK_CAPABILITY_DELTA, rover_negotiation->AgreedCapabilities());
+
+    EXPECT_CALL(*mock_listen_callbacks.get(), HearMovement(testing::DoubleNear(1.5, 0.0005), testing::DoubleNear(-0.25, 0.0005))).Times(1);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, operatorMouth.SpeakMovement(1.5, -0.25));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, roverEars.Listen());
+    ASSERT_EQ(1U, operator_delta->Counters(static_cast<CaveTalk_Id_t>(cave_talk::ID_MOVEMENT)).keyframes);
+
+    // Neither side offered fragments, so no object is started
+    ASSERT_EQ(64U, operator_negotiation->AgreedMaxPayload());
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, operatorFragmenter.Start(0x42U, 300U));
+    ASSERT_FALSE(operatorFragmenter.Active());
+}
+
+struct HeartbeatTimer
+{
+    cave_talk::TimerWheel *timer_wheel;
+    cave_talk::Heartbeat *heartbeat;
+    CaveTalk_Timer_t timer;
+};
+
+static void BeatAndRearm(void *const context)
+{
+    HeartbeatTimer *const heartbeat_timer = static_cast<HeartbeatTimer *>(context);
+
+    heartbeat_timer->heartbeat->Beat();
+    heartbeat_timer->timer_wheel->Start(heartbeat_timer->timer, 1000U);
+}
+
+TEST(CaveTalkCppTests, TimerWheelHeartbeat){
+
+    cave_talk::TimerWheel timer_wheel(OperatorClock, 100U);
+    cave_talk::Heartbeat heartbeat(Send, OperatorClock, 1000U);
+    HeartbeatTimer heartbeat_timer = {.timer_wheel = &timer_wheel, .heartbeat = &heartbeat, .timer = {}};
+
+    ring_buffer.Clear();
+    now = 1000U;
+
+    // The wheel beats the heartbeat when it is due instead of the loop polling it
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&heartbeat_timer.timer, BeatAndRearm, &heartbeat_timer));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, timer_wheel.Start(heartbeat_timer.timer, 0U));
+    ASSERT_EQ(1U, timer_wheel.Active());
+
+    ASSERT_EQ(1U, timer_wheel.Advance());
+    ASSERT_NE(0U, ring_buffer.Size());
+    ring_buffer.Clear();
+
+    now = 1900U;
+    ASSERT_EQ(0U, timer_wheel.Advance());
+
+    now = 2000U;
+    ASSERT_EQ(1U, timer_wheel.Advance());
+    ASSERT_NE(0U, ring_buffer.Size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, timer_wheel.Cancel(heartbeat_timer.timer));
+    ASSERT_EQ(0U, timer_wheel.Active());
+}
+
+TEST(CaveTalkCppTests, TimerWheelReliable){
+
+    cave_talk::TimerWheel   timer_wheel(OperatorClock, 1000U);
+    cave_talk::TimerWheel   broken_wheel(OperatorClock, 0U);
+    cave_talk::Reliable     reliable(Send, OperatorClock, 4U, 0U);
+    CaveTalk_Microseconds_t deadline = 0U;
+    CaveTalk_Timer_t        timer;
+    const uint8_t           message  = 1U;
+
+    ring_buffer.Clear();
+    now = 0U;
+
+    // A wheel that could not be set up says why rather than holding timers it will never fire
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, broken_wheel.Error());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&timer, BeatAndRearm, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, broken_wheel.Start(timer, 100U));
+    ASSERT_EQ(0U, broken_wheel.Advance());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, timer_wheel.Error());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, reliable.Enable(5U, true));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, reliable.Schedule(timer_wheel));
+    ASSERT_FALSE(reliable.Deadline(deadline));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, reliable.Speak(5U, &message, sizeof(message)));
+    ASSERT_TRUE(reliable.Deadline(deadline));
+    ASSERT_EQ(CAVE_TALK_RELIABLE_RTO_INITIAL, deadline);
+    ASSERT_EQ(1U, timer_wheel.Active());
+    ring_buffer.Clear();
+
+    // The unacknowledged frame is sent again from the wheel without polling Retransmit
+    now = CAVE_TALK_RELIABLE_RTO_INITIAL;
+    ASSERT_EQ(1U, timer_wheel.Advance());
+    ASSERT_EQ(1U, reliable.Counters().retransmitted);
+    ASSERT_NE(0U, ring_buffer.Size());
+    ASSERT_EQ(1U, timer_wheel.Active());
+    ring_buffer.Clear();
 }
\ No newline at end of file
@@ -1,3 +1,327 @@
+#include <cstddef>
+#include <cstdint>
+
 #include <gtest/gtest.h>
 
-// TODO SD-155
\ No newline at end of file
+#include "cave_talk.h"
+#include "cave_talk_heartbeat.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+// TODO SD-155
+
+static const std::size_t kMaxMessageLength = 255U;
+static RingBuffer<uint8_t, kMaxMessageLength> ring_buffer;
+static CaveTalk_Microseconds_t now = 0U;
+
+CaveTalk_Error_t Send(const void *const data, const size_t size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (size > ring_buffer.Capacity() - ring_buffer.Size())
+    {
+        error = CAVE_TALK_ERROR_INCOMPLETE;
+    }
+    else
+    {
+        ring_buffer.Write(static_cast<const uint8_t *const>(data), size);
+    }
+
+    return error;
+}
+
+CaveTalk_Error_t Receive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received = ring_buffer.Read(static_cast<uint8_t *const>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+CaveTalk_Error_t Available(size_t *const bytes_available)
+{
+    *bytes_available = ring_buffer.Size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+CaveTalk_Microseconds_t OperatorClock(void)
+{
+    return now;
+}
+
+CaveTalk_Microseconds_t RoverClock(void)
+{
+    return now + 5000U;
+}
+
+TEST(CaveTalkCTests, HeartbeatPingPong)
+{
+    uint8_t              operator_buffer[kMaxMessageLength] = {0U};
+    uint8_t              rover_buffer[kMaxMessageLength]    = {0U};
+    CaveTalk_Heartbeat_t operator_heartbeat;
+    CaveTalk_Heartbeat_t rover_heartbeat;
+    CaveTalk_Handle_t    operator_handle = kCaveTalk_HandleNull;
+    CaveTalk_Handle_t    rover_handle    = kCaveTalk_HandleNull;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&operator_heartbeat, OperatorClock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&rover_heartbeat, RoverClock, 1000U));
+
+    operator_handle.link_handle.send      = Send;
+    operator_handle.link_handle.receive   = Receive;
+    operator_handle.link_handle.available = Available;
+    operator_handle.buffer                = operator_buffer;
+    operator_handle.buffer_size           = sizeof(operator_buffer);
+    operator_handle.heartbeat             = &operator_heartbeat;
+
+    rover_handle             = operator_handle;
+    rover_handle.buffer      = rover_buffer;
+    rover_handle.buffer_size = sizeof(rover_buffer);
+    rover_handle.heartbeat   = &rover_heartbeat;
+
+    ring_buffer.Clear();
+
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&operator_handle));
+    ASSERT_EQ(1U, operator_heartbeat.pings_sent);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&operator_handle));
+    ASSERT_EQ(1U, operator_heartbeat.pings_sent);
+
+    now = 1200U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&rover_handle));
+    ASSERT_TRUE(CaveTalk_HeartbeatAlive(&rover_heartbeat, 3000U));
+
+    now = 1400U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&operator_handle));
+    ASSERT_EQ(0U, ring_buffer.Size());
+    ASSERT_EQ(1U, operator_heartbeat.pongs_received);
+    ASSERT_EQ(400U, operator_heartbeat.round_trip_time);
+    ASSERT_EQ(5000, operator_heartbeat.clock_offset);
+    ASSERT_TRUE(CaveTalk_HeartbeatAlive(&operator_heartbeat, 3000U));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SpeakHeartbeat(&kCaveTalk_HandleNull));
+}
+
+
+TEST(CaveTalkCTests, ExactBufferSize)
+{
+    static_assert(cave_talk_Pong_size == CAVE_TALK_MESSAGE_SIZE_MAX);
+    static_assert((CAVE_TALK_MESSAGE_SIZE_MAX + CAVE_TALK_RELIABLE_HEADER_SIZE) == CAVE_TALK_BUFFER_SIZE);
+
+    uint8_t              operator_buffer[CAVE_TALK_BUFFER_SIZE] = {0U};
+    uint8_t              rover_buffer[CAVE_TALK_BUFFER_SIZE]    = {0U};
+    CaveTalk_Heartbeat_t operator_heartbeat;
+    CaveTalk_Heartbeat_t rover_heartbeat;
+    CaveTalk_Handle_t    operator_handle = kCaveTalk_HandleNull;
+    CaveTalk_Handle_t    rover_handle    = kCaveTalk_HandleNull;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&operator_heartbeat, OperatorClock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&rover_heartbeat, RoverClock, 1000U));
+
+    operator_handle.link_handle.send      = Send;
+    operator_handle.link_handle.receive   = Receive;
+    operator_handle.link_handle.available = Available;
+    operator_handle.buffer                = operator_buffer;
+    operator_handle.buffer_size           = sizeof(operator_buffer);
+    operator_handle.heartbeat             = &operator_heartbeat;
+
+    rover_handle             = operator_handle;
+    rover_handle.buffer      = rover_buffer;
+    rover_handle.buffer_size = sizeof(rover_buffer);
+    rover_handle.heartbeat   = &rover_heartbeat;
+
+    ring_buffer.Clear();
+
+    // The pong is the largest message
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&operator_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&rover_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&operator_handle));
+    ASSERT_EQ(1U, operator_heartbeat.pongs_received);
+    ASSERT_EQ(0U, ring_buffer.Size());
+}
+
+TEST(CaveTalkCTests, HearUntil)
+{
+    uint8_t                operator_buffer[CAVE_TALK_BUFFER_SIZE] = {0U};
+    uint8_t                rover_buffer[CAVE_TALK_BUFFER_SIZE]    = {0U};
+    uint8_t                frame[kMaxMessageLength]               = {0U};
+    CaveTalk_Heartbeat_t   operator_heartbeat;
+    CaveTalk_Heartbeat_t   rover_heartbeat;
+    CaveTalk_ListenState_t listen_state;
+    CaveTalk_Handle_t      operator_handle = kCaveTalk_HandleNull;
+    CaveTalk_Handle_t      rover_handle    = kCaveTalk_HandleNull;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&operator_heartbeat, OperatorClock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&rover_heartbeat, RoverClock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenStateInit(&listen_state, RoverClock, nullptr, nullptr));
+
+    operator_handle.link_handle.send = Send;
+    operator_handle.buffer           = operator_buffer;
+    operator_handle.buffer_size      = sizeof(operator_buffer);
+    operator_handle.heartbeat        = &operator_heartbeat;
+
+    rover_handle.link_handle.receive   = Receive;
+    rover_handle.link_handle.available = Available;
+    rover_handle.buffer                = rover_buffer;
+    rover_handle.buffer_size           = sizeof(rover_buffer);
+    rover_handle.heartbeat             = &rover_heartbeat;
+
+    ring_buffer.Clear();
+
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&operator_handle));
+
+    // Only part of the ping has arrived when the rover's budget runs out
+    const std::size_t size = ring_buffer.Read(frame, sizeof(frame));
+
+    ring_buffer.Write(frame, 5U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HearUntil(&rover_handle, &listen_state, RoverClock() + 100U));
+    ASSERT_FALSE(CaveTalk_HeartbeatAlive(&rover_heartbeat, 3000U));
+    ASSERT_EQ(1U, listen_state.expired);
+
+    ring_buffer.Write(&frame[5U], size - 5U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HearUntil(&rover_handle, &listen_state, RoverClock() + 100U));
+    ASSERT_TRUE(CaveTalk_HeartbeatAlive(&rover_heartbeat, 3000U));
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HearUntil(&rover_handle, nullptr, 0U));
+}
+
+TEST(CaveTalkCTests, SpeakPaced)
+{
+    uint8_t              buffer[CAVE_TALK_BUFFER_SIZE] = {0U};
+    CaveTalk_PacerSlot_t slots[1U];
+    CaveTalk_Pacer_t     pacer;
+    CaveTalk_Handle_t    handle = kCaveTalk_HandleNull;
+
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerInit(&pacer, OperatorClock, 1000U, CAVE_TALK_PACER_FRAME_SIZE_MAX, slots, 1U));
+
+    handle.link_handle.send = Send;
+    handle.buffer           = buffer;
+    handle.buffer_size      = sizeof(buffer);
+    handle.pacer            = &pacer;
+
+    ring_buffer.Clear();
+
+    // Movement frames of 25 bytes, ten fit in the burst, the next waits in the slot and the one after is rejected
+    for (std::size_t frame = 0U; frame < 11U; frame++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakMovement(&handle, 1.0, 0.5));
+    }
+    ASSERT_EQ(CAVE_TALK_ERROR_RATE, CaveTalk_SpeakMovement(&handle, 1.0, 0.5));
+    ASSERT_EQ(250U, ring_buffer.Size());
+    ASSERT_EQ(13000U, CaveTalk_PacerDelay(&pacer));
+
+    ring_buffer.Clear();
+    now += 13000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakPaced(&handle));
+    ASSERT_EQ(25U, ring_buffer.Size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SpeakPaced(&kCaveTalk_HandleNull));
+}
+
+TEST(CaveTalkCTests, SpeakPacedCharged)
+{
+    uint8_t               buffer[CAVE_TALK_BUFFER_SIZE] = {0U};
+    CaveTalk_PacerSlot_t  slots[1U];
+    CaveTalk_Pacer_t      pacer;
+    CaveTalk_Heartbeat_t  heartbeat;
+    CaveTalk_LinkHandle_t link_handle = kCaveTalk_LinkHandleNull;
+    CaveTalk_Handle_t     handle      = kCaveTalk_HandleNull;
+
+    // A timestamp large enough that the ping frame is bigger than the 12 bytes the burst has spare
+    now = 1ULL << 40U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerInit(&pacer, OperatorClock, 1000U, CAVE_TALK_PACER_FRAME_SIZE_MAX, slots, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&heartbeat, OperatorClock, 1000U));
+
+    link_handle.send = Send;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerBind(&pacer, &link_handle, &handle.link_handle));
+
+    handle.buffer      = buffer;
+    handle.buffer_size = sizeof(buffer);
+    handle.heartbeat   = &heartbeat;
+    handle.pacer       = &pacer;
+
+    ring_buffer.Clear();
+
+    // A ping does not wait for tokens but spends them, so one movement frame fewer fits in the burst
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&handle));
+    const std::size_t ping_size = ring_buffer.Size();
+    ASSERT_LT(0U, ping_size);
+    ASSERT_EQ(ping_size, pacer.counters.bytes_charged);
+    ring_buffer.Clear();
+
+    for (std::size_t frame = 0U; frame < 10U; frame++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakMovement(&handle, 1.0, 0.5));
+    }
+    ASSERT_EQ(1U, pacer.counters.queued);
+    ASSERT_EQ(225U, ring_buffer.Size());
+    ASSERT_EQ(ping_size, pacer.counters.bytes_charged);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerUnbind(&pacer));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerBind(&pacer, &kCaveTalk_LinkHandleNull, &link_handle));
+}
+
+TEST(CaveTalkCTests, SpeakNegotiation)
+{
+    uint8_t                operator_buffer[kMaxMessageLength] = {0U};
+    uint8_t                rover_buffer[kMaxMessageLength]    = {0U};
+    CaveTalk_Heartbeat_t   operator_heartbeat;
+    CaveTalk_Negotiation_t operator_negotiation;
+    CaveTalk_Negotiation_t rover_negotiation;
+    CaveTalk_Handle_t      operator_handle = kCaveTalk_HandleNull;
+    CaveTalk_Handle_t      rover_handle    = kCaveTalk_HandleNull;
+
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&operator_heartbeat, OperatorClock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&operator_negotiation, OperatorClock, CAVE_TALK_CAPABILITY_HEARTBEAT, 255U, 1000U, 3U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&rover_negotiation, RoverClock, CAVE_TALK_CAPABILITY_HEARTBEAT, 16U, 1000U, 3U));
+
+    operator_handle.link_handle.send      = Send;
+    operator_handle.link_handle.receive   = Receive;
+    operator_handle.link_handle.available = Available;
+    operator_handle.buffer                = operator_buffer;
+    operator_handle.buffer_size           = sizeof(operator_buffer);
+    operator_handle.heartbeat             = &operator_heartbeat;
+    operator_handle.negotiation           = &operator_negotiation;
+
+    rover_handle.link_handle = operator_handle.link_handle;
+    rover_handle.buffer      = rover_buffer;
+    rover_handle.buffer_size = sizeof(rover_buffer);
+    rover_handle.negotiation = &rover_negotiation;
+
+    ring_buffer.Clear();
+
+    // No pings before the peer has agreed to heartbeats
+    CaveTalk_NegotiationStart(&operator_negotiation);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&operator_handle));
+    ASSERT_EQ(0U, operator_heartbeat.pings_sent);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakNegotiation(&operator_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&rover_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&operator_handle));
+    ASSERT_EQ(0U, ring_buffer.Size());
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_AGREED, operator_negotiation.state);
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_AGREED, rover_negotiation.state);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakHeartbeat(&operator_handle));
+    ASSERT_EQ(1U, operator_heartbeat.pings_sent);
+
+    // Movement takes 18 bytes, more than the 16 the rover offered
+    ring_buffer.Clear();
+    ASSERT_EQ(16U, CaveTalk_NegotiationMaxPayload(&operator_negotiation));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_SpeakMovement(&operator_handle, 1.0, 0.5));
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    // A handle without negotiation ignores offers, as a revision 1 peer would
+    ring_buffer.Clear();
+    CaveTalk_NegotiationStart(&operator_negotiation);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SpeakNegotiation(&operator_handle));
+    rover_handle.negotiation = NULL;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Hear(&rover_handle));
+    ASSERT_EQ(0U, ring_buffer.Size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SpeakNegotiation(&kCaveTalk_HandleNull));
+}
\ No newline at end of file
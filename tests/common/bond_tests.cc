@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_bond.h"
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+static const std::size_t kPathCount = 2U;
+
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+/* One way link between the two bonds, a link that is down loses what is sent and one that is not delivering holds it */
+struct BondPipe
+{
+    RingBuffer<uint8_t, 2048U> bytes;
+    bool up         = true;
+    bool delivering = true;
+};
+
+static CaveTalk_Error_t BondPipeSend(void *const context, const void *const data, const size_t size)
+{
+    BondPipe *const pipe = static_cast<BondPipe *>(context);
+
+    if (pipe->up)
+    {
+        pipe->bytes.Write(static_cast<const uint8_t *>(data), size);
+    }
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t BondPipeReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received = static_cast<BondPipe *>(context)->bytes.Read(static_cast<uint8_t *>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t BondPipeAvailable(void *const context, size_t *const bytes_available)
+{
+    BondPipe *const pipe = static_cast<BondPipe *>(context);
+
+    *bytes_available = pipe->delivering ? pipe->bytes.Size() : 0U;
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+class BondTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        now = 1000U;
+
+        for (std::size_t index = 0U; index < kPathCount; index++)
+        {
+            const CaveTalk_LinkBinding_t sender_binding   = {&pipes_[index], BondPipeSend, nullptr, nullptr};
+            const CaveTalk_LinkBinding_t receiver_binding = {&pipes_[index], nullptr, BondPipeReceive, BondPipeAvailable};
+
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkBind(&sender_binding, &sender_links_[index]));
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkBind(&receiver_binding, &receiver_links_[index]));
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BondPathInit(&sender_paths_[index], &sender_links_[index]));
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BondPathInit(&receiver_paths_[index], &receiver_links_[index]));
+        }
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BondOpen(&sender_, sender_paths_.data(), kPathCount, Clock, &sender_link_));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BondOpen(&receiver_, receiver_paths_.data(), kPathCount, Clock, &receiver_link_));
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_BondClose(&sender_);
+        CaveTalk_BondClose(&receiver_);
+
+        for (std::size_t index = 0U; index < kPathCount; index++)
+        {
+            CaveTalk_LinkUnbind(&sender_links_[index]);
+            CaveTalk_LinkUnbind(&receiver_links_[index]);
+        }
+    }
+
+    void Speak(const CaveTalk_Id_t id, const uint8_t value)
+    {
+        const std::array<uint8_t, 4> payload = {value, value, value, value};
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&sender_link_, id, payload.data(), payload.size()));
+    }
+
+    void Expect(const CaveTalk_Id_t id, const uint8_t value)
+    {
+        std::array<uint8_t, 255> data   = {};
+        CaveTalk_Id_t            heard  = CAVE_TALK_ID_NONE;
+        CaveTalk_Length_t        length = 0U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&receiver_link_, &heard, data.data(), data.size(), &length));
+        ASSERT_EQ(id, heard);
+
+        if (CAVE_TALK_ID_NONE != id)
+        {
+            ASSERT_EQ(4U, length);
+            ASSERT_EQ(value, data[3U]);
+        }
+    }
+
+    std::array<BondPipe, kPathCount> pipes_;
+    std::array<CaveTalk_LinkHandle_t, kPathCount> sender_links_;
+    std::array<CaveTalk_LinkHandle_t, kPathCount> receiver_links_;
+    std::array<CaveTalk_BondPath_t, kPathCount> sender_paths_;
+    std::array<CaveTalk_BondPath_t, kPathCount> receiver_paths_;
+    CaveTalk_Bond_t sender_;
+    CaveTalk_Bond_t receiver_;
+    CaveTalk_LinkHandle_t sender_link_   = kCaveTalk_LinkHandleNull;
+    CaveTalk_LinkHandle_t receiver_link_ = kCaveTalk_LinkHandleNull;
+};
+
+TEST_F(BondTests, Init)
+{
+    CaveTalk_Bond_t       bond;
+    CaveTalk_LinkHandle_t link_handle = kCaveTalk_LinkHandleNull;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondPathInit(nullptr, &sender_links_[0]));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondPathInit(&sender_paths_[0], nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondOpen(nullptr, sender_paths_.data(), kPathCount, Clock, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondOpen(&bond, nullptr, kPathCount, Clock, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondOpen(&bond, sender_paths_.data(), kPathCount, nullptr, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondOpen(&bond, sender_paths_.data(), kPathCount, Clock, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_BondOpen(&bond, sender_paths_.data(), 0U, Clock, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_BondOpen(&bond, sender_paths_.data(), CAVE_TALK_BOND_PATH_COUNT_MAX + 1U, Clock, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BondClose(nullptr));
+}
+
+TEST_F(BondTests, Duplicated)
+{
+    const std::size_t kFrameSize = CAVE_TALK_HEADER_SIZE + CAVE_TALK_BOND_HEADER_SIZE + 4U + CAVE_TALK_CRC_SIZE;
+
+    Speak(2U, 0x10U);
+    Speak(3U, 0x20U);
+
+    for (BondPipe &pipe : pipes_)
+    {
+        std::array<uint8_t, 2U * kFrameSize> frames = {};
+
+        ASSERT_EQ(frames.size(), pipe.bytes.Read(frames.data(), frames.size()));
+        ASSERT_EQ(CAVE_TALK_ID_BOND, frames[CAVE_TALK_ID_INDEX]);
+        ASSERT_EQ(CAVE_TALK_BOND_HEADER_SIZE + 4U, frames[CAVE_TALK_LENGTH_INDEX]);
+        ASSERT_EQ(0U, frames[CAVE_TALK_HEADER_SIZE]);
+        ASSERT_EQ(1U, frames[kFrameSize + CAVE_TALK_HEADER_SIZE]);
+        ASSERT_EQ(3U, frames[kFrameSize + CAVE_TALK_HEADER_SIZE + 6U]);
+    }
+
+    /* Frames too large to wrap are refused */
+    std::array<uint8_t, CAVE_TALK_BOND_PAYLOAD_SIZE_MAX + 1U> payload = {};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_Speak(&sender_link_, 2U, payload.data(), payload.size()));
+    ASSERT_EQ(0U, pipes_[0].bytes.Size());
+}
+
+TEST_F(BondTests, OuterCrc)
+{
+    const std::size_t                       kPayloadSize = CAVE_TALK_BOND_HEADER_SIZE + 4U;
+    std::array<uint8_t, 255U>               frame        = {};
+    std::array<uint8_t, CAVE_TALK_CRC_SIZE> expected     = {};
+
+    Speak(2U, 0x10U);
+
+    /* The CRC after the Bond payload is the outer frame's own, covering the Bond header as well as the inner payload */
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE + kPayloadSize + CAVE_TALK_CRC_SIZE, pipes_[0].bytes.Read(frame.data(), frame.size()));
+    ASSERT_EQ(kPayloadSize, frame[CAVE_TALK_LENGTH_INDEX]);
+    ASSERT_TRUE(CaveTalk_CrcCheck(frame.data(), &frame[CAVE_TALK_HEADER_SIZE], &frame[CAVE_TALK_HEADER_SIZE + kPayloadSize]));
+
+    CaveTalk_CrcWrite(frame.data(), &frame[CAVE_TALK_HEADER_SIZE], expected.data());
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), &frame[CAVE_TALK_HEADER_SIZE + kPayloadSize]));
+}
+
+TEST_F(BondTests, FirstArrivalWins)
+{
+    Speak(2U, 0x10U);
+    Speak(3U, 0x20U);
+    Speak(4U, 0x30U);
+
+    Expect(2U, 0x10U);
+    Expect(3U, 0x20U);
+    Expect(4U, 0x30U);
+    Expect(CAVE_TALK_ID_NONE, 0U);
+
+    ASSERT_EQ(3U, receiver_paths_[0].stats.wins);
+    ASSERT_EQ(0U, receiver_paths_[0].stats.duplicates);
+    ASSERT_EQ(0U, receiver_paths_[1].stats.wins);
+    ASSERT_EQ(3U, receiver_paths_[1].stats.duplicates);
+    ASSERT_EQ(0U, receiver_.last_winner);
+}
+
+TEST_F(BondTests, FasterPathWins)
+{
+    /* Path 0 is slow, its copy arrives 200 us after path 1's */
+    pipes_[0].delivering = false;
+    Speak(2U, 0x10U);
+
+    now = 1300U;
+    Expect(2U, 0x10U);
+    ASSERT_EQ(1U, receiver_.last_winner);
+    ASSERT_EQ(300, receiver_paths_[1].stats.latency);
+
+    pipes_[0].delivering = true;
+    now                  = 1500U;
+    Expect(CAVE_TALK_ID_NONE, 0U);
+
+    ASSERT_EQ(0U, receiver_paths_[0].stats.wins);
+    ASSERT_EQ(1U, receiver_paths_[0].stats.duplicates);
+    ASSERT_EQ(500, receiver_paths_[0].stats.latency);
+    ASSERT_EQ(500, receiver_paths_[0].stats.latency_max);
+    ASSERT_EQ(200U, receiver_paths_[0].stats.smoothed_lag);
+    ASSERT_EQ(1U, receiver_paths_[1].stats.wins);
+}
+
+TEST_F(BondTests, PathLoss)
+{
+    pipes_[0].up = false;
+    Speak(2U, 0x10U);
+    Speak(2U, 0x11U);
+
+    Expect(2U, 0x10U);
+    Expect(2U, 0x11U);
+
+    /* Path 1 goes down as path 0 comes back, nothing is lost or repeated */
+    pipes_[0].up = true;
+    pipes_[1].up = false;
+    Speak(2U, 0x12U);
+
+    Expect(2U, 0x12U);
+    Expect(CAVE_TALK_ID_NONE, 0U);
+
+    ASSERT_EQ(1U, receiver_paths_[0].stats.wins);
+    ASSERT_EQ(2U, receiver_paths_[1].stats.wins);
+    ASSERT_EQ(0U, receiver_.last_winner);
+}
+
+TEST_F(BondTests, PassThrough)
+{
+    const std::array<uint8_t, 4> payload = {0x40U, 0x40U, 0x40U, 0x40U};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&sender_links_[1], 5U, payload.data(), payload.size()));
+
+    Expect(5U, 0x40U);
+    Expect(CAVE_TALK_ID_NONE, 0U);
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_bulk.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static const CaveTalk_Id_t kIdLights = 4U; /* See ids.proto */
+static const std::size_t kCapacity   = 256U;
+
+static void AppendDouble(std::vector<uint8_t> &bytes, const uint8_t tag, const double value)
+{
+    uint8_t little_endian[sizeof(double)];
+
+    std::memcpy(little_endian, &value, sizeof(value));
+    bytes.push_back(tag);
+    bytes.insert(bytes.end(), little_endian, little_endian + sizeof(little_endian));
+}
+
+static void AppendFrame(std::vector<uint8_t> &data, const CaveTalk_Id_t id, const std::vector<uint8_t> &payload)
+{
+    data.push_back(CAVE_TALK_VERSION);
+    data.push_back(id);
+    data.push_back(static_cast<uint8_t>(payload.size()));
+    data.insert(data.end(), payload.begin(), payload.end());
+    data.insert(data.end(), CAVE_TALK_CRC_SIZE, 0U);
+}
+
+/* As the encoders write it, both fields in order */
+static void AppendMessage(std::vector<uint8_t> &data, const CaveTalk_Id_t id, const double first, const double second)
+{
+    std::vector<uint8_t> payload;
+
+    AppendDouble(payload, 0x09U, first);
+    AppendDouble(payload, 0x11U, second);
+    AppendFrame(data, id, payload);
+}
+
+class BulkTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        columns_.speed                    = speed_.data();
+        columns_.turn_rate                = turn_rate_.data();
+        columns_.movement_capacity        = kCapacity;
+        columns_.movement_count           = 0U;
+        columns_.pan                      = pan_.data();
+        columns_.tilt                     = tilt_.data();
+        columns_.camera_movement_capacity = kCapacity;
+        columns_.camera_movement_count    = 0U;
+        columns_.skipped                  = 0U;
+        columns_.fallbacks                = 0U;
+    }
+
+    CaveTalk_BulkColumns_t columns_;
+    std::vector<double> speed_     = std::vector<double>(kCapacity);
+    std::vector<double> turn_rate_ = std::vector<double>(kCapacity);
+    std::vector<double> pan_       = std::vector<double>(kCapacity);
+    std::vector<double> tilt_      = std::vector<double>(kCapacity);
+    std::vector<uint8_t> data_;
+    std::size_t consumed_ = 0U;
+};
+
+TEST_F(BulkTests, Init)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BulkDecode(nullptr, data_.data(), 0U, &consumed_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BulkDecode(&columns_, nullptr, 0U, &consumed_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_BulkDecode(&columns_, data_.data(), 0U, nullptr));
+
+    AppendMessage(data_, CAVE_TALK_ID_MOVEMENT, 1.0, 2.0);
+    data_[CAVE_TALK_VERSION_INDEX] = CAVE_TALK_VERSION + 1U;
+    ASSERT_EQ(CAVE_TALK_ERROR_VERSION, CaveTalk_BulkDecode(&columns_, data_.data(), data_.size(), &consumed_));
+    ASSERT_EQ(0U, consumed_);
+}
+
+TEST_F(BulkTests, FixedLayout)
+{
+    /* Runs of odd length, so both the paired and the single frame paths are taken */
+    for (std::size_t index = 0U; index < 101U; index++)
+    {
+        AppendMessage(data_, CAVE_TALK_ID_MOVEMENT, static_cast<double>(index), -static_cast<double>(index));
+
+        if (0U == (index % 7U))
+        {
+            AppendMessage(data_, CAVE_TALK_ID_CAMERA_MOVEMENT, 0.5 * static_cast<double>(index), 0.25);
+        }
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BulkDecode(&columns_, data_.data(), data_.size(), &consumed_));
+    ASSERT_EQ(data_.size(), consumed_);
+    ASSERT_EQ(101U, columns_.movement_count);
+    ASSERT_EQ(15U, columns_.camera_movement_count);
+    ASSERT_EQ(0U, columns_.fallbacks);
+
+    for (std::size_t index = 0U; index < columns_.movement_count; index++)
+    {
+        ASSERT_EQ(static_cast<double>(index), speed_[index]);
+        ASSERT_EQ(-static_cast<double>(index), turn_rate_[index]);
+    }
+    ASSERT_EQ(24.5, pan_[7U]);
+    ASSERT_EQ(0.25, tilt_[14U]);
+}
+
+TEST_F(BulkTests, Fallback)
+{
+    std::vector<uint8_t> zero;
+    std::vector<uint8_t> reversed;
+    std::vector<uint8_t> unknown;
+
+    /* Zero fields are left out, fields may come in any order, and unknown fields are skipped */
+    AppendDouble(zero, 0x11U, 3.0);
+    AppendDouble(reversed, 0x11U, 5.0);
+    AppendDouble(reversed, 0x09U, 4.0);
+    unknown = {0x18U, 0x96U, 0x01U, 0x22U, 0x02U, 0xAAU, 0xBBU, 0x2DU, 0x01U, 0x02U, 0x03U, 0x04U};
+    AppendDouble(unknown, 0x09U, 6.0);
+
+    AppendFrame(data_, CAVE_TALK_ID_MOVEMENT, zero);
+    AppendMessage(data_, CAVE_TALK_ID_MOVEMENT, 1.0, 2.0);
+    AppendFrame(data_, CAVE_TALK_ID_CAMERA_MOVEMENT, reversed);
+    AppendFrame(data_, CAVE_TALK_ID_MOVEMENT, unknown);
+    AppendFrame(data_, CAVE_TALK_ID_MOVEMENT, {});
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BulkDecode(&columns_, data_.data(), data_.size(), &consumed_));
+    ASSERT_EQ(data_.size(), consumed_);
+    ASSERT_EQ(4U, columns_.fallbacks);
+    ASSERT_EQ(4U, columns_.movement_count);
+    ASSERT_EQ(0.0, speed_[0U]);
+    ASSERT_EQ(3.0, turn_rate_[0U]);
+    ASSERT_EQ(1.0, speed_[1U]);
+    ASSERT_EQ(6.0, speed_[2U]);
+    ASSERT_EQ(0.0, turn_rate_[2U]);
+    ASSERT_EQ(0.0, speed_[3U]);
+    ASSERT_EQ(4.0, pan_[0U]);
+    ASSERT_EQ(5.0, tilt_[0U]);
+
+    /* A malformed message stops the decode at its frame */
+    data_.clear();
+    AppendMessage(data_, CAVE_TALK_ID_CAMERA_MOVEMENT, 1.0, 2.0);
+    AppendFrame(data_, CAVE_TALK_ID_CAMERA_MOVEMENT, {0x09U, 0x00U, 0x00U});
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_BulkDecode(&columns_, data_.data(), data_.size(), &consumed_));
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE + 18U + CAVE_TALK_CRC_SIZE, consumed_);
+    ASSERT_EQ(2U, columns_.camera_movement_count);
+}
+
+TEST_F(BulkTests, SkippedPartialFull)
+{
+    AppendFrame(data_, kIdLights, {0x08U, 0x01U});
+    AppendMessage(data_, CAVE_TALK_ID_CAMERA_MOVEMENT, 1.0, 2.0);
+    for (std::size_t index = 0U; index < 5U; index++)
+    {
+        AppendMessage(data_, CAVE_TALK_ID_MOVEMENT, static_cast<double>(index), 0.0);
+    }
+
+    /* Frames of other ids and of messages without columns are skipped, a frame cut off is left for the next call */
+    columns_.pan               = nullptr;
+    columns_.movement_capacity = 3U;
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_BulkDecode(&columns_, data_.data(), data_.size() - 1U, &consumed_));
+    ASSERT_EQ(2U, columns_.skipped);
+    ASSERT_EQ(3U, columns_.movement_count);
+
+    columns_.movement_count = 0U;
+    const std::size_t first = consumed_;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BulkDecode(&columns_, &data_[first], data_.size() - first - 1U, &consumed_));
+    ASSERT_EQ(1U, columns_.movement_count);
+    ASSERT_EQ(3.0, speed_[0U]);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_BulkDecode(&columns_, &data_[first + consumed_], data_.size() - first - consumed_, &consumed_));
+    ASSERT_EQ(2U, columns_.movement_count);
+    ASSERT_EQ(4.0, speed_[1U]);
+}
\ No newline at end of file
@@ -103,6 +103,21 @@ TEST(CommonTests, SpeakAndListen)
     ASSERT_THAT(data_receive, testing::ElementsAreArray(data_send));
 }
 
+TEST(CommonTests, ListenVersion)
+{
+    const uint8_t     frame[]         = {CAVE_TALK_VERSION + 1U, 0x0F, 1U, 0xDE, 0U, 0U, 0U, 0U};
+    uint8_t           data_receive[1] = {0U};
+    CaveTalk_Id_t     id              = 0U;
+    CaveTalk_Length_t length          = 0U;
+
+    ring_buffer.Clear();
+
+    // A frame from another version is refused before its payload is read
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Send(frame, sizeof(frame)));
+    ASSERT_EQ(CAVE_TALK_ERROR_VERSION, CaveTalk_Listen(&kLinkHandle, &id, static_cast<void *>(data_receive), sizeof(data_receive), &length));
+    ASSERT_EQ(sizeof(frame) - CAVE_TALK_HEADER_SIZE, ring_buffer.Size());
+}
+
 TEST(CommonTests, NullErrors)
 {
     uint8_t data_send[] = {0xDE, 0xAD, 0xBE, 0xEF};
@@ -142,7 +157,7 @@ TEST(CommonTests, SizeAndIncompleteness)
 
     uint8_t data_send[10U] = {0U};
     uint8_t data_receive[3U] = {0U};
-    uint8_t data_rand_0[4U] = {0U};
+    uint8_t data_rand_0[4U] = {CAVE_TALK_VERSION, 0U, 0U, 0U};
     CaveTalk_Id_t id = 0U;
     CaveTalk_Length_t length = 0U;
 
@@ -0,0 +1,138 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_delta.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static const CaveTalk_Id_t kIdMovement       = 2U; /* See ids.proto */
+static const CaveTalk_Id_t kIdCameraMovement = 3U; /* See ids.proto */
+static const double kQuantum                 = 0.001;
+static const uint32_t kKeyframeInterval      = 4U;
+static const double kTolerance               = kQuantum * 0.501; /* Half a quantum, with room for rounding */
+
+class DeltaTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_DeltaInit(&sender_, kIdMovement, kQuantum, kKeyframeInterval));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_DeltaInit(&receiver_, kIdMovement, kQuantum, kKeyframeInterval));
+    }
+
+    CaveTalk_Length_t Encode(const double first, const double second)
+    {
+        const double      values[CAVE_TALK_DELTA_VALUES] = {first, second};
+        CaveTalk_Length_t length                         = 0U;
+
+        EXPECT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_DeltaEncode(&sender_, values, data_.data(), data_.size(), &length));
+
+        return length;
+    }
+
+    CaveTalk_Id_t Decode(const CaveTalk_Length_t length)
+    {
+        CaveTalk_Id_t id = CAVE_TALK_ID_NONE;
+
+        EXPECT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_DeltaDecode(&receiver_, 1U, data_.data(), length, &id, values_));
+
+        return id;
+    }
+
+    CaveTalk_DeltaStream_t sender_;
+    CaveTalk_DeltaStream_t receiver_;
+    std::array<uint8_t, CAVE_TALK_DELTA_SIZE_MAX> data_ = {};
+    double values_[CAVE_TALK_DELTA_VALUES]            = {0.0, 0.0};
+};
+
+TEST_F(DeltaTests, Init)
+{
+    const double      values[CAVE_TALK_DELTA_VALUES] = {0.0, 0.0};
+    CaveTalk_Length_t length                         = 0U;
+    CaveTalk_Id_t     id                             = CAVE_TALK_ID_NONE;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_DeltaInit(nullptr, kIdMovement, kQuantum, kKeyframeInterval));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_DeltaInit(&sender_, kIdMovement, 0.0, kKeyframeInterval));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_DeltaInit(&sender_, kIdMovement, kQuantum, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_DeltaEncode(&sender_, nullptr, data_.data(), data_.size(), &length));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_DeltaEncode(&sender_, values, data_.data(), data_.size() - 1U, &length));
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_DeltaDecode(&receiver_, 1U, data_.data(), 1U, &id, values_));
+
+    /* A stream the receiver does not know */
+    data_[0U] = kIdCameraMovement;
+    data_[1U] = 0x01U;
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, CaveTalk_DeltaDecode(&receiver_, 1U, data_.data(), 4U, &id, values_));
+}
+
+TEST_F(DeltaTests, RoundTrip)
+{
+    const double kSpeeds[] = {1.0, 1.0004, 1.013, 0.987, -0.25, 1.5};
+
+    for (const double speed : kSpeeds)
+    {
+        ASSERT_EQ(kIdMovement, Decode(Encode(speed, -speed / 2.0)));
+        ASSERT_NEAR(speed, values_[0U], kTolerance);
+        ASSERT_NEAR(-speed / 2.0, values_[1U], kTolerance);
+    }
+
+    /* Out of range values are clamped rather than wrapped */
+    ASSERT_EQ(kIdMovement, Decode(Encode(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN())));
+    ASSERT_LT(1.0e6, values_[0U]);
+    ASSERT_EQ(0.0, values_[1U]);
+}
+
+TEST_F(DeltaTests, Keyframes)
+{
+    /* The first frame is always a keyframe, small changes after it are sent as deltas */
+    const CaveTalk_Length_t keyframe_length = Encode(2.0, 1.0);
+    ASSERT_EQ(1U, sender_.counters.keyframes);
+
+    const CaveTalk_Length_t delta_length = Encode(2.001, 1.0);
+    ASSERT_EQ(1U, sender_.counters.deltas);
+    ASSERT_LT(delta_length, keyframe_length);
+    ASSERT_EQ(4U, delta_length);
+
+    /* Every keyframe_interval frames a keyframe is sent regardless */
+    for (uint32_t index = 2U; index < kKeyframeInterval; index++)
+    {
+        Encode(2.001, 1.0);
+    }
+    ASSERT_EQ(1U, sender_.counters.keyframes);
+    Encode(2.001, 1.0);
+    ASSERT_EQ(2U, sender_.counters.keyframes);
+
+    /* Values near zero are no larger sent whole, so they are sent as keyframes */
+    Encode(0.0, 0.0);
+    ASSERT_EQ(3U, sender_.counters.keyframes);
+
+    CaveTalk_DeltaKeyframe(&sender_);
+    Encode(0.0, 0.0);
+    ASSERT_EQ(4U, sender_.counters.keyframes);
+}
+
+TEST_F(DeltaTests, LostKeyframe)
+{
+    ASSERT_EQ(kIdMovement, Decode(Encode(3.0, 3.0)));
+    ASSERT_EQ(kIdMovement, Decode(Encode(3.002, 3.0)));
+
+    /* The keyframe after the interval is lost, the deltas against it are dropped rather than applied to the old one */
+    for (uint32_t index = 2U; index < kKeyframeInterval; index++)
+    {
+        Decode(Encode(3.002, 3.0));
+    }
+    Encode(3.1, 3.1);
+    ASSERT_EQ(CAVE_TALK_ID_NONE, Decode(Encode(3.101, 3.1)));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, Decode(Encode(3.102, 3.1)));
+    ASSERT_EQ(2U, receiver_.counters.dropped);
+
+    /* Decoding recovers at the next keyframe */
+    CaveTalk_DeltaKeyframe(&sender_);
+    ASSERT_EQ(kIdMovement, Decode(Encode(3.2, 3.1)));
+    ASSERT_NEAR(3.2, values_[0U], kTolerance);
+    ASSERT_EQ(kIdMovement, Decode(Encode(3.201, 3.1)));
+    ASSERT_NEAR(3.201, values_[0U], kTolerance);
+}
\ No newline at end of file
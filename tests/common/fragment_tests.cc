@@ -0,0 +1,440 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_fragment.h"
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+#include "cave_talk_varint.h"
+
+static const CaveTalk_Id_t kControlId = 4U;
+static const CaveTalk_Id_t kObjectId  = 0x42U;
+
+static std::vector<uint8_t>    wire;
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+static CaveTalk_Error_t Collect(const void *const data, const size_t size)
+{
+    const uint8_t *const bytes = static_cast<const uint8_t *>(data);
+
+    wire.insert(wire.end(), bytes, bytes + size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static const CaveTalk_LinkHandle_t kCollectHandle = {
+    .send      = Collect,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+// Splits everything spoken so far back into frames
+static std::vector<std::pair<CaveTalk_Id_t, std::vector<uint8_t>>> Frames(void)
+{
+    std::vector<std::pair<CaveTalk_Id_t, std::vector<uint8_t>>> frames;
+    uint8_t                                                     payload[UINT8_MAX];
+    std::size_t                                                 offset = 0U;
+    CaveTalk_FrameParser_t                                      parser;
+
+    CaveTalk_FrameParserInit(&parser, payload, sizeof(payload));
+
+    while (offset < wire.size())
+    {
+        std::size_t       consumed = 0U;
+        CaveTalk_Id_t     id       = 0U;
+        CaveTalk_Length_t length   = 0U;
+
+        if (CAVE_TALK_ERROR_NONE == CaveTalk_FrameParse(&parser, &wire[offset], wire.size() - offset, &consumed, &id, &length))
+        {
+            frames.emplace_back(id, std::vector<uint8_t>(payload, payload + length));
+        }
+        offset += consumed;
+    }
+
+    wire.clear();
+
+    return frames;
+}
+
+static std::vector<uint8_t> Pattern(const std::size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+
+    for (std::size_t index = 0U; index < size; index++)
+    {
+        bytes[index] = static_cast<uint8_t>((index * 31U) ^ (index >> 8U));
+    }
+
+    return bytes;
+}
+
+// Streams an object one chunk at a time, as if reading it from storage
+static void SpeakObject(CaveTalk_Fragmenter_t &fragmenter, const std::vector<uint8_t> &object)
+{
+    std::size_t offset = 0U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentStart(&fragmenter, kObjectId, object.size()));
+    while (fragmenter.active)
+    {
+        const std::size_t chunk_size = CaveTalk_FragmentChunkSize(&fragmenter);
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentSpeak(&fragmenter, &kCollectHandle, &object[offset], chunk_size));
+        offset += chunk_size;
+    }
+    ASSERT_EQ(object.size(), offset);
+}
+
+TEST(FragmentTests, Varint)
+{
+    const uint32_t values[] = {0U, 1U, 127U, 128U, 300U, 16383U, 16384U, 65535U, 2097152U, UINT32_MAX};
+    const size_t   sizes[]  = {1U, 1U, 1U, 2U, 2U, 2U, 3U, 3U, 4U, 5U};
+    uint8_t        bytes[CAVE_TALK_VARINT_SIZE_MAX];
+
+    for (std::size_t index = 0U; index < (sizeof(values) / sizeof(values[0])); index++)
+    {
+        std::size_t written = 0U;
+        std::size_t read    = 0U;
+        uint32_t    decoded = 0U;
+
+        ASSERT_EQ(sizes[index], CaveTalk_VarintSize(values[index]));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_VarintEncode(values[index], bytes, sizeof(bytes), &written));
+        ASSERT_EQ(sizes[index], written);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_VarintDecode(bytes, written, &decoded, &read));
+        ASSERT_EQ(values[index], decoded);
+        ASSERT_EQ(written, read);
+
+        if (written > 1U)
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_VarintDecode(bytes, written - 1U, &decoded, &read));
+        }
+    }
+
+    const uint8_t overlong[] = {0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x01U};
+    std::size_t   read       = 0U;
+    uint32_t      decoded    = 0U;
+    std::size_t   written    = 0U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_VarintDecode(overlong, sizeof(overlong), &decoded, &read));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_VarintEncode(UINT32_MAX, bytes, 4U, &written));
+}
+
+TEST(FragmentTests, Init)
+{
+    CaveTalk_Fragmenter_t     fragmenter;
+    CaveTalk_Reassembler_t    reassembler;
+    CaveTalk_ReassemblySlot_t slots[2];
+    uint8_t                   pool[64];
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_FragmenterInit(nullptr, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_FragmenterInit(&fragmenter, CAVE_TALK_FRAGMENT_STREAM_COUNT, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MIN - 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(0U, CaveTalk_FragmentChunkSize(&fragmenter));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_FragmentSpeak(&fragmenter, &kCollectHandle, pool, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_FragmentStart(&fragmenter, kObjectId, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentStart(&fragmenter, kObjectId, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_FragmentStart(&fragmenter, kObjectId, 1000U));
+
+    // Transfer, offset, id and a two byte length
+    ASSERT_EQ(CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX - 5U, CaveTalk_FragmentChunkSize(&fragmenter));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ReassemblerInit(&reassembler, nullptr, sizeof(pool), slots, 2U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ReassemblerInit(&reassembler, pool, sizeof(pool), slots, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool, sizeof(pool), slots, 2U));
+    ASSERT_EQ(32U, reassembler.slot_size);
+}
+
+TEST(FragmentTests, StreamInterleaved)
+{
+    const std::vector<uint8_t> object  = Pattern(10000U);
+    const uint8_t              control = 1U;
+    std::vector<uint8_t>       pool(object.size());
+    CaveTalk_ReassemblySlot_t  slot;
+    CaveTalk_Reassembler_t     reassembler;
+    CaveTalk_Fragmenter_t      fragmenter;
+    CaveTalk_FragmentObject_t  heard      = {0U, nullptr, 0U};
+    std::size_t                offset     = 0U;
+    std::size_t                completions = 0U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 3U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool.data(), pool.size(), &slot, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentStart(&fragmenter, kObjectId, object.size()));
+
+    // One control frame and one fragment per tick, the control frames are never held back by the object
+    wire.clear();
+    while (fragmenter.active)
+    {
+        const std::size_t chunk_size = CaveTalk_FragmentChunkSize(&fragmenter);
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kCollectHandle, kControlId, &control, sizeof(control)));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentSpeak(&fragmenter, &kCollectHandle, &object[offset], chunk_size));
+        offset += chunk_size;
+    }
+
+    const auto frames = Frames();
+
+    ASSERT_EQ(0U, frames.size() % 2U);
+    for (std::size_t index = 0U; index < frames.size(); index++)
+    {
+        const CaveTalk_Error_t error = CaveTalk_ReassemblerHear(&reassembler, frames[index].second.data(), frames[index].second.size(), &heard);
+
+        if (0U == (index % 2U))
+        {
+            ASSERT_EQ(kControlId, frames[index].first);
+            continue;
+        }
+
+        ASSERT_EQ(CAVE_TALK_ID_FRAGMENT, frames[index].first);
+        if ((index + 1U) < frames.size())
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, error);
+        }
+        else
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, error);
+            completions++;
+        }
+    }
+
+    ASSERT_EQ(1U, completions);
+    ASSERT_EQ(kObjectId, heard.id);
+    ASSERT_EQ(object, std::vector<uint8_t>(heard.data, heard.data + heard.length));
+    ASSERT_EQ(frames.size() / 2U, reassembler.counters.fragments);
+    ASSERT_EQ(1U, reassembler.counters.completed);
+    ASSERT_EQ(0U, reassembler.counters.dropped);
+}
+
+TEST(FragmentTests, SingleFrame)
+{
+    const std::vector<uint8_t> object = Pattern(100U);
+    uint8_t                    pool[16];
+    CaveTalk_ReassemblySlot_t  slot;
+    CaveTalk_Reassembler_t     reassembler;
+    CaveTalk_Fragmenter_t      fragmenter;
+    CaveTalk_FragmentObject_t  heard = {0U, nullptr, 0U};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool, sizeof(pool), &slot, 1U));
+
+    wire.clear();
+    SpeakObject(fragmenter, object);
+
+    const auto frames = Frames();
+
+    // Delivered from the frame itself, so it does not need to fit in the pool
+    ASSERT_EQ(1U, frames.size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerHear(&reassembler, frames[0].second.data(), frames[0].second.size(), &heard));
+    ASSERT_EQ(frames[0].second.data() + frames[0].second.size() - object.size(), heard.data);
+    ASSERT_EQ(object, std::vector<uint8_t>(heard.data, heard.data + heard.length));
+}
+
+TEST(FragmentTests, Limit)
+{
+    const std::vector<uint8_t> object = Pattern(100U);
+    CaveTalk_Fragmenter_t      fragmenter;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+
+    // Cut to a smaller negotiated max payload, a limit below the header leaves no room for data
+    CaveTalk_FragmentLimit(&fragmenter, 40U);
+    wire.clear();
+    SpeakObject(fragmenter, object);
+
+    const auto frames = Frames();
+
+    ASSERT_EQ(3U, frames.size());
+    for (const auto &frame : frames)
+    {
+        ASSERT_GE(40U, frame.second.size());
+    }
+
+    CaveTalk_FragmentLimit(&fragmenter, 2U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentStart(&fragmenter, kObjectId, object.size()));
+    ASSERT_EQ(0U, CaveTalk_FragmentChunkSize(&fragmenter));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_FragmentSpeak(&fragmenter, &kCollectHandle, object.data(), 1U));
+}
+
+TEST(FragmentTests, TooLarge)
+{
+    const std::vector<uint8_t> object = Pattern(1000U);
+    uint8_t                    pool[512];
+    CaveTalk_ReassemblySlot_t  slot;
+    CaveTalk_Reassembler_t     reassembler;
+    CaveTalk_Fragmenter_t      fragmenter;
+    CaveTalk_FragmentObject_t  heard = {0U, nullptr, 0U};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool, sizeof(pool), &slot, 1U));
+
+    wire.clear();
+    SpeakObject(fragmenter, object);
+
+    const auto frames = Frames();
+
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ReassemblerHear(&reassembler, frames[0].second.data(), frames[0].second.size(), &heard));
+    for (std::size_t index = 1U; index < frames.size(); index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_ReassemblerHear(&reassembler, frames[index].second.data(), frames[index].second.size(), &heard));
+    }
+    ASSERT_EQ(0U, reassembler.counters.completed);
+    ASSERT_EQ(frames.size(), reassembler.counters.dropped);
+}
+
+TEST(FragmentTests, LostFragment)
+{
+    const std::vector<uint8_t> object = Pattern(1000U);
+    std::vector<uint8_t>       pool(object.size());
+    CaveTalk_ReassemblySlot_t  slot;
+    CaveTalk_Reassembler_t     reassembler;
+    CaveTalk_Fragmenter_t      fragmenter;
+    CaveTalk_FragmentObject_t  heard = {0U, nullptr, 0U};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool.data(), pool.size(), &slot, 1U));
+
+    wire.clear();
+    SpeakObject(fragmenter, object);
+    SpeakObject(fragmenter, object);
+
+    auto frames = Frames();
+
+    ASSERT_EQ(0U, frames.size() % 2U);
+    frames.erase(frames.begin() + 1);
+
+    for (const auto &frame : frames)
+    {
+        const CaveTalk_Error_t error = CaveTalk_ReassemblerHear(&reassembler, frame.second.data(), frame.second.size(), &heard);
+
+        ASSERT_TRUE((CAVE_TALK_ERROR_NONE == error) || (CAVE_TALK_ERROR_INCOMPLETE == error));
+    }
+
+    // The first object is dropped at the gap along with its last fragment, the second one on the same stream completes
+    ASSERT_EQ(1U, reassembler.counters.completed);
+    ASSERT_EQ(2U, reassembler.counters.dropped);
+    ASSERT_EQ(object, std::vector<uint8_t>(heard.data, heard.data + heard.length));
+}
+
+TEST(FragmentTests, Expire)
+{
+    const std::vector<uint8_t> object = Pattern(600U);
+    std::vector<uint8_t>       pool(2U * object.size());
+    CaveTalk_ReassemblySlot_t  slots[2U];
+    CaveTalk_Reassembler_t     reassembler;
+    CaveTalk_Fragmenter_t      fragmenter;
+    CaveTalk_TimerWheel_t      wheel;
+    CaveTalk_FragmentObject_t  heard    = {0U, nullptr, 0U};
+    CaveTalk_Microseconds_t    deadline = 0U;
+    std::size_t                fired    = 0U;
+
+    now = 0U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelInit(&wheel, Clock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&fragmenter, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool.data(), pool.size(), slots, 2U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ReassemblerSchedule(&reassembler, &wheel, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerSchedule(&reassembler, &wheel, 50000U));
+    ASSERT_FALSE(CaveTalk_ReassemblerDeadline(&reassembler, &deadline));
+
+    wire.clear();
+    SpeakObject(fragmenter, object);
+
+    const auto frames = Frames();
+
+    ASSERT_EQ(3U, frames.size());
+
+    // The object is timed from its latest fragment
+    now = 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_ReassemblerHear(&reassembler, frames[0U].second.data(), frames[0U].second.size(), &heard));
+    ASSERT_TRUE(CaveTalk_ReassemblerDeadline(&reassembler, &deadline));
+    ASSERT_EQ(51000U, deadline);
+    ASSERT_EQ(1U, wheel.active);
+
+    now = 30000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_ReassemblerHear(&reassembler, frames[1U].second.data(), frames[1U].second.size(), &heard));
+    ASSERT_TRUE(CaveTalk_ReassemblerDeadline(&reassembler, &deadline));
+    ASSERT_EQ(80000U, deadline);
+
+    // The timer armed for the first fragment finds the object heard since and rearms on its new deadline
+    now = 51000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel, &fired));
+    ASSERT_EQ(1U, fired);
+    ASSERT_EQ(0U, reassembler.counters.expired);
+    ASSERT_EQ(1U, wheel.active);
+
+    now = 80000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel, &fired));
+    ASSERT_EQ(1U, fired);
+    ASSERT_EQ(1U, reassembler.counters.expired);
+    ASSERT_EQ(0U, wheel.active);
+    ASSERT_FALSE(CaveTalk_ReassemblerDeadline(&reassembler, &deadline));
+
+    // The last fragment arrives after its object was given up on
+    ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_ReassemblerHear(&reassembler, frames[2U].second.data(), frames[2U].second.size(), &heard));
+    ASSERT_EQ(0U, reassembler.counters.completed);
+    ASSERT_EQ(1U, reassembler.counters.dropped);
+}
+
+TEST(FragmentTests, Evict)
+{
+    const std::vector<uint8_t> object = Pattern(600U);
+    std::vector<uint8_t>       pool(object.size());
+    CaveTalk_ReassemblySlot_t  slot;
+    CaveTalk_Reassembler_t     reassembler;
+    CaveTalk_Fragmenter_t      first;
+    CaveTalk_Fragmenter_t      second;
+    CaveTalk_FragmentObject_t  heard = {0U, nullptr, 0U};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&first, 0U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmenterInit(&second, 1U, CAVE_TALK_FRAGMENT_FRAME_SIZE_MAX));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReassemblerInit(&reassembler, pool.data(), pool.size(), &slot, 1U));
+
+    // Both objects in flight at once with room for only one
+    wire.clear();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentStart(&first, kObjectId, object.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentStart(&second, kObjectId + 1U, object.size()));
+
+    std::size_t first_offset  = 0U;
+    std::size_t second_offset = 0U;
+
+    while (first.active || second.active)
+    {
+        std::size_t chunk_size = CaveTalk_FragmentChunkSize(&first);
+
+        if (0U != chunk_size)
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentSpeak(&first, &kCollectHandle, &object[first_offset], chunk_size));
+            first_offset += chunk_size;
+        }
+
+        chunk_size = CaveTalk_FragmentChunkSize(&second);
+        if (0U != chunk_size)
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FragmentSpeak(&second, &kCollectHandle, &object[second_offset], chunk_size));
+            second_offset += chunk_size;
+        }
+    }
+
+    std::size_t completions = 0U;
+
+    for (const auto &frame : Frames())
+    {
+        if (CAVE_TALK_ERROR_NONE == CaveTalk_ReassemblerHear(&reassembler, frame.second.data(), frame.second.size(), &heard))
+        {
+            completions++;
+        }
+    }
+
+    ASSERT_EQ(1U, completions);
+    ASSERT_EQ(kObjectId + 1U, heard.id);
+    ASSERT_EQ(1U, reassembler.counters.evicted);
+    ASSERT_EQ(object, std::vector<uint8_t>(heard.data, heard.data + heard.length));
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static std::vector<uint8_t> frame_bytes;
+
+static CaveTalk_Error_t Collect(const void *const data, const size_t size)
+{
+    const uint8_t *const bytes = static_cast<const uint8_t *>(data);
+
+    frame_bytes.insert(frame_bytes.end(), bytes, bytes + size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static const CaveTalk_LinkHandle_t kCollectHandle = {
+    .send      = Collect,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+TEST(FrameParserTests, ParseWhole)
+{
+    uint8_t                payload[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint8_t                buffer[8] = {0U};
+    std::size_t            consumed  = 0U;
+    CaveTalk_Id_t          id        = 0U;
+    CaveTalk_Length_t      length    = 0U;
+    CaveTalk_FrameParser_t parser;
+
+    frame_bytes.clear();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kCollectHandle, 0x0A, payload, sizeof(payload)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kCollectHandle, 0x0B, payload, 0U));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_FrameParserInit(nullptr, buffer, sizeof(buffer)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParserInit(&parser, buffer, sizeof(buffer)));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParse(&parser, frame_bytes.data(), frame_bytes.size(), &consumed, &id, &length));
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE + sizeof(payload) + CAVE_TALK_CRC_SIZE, consumed);
+    ASSERT_EQ(0x0A, id);
+    ASSERT_EQ(sizeof(payload), length);
+    ASSERT_THAT(payload, testing::ElementsAreArray(buffer, sizeof(payload)));
+    ASSERT_EQ(0U, CaveTalk_FrameParserPending(&parser));
+
+    std::size_t offset = consumed;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParse(&parser, frame_bytes.data() + offset, frame_bytes.size() - offset, &consumed, &id, &length));
+    ASSERT_EQ(0x0B, id);
+    ASSERT_EQ(0U, length);
+    ASSERT_EQ(frame_bytes.size(), offset + consumed);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_FrameParse(&parser, nullptr, 0U, &consumed, &id, &length));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_FrameParse(&parser, frame_bytes.data(), frame_bytes.size(), nullptr, &id, &length));
+}
+
+TEST(FrameParserTests, ParseByteByByte)
+{
+    uint8_t                payload[] = {0x01, 0x02, 0x03};
+    std::size_t            consumed  = 0U;
+    std::size_t            frames    = 0U;
+    CaveTalk_Id_t          id        = 0U;
+    CaveTalk_Length_t      length    = 0U;
+    CaveTalk_FrameParser_t parser;
+
+    frame_bytes.clear();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kCollectHandle, 0x0C, payload, sizeof(payload)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParserInit(&parser, nullptr, 0U));
+
+    for (std::size_t index = 0U; index < frame_bytes.size(); index++)
+    {
+        const CaveTalk_Error_t error = CaveTalk_FrameParse(&parser, &frame_bytes[index], 1U, &consumed, &id, &length);
+
+        ASSERT_EQ(1U, consumed);
+        if (CAVE_TALK_ERROR_NONE == error)
+        {
+            frames++;
+        }
+        else
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, error);
+            ASSERT_EQ(index + 1U, CaveTalk_FrameParserPending(&parser));
+        }
+    }
+
+    ASSERT_EQ(1U, frames);
+    ASSERT_EQ(0x0C, id);
+    ASSERT_EQ(sizeof(payload), length);
+}
+
+TEST(FrameParserTests, Resync)
+{
+    uint8_t                payload[] = {0xAA, 0xBB};
+    uint8_t                buffer[1] = {0U};
+    std::size_t            consumed  = 0U;
+    std::size_t            offset    = 0U;
+    std::size_t            errors    = 0U;
+    CaveTalk_Id_t          id        = 0U;
+    CaveTalk_Length_t      length    = 0U;
+    CaveTalk_FrameParser_t parser;
+
+    frame_bytes = {0x00, 0x07, 0x55};
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kCollectHandle, 0x0D, payload, sizeof(payload)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParserInit(&parser, nullptr, 0U));
+
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_VERSION;
+    while (CAVE_TALK_ERROR_VERSION == error)
+    {
+        error   = CaveTalk_FrameParse(&parser, frame_bytes.data() + offset, frame_bytes.size() - offset, &consumed, &id, &length);
+        offset += consumed;
+        errors += (CAVE_TALK_ERROR_VERSION == error) ? 1U : 0U;
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, error);
+    ASSERT_EQ(3U, errors);
+    ASSERT_EQ(0x0D, id);
+    ASSERT_EQ(frame_bytes.size(), offset);
+
+    // Payloads that do not fit the buffer are rejected and resynchronized past
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParserInit(&parser, buffer, sizeof(buffer)));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_FrameParse(&parser, frame_bytes.data() + 3U, frame_bytes.size() - 3U, &consumed, &id, &length));
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE, consumed);
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE - 1U, CaveTalk_FrameParserPending(&parser));
+}
\ No newline at end of file
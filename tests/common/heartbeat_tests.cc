@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_heartbeat.h"
+#include "cave_talk_types.h"
+
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+TEST(HeartbeatTests, Init)
+{
+    CaveTalk_Heartbeat_t heartbeat;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HeartbeatInit(nullptr, Clock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HeartbeatInit(&heartbeat, nullptr, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&heartbeat, Clock, 1000U));
+    ASSERT_EQ(0U, heartbeat.pings_sent);
+    ASSERT_EQ(0U, heartbeat.pongs_received);
+}
+
+TEST(HeartbeatTests, Due)
+{
+    CaveTalk_Heartbeat_t heartbeat;
+
+    now = 5000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&heartbeat, Clock, 1000U));
+    ASSERT_TRUE(CaveTalk_HeartbeatDue(&heartbeat));
+
+    CaveTalk_HeartbeatPinged(&heartbeat, now);
+    ASSERT_FALSE(CaveTalk_HeartbeatDue(&heartbeat));
+
+    now += 999U;
+    ASSERT_FALSE(CaveTalk_HeartbeatDue(&heartbeat));
+
+    now += 1U;
+    ASSERT_TRUE(CaveTalk_HeartbeatDue(&heartbeat));
+}
+
+TEST(HeartbeatTests, RoundTripAndOffset)
+{
+    CaveTalk_Heartbeat_t heartbeat;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&heartbeat, Clock, 1000U));
+
+    // Remote clock is 5000us ahead, 200us each way, 100us processing
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatPonged(&heartbeat, 1000U, 6200U, 6300U, 1500U));
+    ASSERT_EQ(400U, heartbeat.round_trip_time);
+    ASSERT_EQ(400U, heartbeat.smoothed_round_trip_time);
+    ASSERT_EQ(5000, heartbeat.clock_offset);
+
+    // Queuing on the way back skews the offset but a lower delay sample is kept
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatPonged(&heartbeat, 2000U, 7200U, 7300U, 3300U));
+    ASSERT_EQ(1200U, heartbeat.round_trip_time);
+    ASSERT_EQ(500U, heartbeat.smoothed_round_trip_time);
+    ASSERT_EQ(5000, heartbeat.clock_offset);
+    ASSERT_EQ(2U, heartbeat.pongs_received);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_HeartbeatPonged(&heartbeat, 2000U, 7200U, 7300U, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_HeartbeatPonged(&heartbeat, 2000U, 7300U, 7200U, 3000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HeartbeatPonged(nullptr, 2000U, 7200U, 7300U, 3000U));
+}
+
+TEST(HeartbeatTests, Alive)
+{
+    CaveTalk_Heartbeat_t heartbeat;
+
+    now = 10000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HeartbeatInit(&heartbeat, Clock, 1000U));
+    ASSERT_FALSE(CaveTalk_HeartbeatAlive(&heartbeat, 3000U));
+
+    CaveTalk_HeartbeatHeard(&heartbeat, now);
+    ASSERT_TRUE(CaveTalk_HeartbeatAlive(&heartbeat, 3000U));
+
+    now += 3000U;
+    ASSERT_FALSE(CaveTalk_HeartbeatAlive(&heartbeat, 3000U));
+}
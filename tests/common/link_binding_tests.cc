@@ -0,0 +1,91 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_types.h"
+
+static CaveTalk_Error_t Send(void *const context, const void *const data, const size_t size)
+{
+    static_cast<void>(data);
+
+    *static_cast<std::size_t *>(context) += size;
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+TEST(LinkBindingTests, Capacity)
+{
+    std::array<std::size_t, CAVE_TALK_LINK_BINDING_SLOTS>           sent = {};
+    std::array<CaveTalk_LinkHandle_t, CAVE_TALK_LINK_BINDING_SLOTS> handles;
+    CaveTalk_LinkHandle_t                                           handle;
+    const uint8_t                                                   byte = 0U;
+
+    for (std::size_t index = 0U; index < handles.size(); index++)
+    {
+        const CaveTalk_LinkBinding_t binding = {&sent[index], Send, nullptr, nullptr};
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkBind(&binding, &handles[index]));
+        ASSERT_EQ(nullptr, handles[index].receive);
+    }
+
+    /* Every slot is taken */
+    const CaveTalk_LinkBinding_t binding = {&sent[0U], Send, nullptr, nullptr};
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_LinkBind(&binding, &handle));
+
+    for (std::size_t index = 0U; index < handles.size(); index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, handles[index].send(&byte, index));
+        ASSERT_EQ(index, sent[index]);
+    }
+
+    for (const CaveTalk_LinkHandle_t &each : handles)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkUnbind(&each));
+    }
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, CaveTalk_LinkUnbind(&handles[0U]));
+}
+
+TEST(LinkBindingTests, Concurrent)
+{
+    const std::size_t        kThreads = 4U;
+    const std::size_t        kRounds  = 2000U;
+    std::atomic<bool>        shared   = false;
+    std::vector<std::thread> threads;
+
+    /* Threads binding and unbinding at once never share a slot */
+    for (std::size_t thread = 0U; thread < kThreads; thread++)
+    {
+        threads.emplace_back([&]() {
+            const uint8_t byte = 0U;
+
+            for (std::size_t round = 0U; round < kRounds; round++)
+            {
+                std::size_t                  sent    = 0U;
+                const CaveTalk_LinkBinding_t binding = {&sent, Send, nullptr, nullptr};
+                CaveTalk_LinkHandle_t        handle;
+
+                if (CAVE_TALK_ERROR_NONE == CaveTalk_LinkBind(&binding, &handle))
+                {
+                    handle.send(&byte, 1U);
+                    std::this_thread::yield();
+                    handle.send(&byte, 1U);
+                    shared = shared || (2U != sent);
+                    CaveTalk_LinkUnbind(&handle);
+                }
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_FALSE(shared);
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+static RingBuffer<uint8_t, 1024U> link_bytes;
+static CaveTalk_Microseconds_t now          = 0U;
+static CaveTalk_Microseconds_t receive_cost = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+/* Every receive takes receive_cost of the caller's time, as a slow link would */
+static CaveTalk_Error_t Receive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received  = link_bytes.Read(static_cast<uint8_t *>(data), size);
+    now             += receive_cost;
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t Available(size_t *const bytes_available)
+{
+    *bytes_available = link_bytes.Size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static const CaveTalk_LinkHandle_t kLinkHandle = {
+    .send      = nullptr,
+    .receive   = Receive,
+    .available = Available,
+};
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const uint8_t length)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, length};
+
+    for (uint8_t index = 0U; index < length; index++)
+    {
+        frame.push_back(index);
+    }
+
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+/* Sleeps until the deadline, delivering whatever is queued to arrive meanwhile */
+struct Arrival
+{
+    std::vector<uint8_t> bytes;
+    CaveTalk_Microseconds_t timeout = 0U;
+    std::size_t waits               = 0U;
+};
+
+static CaveTalk_Error_t Wait(void *const context, const CaveTalk_Microseconds_t timeout)
+{
+    Arrival *const arrival = static_cast<Arrival *>(context);
+
+    arrival->timeout = timeout;
+    arrival->waits++;
+
+    if (arrival->bytes.empty())
+    {
+        now += timeout;
+    }
+    else
+    {
+        link_bytes.Write(arrival->bytes.data(), arrival->bytes.size());
+        arrival->bytes.clear();
+        now += timeout / 2U;
+    }
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+class ListenTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        link_bytes.Clear();
+        now          = 1000U;
+        receive_cost = 0U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenStateInit(&state_, Clock, nullptr, nullptr));
+    }
+
+    void Write(const std::vector<uint8_t> &bytes, const std::size_t begin, const std::size_t end)
+    {
+        link_bytes.Write(&bytes[begin], end - begin);
+    }
+
+    CaveTalk_ListenState_t state_;
+    std::array<uint8_t, 255U> data_ = {};
+    CaveTalk_Id_t id_               = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t length_       = 0U;
+};
+
+TEST_F(ListenTests, Init)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ListenStateInit(nullptr, Clock, nullptr, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ListenStateInit(&state_, nullptr, nullptr, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ListenUntil(&kCaveTalk_LinkHandleNull, &state_, now, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ListenUntil(&kLinkHandle, nullptr, now, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ListenFor(&kLinkHandle, nullptr, 100U, &id_, data_.data(), data_.size(), &length_));
+}
+
+TEST_F(ListenTests, OneFrameAtATime)
+{
+    const std::vector<uint8_t> first  = Frame(2U, 6U);
+    const std::vector<uint8_t> second = Frame(3U, 4U);
+
+    Write(first, 0U, first.size());
+    Write(second, 0U, second.size());
+
+    /* Nothing past the end of the frame is taken from the link */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&kLinkHandle, &state_, 100U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(6U, length_);
+    ASSERT_EQ(5U, data_[5U]);
+    ASSERT_EQ(second.size(), link_bytes.Size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&kLinkHandle, &state_, 100U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(3U, id_);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&kLinkHandle, &state_, 100U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_EQ(0U, state_.expired);
+}
+
+TEST_F(ListenTests, PartialFrame)
+{
+    const std::vector<uint8_t> frame = Frame(2U, 10U);
+
+    /* The frame is cut off mid payload, what arrived is kept for the next listen */
+    Write(frame, 0U, 8U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenUntil(&kLinkHandle, &state_, now + 100U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_EQ(8U, CaveTalk_FrameParserPending(&state_.parser));
+    ASSERT_EQ(1U, state_.expired);
+
+    Write(frame, 8U, frame.size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenUntil(&kLinkHandle, &state_, now + 100U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(10U, length_);
+    ASSERT_EQ(9U, data_[9U]);
+}
+
+TEST_F(ListenTests, Budget)
+{
+    const std::vector<uint8_t> frame = Frame(2U, 10U);
+
+    /* Each receive takes 60 us, so a 50 us budget runs out once the header is in */
+    receive_cost = 60U;
+    Write(frame, 0U, frame.size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&kLinkHandle, &state_, 50U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_EQ(1060U, now);
+    ASSERT_EQ(frame.size() - CAVE_TALK_HEADER_SIZE, link_bytes.Size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&kLinkHandle, &state_, 50U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(1120U, now);
+
+    /* Bytes already available are read even when the deadline has passed */
+    Write(frame, 0U, frame.size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenUntil(&kLinkHandle, &state_, 0U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE, CaveTalk_FrameParserPending(&state_.parser));
+}
+
+TEST_F(ListenTests, Wait)
+{
+    const std::vector<uint8_t> frame = Frame(2U, 4U);
+    Arrival                    arrival;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenStateInit(&state_, Clock, Wait, &arrival));
+
+    /* Nothing arrives, the listen sleeps out the rest of its budget once and returns at the deadline */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&kLinkHandle, &state_, 500U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_EQ(1U, arrival.waits);
+    ASSERT_EQ(500U, arrival.timeout);
+    ASSERT_EQ(1500U, now);
+
+    /* The frame arrives while waiting and is returned before the deadline */
+    arrival.bytes = frame;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenUntil(&kLinkHandle, &state_, 2000U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(2U, arrival.waits);
+    ASSERT_EQ(500U, arrival.timeout);
+    ASSERT_EQ(1750U, now);
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_negotiation.h"
+#include "cave_talk_types.h"
+
+static const CaveTalk_Microseconds_t kRetryInterval = 1000U;
+static const uint32_t kAttempts                     = 3U;
+
+static CaveTalk_Microseconds_t now = 0U;
+static std::vector<uint8_t> to_rover;
+static std::vector<uint8_t> to_operator;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+static CaveTalk_Error_t SendToRover(const void *const data, const size_t size)
+{
+    to_rover.insert(to_rover.end(), static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t SendToOperator(const void *const data, const size_t size)
+{
+    to_operator.insert(to_operator.end(), static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static const CaveTalk_LinkHandle_t kOperatorLink = {
+    .send      = SendToRover,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+static const CaveTalk_LinkHandle_t kRoverLink = {
+    .send      = SendToOperator,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+class NegotiationTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        now = 1000U;
+        to_rover.clear();
+        to_operator.clear();
+    }
+
+    /* Hands every Hello frame on the wire to the negotiation at the other end, returning how many there were */
+    std::size_t Deliver(std::vector<uint8_t> &wire, CaveTalk_Negotiation_t &negotiation, const CaveTalk_LinkHandle_t &link)
+    {
+        std::vector<uint8_t> frames;
+        std::size_t          count = 0U;
+
+        frames.swap(wire);
+
+        for (std::size_t index = 0U; (index + CAVE_TALK_HEADER_SIZE) <= frames.size();)
+        {
+            const CaveTalk_Length_t length = frames[index + CAVE_TALK_LENGTH_INDEX];
+
+            EXPECT_EQ(CAVE_TALK_ID_HELLO, frames[index + CAVE_TALK_ID_INDEX]);
+            EXPECT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationHear(&negotiation, &link, &frames[index + CAVE_TALK_HEADER_SIZE], length));
+
+            index += CAVE_TALK_HEADER_SIZE + length + CAVE_TALK_CRC_SIZE;
+            count++;
+        }
+
+        return count;
+    }
+
+    CaveTalk_Negotiation_t operator_;
+    CaveTalk_Negotiation_t rover_;
+};
+
+TEST_F(NegotiationTests, Init)
+{
+    const uint8_t hello[CAVE_TALK_NEGOTIATION_HELLO_SIZE - 1U] = {0U};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_NegotiationInit(nullptr, Clock, 0U, 255U, kRetryInterval, kAttempts));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_NegotiationInit(&operator_, nullptr, 0U, 255U, kRetryInterval, kAttempts));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_NegotiationInit(&operator_, Clock, 0U, 255U, kRetryInterval, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&operator_, Clock, 0U, 255U, kRetryInterval, kAttempts));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_NegotiationPoll(&operator_, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_NegotiationHear(&operator_, &kOperatorLink, hello, sizeof(hello)));
+
+    /* Nothing is offered until started, and nothing optional is allowed meanwhile */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+    ASSERT_TRUE(to_rover.empty());
+    ASSERT_FALSE(CaveTalk_NegotiationAllows(&operator_, CAVE_TALK_CAPABILITY_HEARTBEAT));
+    ASSERT_TRUE(CaveTalk_NegotiationAllows(nullptr, CAVE_TALK_CAPABILITY_HEARTBEAT));
+    ASSERT_EQ(255U, CaveTalk_NegotiationMaxPayload(&operator_));
+    ASSERT_EQ(UINT8_MAX, CaveTalk_NegotiationMaxPayload(nullptr));
+}
+
+TEST_F(NegotiationTests, Agree)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&operator_, Clock, CAVE_TALK_CAPABILITY_HEARTBEAT | CAVE_TALK_CAPABILITY_RELIABLE | CAVE_TALK_CAPABILITY_DELTA, 255U, kRetryInterval, kAttempts));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&rover_, Clock, CAVE_TALK_CAPABILITY_HEARTBEAT | CAVE_TALK_CAPABILITY_DELTA | (1UL << 31U), 128U, kRetryInterval, kAttempts));
+
+    CaveTalk_NegotiationStart(&operator_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+    ASSERT_EQ(CAVE_TALK_HEADER_SIZE + CAVE_TALK_NEGOTIATION_HELLO_SIZE + CAVE_TALK_CRC_SIZE, to_rover.size());
+
+    /* The rover agrees on hearing the offer and answers it, the reply is not answered again */
+    ASSERT_EQ(1U, Deliver(to_rover, rover_, kRoverLink));
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_AGREED, rover_.state);
+    ASSERT_EQ(1U, Deliver(to_operator, operator_, kOperatorLink));
+    ASSERT_TRUE(to_rover.empty());
+
+    for (const CaveTalk_Negotiation_t *const negotiation : {&operator_, &rover_})
+    {
+        ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_AGREED, negotiation->state);
+        ASSERT_EQ(CAVE_TALK_NEGOTIATION_REVISION, negotiation->peer_revision);
+        ASSERT_EQ(CAVE_TALK_CAPABILITY_HEARTBEAT | CAVE_TALK_CAPABILITY_DELTA, negotiation->agreed_capabilities);
+        ASSERT_EQ(128U, negotiation->agreed_max_payload);
+        ASSERT_EQ(128U, CaveTalk_NegotiationMaxPayload(negotiation));
+        ASSERT_TRUE(CaveTalk_NegotiationAllows(negotiation, CAVE_TALK_CAPABILITY_DELTA));
+        ASSERT_FALSE(CaveTalk_NegotiationAllows(negotiation, CAVE_TALK_CAPABILITY_RELIABLE));
+        ASSERT_FALSE(CaveTalk_NegotiationAllows(negotiation, CAVE_TALK_CAPABILITY_HEARTBEAT | CAVE_TALK_CAPABILITY_RELIABLE));
+    }
+
+    /* Once agreed no more offers are made */
+    now += 10U * kRetryInterval;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+    ASSERT_TRUE(to_rover.empty());
+}
+
+TEST_F(NegotiationTests, Fallback)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&operator_, Clock, CAVE_TALK_CAPABILITY_RELIABLE, 255U, kRetryInterval, kAttempts));
+    CaveTalk_NegotiationStart(&operator_);
+
+    /* A revision 1 peer never answers, offers are repeated every retry interval until the attempts run out */
+    for (uint32_t attempt = 0U; attempt < kAttempts; attempt++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+        ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_OFFERING, operator_.state);
+        now += kRetryInterval;
+    }
+    ASSERT_EQ(kAttempts * (CAVE_TALK_HEADER_SIZE + CAVE_TALK_NEGOTIATION_HELLO_SIZE + CAVE_TALK_CRC_SIZE), to_rover.size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_FALLBACK, operator_.state);
+    ASSERT_EQ(1U, operator_.peer_revision);
+    ASSERT_FALSE(CaveTalk_NegotiationAllows(&operator_, CAVE_TALK_CAPABILITY_RELIABLE));
+}
+
+TEST_F(NegotiationTests, Restart)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&operator_, Clock, CAVE_TALK_CAPABILITY_RELIABLE, 255U, kRetryInterval, kAttempts));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&rover_, Clock, CAVE_TALK_CAPABILITY_RELIABLE, 255U, kRetryInterval, kAttempts));
+
+    CaveTalk_NegotiationStart(&operator_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&operator_, &kOperatorLink));
+    ASSERT_EQ(1U, Deliver(to_rover, rover_, kRoverLink));
+    ASSERT_EQ(1U, Deliver(to_operator, operator_, kOperatorLink));
+
+    /* The rover restarts and offers again, the operator answers although it has already agreed */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationInit(&rover_, Clock, 0U, 255U, kRetryInterval, kAttempts));
+    CaveTalk_NegotiationStart(&rover_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_NegotiationPoll(&rover_, &kRoverLink));
+    ASSERT_EQ(1U, Deliver(to_operator, operator_, kOperatorLink));
+    ASSERT_EQ(1U, Deliver(to_rover, rover_, kRoverLink));
+
+    ASSERT_EQ(CAVE_TALK_NEGOTIATION_STATE_AGREED, rover_.state);
+    ASSERT_FALSE(CaveTalk_NegotiationAllows(&operator_, CAVE_TALK_CAPABILITY_RELIABLE));
+    ASSERT_EQ(0U, operator_.agreed_capabilities);
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_pacer.h"
+#include "cave_talk_types.h"
+
+static const uint32_t kRate  = 1000U;
+static const uint32_t kBurst = CAVE_TALK_PACER_FRAME_SIZE_MAX;
+
+static CaveTalk_Microseconds_t now = 0U;
+static std::vector<uint8_t> wire;
+static std::vector<CaveTalk_Id_t> ids;
+static CaveTalk_Error_t send_error = CAVE_TALK_ERROR_NONE;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+static CaveTalk_Error_t Send(const void *const data, const size_t size)
+{
+    const uint8_t *const bytes = static_cast<const uint8_t *>(data);
+
+    if ((CAVE_TALK_ERROR_NONE == send_error) && (CAVE_TALK_HEADER_SIZE == size) && (CAVE_TALK_VERSION == bytes[0U]))
+    {
+        ids.push_back(bytes[CAVE_TALK_ID_INDEX]);
+    }
+
+    if (CAVE_TALK_ERROR_NONE == send_error)
+    {
+        wire.insert(wire.end(), bytes, bytes + size);
+    }
+
+    return send_error;
+}
+
+static const CaveTalk_LinkHandle_t kLinkHandle = {
+    .send      = Send,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+class PacerTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        now        = 1000U;
+        send_error = CAVE_TALK_ERROR_NONE;
+        wire.clear();
+        ids.clear();
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerInit(&pacer_, Clock, kRate, kBurst, slots_.data(), slots_.size()));
+    }
+
+    /* Frames of 93 bytes, so the full bucket holds two of them */
+    CaveTalk_Error_t Speak(const CaveTalk_Id_t id)
+    {
+        return CaveTalk_PacerSpeak(&pacer_, &kLinkHandle, id, payload_.data(), payload_.size());
+    }
+
+    CaveTalk_Pacer_t pacer_;
+    std::array<CaveTalk_PacerSlot_t, 2U> slots_;
+    const std::array<uint8_t, 86U> payload_ = {};
+    const std::size_t frame_size_           = CAVE_TALK_HEADER_SIZE + 86U + CAVE_TALK_CRC_SIZE;
+};
+
+TEST_F(PacerTests, Init)
+{
+    CaveTalk_Pacer_t pacer;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerInit(nullptr, Clock, kRate, kBurst, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerInit(&pacer, nullptr, kRate, kBurst, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerInit(&pacer, Clock, kRate, kBurst, nullptr, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_PacerInit(&pacer, Clock, 0U, kBurst, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_PacerInit(&pacer, Clock, kRate, kBurst - 1U, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerSpeak(nullptr, &kLinkHandle, 2U, payload_.data(), payload_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerSpeak(&pacer_, &kLinkHandle, 2U, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerDrain(&pacer_, nullptr));
+    ASSERT_EQ(0U, CaveTalk_PacerDelay(nullptr));
+}
+
+TEST_F(PacerTests, Reject)
+{
+    CaveTalk_Pacer_t pacer;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerInit(&pacer, Clock, kRate, kBurst, nullptr, 0U));
+
+    /* Without slots a frame the bucket cannot pay for is rejected, nothing of it reaches the link */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 2U, payload_.data(), payload_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 3U, payload_.data(), payload_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_RATE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 4U, payload_.data(), payload_.size()));
+    ASSERT_EQ(2U * frame_size_, wire.size());
+    ASSERT_EQ(1U, pacer.counters.rejected);
+
+    /* Tokens accrue at the rate, a byte per millisecond */
+    now += (frame_size_ - (kBurst - (2U * frame_size_)) - 1U) * 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_RATE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 4U, payload_.data(), payload_.size()));
+    now += 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 4U, payload_.data(), payload_.size()));
+    ASSERT_EQ(3U, pacer.counters.sent);
+    ASSERT_EQ(3U * frame_size_, pacer.counters.bytes_sent);
+
+    /* The bucket never holds more than the burst */
+    now += 10000000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 5U, payload_.data(), payload_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 6U, payload_.data(), payload_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_RATE, CaveTalk_PacerSpeak(&pacer, &kLinkHandle, 7U, payload_.data(), payload_.size()));
+}
+
+TEST_F(PacerTests, Queue)
+{
+    const CaveTalk_Microseconds_t spare = (kBurst - (2U * frame_size_)) * 1000U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(2U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(3U));
+    ASSERT_EQ(0U, CaveTalk_PacerDelay(&pacer_));
+
+    /* Frames past the burst wait in the slots, and report how long a frame spoken now would wait */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(4U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(5U));
+    ASSERT_EQ(CAVE_TALK_ERROR_RATE, Speak(6U));
+    ASSERT_EQ(2U, pacer_.counters.queued);
+    ASSERT_EQ((2U * frame_size_ * 1000U) - spare, CaveTalk_PacerDelay(&pacer_));
+
+    /* Queued frames go out in order as tokens accrue */
+    now += (frame_size_ * 1000U) - spare;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerDrain(&pacer_, &kLinkHandle));
+    ASSERT_EQ(frame_size_ * 1000U, CaveTalk_PacerDelay(&pacer_));
+
+    /* A frame spoken while others wait is queued behind them even when the bucket could pay for it */
+    now += frame_size_ * 1000U;
+    pacer_.tokens = static_cast<int64_t>(kBurst) * 1000000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(7U));
+    ASSERT_EQ(std::vector<CaveTalk_Id_t>({2U, 3U, 4U, 5U, 7U}), ids);
+    ASSERT_EQ(0U, CaveTalk_PacerDelay(&pacer_));
+}
+
+TEST_F(PacerTests, SendError)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(2U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(3U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(4U));
+
+    /* A frame the link fails to take is kept and retried on the next drain */
+    now += kBurst * 1000U;
+    send_error = CAVE_TALK_ERROR_IO;
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_PacerDrain(&pacer_, &kLinkHandle));
+    ASSERT_EQ(1U, pacer_.slots_queued);
+
+    send_error = CAVE_TALK_ERROR_NONE;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerDrain(&pacer_, &kLinkHandle));
+    ASSERT_EQ(0U, pacer_.slots_queued);
+    ASSERT_EQ(std::vector<CaveTalk_Id_t>({2U, 3U, 4U}), ids);
+}
+
+TEST_F(PacerTests, Charged)
+{
+    CaveTalk_LinkHandle_t charged_link_handle = kCaveTalk_LinkHandleNull;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerBind(&pacer_, &kCaveTalk_LinkHandleNull, &charged_link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerBind(&pacer_, &kLinkHandle, &charged_link_handle));
+    ASSERT_EQ(nullptr, charged_link_handle.receive);
+
+    /* Frames the pacer sends through the charged link are paid for once */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerSpeak(&pacer_, &charged_link_handle, 2U, payload_.data(), payload_.size()));
+    ASSERT_EQ(0U, pacer_.counters.bytes_charged);
+
+    /* Frames sent past the queue go out at once and may take the bucket below empty */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&charged_link_handle, 3U, payload_.data(), payload_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&charged_link_handle, 4U, payload_.data(), payload_.size()));
+    ASSERT_EQ(2U * frame_size_, pacer_.counters.bytes_charged);
+    ASSERT_EQ(std::vector<CaveTalk_Id_t>({2U, 3U, 4U}), ids);
+
+    /* A paced frame then waits until the debt is repaid as well as for its own cost */
+    const CaveTalk_Microseconds_t debt = ((3U * frame_size_) - kBurst) * 1000U;
+
+    ASSERT_EQ(debt, CaveTalk_PacerDelay(&pacer_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Speak(5U));
+    ASSERT_EQ(debt + (frame_size_ * 1000U), CaveTalk_PacerDelay(&pacer_));
+
+    now += debt + (frame_size_ * 1000U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerDrain(&pacer_, &kLinkHandle));
+    ASSERT_EQ(std::vector<CaveTalk_Id_t>({2U, 3U, 4U, 5U}), ids);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_PacerUnbind(&pacer_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_PacerUnbind(nullptr));
+}
\ No newline at end of file
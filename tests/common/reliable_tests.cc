@@ -0,0 +1,345 @@
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_reliable.h"
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+
+static CaveTalk_Microseconds_t now = 0U;
+static std::vector<uint8_t>    to_rover;
+static std::vector<uint8_t>    to_operator;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+static CaveTalk_Error_t SendToRover(const void *const data, const size_t size)
+{
+    const uint8_t *const bytes = static_cast<const uint8_t *>(data);
+
+    to_rover.insert(to_rover.end(), bytes, bytes + size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t SendToOperator(const void *const data, const size_t size)
+{
+    const uint8_t *const bytes = static_cast<const uint8_t *>(data);
+
+    to_operator.insert(to_operator.end(), bytes, bytes + size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static const CaveTalk_LinkHandle_t kOperatorLink = {
+    .send      = SendToRover,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+static const CaveTalk_LinkHandle_t kRoverLink = {
+    .send      = SendToOperator,
+    .receive   = nullptr,
+    .available = nullptr,
+};
+
+// Parses every frame on one direction of the link, dropping the ones the loss function picks
+static void Pump(std::vector<uint8_t> &bytes,
+                 const std::function<bool(void)> &lose,
+                 const std::function<void(CaveTalk_Id_t, const uint8_t *, CaveTalk_Length_t)> &deliver)
+{
+    std::vector<uint8_t>   in_flight;
+    uint8_t                payload[UINT8_MAX];
+    std::size_t            offset = 0U;
+    CaveTalk_FrameParser_t parser;
+
+    in_flight.swap(bytes);
+    CaveTalk_FrameParserInit(&parser, payload, sizeof(payload));
+
+    while (offset < in_flight.size())
+    {
+        std::size_t       consumed = 0U;
+        CaveTalk_Id_t     id       = 0U;
+        CaveTalk_Length_t length   = 0U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParse(&parser, &in_flight[offset], in_flight.size() - offset, &consumed, &id, &length));
+        offset += consumed;
+
+        if (!lose())
+        {
+            deliver(id, payload, length);
+        }
+    }
+}
+
+class ReliableTests : public testing::Test
+{
+    protected:
+        void SetUp(void) override
+        {
+            now = 0U;
+            to_rover.clear();
+            to_operator.clear();
+
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableInit(&sender_, Clock, send_slots_, 8U, nullptr, 0U));
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableInit(&receiver_, Clock, nullptr, 0U, receive_slots_, 8U));
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableEnable(&sender_, 5U, true));
+        }
+
+        // Delivers frames from the operator to the rover and ACKs back, recording what the rover hears
+        void Exchange(const std::function<bool(void)> &lose)
+        {
+            Pump(to_rover, lose, [this](CaveTalk_Id_t id, const uint8_t *data, CaveTalk_Length_t length) {
+                CaveTalk_ReliableFrame_t frame;
+
+                ASSERT_EQ(CAVE_TALK_ID_RELIABLE, id);
+
+                if (CAVE_TALK_ERROR_NONE == CaveTalk_ReliableHear(&receiver_, &kRoverLink, data, length, &frame))
+                {
+                    heard_.push_back(frame.data[0]);
+                    while (CaveTalk_ReliableNext(&receiver_, &frame))
+                    {
+                        heard_.push_back(frame.data[0]);
+                    }
+                }
+            });
+
+            Pump(to_operator, lose, [this](CaveTalk_Id_t id, const uint8_t *data, CaveTalk_Length_t length) {
+                ASSERT_EQ(CAVE_TALK_ID_ACK, id);
+                ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableHearAck(&sender_, data, length));
+            });
+        }
+
+        CaveTalk_ReliableSlot_t send_slots_[8U];
+        CaveTalk_ReliableSlot_t receive_slots_[8U];
+        CaveTalk_Reliable_t     sender_;
+        CaveTalk_Reliable_t     receiver_;
+        std::vector<uint8_t>    heard_;
+};
+
+TEST_F(ReliableTests, Init)
+{
+    CaveTalk_Reliable_t     reliable;
+    CaveTalk_ReliableSlot_t slots[CAVE_TALK_RELIABLE_WINDOW + 1U];
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ReliableInit(nullptr, Clock, slots, 1U, slots, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ReliableInit(&reliable, nullptr, slots, 1U, slots, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ReliableInit(&reliable, Clock, nullptr, 1U, slots, 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ReliableInit(&reliable, Clock, slots, CAVE_TALK_RELIABLE_WINDOW + 1U, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableInit(&reliable, Clock, slots, CAVE_TALK_RELIABLE_WINDOW, nullptr, 0U));
+    ASSERT_EQ(CAVE_TALK_RELIABLE_RTO_INITIAL, reliable.retransmission_timeout);
+
+    ASSERT_FALSE(CaveTalk_ReliableEnabled(&reliable, 5U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableEnable(&reliable, 5U, true));
+    ASSERT_TRUE(CaveTalk_ReliableEnabled(&reliable, 5U));
+    ASSERT_FALSE(CaveTalk_ReliableEnabled(&reliable, 2U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableEnable(&reliable, 5U, false));
+    ASSERT_FALSE(CaveTalk_ReliableEnabled(&reliable, 5U));
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, CaveTalk_ReliableEnable(&reliable, CAVE_TALK_ID_ACK, true));
+    ASSERT_FALSE(CaveTalk_ReliableEnabled(nullptr, 5U));
+}
+
+TEST_F(ReliableTests, InOrder)
+{
+    uint8_t message = 0U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+
+    now = 10000U;
+    Exchange([]() {
+        return false;
+    });
+
+    // RFC 6298 first sample: RTO = SRTT + 4 * SRTT / 2
+    ASSERT_EQ(10000U, sender_.smoothed_round_trip_time);
+    ASSERT_EQ(30000U, sender_.retransmission_timeout);
+
+    for (message = 1U; message < 4U; message++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+    }
+    ASSERT_EQ(3U, CaveTalk_ReliableInFlight(&sender_));
+
+    now = 20000U;
+    Exchange([]() {
+        return false;
+    });
+
+    ASSERT_EQ((std::vector<uint8_t>{0U, 1U, 2U, 3U}), heard_);
+    ASSERT_EQ(0U, CaveTalk_ReliableInFlight(&sender_));
+    ASSERT_EQ(4U, sender_.counters.acknowledged);
+    ASSERT_EQ(0U, receiver_.counters.out_of_order);
+
+    // A steady RTT shrinks the variance and with it the RTO
+    ASSERT_EQ(10000U, sender_.smoothed_round_trip_time);
+    ASSERT_GT(30000U, sender_.retransmission_timeout);
+}
+
+TEST_F(ReliableTests, SelectiveAck)
+{
+    std::size_t frame = 0U;
+
+    for (uint8_t message = 0U; message < 4U; message++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+    }
+
+    // Lose the first frame only, the others are buffered and selectively acknowledged
+    Exchange([&frame]() {
+        return 0U == frame++;
+    });
+    ASSERT_TRUE(heard_.empty());
+    ASSERT_EQ(3U, receiver_.counters.out_of_order);
+    ASSERT_EQ(1U, CaveTalk_ReliableInFlight(&sender_));
+
+    // Nothing is retransmitted before the RTO
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableRetransmit(&sender_, &kOperatorLink));
+    ASSERT_TRUE(to_rover.empty());
+
+    now = CAVE_TALK_RELIABLE_RTO_INITIAL;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableRetransmit(&sender_, &kOperatorLink));
+    ASSERT_EQ(1U, sender_.counters.retransmitted);
+    Exchange([]() {
+        return false;
+    });
+
+    ASSERT_EQ((std::vector<uint8_t>{0U, 1U, 2U, 3U}), heard_);
+    ASSERT_EQ(0U, CaveTalk_ReliableInFlight(&sender_));
+
+    // Karn's algorithm, only the frames acknowledged on their first transmission were sampled
+    ASSERT_EQ(0U, sender_.smoothed_round_trip_time);
+}
+
+TEST_F(ReliableTests, Duplicate)
+{
+    uint8_t message = 7U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+
+    // Lose the ACK, the retransmission is acknowledged again but not delivered twice
+    Pump(to_rover, []() {
+        return false;
+    }, [this](CaveTalk_Id_t, const uint8_t *data, CaveTalk_Length_t length) {
+        CaveTalk_ReliableFrame_t frame;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableHear(&receiver_, &kRoverLink, data, length, &frame));
+        heard_.push_back(frame.data[0]);
+    });
+    to_operator.clear();
+
+    now = CAVE_TALK_RELIABLE_RTO_INITIAL;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableRetransmit(&sender_, &kOperatorLink));
+    Exchange([]() {
+        return false;
+    });
+
+    ASSERT_EQ((std::vector<uint8_t>{7U}), heard_);
+    ASSERT_EQ(1U, receiver_.counters.duplicates);
+    ASSERT_EQ(0U, CaveTalk_ReliableInFlight(&sender_));
+}
+
+TEST_F(ReliableTests, Scheduled)
+{
+    CaveTalk_TimerWheel_t   wheel;
+    CaveTalk_Microseconds_t deadline = 0U;
+    std::size_t             fired    = 0U;
+    uint8_t                 message  = 3U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelInit(&wheel, Clock, 1000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ReliableSchedule(&sender_, &wheel, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSchedule(&sender_, &wheel, &kOperatorLink));
+    ASSERT_FALSE(CaveTalk_ReliableDeadline(&sender_, &deadline));
+    ASSERT_EQ(0U, wheel.active);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+    ASSERT_TRUE(CaveTalk_ReliableDeadline(&sender_, &deadline));
+    ASSERT_EQ(CAVE_TALK_RELIABLE_RTO_INITIAL, deadline);
+    ASSERT_EQ(1U, wheel.active);
+    to_rover.clear();
+
+    // The wheel retransmits on the deadline and rearms on the backed off one
+    now = CAVE_TALK_RELIABLE_RTO_INITIAL - 1U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel, &fired));
+    ASSERT_EQ(0U, fired);
+    ASSERT_TRUE(to_rover.empty());
+
+    now = CAVE_TALK_RELIABLE_RTO_INITIAL;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel, &fired));
+    ASSERT_EQ(1U, fired);
+    ASSERT_EQ(1U, sender_.counters.retransmitted);
+    ASSERT_FALSE(to_rover.empty());
+    ASSERT_TRUE(CaveTalk_ReliableDeadline(&sender_, &deadline));
+    ASSERT_EQ(3U * CAVE_TALK_RELIABLE_RTO_INITIAL, deadline);
+    ASSERT_EQ(1U, wheel.active);
+
+    // Once everything is acknowledged the timer is cancelled
+    Exchange([]() {
+        return false;
+    });
+    ASSERT_EQ((std::vector<uint8_t>{3U}), heard_);
+    ASSERT_FALSE(CaveTalk_ReliableDeadline(&sender_, &deadline));
+    ASSERT_EQ(0U, wheel.active);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSchedule(&sender_, nullptr, nullptr));
+}
+
+TEST_F(ReliableTests, WindowFull)
+{
+    uint8_t message = 0U;
+
+    for (std::size_t slot = 0U; slot < 8U; slot++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+    }
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message)));
+
+    uint8_t payload[CAVE_TALK_RELIABLE_PAYLOAD_SIZE_MAX + 1U] = {0U};
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ReliableSpeak(&receiver_, &kRoverLink, 5U, payload, sizeof(payload)));
+}
+
+TEST_F(ReliableTests, LossyLink)
+{
+    const std::size_t kMessages = 500U;
+    uint32_t          random    = 12345U;
+    std::size_t       next      = 0U;
+
+    // 30% loss in both directions
+    const auto lose = [&random]() {
+        random = (random * 1103515245U) + 12345U;
+        return ((random >> 16) % 100U) < 30U;
+    };
+
+    while (heard_.size() < kMessages)
+    {
+        CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+        while ((next < kMessages) && (CAVE_TALK_ERROR_NONE == error))
+        {
+            const uint8_t message = static_cast<uint8_t>(next);
+
+            error = CaveTalk_ReliableSpeak(&sender_, &kOperatorLink, 5U, &message, sizeof(message));
+            next += (CAVE_TALK_ERROR_NONE == error) ? 1U : 0U;
+        }
+
+        now += 20000U;
+        Exchange(lose);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReliableRetransmit(&sender_, &kOperatorLink));
+        ASSERT_LT(now, 1000000000U);
+    }
+
+    for (std::size_t message = 0U; message < kMessages; message++)
+    {
+        ASSERT_EQ(static_cast<uint8_t>(message), heard_[message]);
+    }
+    ASSERT_EQ(kMessages, receiver_.counters.delivered);
+    ASSERT_LT(0U, sender_.counters.retransmitted);
+    ASSERT_LT(0U, receiver_.counters.out_of_order);
+    ASSERT_GE(sender_.retransmission_timeout, CAVE_TALK_RELIABLE_RTO_MIN);
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_link_binding.h"
+#include "cave_talk_router.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+static const std::size_t kLinkCount  = 3U;
+static const std::size_t kQueueSlots = 2U;
+
+/* Link 0 is the operator, links 1 and 2 are robots */
+static const CaveTalk_RouterRule_t kRules[] = {
+    {.sources = 1U << 0U, .id = 2U, .destinations = CAVE_TALK_ROUTER_LINKS_ALL},
+    {.sources = 1U << 0U, .id = 3U, .destinations = 1U << 2U},
+    {.sources = (1U << 1U) | (1U << 2U), .id = CAVE_TALK_ROUTER_ID_ANY, .destinations = 1U << 0U},
+};
+
+struct Pipe
+{
+    RingBuffer<uint8_t, 1024U> input;
+    RingBuffer<uint8_t, 1024U> output;
+    bool accept = true;
+};
+
+static CaveTalk_Error_t PipeSend(void *const context, const void *const data, const size_t size)
+{
+    Pipe *const      pipe  = static_cast<Pipe *>(context);
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_INCOMPLETE;
+
+    if (pipe->accept && (size <= (pipe->output.Capacity() - pipe->output.Size())))
+    {
+        pipe->output.Write(static_cast<const uint8_t *>(data), size);
+        error = CAVE_TALK_ERROR_NONE;
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t PipeReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received = static_cast<Pipe *>(context)->input.Read(static_cast<uint8_t *>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t PipeAvailable(void *const context, size_t *const bytes_available)
+{
+    *bytes_available = static_cast<Pipe *>(context)->input.Size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+class RouterTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        for (std::size_t index = 0U; index < kLinkCount; index++)
+        {
+            const CaveTalk_LinkBinding_t binding = {&pipes_[index], PipeSend, PipeReceive, PipeAvailable};
+
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkBind(&binding, &link_handles_[index]));
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_RouterLinkInit(&links_[index], &link_handles_[index], queues_[index].data(), queues_[index].size()));
+        }
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_RouterInit(&router_, links_.data(), links_.size(), kRules, sizeof(kRules) / sizeof(kRules[0]), 8U));
+    }
+
+    void TearDown() override
+    {
+        for (const CaveTalk_LinkHandle_t &link_handle : link_handles_)
+        {
+            CaveTalk_LinkUnbind(&link_handle);
+        }
+    }
+
+    /* Speaks into the router on a link's input side */
+    void Inject(const std::size_t link, const CaveTalk_Id_t id, const uint8_t value)
+    {
+        const CaveTalk_LinkBinding_t binding = {&pipes_[link].input, InputSend, nullptr, nullptr};
+        CaveTalk_LinkHandle_t        input   = kCaveTalk_LinkHandleNull;
+        const std::array<uint8_t, 4> payload = {value, value, value, value};
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkBind(&binding, &input));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&input, id, payload.data(), payload.size()));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkUnbind(&input));
+    }
+
+    /* Listens on a link's output side */
+    void Expect(const std::size_t link, const CaveTalk_Id_t id, const uint8_t value)
+    {
+        const CaveTalk_LinkBinding_t binding = {&pipes_[link].output, nullptr, OutputReceive, OutputAvailable};
+        CaveTalk_LinkHandle_t        output  = kCaveTalk_LinkHandleNull;
+        std::array<uint8_t, 255>     data    = {};
+        CaveTalk_Id_t                heard   = CAVE_TALK_ID_NONE;
+        CaveTalk_Length_t            length  = 0U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkBind(&binding, &output));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&output, &heard, data.data(), data.size(), &length));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_LinkUnbind(&output));
+        ASSERT_EQ(id, heard);
+
+        if (CAVE_TALK_ID_NONE != id)
+        {
+            ASSERT_EQ(4U, length);
+            ASSERT_EQ(value, data[3U]);
+        }
+    }
+
+    static CaveTalk_Error_t InputSend(void *const context, const void *const data, const size_t size)
+    {
+        static_cast<RingBuffer<uint8_t, 1024U> *>(context)->Write(static_cast<const uint8_t *>(data), size);
+
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    static CaveTalk_Error_t OutputReceive(void *const context, void *const data, const size_t size, size_t *const bytes_received)
+    {
+        *bytes_received = static_cast<RingBuffer<uint8_t, 1024U> *>(context)->Read(static_cast<uint8_t *>(data), size);
+
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    static CaveTalk_Error_t OutputAvailable(void *const context, size_t *const bytes_available)
+    {
+        *bytes_available = static_cast<RingBuffer<uint8_t, 1024U> *>(context)->Size();
+
+        return CAVE_TALK_ERROR_NONE;
+    }
+
+    std::array<Pipe, kLinkCount> pipes_;
+    std::array<CaveTalk_LinkHandle_t, kLinkCount> link_handles_;
+    std::array<std::array<uint8_t, kQueueSlots * CAVE_TALK_ROUTER_FRAME_SIZE_MAX>, kLinkCount> queues_;
+    std::array<CaveTalk_RouterLink_t, kLinkCount> links_;
+    CaveTalk_Router_t router_;
+    std::size_t forwarded_ = 0U;
+};
+
+TEST_F(RouterTests, Init)
+{
+    CaveTalk_Router_t router;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_RouterLinkInit(nullptr, &link_handles_[0], queues_[0].data(), queues_[0].size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_RouterLinkInit(&links_[0], &link_handles_[0], queues_[0].data(), CAVE_TALK_ROUTER_FRAME_SIZE_MAX - 1U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_RouterInit(nullptr, links_.data(), links_.size(), kRules, 1U, 8U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_RouterInit(&router, links_.data(), links_.size(), nullptr, 1U, 8U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_RouterInit(&router, links_.data(), 0U, kRules, 1U, 8U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_RouterInit(&router, links_.data(), CAVE_TALK_ROUTER_LINK_COUNT_MAX + 1U, kRules, 1U, 8U));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_RouterInit(&router, links_.data(), links_.size(), kRules, 1U, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_RouterPoll(&router_, nullptr));
+}
+
+TEST_F(RouterTests, Destinations)
+{
+    ASSERT_EQ((1U << 1U) | (1U << 2U), CaveTalk_RouterDestinations(&router_, 0U, 2U));
+    ASSERT_EQ(1U << 2U, CaveTalk_RouterDestinations(&router_, 0U, 3U));
+    ASSERT_EQ(0U, CaveTalk_RouterDestinations(&router_, 0U, 4U));
+    ASSERT_EQ(1U << 0U, CaveTalk_RouterDestinations(&router_, 1U, 9U));
+    ASSERT_EQ(1U << 0U, CaveTalk_RouterDestinations(&router_, 2U, 2U));
+    ASSERT_EQ(0U, CaveTalk_RouterDestinations(&router_, kLinkCount, 2U));
+}
+
+TEST_F(RouterTests, FanOutFanIn)
+{
+    Inject(0U, 2U, 0x10U);
+    Inject(0U, 3U, 0x20U);
+    Inject(0U, 4U, 0x30U);
+    Inject(1U, 5U, 0x40U);
+    Inject(2U, 6U, 0x50U);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_RouterPoll(&router_, &forwarded_));
+    ASSERT_EQ(5U, forwarded_);
+
+    Expect(1U, 2U, 0x10U);
+    Expect(1U, CAVE_TALK_ID_NONE, 0U);
+
+    Expect(2U, 2U, 0x10U);
+    Expect(2U, 3U, 0x20U);
+    Expect(2U, CAVE_TALK_ID_NONE, 0U);
+
+    Expect(0U, 5U, 0x40U);
+    Expect(0U, 6U, 0x50U);
+    Expect(0U, CAVE_TALK_ID_NONE, 0U);
+
+    ASSERT_EQ(4U, router_.counters.routed);
+    ASSERT_EQ(1U, router_.counters.unrouted);
+    ASSERT_EQ(3U, links_[0].counters.frames_in);
+    ASSERT_EQ(2U, links_[2].counters.frames_out);
+}
+
+TEST_F(RouterTests, Backpressure)
+{
+    const std::size_t kFrames = 6U;
+
+    pipes_[1].accept = false;
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        Inject(0U, 2U, static_cast<uint8_t>(index));
+    }
+
+    /* Link 1 refuses frames, its queue fills and the operator link is no longer read */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_RouterPoll(&router_, &forwarded_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_RouterPoll(&router_, &forwarded_));
+    ASSERT_EQ(kQueueSlots + 1U, links_[0].counters.frames_in);
+    ASSERT_EQ(kQueueSlots, links_[1].queue_count);
+    ASSERT_NE(0U, links_[0].counters.stalls);
+    ASSERT_NE(0U, links_[1].counters.stalls);
+
+    /* Link 2 still got every frame that was read */
+    for (std::size_t index = 0U; index < kQueueSlots; index++)
+    {
+        Expect(2U, 2U, static_cast<uint8_t>(index));
+    }
+
+    /* Once link 1 drains, every frame arrives in order and none are lost */
+    pipes_[1].accept = true;
+
+    for (std::size_t pass = 0U; pass < kFrames; pass++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_RouterPoll(&router_, &forwarded_));
+    }
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        Expect(1U, 2U, static_cast<uint8_t>(index));
+    }
+
+    for (std::size_t index = kQueueSlots; index < kFrames; index++)
+    {
+        Expect(2U, 2U, static_cast<uint8_t>(index));
+    }
+
+    Expect(1U, CAVE_TALK_ID_NONE, 0U);
+    Expect(2U, CAVE_TALK_ID_NONE, 0U);
+    ASSERT_EQ(kFrames, router_.counters.routed);
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_timer.h"
+#include "cave_talk_types.h"
+
+static const CaveTalk_Microseconds_t kTick = 1000U;
+
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+/* Records when each timer fired, and can restart itself or cancel another timer from its callback */
+struct Expiry
+{
+    CaveTalk_TimerWheel_t *wheel          = nullptr;
+    CaveTalk_Timer_t *timer               = nullptr;
+    CaveTalk_Timer_t *cancel              = nullptr;
+    CaveTalk_Microseconds_t restart       = 0U;
+    std::vector<CaveTalk_Microseconds_t> fired;
+};
+
+static void Fire(void *const context)
+{
+    Expiry *const expiry = static_cast<Expiry *>(context);
+
+    expiry->fired.push_back(now);
+
+    if (0U != expiry->restart)
+    {
+        CaveTalk_TimerStart(expiry->wheel, expiry->timer, expiry->restart);
+    }
+
+    if (nullptr != expiry->cancel)
+    {
+        CaveTalk_TimerCancel(expiry->wheel, expiry->cancel);
+    }
+}
+
+class TimerTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        now = 1000U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelInit(&wheel_, Clock, kTick));
+    }
+
+    /* Advances the clock a tick at a time, as a loop polling the wheel would */
+    std::size_t AdvanceTo(const CaveTalk_Microseconds_t until)
+    {
+        std::size_t total = 0U;
+        std::size_t fired = 0U;
+
+        while (now < until)
+        {
+            now = ((now + kTick) < until) ? (now + kTick) : until;
+            EXPECT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel_, &fired));
+            total += fired;
+        }
+
+        return total;
+    }
+
+    CaveTalk_TimerWheel_t wheel_;
+    std::size_t fired_ = 0U;
+};
+
+TEST_F(TimerTests, Init)
+{
+    CaveTalk_Timer_t timer;
+    Expiry           expiry;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerWheelInit(nullptr, Clock, kTick));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerWheelInit(&wheel_, nullptr, kTick));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_TimerWheelInit(&wheel_, Clock, 0U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerInit(nullptr, Fire, &expiry));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerInit(&timer, nullptr, &expiry));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&timer, Fire, &expiry));
+    ASSERT_FALSE(CaveTalk_TimerPending(&timer));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerStart(nullptr, &timer, 100U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerStart(&wheel_, nullptr, 100U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerCancel(&wheel_, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TimerWheelAdvance(&wheel_, nullptr));
+}
+
+TEST_F(TimerTests, StartCancel)
+{
+    std::array<CaveTalk_Timer_t, 3U> timers;
+    std::array<Expiry, 3U>           expiries;
+
+    for (std::size_t index = 0U; index < timers.size(); index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&timers[index], Fire, &expiries[index]));
+    }
+
+    /* Timeouts round up to whole ticks, a timer never fires early */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timers[0U], 2500U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timers[1U], 2500U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timers[2U], 0U));
+    ASSERT_TRUE(CaveTalk_TimerPending(&timers[0U]));
+    ASSERT_EQ(3U, wheel_.active);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel_, &fired_));
+    ASSERT_EQ(1U, fired_);
+    ASSERT_EQ(1U, expiries[2U].fired.size());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerCancel(&wheel_, &timers[1U]));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerCancel(&wheel_, &timers[1U]));
+    ASSERT_FALSE(CaveTalk_TimerPending(&timers[1U]));
+
+    ASSERT_EQ(0U, AdvanceTo(3000U));
+    ASSERT_EQ(1U, AdvanceTo(4000U));
+    ASSERT_EQ(4000U, expiries[0U].fired.at(0U));
+    ASSERT_TRUE(expiries[1U].fired.empty());
+    ASSERT_EQ(0U, wheel_.active);
+
+    /* Starting a pending timer moves it rather than adding it twice */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timers[0U], 5000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timers[0U], 1000U));
+    ASSERT_EQ(1U, wheel_.active);
+    ASSERT_EQ(1U, AdvanceTo(10000U));
+    ASSERT_EQ(5000U, expiries[0U].fired.at(1U));
+}
+
+TEST_F(TimerTests, Levels)
+{
+    const std::array<CaveTalk_Microseconds_t, 8U> kTimeouts = {
+        63U * kTick, 64U * kTick, 100U * kTick, 4095U * kTick, 4096U * kTick, 300000U * kTick, (1ULL << 24U) * kTick, (1ULL << 25U) * kTick + 7U,
+    };
+    std::array<CaveTalk_Timer_t, kTimeouts.size()> timers;
+    std::array<Expiry, kTimeouts.size()>           expiries;
+
+    now = 5000U * kTick + 17U;
+
+    for (std::size_t index = 0U; index < timers.size(); index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&timers[index], Fire, &expiries[index]));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timers[index], kTimeouts[index]));
+    }
+
+    /* Every timer is moved down through the levels and fires on the first tick at or after its deadline, the clock
+     * jumps straight to just before it and the wheel steps through the ticks in between */
+    const CaveTalk_Microseconds_t start = now;
+
+    for (std::size_t index = 0U; index < timers.size(); index++)
+    {
+        const CaveTalk_Microseconds_t due = ((start + kTimeouts[index] + kTick - 1U) / kTick) * kTick;
+
+        now = due - 1U;
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel_, &fired_));
+        ASSERT_EQ(0U, fired_) << index;
+
+        now = due;
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerWheelAdvance(&wheel_, &fired_));
+        ASSERT_EQ(1U, fired_) << index;
+        ASSERT_EQ(1U, expiries[index].fired.size()) << index;
+    }
+
+    ASSERT_EQ(0U, wheel_.active);
+}
+
+TEST_F(TimerTests, Callbacks)
+{
+    CaveTalk_Timer_t periodic;
+    CaveTalk_Timer_t cancelled;
+    Expiry           periodic_expiry;
+    Expiry           cancelled_expiry;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&periodic, Fire, &periodic_expiry));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&cancelled, Fire, &cancelled_expiry));
+
+    /* Both are due on the same tick, the one that fires first restarts itself and cancels the other */
+    periodic_expiry.wheel   = &wheel_;
+    periodic_expiry.timer   = &periodic;
+    periodic_expiry.cancel  = &cancelled;
+    periodic_expiry.restart = 10U * kTick;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &cancelled, 10U * kTick));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &periodic, 10U * kTick));
+
+    ASSERT_EQ(5U, AdvanceTo(51000U));
+    ASSERT_TRUE(cancelled_expiry.fired.empty());
+    ASSERT_EQ(21000U, periodic_expiry.fired[1U]);
+    ASSERT_TRUE(CaveTalk_TimerPending(&periodic));
+
+    /* A restart of no time fires on the next tick rather than in the same advance */
+    periodic_expiry.restart = 1U;
+    ASSERT_EQ(1U, AdvanceTo(61000U));
+    ASSERT_EQ(1U, AdvanceTo(62000U));
+    ASSERT_EQ(62000U, periodic_expiry.fired.back());
+}
+
+TEST_F(TimerTests, Idle)
+{
+    CaveTalk_Timer_t timer;
+    Expiry           expiry;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerInit(&timer, Fire, &expiry));
+
+    // The wheel sat empty far longer than it spans without being advanced, the timer is placed from the current tick
+    now += (1ULL << 30U) * kTick;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TimerStart(&wheel_, &timer, 2U * kTick));
+    ASSERT_EQ(now / kTick, wheel_.next);
+
+    ASSERT_EQ(0U, AdvanceTo(now + kTick));
+    ASSERT_EQ(1U, AdvanceTo(now + kTick));
+    ASSERT_EQ(now, expiry.fired.at(0U));
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_trace.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+#if defined(CAVE_TALK_TRACE) && !defined(CAVE_TALK_TRACE_USDT)
+static const bool kTraceHook = true;
+#else
+static const bool kTraceHook = false;
+#endif
+
+struct Probe
+{
+    CaveTalk_TraceProbe_t probe;
+    CaveTalk_Id_t id;
+    CaveTalk_Length_t length;
+
+    bool operator==(const Probe &other) const = default;
+};
+
+static RingBuffer<uint8_t, 1024U> trace_link;
+static std::vector<Probe> probes;
+
+static void Hook(const CaveTalk_TraceProbe_t probe, const CaveTalk_Id_t id, const CaveTalk_Length_t length)
+{
+    probes.push_back({probe, id, length});
+}
+
+static CaveTalk_Error_t Send(const void *const data, const size_t size)
+{
+    trace_link.Write(static_cast<const uint8_t *>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t Receive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received = trace_link.Read(static_cast<uint8_t *>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t Available(size_t *const bytes_available)
+{
+    *bytes_available = trace_link.Size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static const CaveTalk_LinkHandle_t kLinkHandle = {
+    .send      = Send,
+    .receive   = Receive,
+    .available = Available,
+};
+
+class TraceTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        trace_link.Clear();
+        probes.clear();
+        CaveTalk_TraceSetHook(Hook);
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_TraceSetHook(nullptr);
+    }
+
+    const uint8_t payload_[6U] = {1U, 2U, 3U, 4U, 5U, 6U};
+    uint8_t data_[255U]        = {0U};
+    CaveTalk_Id_t id_          = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t length_  = 0U;
+};
+
+TEST_F(TraceTests, Hook)
+{
+    CaveTalk_Trace(CAVE_TALK_TRACE_PROBE_DECODE, 2U, 18U);
+    ASSERT_EQ(std::vector<Probe>({{CAVE_TALK_TRACE_PROBE_DECODE, 2U, 18U}}), probes);
+
+    CaveTalk_TraceSetHook(nullptr);
+    CaveTalk_Trace(CAVE_TALK_TRACE_PROBE_DECODE, 2U, 18U);
+    ASSERT_EQ(1U, probes.size());
+}
+
+TEST_F(TraceTests, SpeakListen)
+{
+    if (!kTraceHook)
+    {
+        GTEST_SKIP() << "Tracepoints are compiled out, or are USDT probes";
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kLinkHandle, 3U, payload_, sizeof(payload_)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&kLinkHandle, &id_, data_, sizeof(data_), &length_));
+
+    const std::vector<Probe> expected = {
+        {CAVE_TALK_TRACE_PROBE_SEND, 3U, 6U},
+        {CAVE_TALK_TRACE_PROBE_HEADER, 3U, 6U},
+        {CAVE_TALK_TRACE_PROBE_PAYLOAD, 3U, 6U},
+    };
+    ASSERT_EQ(expected, probes);
+}
+
+TEST_F(TraceTests, FrameParser)
+{
+    if (!kTraceHook)
+    {
+        GTEST_SKIP() << "Tracepoints are compiled out, or are USDT probes";
+    }
+
+    CaveTalk_FrameParser_t parser;
+    uint8_t                bytes[8U];
+    std::size_t            size     = 0U;
+    std::size_t            consumed = 0U;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kLinkHandle, 4U, payload_, sizeof(payload_)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParserInit(&parser, data_, sizeof(data_)));
+    probes.clear();
+
+    /* The header probe fires as soon as the header is in, the payload probe only once the CRC is */
+    size = trace_link.Read(bytes, sizeof(bytes));
+    ASSERT_EQ(CAVE_TALK_ERROR_INCOMPLETE, CaveTalk_FrameParse(&parser, bytes, size, &consumed, &id_, &length_));
+    ASSERT_EQ(std::vector<Probe>({{CAVE_TALK_TRACE_PROBE_HEADER, 4U, 6U}}), probes);
+
+    size = trace_link.Read(bytes, sizeof(bytes));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_FrameParse(&parser, bytes, size, &consumed, &id_, &length_));
+    ASSERT_EQ(2U, probes.size());
+    ASSERT_EQ((Probe{CAVE_TALK_TRACE_PROBE_PAYLOAD, 4U, 6U}), probes.back());
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_transmit.h"
+#include "cave_talk_types.h"
+
+/* A link that takes at most room bytes, as a non-blocking socket with a nearly full buffer would */
+struct Outlet
+{
+    std::vector<uint8_t> wire;
+    std::size_t room       = SIZE_MAX;
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+};
+
+static CaveTalk_Error_t OutletWrite(void *const context, const void *const data, const size_t size, size_t *const bytes_written)
+{
+    Outlet *const        outlet = static_cast<Outlet *>(context);
+    const std::size_t    count  = (size < outlet->room) ? size : outlet->room;
+    const uint8_t *const bytes  = static_cast<const uint8_t *>(data);
+
+    *bytes_written = 0U;
+
+    if (CAVE_TALK_ERROR_NONE == outlet->error)
+    {
+        outlet->wire.insert(outlet->wire.end(), bytes, bytes + count);
+        outlet->room   -= count;
+        *bytes_written  = count;
+    }
+
+    return outlet->error;
+}
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const std::vector<uint8_t> &payload)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, static_cast<uint8_t>(payload.size())};
+
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+class TransmitTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterOpen(&transmitter_, OutletWrite, &outlet_, &link_handle_));
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_TransmitterClose(&transmitter_);
+    }
+
+    Outlet outlet_;
+    CaveTalk_Transmitter_t transmitter_;
+    CaveTalk_LinkHandle_t link_handle_;
+    const std::vector<uint8_t> first_  = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U};
+    const std::vector<uint8_t> second_ = {11U, 12U, 13U};
+};
+
+TEST_F(TransmitTests, Open)
+{
+    CaveTalk_Transmitter_t transmitter;
+    CaveTalk_LinkHandle_t  link_handle;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TransmitterOpen(nullptr, OutletWrite, &outlet_, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TransmitterOpen(&transmitter, nullptr, &outlet_, &link_handle));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TransmitterOpen(&transmitter, OutletWrite, &outlet_, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_TransmitterResume(nullptr));
+    ASSERT_EQ(0U, CaveTalk_TransmitterPending(nullptr));
+    ASSERT_EQ(nullptr, link_handle_.receive);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, first_.data(), first_.size()));
+    ASSERT_THAT(outlet_.wire, ::testing::ElementsAreArray(Frame(2U, first_)));
+    ASSERT_EQ(1U, transmitter_.stats.frames);
+    ASSERT_EQ(1U, transmitter_.stats.writes);
+}
+
+TEST_F(TransmitTests, PartialWrite)
+{
+    const std::vector<uint8_t> frame = Frame(2U, first_);
+
+    /* Only the header and two payload bytes fit, the rest of the frame is kept for later */
+    outlet_.room = 5U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, first_.data(), first_.size()));
+    ASSERT_EQ(5U, outlet_.wire.size());
+    ASSERT_EQ(frame.size() - 5U, CaveTalk_TransmitterPending(&transmitter_));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterResume(&transmitter_));
+    ASSERT_EQ(frame.size() - 5U, CaveTalk_TransmitterPending(&transmitter_));
+
+    outlet_.room = 4U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterResume(&transmitter_));
+    ASSERT_EQ(frame.size() - 9U, CaveTalk_TransmitterPending(&transmitter_));
+
+    outlet_.room = SIZE_MAX;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterResume(&transmitter_));
+    ASSERT_EQ(0U, CaveTalk_TransmitterPending(&transmitter_));
+    ASSERT_THAT(outlet_.wire, ::testing::ElementsAreArray(frame));
+    ASSERT_EQ(1U, transmitter_.stats.frames);
+    ASSERT_EQ(2U, transmitter_.stats.partial_writes);
+}
+
+TEST_F(TransmitTests, Busy)
+{
+    std::vector<uint8_t>       stream = Frame(2U, first_);
+    const std::vector<uint8_t> second = Frame(3U, second_);
+
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    /* A frame is refused whole while another is pending, so the stream never interleaves */
+    outlet_.room = 5U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, first_.data(), first_.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_BUSY, CaveTalk_Speak(&link_handle_, 3U, second_.data(), second_.size()));
+    ASSERT_EQ(5U, outlet_.wire.size());
+    ASSERT_EQ(1U, transmitter_.stats.busy);
+
+    /* Speaking resumes the pending frame first */
+    outlet_.room = SIZE_MAX;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 3U, second_.data(), second_.size()));
+    ASSERT_THAT(outlet_.wire, ::testing::ElementsAreArray(stream));
+    ASSERT_EQ(2U, transmitter_.stats.frames);
+}
+
+TEST_F(TransmitTests, WriteError)
+{
+    const std::vector<uint8_t> frame = Frame(2U, first_);
+
+    outlet_.room = 5U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, first_.data(), first_.size()));
+
+    /* Part of the frame is already on the wire, so it is kept through the error rather than dropped */
+    outlet_.error = CAVE_TALK_ERROR_IO;
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_TransmitterResume(&transmitter_));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_Speak(&link_handle_, 3U, second_.data(), second_.size()));
+    ASSERT_EQ(frame.size() - 5U, CaveTalk_TransmitterPending(&transmitter_));
+
+    outlet_.error = CAVE_TALK_ERROR_NONE;
+    outlet_.room  = SIZE_MAX;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterResume(&transmitter_));
+    ASSERT_THAT(outlet_.wire, ::testing::ElementsAreArray(frame));
+}
+
+TEST_F(TransmitTests, WriteErrorRollback)
+{
+    const std::vector<uint8_t> frame = Frame(2U, first_);
+
+    /* Nothing reached the link, so the frame is not kept behind the error */
+    outlet_.error = CAVE_TALK_ERROR_IO;
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_Speak(&link_handle_, 2U, first_.data(), first_.size()));
+    ASSERT_EQ(0U, CaveTalk_TransmitterPending(&transmitter_));
+
+    outlet_.error = CAVE_TALK_ERROR_NONE;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterResume(&transmitter_));
+    ASSERT_TRUE(outlet_.wire.empty());
+
+    /* Speaking it again sends it once */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, first_.data(), first_.size()));
+    ASSERT_THAT(outlet_.wire, ::testing::ElementsAreArray(frame));
+    ASSERT_EQ(1U, transmitter_.stats.frames);
+}
+
+TEST_F(TransmitTests, AbandonedHeader)
+{
+    const std::vector<uint8_t> frame                         = Frame(3U, second_);
+    const uint8_t              header[CAVE_TALK_HEADER_SIZE] = {CAVE_TALK_VERSION, 2U, static_cast<uint8_t>(first_.size())};
+
+    /* A header whose payload never arrives is dropped, not sent ahead of the next frame */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, link_handle_.send(header, sizeof(header)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, link_handle_.send(nullptr, first_.size()));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 3U, second_.data(), second_.size()));
+    ASSERT_THAT(outlet_.wire, ::testing::ElementsAreArray(frame));
+}
\ No newline at end of file
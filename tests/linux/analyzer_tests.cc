@@ -0,0 +1,139 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_capture.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Runs the analyzer built alongside the tests and returns what it printed, or an empty string when it fails */
+static std::string Analyze(const std::string &arguments)
+{
+    const std::string     command = std::string(CAVE_TALK_ANALYZER) + " " + arguments + " 2>/dev/null";
+    std::string           output;
+    std::array<char, 256> line;
+    FILE *const           pipe = popen(command.c_str(), "r");
+
+    while ((nullptr != pipe) && (nullptr != fgets(line.data(), line.size(), pipe)))
+    {
+        output += line.data();
+    }
+
+    if ((nullptr == pipe) || (0 != WEXITSTATUS(pclose(pipe))))
+    {
+        output.clear();
+    }
+
+    return output;
+}
+
+/* Drops the first line, which names the file and how it was split */
+static std::string Report(const std::string &output)
+{
+    return output.substr(output.find('\n') + 1U);
+}
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const uint8_t length)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, length};
+
+    frame.insert(frame.end(), length, 0xA5U);
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+static std::string TempPath(const char *const name)
+{
+    return testing::TempDir() + name;
+}
+
+TEST(AnalyzerTests, Usage)
+{
+    ASSERT_TRUE(Analyze("").empty());
+    ASSERT_TRUE(Analyze("--direction up file").empty());
+    ASSERT_TRUE(Analyze(TempPath("analyzer_missing.bin")).empty());
+}
+
+TEST(AnalyzerTests, Raw)
+{
+    const std::string    path = TempPath("analyzer_raw.bin");
+    std::vector<uint8_t> bytes;
+
+    /* Large enough to be split into several chunks, with a stray byte every 1000 frames and a frame cut off at the end */
+    for (std::size_t index = 0U; index < 200000U; index++)
+    {
+        const std::vector<uint8_t> frame = Frame((0U == (index % 4U)) ? 3U : 2U, static_cast<uint8_t>(index % 16U));
+
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+        if (999U == (index % 1000U))
+        {
+            bytes.push_back(0xFFU);
+        }
+    }
+    bytes.insert(bytes.end(), {CAVE_TALK_VERSION, 2U, 10U, 0U});
+
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    const std::string single   = Analyze("--threads 1 " + path);
+    const std::string parallel = Analyze("--threads 4 " + path);
+
+    ASSERT_NE(std::string::npos, single.find("raw, " + std::to_string(bytes.size()) + " bytes"));
+    ASSERT_NE(std::string::npos, single.find("Frames:   200000\n"));
+    ASSERT_NE(std::string::npos, single.find("Errors:   200\n"));
+    ASSERT_NE(std::string::npos, single.find("Trailing: 4 bytes"));
+    ASSERT_NE(std::string::npos, single.find("VERSION  200\n"));
+    ASSERT_NE(std::string::npos, single.find("at offset "));
+
+    /* Chunks parsed in parallel are reconciled to the same result */
+    ASSERT_EQ(std::string::npos, single.find("1 chunks"));
+    ASSERT_EQ(Report(single), Report(parallel));
+}
+
+TEST(AnalyzerTests, Capture)
+{
+    const std::string           path = TempPath("analyzer_capture.cvtk");
+    const CaveTalk_LinkHandle_t link = {[](const void *const, const size_t) { return CAVE_TALK_ERROR_NONE; }, nullptr, nullptr};
+    CaveTalk_Capture_t          capture;
+    CaveTalk_LinkHandle_t       recording_link;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureOpen(&capture, path.c_str(), 256U, &link, [] { return CaveTalk_Microseconds_t{0U}; }, &recording_link));
+
+    /* One frame every 1 ms for a second, every one of them split across two records */
+    for (CaveTalk_Microseconds_t timestamp = 0U; timestamp < 1000000U; timestamp += 1000U)
+    {
+        const std::vector<uint8_t> frame = Frame(2U, 8U);
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_RX, timestamp, frame.data(), 5U));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_RX, timestamp, &frame[5U], frame.size() - 5U));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_TX, timestamp, &frame[1U], 1U));
+    }
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureClose(&capture));
+
+    const std::string rx = Analyze("--threads 1 --rates --interval 500000 " + path);
+
+    ASSERT_NE(std::string::npos, rx.find("capture rx"));
+    ASSERT_NE(std::string::npos, rx.find("Frames:   1000\n"));
+    ASSERT_NE(std::string::npos, rx.find("Errors:   0\n"));
+    ASSERT_NE(std::string::npos, rx.find("Duration: 0.999000 s"));
+    ASSERT_NE(std::string::npos, rx.find("1001.00"));
+    ASSERT_NE(std::string::npos, rx.find("        0 us 0x02        500\n"));
+    ASSERT_NE(std::string::npos, rx.find("   500000 us 0x02        500\n"));
+    ASSERT_EQ(Report(rx), Report(Analyze("--threads 4 --rates --interval 500000 " + path)));
+
+    /* The other direction only holds stray bytes, each is an error until the last two are too few for a header */
+    const std::string tx = Analyze("--direction tx " + path);
+
+    ASSERT_NE(std::string::npos, tx.find("capture tx"));
+    ASSERT_NE(std::string::npos, tx.find("Frames:   0\n"));
+    ASSERT_NE(std::string::npos, tx.find("Errors:   998\n"));
+    ASSERT_NE(std::string::npos, tx.find("Trailing: 2 bytes"));
+}
\ No newline at end of file
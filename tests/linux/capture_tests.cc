@@ -0,0 +1,206 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include "cave_talk_capture.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+#include "ring_buffer.h"
+
+static const std::size_t kMaxMessageLength = 255U;
+static RingBuffer<uint8_t, kMaxMessageLength> ring_buffer;
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Error_t Send(const void *const data, const size_t size)
+{
+    CaveTalk_Error_t error = CAVE_TALK_ERROR_NONE;
+
+    if (size > ring_buffer.Capacity() - ring_buffer.Size())
+    {
+        error = CAVE_TALK_ERROR_INCOMPLETE;
+    }
+    else
+    {
+        ring_buffer.Write(static_cast<const uint8_t *const>(data), size);
+    }
+
+    return error;
+}
+
+static CaveTalk_Error_t Receive(void *const data, const size_t size, size_t *const bytes_received)
+{
+    *bytes_received = ring_buffer.Read(static_cast<uint8_t *const>(data), size);
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Error_t Available(size_t *const bytes_available)
+{
+    *bytes_available = ring_buffer.Size();
+
+    return CAVE_TALK_ERROR_NONE;
+}
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+static const CaveTalk_LinkHandle_t kLinkHandle = {
+    .send      = Send,
+    .receive   = Receive,
+    .available = Available,
+};
+
+static std::string CapturePath(const char *const name)
+{
+    return testing::TempDir() + name;
+}
+
+TEST(CaptureTests, RecordAndRead)
+{
+    const std::string        path            = CapturePath("record_and_read.cvtk");
+    uint8_t                  data_send[]     = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint8_t                  data_receive[4] = {0U};
+    CaveTalk_Id_t            id              = 0U;
+    CaveTalk_Length_t        length          = 0U;
+    CaveTalk_Capture_t       capture;
+    CaveTalk_LinkHandle_t    recording_link;
+    CaveTalk_CaptureReader_t reader;
+    CaveTalk_CaptureCursor_t cursor;
+    CaveTalk_CaptureRecord_t record;
+
+    ring_buffer.Clear();
+
+    now = 100U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureOpen(&capture, path.c_str(), 0U, &kLinkHandle, Clock, &recording_link));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&recording_link, 0x0F, data_send, sizeof(data_send)));
+    now = 200U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&recording_link, &id, data_receive, sizeof(data_receive), &length));
+    ASSERT_THAT(data_receive, testing::ElementsAreArray(data_send));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureClose(&capture));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureReaderOpen(&reader, path.c_str()));
+    ASSERT_EQ(1U, reader.block_count);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureSeek(&reader, 0U, &cursor));
+
+    // Header, payload and CRC are sent and received separately but recorded as one frame in each direction
+    for (const CaveTalk_CaptureDirection_t direction : {CAVE_TALK_CAPTURE_DIRECTION_TX, CAVE_TALK_CAPTURE_DIRECTION_RX})
+    {
+        ASSERT_TRUE(CaveTalk_CaptureNext(&reader, &cursor, &record));
+        ASSERT_EQ(direction, record.direction);
+        ASSERT_EQ(3U + sizeof(data_send) + sizeof(CaveTalk_Crc_t), record.length);
+        ASSERT_EQ(0x0F, record.data[1]);
+        ASSERT_EQ(0xEF, record.data[6]);
+        ASSERT_EQ((CAVE_TALK_CAPTURE_DIRECTION_TX == direction) ? 100U : 200U, record.timestamp);
+    }
+
+    ASSERT_FALSE(CaveTalk_CaptureNext(&reader, &cursor, &record));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureReaderClose(&reader));
+}
+
+TEST(CaptureTests, SeekByTime)
+{
+    const std::string        path      = CapturePath("seek_by_time.cvtk");
+    uint8_t                  data[600] = {0U};
+    CaveTalk_Capture_t       capture;
+    CaveTalk_LinkHandle_t    recording_link;
+    CaveTalk_CaptureReader_t reader;
+    CaveTalk_CaptureCursor_t cursor;
+    CaveTalk_CaptureRecord_t record;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_CaptureOpen(&capture, path.c_str(), 100U, &kLinkHandle, Clock, &recording_link));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureOpen(&capture, path.c_str(), 256U, &kLinkHandle, Clock, &recording_link));
+
+    for (CaveTalk_Microseconds_t timestamp = 0U; timestamp < 10000U; timestamp += 10U)
+    {
+        data[0] = static_cast<uint8_t>(timestamp / 10U);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_RX, timestamp, data, 1U + (timestamp % 50U)));
+    }
+
+    // Records larger than a block are split
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_RX, 10000U, data, sizeof(data)));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureClose(&capture));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureReaderOpen(&reader, path.c_str()));
+    ASSERT_LT(100U, reader.block_count);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureSeek(&reader, 5005U, &cursor));
+    ASSERT_TRUE(CaveTalk_CaptureNext(&reader, &cursor, &record));
+    ASSERT_EQ(5010U, record.timestamp);
+    ASSERT_EQ(static_cast<uint8_t>(501U), record.data[0]);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureSeek(&reader, 0U, &cursor));
+    ASSERT_TRUE(CaveTalk_CaptureNext(&reader, &cursor, &record));
+    ASSERT_EQ(0U, record.timestamp);
+
+    std::size_t split_length = 0U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureSeek(&reader, 10000U, &cursor));
+    while (CaveTalk_CaptureNext(&reader, &cursor, &record))
+    {
+        ASSERT_EQ(10000U, record.timestamp);
+        split_length += record.length;
+    }
+    ASSERT_EQ(sizeof(data), split_length);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureReaderClose(&reader));
+}
+
+TEST(CaptureTests, Replay)
+{
+    const std::string     path        = CapturePath("replay.cvtk");
+    uint8_t               frame[64]   = {0U};
+    uint8_t               data_send[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint8_t               data_receive[4];
+    CaveTalk_Id_t         id     = 0U;
+    CaveTalk_Length_t     length = 0U;
+    std::size_t           size   = 0U;
+    CaveTalk_Capture_t    capture;
+    CaveTalk_LinkHandle_t recording_link;
+    CaveTalk_Replay_t     replay;
+    CaveTalk_LinkHandle_t replay_link;
+
+    ring_buffer.Clear();
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureOpen(&capture, path.c_str(), 0U, &kLinkHandle, Clock, &recording_link));
+    for (CaveTalk_Id_t frame_id = 1U; frame_id <= 3U; frame_id++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&kLinkHandle, frame_id, data_send, sizeof(data_send)));
+        size = ring_buffer.Read(frame, sizeof(frame));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_RX, frame_id * 1000U, frame, size));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureAppend(&capture, CAVE_TALK_CAPTURE_DIRECTION_TX, frame_id * 1000U, frame, 1U));
+    }
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_CaptureClose(&capture));
+
+    // Maximum speed
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReplayOpen(&replay, path.c_str(), CAVE_TALK_CAPTURE_DIRECTION_RX, nullptr, &replay_link));
+    for (CaveTalk_Id_t frame_id = 1U; frame_id <= 3U; frame_id++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&replay_link, &id, data_receive, sizeof(data_receive), &length));
+        ASSERT_EQ(frame_id, id);
+        ASSERT_THAT(data_receive, testing::ElementsAreArray(data_send));
+    }
+    ASSERT_TRUE(CaveTalk_ReplayDone(&replay));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReplayClose(&replay));
+
+    // Real time, frames are released as the clock reaches their offset from the start of the capture
+    now = 50000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReplayOpen(&replay, path.c_str(), CAVE_TALK_CAPTURE_DIRECTION_RX, Clock, &replay_link));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&replay_link, &id, data_receive, sizeof(data_receive), &length));
+    ASSERT_EQ(1U, id);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&replay_link, &id, data_receive, sizeof(data_receive), &length));
+    ASSERT_EQ(0U, id);
+
+    now += 1000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&replay_link, &id, data_receive, sizeof(data_receive), &length));
+    ASSERT_EQ(2U, id);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReplaySeek(&replay, 3000U));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&replay_link, &id, data_receive, sizeof(data_receive), &length));
+    ASSERT_EQ(3U, id);
+    ASSERT_TRUE(CaveTalk_ReplayDone(&replay));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ReplayClose(&replay));
+}
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_channel.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static const std::size_t kSlotCount = 8U;
+
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+class CaveTalkChannelTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        now = 1000U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelOpen(&channel_, nullptr, kSlotCount, Clock));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReaderAttach(&reader_, &channel_));
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_ChannelReaderClose(&reader_);
+        CaveTalk_ChannelClose(&channel_);
+    }
+
+    CaveTalk_Channel_t channel_;
+    CaveTalk_ChannelReader_t reader_;
+    CaveTalk_ChannelRecord_t record_;
+};
+
+TEST_F(CaveTalkChannelTests, Open)
+{
+    CaveTalk_Channel_t channel;
+    const std::string  long_name(CAVE_TALK_CHANNEL_NAME_SIZE_MAX, 'a');
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ChannelOpen(nullptr, nullptr, kSlotCount, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ChannelOpen(&channel, nullptr, kSlotCount, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ChannelOpen(&channel, nullptr, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ChannelOpen(&channel, nullptr, 6U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_ChannelOpen(&channel, long_name.c_str(), kSlotCount, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_ChannelReaderOpen(&reader_, "/cave-talk-channel-missing"));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_ChannelRead(nullptr, &record_));
+}
+
+TEST_F(CaveTalkChannelTests, PublishRead)
+{
+    CaveTalk_ChannelReader_t reader;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReaderAttach(&reader, &channel_));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelPublishMovement(&channel_, 1.5, -0.5));
+    now = 2000U;
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelPublishMode(&channel_, true));
+
+    /* Readers keep their own cursors, both see every record */
+    for (CaveTalk_ChannelReader_t *const each : {&reader_, &reader})
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelRead(each, &record_));
+        ASSERT_EQ(CAVE_TALK_ID_MOVEMENT, record_.id);
+        ASSERT_EQ(0U, record_.sequence);
+        ASSERT_EQ(1000U, record_.timestamp);
+        ASSERT_EQ(1.5, record_.message.movement.speed);
+        ASSERT_EQ(-0.5, record_.message.movement.turn_rate);
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelRead(each, &record_));
+        ASSERT_EQ(CAVE_TALK_ID_MODE, record_.id);
+        ASSERT_EQ(2000U, record_.timestamp);
+        ASSERT_TRUE(record_.message.mode.manual);
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelRead(each, &record_));
+        ASSERT_EQ(CAVE_TALK_ID_NONE, record_.id);
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReaderClose(&reader));
+}
+
+TEST_F(CaveTalkChannelTests, Overrun)
+{
+    const std::size_t kRecords = kSlotCount + 5U;
+
+    for (std::size_t index = 0U; index < kRecords; index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelPublishCameraMovement(&channel_, static_cast<double>(index), 0.0));
+    }
+
+    /* The writer never waits, a slow reader loses the oldest records and resumes at the oldest still held */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelRead(&reader_, &record_));
+    ASSERT_EQ(CAVE_TALK_ID_CAMERA_MOVEMENT, record_.id);
+    ASSERT_EQ(kRecords - kSlotCount, record_.sequence);
+    ASSERT_EQ(static_cast<double>(kRecords - kSlotCount), record_.message.camera_movement.pan);
+    ASSERT_EQ(kRecords - kSlotCount, reader_.overruns);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReadLatest(&reader_, &record_));
+    ASSERT_EQ(kRecords - 1U, record_.sequence);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReadLatest(&reader_, &record_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, record_.id);
+    ASSERT_EQ(kRecords - kSlotCount, reader_.overruns);
+}
+
+TEST_F(CaveTalkChannelTests, Named)
+{
+    const std::string        name = "/cave-talk-channel-" + std::to_string(getpid());
+    CaveTalk_Channel_t       channel;
+    CaveTalk_ChannelReader_t reader;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelOpen(&channel, name.c_str(), kSlotCount, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReaderOpen(&reader, name.c_str()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelPublishLights(&channel, true));
+
+    /* The reader has its own mapping, as another process would */
+    ASSERT_NE(channel.map, reader.map);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelRead(&reader, &record_));
+    ASSERT_EQ(CAVE_TALK_ID_LIGHTS, record_.id);
+    ASSERT_TRUE(record_.message.lights.headlights);
+
+    /* Closing the channel removes the name, mapped readers keep the ring */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelClose(&channel));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelRead(&reader, &record_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, record_.id);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ChannelReaderClose(&reader));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_ChannelReaderOpen(&reader, name.c_str()));
+}
+
+TEST_F(CaveTalkChannelTests, Concurrent)
+{
+    const uint64_t    kRecords = 200000U;
+    std::atomic<bool> done     = false;
+    uint64_t          received = 0U;
+    uint64_t          last     = 0U;
+    bool              torn     = false;
+    bool              finished = false;
+
+    std::thread writer([&]() {
+        for (uint64_t index = 1U; index <= kRecords; index++)
+        {
+            CaveTalk_ChannelPublishMovement(&channel_, static_cast<double>(index), -static_cast<double>(index));
+        }
+
+        done = true;
+    });
+
+    /* Every record read is whole and in order, whatever the writer is doing to the ring at the time */
+    do
+    {
+        finished = done;
+        CaveTalk_ChannelRead(&reader_, &record_);
+
+        if (CAVE_TALK_ID_NONE != record_.id)
+        {
+            torn = torn || (record_.message.movement.speed != -record_.message.movement.turn_rate);
+            torn = torn || (record_.message.movement.speed <= static_cast<double>(last));
+            last = static_cast<uint64_t>(record_.message.movement.speed);
+            received++;
+        }
+    } while (!finished || (CAVE_TALK_ID_NONE != record_.id));
+
+    writer.join();
+
+    ASSERT_FALSE(torn);
+    ASSERT_EQ(kRecords, last);
+    ASSERT_EQ(kRecords, received + reader_.overruns);
+}
\ No newline at end of file
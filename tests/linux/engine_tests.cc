@@ -0,0 +1,246 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_engine.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static const std::size_t kLinksPerShard = 4U;
+static const std::size_t kHandoffSlots  = 16U;
+
+/* Every frame heard is sent on to the link attached in the order its first payload byte names, or echoed when it names
+ * none */
+struct Relay
+{
+    std::atomic<uint32_t> heard = 0U;
+    std::atomic<uint8_t> last   = 0U;
+    std::vector<uint32_t> links;
+};
+
+static void Forward(void *const context,
+                    CaveTalk_Engine_t *const engine,
+                    const std::size_t shard,
+                    const uint32_t link,
+                    const CaveTalk_Id_t id,
+                    const uint8_t *const payload,
+                    const CaveTalk_Length_t length)
+{
+    Relay *const relay = static_cast<Relay *>(context);
+
+    relay->heard++;
+    relay->last = (0U == length) ? 0U : payload[length - 1U];
+
+    CaveTalk_EngineSend(engine, shard, (0U == length) ? link : relay->links.at(payload[0U]), id, payload, length);
+}
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const std::vector<uint8_t> &payload)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, static_cast<uint8_t>(payload.size())};
+
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+/* Reads until size bytes are in or a second passes without any */
+static std::vector<uint8_t> Receive(const int fd, const std::size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+    std::size_t          received = 0U;
+    struct pollfd        ready    = {fd, POLLIN, 0};
+
+    while ((received < size) && (poll(&ready, 1U, 1000) > 0))
+    {
+        const ssize_t count = read(fd, &bytes[received], size - received);
+
+        if (count <= 0)
+        {
+            break;
+        }
+
+        received += static_cast<std::size_t>(count);
+    }
+
+    bytes.resize(received);
+
+    return bytes;
+}
+
+static bool Eventually(const std::function<bool()> &condition)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    while (!condition() && (std::chrono::steady_clock::now() < deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return condition();
+}
+
+class CaveTalkEngineTests : public ::testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        CaveTalk_EngineClose(&engine_);
+
+        for (const int fd : peers_)
+        {
+            close(fd);
+        }
+    }
+
+    uint32_t Attach(void)
+    {
+        std::array<int, 2U> fds  = {-1, -1};
+        uint32_t            link = 0U;
+
+        EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+        EXPECT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineAttach(&engine_, fds[0U], &link));
+        peers_.push_back(fds[1U]);
+        relay_.links.push_back(link);
+
+        return link;
+    }
+
+    CaveTalk_Engine_t engine_ = {};
+    Relay relay_;
+    std::vector<int> peers_;
+};
+
+TEST_F(CaveTalkEngineTests, Open)
+{
+    uint32_t                  link = 0U;
+    CaveTalk_EngineCounters_t counters;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_EngineOpen(nullptr, 1U, kLinksPerShard, kHandoffSlots, false, Forward, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_EngineOpen(&engine_, 1U, kLinksPerShard, kHandoffSlots, false, nullptr, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_EngineOpen(&engine_, 0U, kLinksPerShard, kHandoffSlots, false, Forward, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_EngineOpen(&engine_, CAVE_TALK_ENGINE_SHARD_COUNT_MAX + 1U, kLinksPerShard, kHandoffSlots, false, Forward, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_EngineOpen(&engine_, 1U, 0U, kHandoffSlots, false, Forward, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_EngineOpen(&engine_, 1U, kLinksPerShard, 12U, false, Forward, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_EngineAttach(&engine_, 0, &link));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineOpen(&engine_, 2U, kLinksPerShard, kHandoffSlots, true, Forward, &relay_));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_EngineAttach(&engine_, -1, &link));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_EngineCounters(&engine_, 2U, &counters));
+
+    /* New links go to the least loaded shard until every shard is full */
+    for (std::size_t index = 0U; index < (2U * kLinksPerShard); index++)
+    {
+        ASSERT_EQ((index % 2U) * kLinksPerShard + (index / 2U), CAVE_TALK_ENGINE_LINK_INDEX(Attach()));
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_EngineAttach(&engine_, peers_[0U], &link));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineCounters(&engine_, 1U, &counters));
+    ASSERT_EQ(kLinksPerShard, counters.links);
+}
+
+TEST_F(CaveTalkEngineTests, Echo)
+{
+    const std::vector<uint8_t> frame = Frame(2U, {});
+    CaveTalk_EngineCounters_t  counters;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineOpen(&engine_, 1U, kLinksPerShard, kHandoffSlots, false, Forward, &relay_));
+    Attach();
+
+    /* Frames split across reads and packed into one both come back whole */
+    ASSERT_EQ(2, write(peers_[0U], frame.data(), 2U));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(static_cast<ssize_t>(frame.size() - 2U), write(peers_[0U], &frame[2U], frame.size() - 2U));
+    ASSERT_EQ(frame, Receive(peers_[0U], frame.size()));
+
+    std::vector<uint8_t> packed = frame;
+
+    packed.insert(packed.end(), frame.begin(), frame.end());
+    ASSERT_EQ(static_cast<ssize_t>(packed.size()), write(peers_[0U], packed.data(), packed.size()));
+    ASSERT_EQ(packed, Receive(peers_[0U], packed.size()));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineCounters(&engine_, 0U, &counters));
+    ASSERT_EQ(3U, counters.frames_in);
+    ASSERT_EQ(3U, counters.frames_out);
+    ASSERT_EQ(0U, counters.handed_off);
+}
+
+TEST_F(CaveTalkEngineTests, Handoff)
+{
+    CaveTalk_EngineCounters_t counters;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineOpen(&engine_, 2U, kLinksPerShard, kHandoffSlots, false, Forward, &relay_));
+
+    const uint32_t first  = Attach();
+    const uint32_t second = Attach();
+
+    ASSERT_NE(CAVE_TALK_ENGINE_LINK_INDEX(first) / kLinksPerShard, CAVE_TALK_ENGINE_LINK_INDEX(second) / kLinksPerShard);
+
+    /* A frame heard on the first shard is sent out on the second shard's link */
+    const std::vector<uint8_t> frame = Frame(3U, {1U, 7U});
+
+    ASSERT_EQ(static_cast<ssize_t>(frame.size()), write(peers_[0U], frame.data(), frame.size()));
+    ASSERT_EQ(frame, Receive(peers_[1U], frame.size()));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineCounters(&engine_, CAVE_TALK_ENGINE_LINK_INDEX(first) / kLinksPerShard, &counters));
+    ASSERT_EQ(1U, counters.frames_in);
+    ASSERT_EQ(1U, counters.handed_off);
+    ASSERT_EQ(0U, counters.frames_out);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineCounters(&engine_, CAVE_TALK_ENGINE_LINK_INDEX(second) / kLinksPerShard, &counters));
+    ASSERT_EQ(0U, counters.frames_in);
+    ASSERT_EQ(1U, counters.frames_out);
+    ASSERT_EQ(7U, relay_.last);
+}
+
+TEST_F(CaveTalkEngineTests, PeerClose)
+{
+    CaveTalk_EngineCounters_t counters;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_EngineOpen(&engine_, 1U, 1U, kHandoffSlots, false, Forward, &relay_));
+
+    const uint32_t closed = Attach();
+
+    ASSERT_EQ(0U, CAVE_TALK_ENGINE_LINK_INDEX(closed));
+
+    /* The peer hanging up frees the link for the next one attached */
+    close(peers_.back());
+    peers_.pop_back();
+    ASSERT_TRUE(Eventually([&]() {
+        CaveTalk_EngineCounters(&engine_, 0U, &counters);
+        return 0U == counters.links;
+    }));
+
+    const uint32_t attached = Attach();
+
+    ASSERT_EQ(0U, CAVE_TALK_ENGINE_LINK_INDEX(attached));
+    ASSERT_NE(closed, attached);
+
+    const std::vector<uint8_t> frame = Frame(2U, {});
+
+    ASSERT_EQ(static_cast<ssize_t>(frame.size()), write(peers_[0U], frame.data(), frame.size()));
+    ASSERT_EQ(frame, Receive(peers_[0U], frame.size()));
+
+    /* A frame sent to the closed link's id is dropped rather than written to the link now in its slot */
+    const std::vector<uint8_t> stale = Frame(2U, {0U, 1U});
+    const std::vector<uint8_t> fresh = Frame(2U, {1U, 2U});
+
+    ASSERT_EQ(static_cast<ssize_t>(stale.size()), write(peers_[0U], stale.data(), stale.size()));
+    ASSERT_TRUE(Eventually([&]() {
+        CaveTalk_EngineCounters(&engine_, 0U, &counters);
+        return 1U == counters.dropped;
+    }));
+    ASSERT_EQ(static_cast<ssize_t>(fresh.size()), write(peers_[0U], fresh.data(), fresh.size()));
+    ASSERT_EQ(fresh, Receive(peers_[0U], fresh.size()));
+}
\ No newline at end of file
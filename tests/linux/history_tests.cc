@@ -0,0 +1,211 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_channel.h"
+#include "cave_talk_history.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+static const std::size_t kChunkRows  = 4U;
+static const std::size_t kChunkCount = 3U;
+
+static CaveTalk_Microseconds_t now = 0U;
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return now;
+}
+
+class CaveTalkHistoryTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        now = 1000U;
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryOpen(&history_, nullptr, kChunkRows, kChunkCount, 0U, Clock));
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_HistoryClose(&history_);
+    }
+
+    CaveTalk_History_t history_;
+    std::array<CaveTalk_Microseconds_t, 16U> timestamps_ = {};
+    std::array<double, 16U> first_                       = {};
+    std::array<double, 16U> second_                      = {};
+    std::array<CaveTalk_HistoryWindow_t, 8U> windows_    = {};
+    std::size_t count_                                   = 0U;
+};
+
+TEST_F(CaveTalkHistoryTests, Open)
+{
+    CaveTalk_History_t       history;
+    CaveTalk_ChannelRecord_t record = {};
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HistoryOpen(nullptr, nullptr, kChunkRows, kChunkCount, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HistoryOpen(&history, nullptr, kChunkRows, kChunkCount, 0U, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_HistoryOpen(&history, nullptr, 0U, kChunkCount, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_HistoryOpen(&history, nullptr, kChunkRows, 1U, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_HistoryOpen(&history, "/cave-talk-history-missing/history", kChunkRows, kChunkCount, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HistoryAppend(&history_, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_MOVEMENT, 0U, now, nullptr, nullptr, nullptr, 0U, nullptr));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_HistoryDownsample(&history_, CAVE_TALK_ID_MOVEMENT, 0U, now, 10U, nullptr, 0U, &count_));
+
+    /* Only the messages a history keeps are accepted */
+    record.id = CAVE_TALK_ID_NONE;
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, CaveTalk_HistoryAppend(&history_, &record));
+    ASSERT_EQ(CAVE_TALK_ERROR_ID, CaveTalk_HistoryRows(&history_, CAVE_TALK_ID_NONE, &count_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_HistoryDownsample(&history_, CAVE_TALK_ID_MOVEMENT, 0U, now, 0U, windows_.data(), windows_.size(), &count_));
+
+    /* Timestamps never go backwards within an id */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordMovement(&history_, 1.0, 2.0));
+    now = 900U;
+    ASSERT_EQ(CAVE_TALK_ERROR_PARSE, CaveTalk_HistoryRecordMovement(&history_, 1.0, 2.0));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordMode(&history_, true));
+}
+
+TEST_F(CaveTalkHistoryTests, Range)
+{
+    for (std::size_t index = 0U; index < 10U; index++)
+    {
+        now = 1000U + (10U * index);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordMovement(&history_, static_cast<double>(index), -static_cast<double>(index)));
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordLights(&history_, true));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRows(&history_, CAVE_TALK_ID_MOVEMENT, &count_));
+    ASSERT_EQ(10U, count_);
+
+    /* The range spans all three chunks, begin inclusive and end exclusive */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+              CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_MOVEMENT, 1015U, 1090U, timestamps_.data(), first_.data(), second_.data(), timestamps_.size(), &count_));
+    ASSERT_EQ(7U, count_);
+    ASSERT_EQ(1020U, timestamps_[0U]);
+    ASSERT_EQ(2.0, first_[0U]);
+    ASSERT_EQ(1080U, timestamps_[6U]);
+    ASSERT_EQ(-8.0, second_[6U]);
+
+    /* Columns not asked for are left alone, and a range that does not fit fills what it can */
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_MOVEMENT, 0U, now + 1U, nullptr, first_.data(), nullptr, 5U, &count_));
+    ASSERT_EQ(5U, count_);
+    ASSERT_EQ(4.0, first_[4U]);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_LIGHTS, 0U, now + 1U, nullptr, first_.data(), nullptr, first_.size(), &count_));
+    ASSERT_EQ(1U, count_);
+    ASSERT_EQ(1.0, first_[0U]);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_MOVEMENT, 2000U, 3000U, nullptr, nullptr, nullptr, 0U, &count_));
+    ASSERT_EQ(0U, count_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_MODE, 0U, 3000U, nullptr, nullptr, nullptr, 0U, &count_));
+    ASSERT_EQ(0U, count_);
+}
+
+TEST_F(CaveTalkHistoryTests, Retention)
+{
+    CaveTalk_History_t history;
+
+    /* Three chunks of four rows hold at most twelve, a thirteenth drops the oldest chunk whole */
+    for (std::size_t index = 0U; index < 13U; index++)
+    {
+        now = 1000U + (10U * index);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordCameraMovement(&history_, static_cast<double>(index), 0.5));
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRows(&history_, CAVE_TALK_ID_CAMERA_MOVEMENT, &count_));
+    ASSERT_EQ(9U, count_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+              CaveTalk_HistoryRange(&history_, CAVE_TALK_ID_CAMERA_MOVEMENT, 0U, now + 1U, timestamps_.data(), first_.data(), second_.data(), timestamps_.size(), &count_));
+    ASSERT_EQ(9U, count_);
+    ASSERT_EQ(1040U, timestamps_[0U]);
+    ASSERT_EQ(12.0, first_[8U]);
+
+    /* With a maximum age, chunks whose newest row is older go first even with space to spare */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryOpen(&history, nullptr, kChunkRows, kChunkCount, 50U, Clock));
+
+    for (std::size_t index = 0U; index < 10U; index++)
+    {
+        now = 1000U + (10U * index);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordCameraMovement(&history, static_cast<double>(index), 0.5));
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRows(&history, CAVE_TALK_ID_CAMERA_MOVEMENT, &count_));
+    ASSERT_EQ(6U, count_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryClose(&history));
+}
+
+TEST_F(CaveTalkHistoryTests, Downsample)
+{
+    for (std::size_t index = 0U; index < 10U; index++)
+    {
+        now = 1000U + (10U * index);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordMovement(&history_, static_cast<double>(index), 1.0));
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordMode(&history_, index < 3U));
+    }
+
+    /* Windows of 40 us aligned to begin, the last one only partly filled */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+              CaveTalk_HistoryDownsample(&history_, CAVE_TALK_ID_MOVEMENT, 1000U, 2000U, 40U, windows_.data(), windows_.size(), &count_));
+    ASSERT_EQ(3U, count_);
+    ASSERT_EQ(1000U, windows_[0U].start);
+    ASSERT_EQ(4U, windows_[0U].count);
+    ASSERT_EQ(1.5, windows_[0U].mean[0U]);
+    ASSERT_EQ(0.0, windows_[0U].min[0U]);
+    ASSERT_EQ(3.0, windows_[0U].max[0U]);
+    ASSERT_EQ(1.0, windows_[0U].mean[1U]);
+    ASSERT_EQ(1080U, windows_[2U].start);
+    ASSERT_EQ(2U, windows_[2U].count);
+    ASSERT_EQ(8.5, windows_[2U].mean[0U]);
+
+    /* Windows without rows are left out */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+              CaveTalk_HistoryDownsample(&history_, CAVE_TALK_ID_MOVEMENT, 1000U, 1040U, 5U, windows_.data(), windows_.size(), &count_));
+    ASSERT_EQ(4U, count_);
+    ASSERT_EQ(1010U, windows_[1U].start);
+    ASSERT_EQ(1U, windows_[1U].count);
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE,
+              CaveTalk_HistoryDownsample(&history_, CAVE_TALK_ID_MOVEMENT, 1000U, 2000U, 5U, windows_.data(), 2U, &count_));
+    ASSERT_EQ(2U, count_);
+
+    /* A boolean's mean is the fraction of the window it was set */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+              CaveTalk_HistoryDownsample(&history_, CAVE_TALK_ID_MODE, 1000U, 1040U, 40U, windows_.data(), windows_.size(), &count_));
+    ASSERT_EQ(1U, count_);
+    ASSERT_EQ(0.75, windows_[0U].mean[0U]);
+}
+
+TEST_F(CaveTalkHistoryTests, File)
+{
+    const std::string  path = "/tmp/cave-talk-history-" + std::to_string(getpid());
+    CaveTalk_History_t history;
+
+    unlink(path.c_str());
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryOpen(&history, path.c_str(), kChunkRows, kChunkCount, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRecordMovement(&history, 1.5, -0.5));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryClose(&history));
+
+    /* Opened again with the same chunk sizes the rows are still there */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryOpen(&history, path.c_str(), kChunkRows, kChunkCount, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+              CaveTalk_HistoryRange(&history, CAVE_TALK_ID_MOVEMENT, 0U, now + 1U, timestamps_.data(), first_.data(), second_.data(), timestamps_.size(), &count_));
+    ASSERT_EQ(1U, count_);
+    ASSERT_EQ(1000U, timestamps_[0U]);
+    ASSERT_EQ(-0.5, second_[0U]);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryClose(&history));
+
+    /* With other chunk sizes it starts over */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryOpen(&history, path.c_str(), kChunkRows * 2U, kChunkCount, 0U, Clock));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryRows(&history, CAVE_TALK_ID_MOVEMENT, &count_));
+    ASSERT_EQ(0U, count_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_HistoryClose(&history));
+
+    unlink(path.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_serial.h"
+#include "cave_talk_transmit.h"
+#include "cave_talk_types.h"
+
+static const int kWaitTimeout = 1000;
+
+static CaveTalk_Microseconds_t MonotonicClock(void)
+{
+    return static_cast<CaveTalk_Microseconds_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const std::size_t length, const uint8_t fill)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, static_cast<uint8_t>(length)};
+
+    frame.insert(frame.end(), length, fill);
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+class CaveTalkSerialTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        master_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        ASSERT_LE(0, master_);
+        ASSERT_EQ(0, grantpt(master_));
+        ASSERT_EQ(0, unlockpt(master_));
+        ASSERT_NE(nullptr, ptsname(master_));
+        path_ = ptsname(master_);
+
+        serial_.fd = -1;
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_SerialClose(&serial_);
+        close(master_);
+    }
+
+    void Open(const CaveTalk_SerialConfig_t &config, const std::size_t buffer_size)
+    {
+        ASSERT_GE(buffer_.size(), buffer_size);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SerialOpen(&serial_, path_.c_str(), &config, buffer_.data(), buffer_size, &link_handle_));
+    }
+
+    void Write(const std::vector<uint8_t> &bytes)
+    {
+        ASSERT_EQ(static_cast<ssize_t>(bytes.size()), write(master_, bytes.data(), bytes.size()));
+    }
+
+    /* Pseudo terminal input is delivered asynchronously, wait until the slave has it queued */
+    void WaitQueued(const int queued)
+    {
+        int  bytes    = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kWaitTimeout);
+
+        while ((0 == ioctl(serial_.fd, FIONREAD, &bytes)) && (bytes < queued) && (std::chrono::steady_clock::now() < deadline))
+        {
+            usleep(1000);
+        }
+
+        ASSERT_EQ(queued, bytes);
+    }
+
+    std::vector<uint8_t> ReadMaster(const std::size_t size)
+    {
+        std::vector<uint8_t> bytes(size);
+        std::size_t          offset = 0U;
+        pollfd               poll_fd = {master_, POLLIN, 0};
+
+        while ((offset < size) && (poll(&poll_fd, 1U, kWaitTimeout) > 0))
+        {
+            const ssize_t result = read(master_, bytes.data() + offset, size - offset);
+
+            if (result <= 0)
+            {
+                break;
+            }
+
+            offset += static_cast<std::size_t>(result);
+        }
+
+        bytes.resize(offset);
+
+        return bytes;
+    }
+
+    int master_ = -1;
+    std::string path_;
+    std::array<uint8_t, 4096U> buffer_ = {};
+    CaveTalk_Serial_t serial_ = {};
+    CaveTalk_LinkHandle_t link_handle_ = kCaveTalk_LinkHandleNull;
+};
+
+TEST_F(CaveTalkSerialTests, Open)
+{
+    CaveTalk_SerialConfig_t config = kCaveTalk_SerialConfigDefault;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SerialOpen(nullptr, path_.c_str(), &config, buffer_.data(), buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SerialOpen(&serial_, path_.c_str(), &config, nullptr, buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_SerialOpen(&serial_, path_.c_str(), &config, buffer_.data(), CAVE_TALK_SERIAL_BUFFER_SIZE_MIN - 1U, &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_SerialOpen(&serial_, "/nonexistent/tty", &config, buffer_.data(), buffer_.size(), &link_handle_));
+
+    config.baud_rate = 12345U;
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_SerialOpen(&serial_, path_.c_str(), &config, buffer_.data(), buffer_.size(), &link_handle_));
+
+    /* Raw mode while open, the original attributes are restored on close */
+    int            slave = open(path_.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    struct termios attributes;
+    ASSERT_LE(0, slave);
+    ASSERT_EQ(0, tcgetattr(slave, &attributes));
+    ASSERT_NE(0U, attributes.c_lflag & ICANON);
+
+    Open(kCaveTalk_SerialConfigDefault, buffer_.size());
+    ASSERT_EQ(0, tcgetattr(slave, &attributes));
+    ASSERT_EQ(0U, attributes.c_lflag & ICANON);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SerialClose(&serial_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SerialClose(&serial_));
+    ASSERT_EQ(0, tcgetattr(slave, &attributes));
+    ASSERT_NE(0U, attributes.c_lflag & ICANON);
+
+    close(slave);
+}
+
+TEST_F(CaveTalkSerialTests, SpeakCoalesced)
+{
+    const std::array<uint8_t, 20U> payload = {};
+    const std::vector<uint8_t>     frame   = Frame(7U, payload.size(), 0U);
+
+    Open(kCaveTalk_SerialConfigDefault, buffer_.size());
+
+    for (std::size_t index = 0U; index < 3U; index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 7U, payload.data(), payload.size()));
+        ASSERT_THAT(ReadMaster(frame.size()), ::testing::ElementsAreArray(frame));
+    }
+
+    /* One write per frame although Speak sends header, payload and CRC separately */
+    ASSERT_EQ(3U, serial_.stats.writes);
+    ASSERT_EQ(3U * frame.size(), serial_.stats.bytes_written);
+
+    /* Bytes that do not complete a frame are held until flushed */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, link_handle_.send(frame.data(), 2U));
+    ASSERT_EQ(3U, serial_.stats.writes);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_SerialFlush(&serial_));
+    ASSERT_EQ(4U, serial_.stats.writes);
+    ASSERT_THAT(ReadMaster(2U), ::testing::ElementsAre(frame[0], frame[1]));
+}
+
+TEST_F(CaveTalkSerialTests, ListenBurst)
+{
+    const std::size_t        kFrames = 10U;
+    std::vector<uint8_t>     burst;
+    std::array<uint8_t, 255> data   = {};
+    CaveTalk_Id_t            id     = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t        length = 0U;
+
+    Open(kCaveTalk_SerialConfigDefault, buffer_.size());
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        const std::vector<uint8_t> frame = Frame(static_cast<CaveTalk_Id_t>(index + 1U), 20U, static_cast<uint8_t>(index));
+        burst.insert(burst.end(), frame.begin(), frame.end());
+    }
+
+    Write(burst);
+    WaitQueued(static_cast<int>(burst.size()));
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id, data.data(), data.size(), &length));
+        ASSERT_EQ(index + 1U, id);
+        ASSERT_EQ(20U, length);
+        ASSERT_EQ(index, data[19U]);
+    }
+
+    /* The whole burst is taken in with a single read and every receive is served from memory */
+    ASSERT_EQ(1U, serial_.stats.reads);
+    ASSERT_EQ(burst.size(), serial_.stats.bytes_read);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id, data.data(), data.size(), &length));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id);
+}
+
+TEST_F(CaveTalkSerialTests, ListenPartialFrame)
+{
+    const std::vector<uint8_t> frame  = Frame(3U, 40U, 0xA5U);
+    std::array<uint8_t, 255>   data   = {};
+    CaveTalk_Id_t              id     = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t          length = 0U;
+
+    Open(kCaveTalk_SerialConfigDefault, buffer_.size());
+
+    Write(std::vector<uint8_t>(frame.begin(), frame.begin() + 10));
+    WaitQueued(10);
+
+    /* Half a frame is kept buffered rather than handed to Listen */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id, data.data(), data.size(), &length));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id);
+
+    Write(std::vector<uint8_t>(frame.begin() + 10, frame.end()));
+    WaitQueued(static_cast<int>(frame.size()) - 10);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id, data.data(), data.size(), &length));
+    ASSERT_EQ(3U, id);
+    ASSERT_EQ(40U, length);
+    ASSERT_EQ(0xA5U, data[39U]);
+}
+
+TEST_F(CaveTalkSerialTests, ListenAcrossBuffers)
+{
+    const std::size_t        kFrames = 12U;
+    std::size_t              heard   = 0U;
+    std::array<uint8_t, 255> data    = {};
+    CaveTalk_Id_t            id      = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t        length  = 0U;
+
+    /* Frames of 107 bytes in 262 byte halves straddle the halves at varying offsets */
+    Open(kCaveTalk_SerialConfigDefault, CAVE_TALK_SERIAL_BUFFER_SIZE_MIN);
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        Write(Frame(static_cast<CaveTalk_Id_t>(index + 1U), 100U, static_cast<uint8_t>(index)));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kWaitTimeout);
+
+    while ((heard < kFrames) && (std::chrono::steady_clock::now() < deadline))
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id, data.data(), data.size(), &length));
+
+        if (CAVE_TALK_ID_NONE != id)
+        {
+            ASSERT_EQ(heard + 1U, id);
+            ASSERT_EQ(100U, length);
+            ASSERT_EQ(heard, data[0U]);
+            ASSERT_EQ(heard, data[99U]);
+            heard++;
+        }
+    }
+
+    ASSERT_EQ(kFrames, heard);
+}
+
+TEST_F(CaveTalkSerialTests, ListenUntil)
+{
+    const std::size_t        kFrames = 3U;
+    std::vector<uint8_t>     burst;
+    std::array<uint8_t, 255> data   = {};
+    CaveTalk_Id_t            id     = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t        length = 0U;
+    CaveTalk_ListenState_t   state;
+
+    Open(kCaveTalk_SerialConfigDefault, buffer_.size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenStateInit(&state, MonotonicClock, CaveTalk_SerialWait, &serial_));
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        const std::vector<uint8_t> frame = Frame(static_cast<CaveTalk_Id_t>(index + 1U), 20U, static_cast<uint8_t>(index));
+        burst.insert(burst.end(), frame.begin(), frame.end());
+    }
+
+    Write(burst);
+    WaitQueued(static_cast<int>(burst.size()));
+
+    /* Once the header is taken the rest of the frame is reported as available, so no frame waits for the deadline */
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        const CaveTalk_Microseconds_t begin = MonotonicClock();
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&link_handle_, &state, 50000U, &id, data.data(), data.size(), &length));
+        ASSERT_EQ(index + 1U, id);
+        ASSERT_EQ(20U, length);
+        ASSERT_EQ(index, data[19U]);
+        ASSERT_LT(MonotonicClock() - begin, 50000U);
+    }
+
+    ASSERT_EQ(0U, state.expired);
+
+    /* Half a frame stays buffered in the link, the listen that gives up on it has taken nothing */
+    const std::vector<uint8_t> frame = Frame(4U, 40U, 0xA5U);
+
+    Write(std::vector<uint8_t>(frame.begin(), frame.begin() + CAVE_TALK_HEADER_SIZE));
+    WaitQueued(CAVE_TALK_HEADER_SIZE);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&link_handle_, &state, 1000U, &id, data.data(), data.size(), &length));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id);
+    ASSERT_EQ(0U, state.expired);
+
+    Write(std::vector<uint8_t>(frame.begin() + CAVE_TALK_HEADER_SIZE, frame.end()));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&link_handle_, &state, 1000000U, &id, data.data(), data.size(), &length));
+    ASSERT_EQ(4U, id);
+    ASSERT_EQ(40U, length);
+    ASSERT_EQ(0xA5U, data[39U]);
+}
+
+TEST_F(CaveTalkSerialTests, ReadTimeout)
+{
+    CaveTalk_SerialConfig_t  config = kCaveTalk_SerialConfigDefault;
+    std::array<uint8_t, 255> data   = {};
+    CaveTalk_Id_t            id     = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t        length = 0U;
+
+    /* Wait up to 100 ms for the first byte */
+    config.vmin  = 0U;
+    config.vtime = 1U;
+    Open(config, buffer_.size());
+
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id, data.data(), data.size(), &length));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id);
+    ASSERT_LE(std::chrono::milliseconds(50), std::chrono::steady_clock::now() - start);
+    ASSERT_EQ(1U, serial_.stats.reads);
+}
+
+TEST_F(CaveTalkSerialTests, TryWrite)
+{
+    const std::array<uint8_t, UINT8_MAX> payload = {};
+    const std::vector<uint8_t>           frame   = Frame(7U, payload.size(), 0U);
+    CaveTalk_Transmitter_t               transmitter;
+    CaveTalk_LinkHandle_t                link_handle;
+    std::size_t                          frames  = 0U;
+    std::size_t                          read    = 0U;
+    bool                                 intact  = true;
+
+    Open(kCaveTalk_SerialConfigDefault, buffer_.size());
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterOpen(&transmitter, CaveTalk_SerialTryWrite, &serial_, &link_handle));
+
+    /* Nobody reads the other end, so the device fills up and speaking stops short of blocking */
+    while ((frames < 10000U) && (CAVE_TALK_ERROR_NONE == CaveTalk_Speak(&link_handle, 7U, payload.data(), payload.size())))
+    {
+        frames++;
+    }
+
+    ASSERT_EQ(CAVE_TALK_ERROR_BUSY, CaveTalk_Speak(&link_handle, 7U, payload.data(), payload.size()));
+    ASSERT_LT(0U, CaveTalk_TransmitterPending(&transmitter));
+
+    /* Draining the other end lets the pending frame finish, and every frame arrives whole */
+    while (read < (frames * frame.size()))
+    {
+        const std::vector<uint8_t> bytes = ReadMaster(frame.size());
+
+        ASSERT_FALSE(bytes.empty());
+
+        for (const uint8_t byte : bytes)
+        {
+            intact = intact && (frame[read % frame.size()] == byte);
+            read++;
+        }
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterResume(&transmitter));
+    }
+
+    ASSERT_TRUE(intact);
+    ASSERT_EQ(0U, CaveTalk_TransmitterPending(&transmitter));
+    ASSERT_EQ(frames, transmitter.stats.frames);
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_SerialTryWrite(nullptr, payload.data(), payload.size(), &read));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_TransmitterClose(&transmitter));
+}
\ No newline at end of file
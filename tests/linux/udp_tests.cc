@@ -0,0 +1,242 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_types.h"
+#include "cave_talk_udp.h"
+
+static const int kWaitTimeout = 1000;
+
+static CaveTalk_Microseconds_t MonotonicClock(void)
+{
+    return static_cast<CaveTalk_Microseconds_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static sockaddr_in Loopback(const uint16_t port)
+{
+    sockaddr_in address = {};
+
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    return address;
+}
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const std::size_t length, const uint8_t fill)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, static_cast<uint8_t>(length)};
+
+    frame.insert(frame.end(), length, fill);
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+class CaveTalkUdpTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        base_.fd  = -1;
+        rover_.fd = -1;
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_UdpClose(&base_);
+        CaveTalk_UdpClose(&rover_);
+    }
+
+    /* The base station binds an ephemeral port and answers whoever it hears, the rover sends to the base station */
+    void Open(const std::size_t base_batch, const std::size_t rover_batch)
+    {
+        sockaddr_in any  = Loopback(0U);
+        sockaddr_in base = {};
+        socklen_t   size = sizeof(base);
+
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+                  CaveTalk_UdpOpen(&base_, reinterpret_cast<sockaddr *>(&any), sizeof(any), nullptr, 0U, base_batch, &base_link_));
+        ASSERT_EQ(0, getsockname(base_.fd, reinterpret_cast<sockaddr *>(&base), &size));
+        base_address_ = base;
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE,
+                  CaveTalk_UdpOpen(&rover_, reinterpret_cast<sockaddr *>(&any), sizeof(any), reinterpret_cast<sockaddr *>(&base), size, rover_batch, &rover_link_));
+    }
+
+    static void WaitReadable(const int fd)
+    {
+        pollfd poll_fd = {fd, POLLIN, 0};
+
+        ASSERT_EQ(1, poll(&poll_fd, 1U, kWaitTimeout));
+    }
+
+    CaveTalk_Udp_t base_ = {};
+    CaveTalk_Udp_t rover_ = {};
+    sockaddr_in base_address_ = {};
+    CaveTalk_LinkHandle_t base_link_ = kCaveTalk_LinkHandleNull;
+    CaveTalk_LinkHandle_t rover_link_ = kCaveTalk_LinkHandleNull;
+    std::array<uint8_t, 255> data_ = {};
+    CaveTalk_Id_t id_ = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t length_ = 0U;
+};
+
+TEST_F(CaveTalkUdpTests, Open)
+{
+    sockaddr_in any = Loopback(0U);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UdpOpen(nullptr, reinterpret_cast<sockaddr *>(&any), sizeof(any), nullptr, 0U, 1U, &base_link_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UdpOpen(&base_, nullptr, sizeof(any), nullptr, 0U, 1U, &base_link_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_UdpOpen(&base_, reinterpret_cast<sockaddr *>(&any), sizeof(any), nullptr, 0U, 0U, &base_link_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE,
+              CaveTalk_UdpOpen(&base_, reinterpret_cast<sockaddr *>(&any), sizeof(any), nullptr, 0U, CAVE_TALK_UDP_BATCH_SIZE_MAX + 1U, &base_link_));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_UdpOpen(&base_, reinterpret_cast<sockaddr *>(&any), sizeof(any), nullptr, 0U, 1U, &base_link_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_UdpClose(&base_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UdpClose(&base_));
+}
+
+TEST_F(CaveTalkUdpTests, SpeakListen)
+{
+    const std::array<uint8_t, 20U> payload = {1U, 2U, 3U};
+
+    Open(1U, 1U);
+
+    /* Nothing to answer until the rover has been heard */
+    ASSERT_EQ(CAVE_TALK_ERROR_SOCKET_CLOSED, CaveTalk_Speak(&base_link_, 5U, payload.data(), payload.size()));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&rover_link_, 4U, payload.data(), payload.size()));
+    ASSERT_EQ(1U, rover_.stats.send_calls);
+    ASSERT_EQ(1U, rover_.stats.datagrams_sent);
+
+    WaitReadable(base_.fd);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(4U, id_);
+    ASSERT_EQ(payload.size(), length_);
+    ASSERT_THAT(std::vector<uint8_t>(data_.begin(), data_.begin() + length_), ::testing::ElementsAreArray(payload));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+
+    /* Answered to the address the rover was heard from */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&base_link_, 5U, payload.data(), payload.size()));
+    WaitReadable(rover_.fd);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&rover_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(5U, id_);
+    ASSERT_EQ(payload.size(), length_);
+}
+
+TEST_F(CaveTalkUdpTests, Batched)
+{
+    const std::size_t              kBatch  = 8U;
+    const std::array<uint8_t, 10U> payload = {};
+
+    Open(1U, kBatch);
+
+    for (std::size_t index = 0U; index < kBatch; index++)
+    {
+        ASSERT_EQ(0U, rover_.stats.send_calls);
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&rover_link_, static_cast<CaveTalk_Id_t>(index + 1U), payload.data(), payload.size()));
+    }
+
+    /* One sendmmsg for the whole batch, and one recvmmsg takes it in */
+    ASSERT_EQ(1U, rover_.stats.send_calls);
+    ASSERT_EQ(kBatch, rover_.stats.datagrams_sent);
+
+    WaitReadable(base_.fd);
+
+    for (std::size_t index = 0U; index < kBatch; index++)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+        ASSERT_EQ(index + 1U, id_);
+    }
+
+    ASSERT_EQ(1U, base_.stats.receive_calls);
+    ASSERT_EQ(kBatch, base_.stats.datagrams_received);
+
+    /* Frames short of a batch wait for a flush */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&rover_link_, 1U, payload.data(), payload.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&rover_link_, 2U, payload.data(), payload.size()));
+    ASSERT_EQ(1U, rover_.stats.send_calls);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_UdpFlush(&rover_));
+    ASSERT_EQ(2U, rover_.stats.send_calls);
+    ASSERT_EQ(kBatch + 2U, rover_.stats.datagrams_sent);
+}
+
+TEST_F(CaveTalkUdpTests, LossIsolation)
+{
+    const int                  sender    = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    const std::vector<uint8_t> truncated = Frame(1U, 20U, 0x11U);
+    const std::vector<uint8_t> first     = Frame(2U, 8U, 0x22U);
+    const std::vector<uint8_t> second    = Frame(3U, 4U, 0x33U);
+    std::vector<uint8_t>       pair      = first;
+
+    Open(1U, 1U);
+    ASSERT_LE(0, sender);
+    pair.insert(pair.end(), second.begin(), second.end());
+
+    /* A datagram cut short is dropped on its own and does not disturb the framing of the next */
+    auto send = [&](const std::vector<uint8_t> &datagram, const std::size_t size) {
+        ASSERT_EQ(static_cast<ssize_t>(size),
+                  sendto(sender, datagram.data(), size, 0, reinterpret_cast<const sockaddr *>(&base_address_), sizeof(base_address_)));
+    };
+    send(truncated, truncated.size() - 6U);
+    send(pair, pair.size());
+    send(first, first.size());
+
+    WaitReadable(base_.fd);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(0x22U, data_[7U]);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(3U, id_);
+    ASSERT_EQ(0x33U, data_[3U]);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&base_link_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+
+    ASSERT_EQ(3U, base_.stats.datagrams_received);
+    ASSERT_EQ(1U, base_.stats.datagrams_dropped);
+
+    close(sender);
+}
+
+TEST_F(CaveTalkUdpTests, ListenUntil)
+{
+    const std::array<uint8_t, 8U> payload = {};
+    CaveTalk_ListenState_t        state;
+
+    Open(1U, 1U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenStateInit(&state, MonotonicClock, CaveTalk_UdpWait, &base_));
+
+    /* With nothing to hear the listen sleeps on the socket until its deadline */
+    CaveTalk_Microseconds_t begin = MonotonicClock();
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&base_link_, &state, 20000U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_GE(MonotonicClock() - begin, 20000U);
+
+    /* A datagram wakes it well before the deadline */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&rover_link_, 4U, payload.data(), payload.size()));
+    begin = MonotonicClock();
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_ListenFor(&base_link_, &state, 5000000U, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(4U, id_);
+    ASSERT_LT(MonotonicClock() - begin, 5000000U);
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UdpWait(nullptr, 0U));
+}
\ No newline at end of file
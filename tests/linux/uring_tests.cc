@@ -0,0 +1,264 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "cave_talk_link.h"
+#include "cave_talk_listen.h"
+#include "cave_talk_types.h"
+#include "cave_talk_uring.h"
+
+static const int kWaitTimeout = 1000;
+
+static std::vector<uint8_t> Frame(const CaveTalk_Id_t id, const std::size_t length, const uint8_t fill)
+{
+    std::vector<uint8_t> frame = {CAVE_TALK_VERSION, id, static_cast<uint8_t>(length)};
+
+    frame.insert(frame.end(), length, fill);
+    frame.insert(frame.end(), CAVE_TALK_CRC_SIZE, 0U);
+
+    return frame;
+}
+
+static CaveTalk_Microseconds_t Clock(void)
+{
+    return static_cast<CaveTalk_Microseconds_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+class CaveTalkUringTests : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::array<int, 2U> fds = {-1, -1};
+
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()));
+        fd_            = fds[0U];
+        peer_          = fds[1U];
+        uring_.ring_fd = -1;
+    }
+
+    void TearDown() override
+    {
+        CaveTalk_UringClose(&uring_);
+        close(fd_);
+        close(peer_);
+    }
+
+    void Open(const std::size_t batch)
+    {
+        ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_UringOpen(&uring_, fd_, batch, buffer_.data(), buffer_.size(), &link_handle_));
+    }
+
+    void Write(const std::vector<uint8_t> &bytes)
+    {
+        ASSERT_EQ(static_cast<ssize_t>(bytes.size()), write(peer_, bytes.data(), bytes.size()));
+    }
+
+    /* Listens until a frame arrives or the budget runs out */
+    CaveTalk_Error_t Listen(const CaveTalk_Microseconds_t budget = kWaitTimeout * 1000U)
+    {
+        CaveTalk_ListenState_t state;
+
+        CaveTalk_ListenStateInit(&state, Clock, CaveTalk_UringWait, &uring_);
+
+        return CaveTalk_ListenFor(&link_handle_, &state, budget, &id_, data_.data(), data_.size(), &length_);
+    }
+
+    std::vector<uint8_t> ReadPeer(const std::size_t size, const int timeout)
+    {
+        std::vector<uint8_t> bytes(size);
+        std::size_t          offset  = 0U;
+        pollfd               poll_fd = {peer_, POLLIN, 0};
+
+        while ((offset < size) && (poll(&poll_fd, 1U, timeout) > 0))
+        {
+            const ssize_t result = read(peer_, bytes.data() + offset, size - offset);
+
+            if (result <= 0)
+            {
+                break;
+            }
+
+            offset += static_cast<std::size_t>(result);
+        }
+
+        bytes.resize(offset);
+
+        return bytes;
+    }
+
+    int fd_   = -1;
+    int peer_ = -1;
+    std::array<uint8_t, CAVE_TALK_URING_BUFFER_SIZE_MIN> buffer_ = {};
+    CaveTalk_Uring_t uring_                                       = {};
+    CaveTalk_LinkHandle_t link_handle_                            = kCaveTalk_LinkHandleNull;
+    std::array<uint8_t, UINT8_MAX> data_                          = {};
+    CaveTalk_Id_t id_                                             = CAVE_TALK_ID_NONE;
+    CaveTalk_Length_t length_                                     = 0U;
+};
+
+TEST_F(CaveTalkUringTests, Open)
+{
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UringOpen(nullptr, fd_, 1U, buffer_.data(), buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UringOpen(&uring_, fd_, 1U, nullptr, buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_UringOpen(&uring_, fd_, 1U, buffer_.data(), CAVE_TALK_URING_BUFFER_SIZE_MIN - 1U, &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_UringOpen(&uring_, fd_, 0U, buffer_.data(), buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_SIZE, CaveTalk_UringOpen(&uring_, fd_, CAVE_TALK_URING_BATCH_SIZE_MAX + 1U, buffer_.data(), buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_IO, CaveTalk_UringOpen(&uring_, -1, 1U, buffer_.data(), buffer_.size(), &link_handle_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UringFlush(&uring_));
+    ASSERT_EQ(CAVE_TALK_ERROR_NULL, CaveTalk_UringClose(&uring_));
+}
+
+TEST_F(CaveTalkUringTests, Listen)
+{
+    const std::vector<uint8_t> first  = Frame(2U, 10U, 0xAAU);
+    const std::vector<uint8_t> second = Frame(3U, 255U, 0x55U);
+
+    Open(1U);
+
+    /* Nothing has arrived, listening returns at once without a system call */
+    const uint64_t enters = uring_.stats.enters;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Listen(&link_handle_, &id_, data_.data(), data_.size(), &length_));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+    ASSERT_EQ(enters, uring_.stats.enters);
+
+    /* The second frame spans several provided buffers, the first is cut off mid payload */
+    Write(std::vector<uint8_t>(first.begin(), first.begin() + 5));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Listen(20000U));
+    ASSERT_EQ(CAVE_TALK_ID_NONE, id_);
+
+    std::vector<uint8_t> rest(first.begin() + 5, first.end());
+
+    rest.insert(rest.end(), second.begin(), second.end());
+    Write(rest);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Listen());
+    ASSERT_EQ(2U, id_);
+    ASSERT_EQ(10U, length_);
+    ASSERT_EQ(0xAAU, data_[9U]);
+
+    while ((CAVE_TALK_ERROR_NONE == Listen()) && (CAVE_TALK_ID_NONE == id_))
+    {
+    }
+
+    ASSERT_EQ(3U, id_);
+    ASSERT_EQ(255U, length_);
+    ASSERT_EQ(0x55U, data_[254U]);
+    ASSERT_EQ(first.size() + second.size(), uring_.stats.bytes_read);
+
+    /* Once the peer hangs up and every frame is heard the link reports it closed */
+    close(peer_);
+    peer_ = -1;
+    ASSERT_EQ(CAVE_TALK_ERROR_SOCKET_CLOSED, Listen());
+}
+
+TEST_F(CaveTalkUringTests, Overrun)
+{
+    const std::vector<uint8_t> frame   = Frame(2U, 100U, 0x11U);
+    const std::size_t          kFrames = 40U;
+
+    Open(1U);
+
+    /* More arrives than the provided buffers hold, the receive is rearmed as they are parsed and nothing is lost */
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        Write(frame);
+    }
+
+    for (std::size_t index = 0U; index < kFrames; index++)
+    {
+        do
+        {
+            ASSERT_EQ(CAVE_TALK_ERROR_NONE, Listen());
+        } while (CAVE_TALK_ID_NONE == id_);
+
+        ASSERT_EQ(100U, length_);
+    }
+
+    ASSERT_EQ(kFrames * frame.size(), uring_.stats.bytes_read);
+}
+
+TEST_F(CaveTalkUringTests, Batch)
+{
+    const std::array<uint8_t, 4U> payload = {1U, 2U, 3U, 4U};
+    const std::vector<uint8_t>    frame   = {CAVE_TALK_VERSION, 2U, 4U, 1U, 2U, 3U, 4U, 0U, 0U, 0U, 0U};
+
+    Open(3U);
+
+    /* Frames are held until the batch is full and then go out in one send */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, payload.data(), payload.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, payload.data(), payload.size()));
+    ASSERT_TRUE(ReadPeer(1U, 10).empty());
+
+    const uint64_t submissions = uring_.stats.submissions;
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, payload.data(), payload.size()));
+    ASSERT_EQ(submissions + 1U, uring_.stats.submissions);
+
+    std::vector<uint8_t> expected;
+
+    for (std::size_t index = 0U; index < 3U; index++)
+    {
+        expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+
+    ASSERT_EQ(expected, ReadPeer(expected.size(), kWaitTimeout));
+
+    /* Flush sends a short batch, close sends whatever is left */
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, payload.data(), payload.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_UringFlush(&uring_));
+    ASSERT_EQ(frame, ReadPeer(frame.size(), kWaitTimeout));
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 2U, payload.data(), payload.size()));
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_UringClose(&uring_));
+    ASSERT_EQ(frame, ReadPeer(frame.size(), kWaitTimeout));
+    ASSERT_EQ(5U * frame.size(), uring_.stats.bytes_written);
+}
+
+TEST_F(CaveTalkUringTests, Serial)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+    ASSERT_LE(0, master);
+    ASSERT_EQ(0, grantpt(master));
+    ASSERT_EQ(0, unlockpt(master));
+
+    const int      slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    struct termios attributes;
+
+    ASSERT_LE(0, slave);
+    ASSERT_EQ(0, tcgetattr(slave, &attributes));
+    cfmakeraw(&attributes);
+    ASSERT_EQ(0, tcsetattr(slave, TCSANOW, &attributes));
+
+    /* Serial devices are read with a multishot read instead of a receive and written with plain writes */
+    close(fd_);
+    close(peer_);
+    fd_   = slave;
+    peer_ = master;
+    Open(1U);
+
+    const std::vector<uint8_t> frame = Frame(4U, 3U, 0x77U);
+
+    Write(frame);
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, Listen());
+    ASSERT_EQ(4U, id_);
+    ASSERT_EQ(0x77U, data_[2U]);
+
+    ASSERT_EQ(CAVE_TALK_ERROR_NONE, CaveTalk_Speak(&link_handle_, 4U, data_.data(), length_));
+    ASSERT_EQ(frame, ReadPeer(frame.size(), kWaitTimeout));
+}
\ No newline at end of file
@@ -0,0 +1,882 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ids.pb.h"
+
+#include "cave_talk_capture.h"
+#include "cave_talk_frame_parser.h"
+#include "cave_talk_link.h"
+#include "cave_talk_types.h"
+
+/* Offline analyzer for CAVeTalk byte streams. The input is either a capture file (see docs/capture.md) or a raw dump
+ * of link bytes, and is memory-mapped so captures larger than RAM stream through the page cache.
+ *
+ * The input is split into chunks that are parsed in parallel. A worker cannot know whether its chunk starts on a frame
+ * boundary, so it parses speculatively and keeps its first events in a window. Parsing carries on past the end of the
+ * chunk into a tail. While merging in order, the previous chunk's tail (which is known to be correct) is matched
+ * against the next chunk's window: the first frame ending at the same position in both is a point where both parsers
+ * are empty, so everything the next worker saw after that point is correct. If no such point exists the chunk is
+ * parsed again from the last known frame boundary. */
+
+namespace
+{
+
+constexpr std::size_t kWindowEvents      = 256U;
+constexpr std::size_t kErrorSamples      = 16U;
+constexpr std::size_t kRawPieceSize      = 65536U;
+constexpr std::size_t kMinRawChunkSize   = 1048576U;
+constexpr std::size_t kMinCaptureBlocks  = 16U;
+constexpr std::size_t kChunksPerThread   = 4U;
+constexpr std::size_t kHistogramLinear   = 64U;
+constexpr std::size_t kHistogramSubBits  = 5U;
+constexpr std::size_t kHistogramBuckets  = kHistogramLinear + ((64U - 6U) << kHistogramSubBits);
+constexpr std::size_t kIdCount           = 256U;
+constexpr double      kMicrosecondsPerSecond = 1000000.0;
+
+struct Options
+{
+    std::string                 path;
+    bool                        raw       = false;
+    CaveTalk_CaptureDirection_t direction = CAVE_TALK_CAPTURE_DIRECTION_RX;
+    std::size_t                 threads   = 0U;
+    CaveTalk_Microseconds_t     interval  = 1000000U;
+    bool                        rates     = false;
+    bool                        sizes     = false;
+};
+
+struct Event
+{
+    uint64_t                end;
+    CaveTalk_Microseconds_t timestamp;
+    CaveTalk_Error_t        error;
+    CaveTalk_Id_t           id;
+    CaveTalk_Length_t       length;
+};
+
+/* Log-linear histogram, exact below 64 and within 1/32 of the value above */
+class Histogram
+{
+    public:
+        void Record(const uint64_t value)
+        {
+            buckets_[Bucket(value)]++;
+            count_++;
+        }
+
+        void Merge(const Histogram &other)
+        {
+            for (std::size_t index = 0U; index < kHistogramBuckets; index++)
+            {
+                buckets_[index] += other.buckets_[index];
+            }
+            count_ += other.count_;
+        }
+
+        uint64_t Count(void) const
+        {
+            return count_;
+        }
+
+        uint64_t Percentile(const double percentile) const
+        {
+            const uint64_t rank  = static_cast<uint64_t>(percentile * static_cast<double>(count_ - 1U) / 100.0);
+            uint64_t       seen  = 0U;
+            uint64_t       value = 0U;
+
+            for (std::size_t index = 0U; index < kHistogramBuckets; index++)
+            {
+                seen += buckets_[index];
+                if (seen > rank)
+                {
+                    value = Value(index);
+                    break;
+                }
+            }
+
+            return value;
+        }
+
+    private:
+        static std::size_t Bucket(const uint64_t value)
+        {
+            std::size_t bucket = static_cast<std::size_t>(value);
+
+            if (value >= kHistogramLinear)
+            {
+                const std::size_t exponent = 63U - static_cast<std::size_t>(__builtin_clzll(value));
+                const std::size_t mantissa = static_cast<std::size_t>(value >> (exponent - kHistogramSubBits)) & ((1U << kHistogramSubBits) - 1U);
+
+                bucket = kHistogramLinear + ((exponent - 6U) << kHistogramSubBits) + mantissa;
+            }
+
+            return bucket;
+        }
+
+        static uint64_t Value(const std::size_t bucket)
+        {
+            uint64_t value = bucket;
+
+            if (bucket >= kHistogramLinear)
+            {
+                const std::size_t exponent = ((bucket - kHistogramLinear) >> kHistogramSubBits) + 6U;
+                const uint64_t    mantissa = (bucket - kHistogramLinear) & ((1U << kHistogramSubBits) - 1U);
+
+                value = (1ULL << exponent) | (mantissa << (exponent - kHistogramSubBits));
+            }
+
+            return value;
+        }
+
+        std::vector<uint64_t> buckets_ = std::vector<uint64_t>(kHistogramBuckets, 0U);
+        uint64_t              count_   = 0U;
+};
+
+struct IdStats
+{
+    uint64_t                                frames = 0U;
+    uint64_t                                bytes  = 0U;
+    std::array<uint64_t, kIdCount>          sizes  = {};
+    Histogram                               inter_arrival;
+    CaveTalk_Microseconds_t                 first = 0U;
+    CaveTalk_Microseconds_t                 last  = 0U;
+};
+
+/* Statistics of a contiguous run of events, mergeable with the run that follows it */
+class Stats
+{
+    public:
+        explicit Stats(const Options &options) : options_(&options)
+        {
+        }
+
+        void Apply(const Event &event)
+        {
+            if (CAVE_TALK_ERROR_NONE == event.error)
+            {
+                IdStats &id_stats = ids_[event.id];
+
+                if ((0U != id_stats.frames) && (event.timestamp >= id_stats.last))
+                {
+                    id_stats.inter_arrival.Record(event.timestamp - id_stats.last);
+                }
+                if (0U == id_stats.frames)
+                {
+                    id_stats.first = event.timestamp;
+                }
+
+                id_stats.frames++;
+                id_stats.bytes += event.length;
+                id_stats.sizes[event.length]++;
+                id_stats.last = event.timestamp;
+                frames_++;
+
+                if (options_->rates)
+                {
+                    rates_[std::make_pair(event.timestamp / options_->interval, event.id)]++;
+                }
+            }
+            else
+            {
+                errors_[event.error]++;
+                if (error_samples_.size() < kErrorSamples)
+                {
+                    error_samples_.push_back(event);
+                }
+            }
+
+            if (0U == events_)
+            {
+                first_timestamp_ = event.timestamp;
+            }
+            last_timestamp_ = event.timestamp;
+            events_++;
+        }
+
+        void Merge(const Stats &other)
+        {
+            if (0U == events_)
+            {
+                first_timestamp_ = other.first_timestamp_;
+            }
+            if (0U != other.events_)
+            {
+                last_timestamp_ = other.last_timestamp_;
+            }
+
+            for (const auto &[id, other_stats] : other.ids_)
+            {
+                IdStats &id_stats = ids_[id];
+
+                if ((0U != id_stats.frames) && (other_stats.first >= id_stats.last))
+                {
+                    id_stats.inter_arrival.Record(other_stats.first - id_stats.last);
+                }
+                if (0U == id_stats.frames)
+                {
+                    id_stats.first = other_stats.first;
+                }
+
+                id_stats.frames += other_stats.frames;
+                id_stats.bytes  += other_stats.bytes;
+                for (std::size_t size = 0U; size < kIdCount; size++)
+                {
+                    id_stats.sizes[size] += other_stats.sizes[size];
+                }
+                id_stats.inter_arrival.Merge(other_stats.inter_arrival);
+                id_stats.last = other_stats.last;
+            }
+
+            for (const auto &[error, count] : other.errors_)
+            {
+                errors_[error] += count;
+            }
+            for (const Event &event : other.error_samples_)
+            {
+                if (error_samples_.size() < kErrorSamples)
+                {
+                    error_samples_.push_back(event);
+                }
+            }
+            for (const auto &[key, count] : other.rates_)
+            {
+                rates_[key] += count;
+            }
+
+            frames_ += other.frames_;
+            events_ += other.events_;
+        }
+
+        uint64_t ErrorCount(void) const
+        {
+            uint64_t count = 0U;
+
+            for (const auto &[error, error_count] : errors_)
+            {
+                count += error_count;
+            }
+
+            return count;
+        }
+
+        void Report(const bool timed, const uint64_t trailing_bytes) const;
+
+    private:
+        const Options                                                   *options_;
+        std::map<CaveTalk_Id_t, IdStats>                                 ids_;
+        std::map<CaveTalk_Error_t, uint64_t>                             errors_;
+        std::vector<Event>                                               error_samples_;
+        std::map<std::pair<CaveTalk_Microseconds_t, CaveTalk_Id_t>, uint64_t> rates_;
+        uint64_t                                                         frames_          = 0U;
+        uint64_t                                                         events_          = 0U;
+        CaveTalk_Microseconds_t                                          first_timestamp_ = 0U;
+        CaveTalk_Microseconds_t                                          last_timestamp_  = 0U;
+};
+
+/* Result of parsing one chunk, see the comment at the top of the file */
+struct Scan
+{
+    explicit Scan(const Options &options) : stats(options)
+    {
+    }
+
+    std::vector<Event> window;
+    Stats              stats;
+    std::vector<Event> tail;
+    std::size_t        pending = 0U;
+};
+
+struct Chunk
+{
+    uint64_t begin;
+    uint64_t end;
+};
+
+/* Memory-mapped input, yielding pieces of stream bytes with their position and timestamp */
+class Input
+{
+    public:
+        using Piece = std::function<bool (const uint8_t *data, std::size_t size, uint64_t position, CaveTalk_Microseconds_t timestamp)>;
+
+        ~Input()
+        {
+            if (timed_)
+            {
+                CaveTalk_CaptureReaderClose(&reader_);
+            }
+            else if (nullptr != map_)
+            {
+                munmap(const_cast<uint8_t *>(map_), size_);
+            }
+        }
+
+        bool Open(const Options &options)
+        {
+            bool        opened = false;
+            const int   fd     = open(options.path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat status;
+            char        magic[8] = {0};
+
+            if ((fd >= 0) && (0 == fstat(fd, &status)))
+            {
+                const bool capture = !options.raw && (static_cast<ssize_t>(sizeof(magic)) == pread(fd, magic, sizeof(magic), 0)) &&
+                                     (0 == std::memcmp(magic, "CVTKCAP", sizeof(magic)));
+
+                direction_ = options.direction;
+
+                if (capture)
+                {
+                    timed_ = (CAVE_TALK_ERROR_NONE == CaveTalk_CaptureReaderOpen(&reader_, options.path.c_str()));
+                    opened = timed_;
+                    size_  = reader_.map_size;
+                }
+                else if (0 == status.st_size)
+                {
+                    opened = true;
+                }
+                else
+                {
+                    void *map = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+                    if (MAP_FAILED != map)
+                    {
+                        map_   = static_cast<const uint8_t *>(map);
+                        size_  = static_cast<std::size_t>(status.st_size);
+                        opened = true;
+                        madvise(map, size_, MADV_SEQUENTIAL);
+                    }
+                }
+            }
+
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+
+            return opened;
+        }
+
+        bool Timed(void) const
+        {
+            return timed_;
+        }
+
+        uint64_t Size(void) const
+        {
+            return size_;
+        }
+
+        std::vector<Chunk> Split(const std::size_t chunk_count) const
+        {
+            std::vector<Chunk> chunks;
+
+            if (timed_)
+            {
+                const uint64_t blocks = std::max<uint64_t>(kMinCaptureBlocks, (reader_.block_count + chunk_count - 1U) / chunk_count);
+
+                for (uint64_t block = 0U; block < reader_.block_count; block += blocks)
+                {
+                    chunks.push_back({BlockPosition(block), BlockPosition(std::min(block + blocks, reader_.block_count))});
+                }
+            }
+            else
+            {
+                const uint64_t bytes = std::max<uint64_t>(kMinRawChunkSize, (size_ + chunk_count - 1U) / chunk_count);
+
+                for (uint64_t position = 0U; position < size_; position += bytes)
+                {
+                    chunks.push_back({position, std::min<uint64_t>(position + bytes, size_)});
+                }
+            }
+
+            if (!chunks.empty())
+            {
+                chunks.back().end = UINT64_MAX;
+            }
+
+            return chunks;
+        }
+
+        /* Calls piece with the stream from position onwards until it returns false or the input ends */
+        void Walk(const uint64_t position, const Piece &piece) const
+        {
+            if (timed_)
+            {
+                CaveTalk_CaptureCursor_t cursor = {(position / reader_.block_size) - 1U, 0U};
+                CaveTalk_CaptureRecord_t record;
+                bool                     more   = true;
+
+                while (more && CaveTalk_CaptureNext(&reader_, &cursor, &record))
+                {
+                    const uint64_t begin = static_cast<uint64_t>(record.data - reader_.map);
+                    const uint64_t end   = begin + record.length;
+
+                    if ((direction_ == record.direction) && (end > position))
+                    {
+                        const uint64_t skip = (position > begin) ? (position - begin) : 0U;
+
+                        more = piece(record.data + skip, record.length - skip, begin + skip, record.timestamp);
+                    }
+                }
+            }
+            else
+            {
+                bool more = true;
+
+                for (uint64_t offset = position; more && (offset < size_); offset += kRawPieceSize)
+                {
+                    more = piece(map_ + offset, std::min<uint64_t>(kRawPieceSize, size_ - offset), offset, 0U);
+                }
+            }
+        }
+
+    private:
+        uint64_t BlockPosition(const uint64_t block) const
+        {
+            return (block + 1U) * reader_.block_size;
+        }
+
+        CaveTalk_CaptureReader_t    reader_    = {};
+        CaveTalk_CaptureDirection_t direction_ = CAVE_TALK_CAPTURE_DIRECTION_RX;
+        const uint8_t              *map_       = nullptr;
+        uint64_t                    size_      = 0U;
+        bool                        timed_     = false;
+};
+
+void ScanChunk(const Input &input, const uint64_t begin, const uint64_t end, Scan &scan)
+{
+    CaveTalk_FrameParser_t parser;
+    std::size_t            tail_frames = 0U;
+    bool                   done        = false;
+
+    CaveTalk_FrameParserInit(&parser, nullptr, 0U);
+
+    input.Walk(begin, [&](const uint8_t *data, std::size_t size, uint64_t position, CaveTalk_Microseconds_t timestamp) {
+        std::size_t offset = 0U;
+
+        while (!done && (offset < size))
+        {
+            std::size_t       consumed = 0U;
+            Event             event    = {0U, timestamp, CAVE_TALK_ERROR_NONE, 0U, 0U};
+            const CaveTalk_Error_t error = CaveTalk_FrameParse(&parser, data + offset, size - offset, &consumed, &event.id, &event.length);
+
+            offset += consumed;
+
+            if (CAVE_TALK_ERROR_INCOMPLETE != error)
+            {
+                event.error = error;
+                event.end   = position + offset;
+
+                if (event.end >= end)
+                {
+                    scan.tail.push_back(event);
+                    if (CAVE_TALK_ERROR_NONE == error)
+                    {
+                        tail_frames++;
+                        done = (tail_frames >= kWindowEvents);
+                    }
+                }
+                else if (scan.window.size() < kWindowEvents)
+                {
+                    scan.window.push_back(event);
+                }
+                else
+                {
+                    scan.stats.Apply(event);
+                }
+            }
+        }
+
+        return !done;
+    });
+
+    scan.pending = CaveTalk_FrameParserPending(&parser);
+}
+
+bool FrameEnd(const Event &event)
+{
+    return CAVE_TALK_ERROR_NONE == event.error;
+}
+
+/* Folds the per chunk scans into stats in stream order, returns the number of trailing bytes of an incomplete frame */
+std::size_t MergeScans(const Options &options, const Input &input, const std::vector<Chunk> &chunks, std::vector<Scan> &scans, Stats &stats,
+                       std::size_t &rescans)
+{
+    std::vector<Event> tail;
+    std::size_t        pending = 0U;
+    bool               ended   = false;
+
+    for (std::size_t index = 0U; (index < scans.size()) && !ended; index++)
+    {
+        Scan &scan = scans[index];
+
+        if (0U == index)
+        {
+            for (const Event &event : scan.window)
+            {
+                stats.Apply(event);
+            }
+            stats.Merge(scan.stats);
+            tail    = std::move(scan.tail);
+            pending = scan.pending;
+            continue;
+        }
+
+        std::unordered_set<uint64_t> ends;
+
+        for (const std::vector<Event> *events : {&scan.window, &scan.tail})
+        {
+            for (const Event &event : *events)
+            {
+                if (FrameEnd(event))
+                {
+                    ends.insert(event.end);
+                }
+            }
+        }
+
+        const auto sync = std::find_if(tail.begin(), tail.end(), [&](const Event &event) {
+            return FrameEnd(event) && (0U != ends.count(event.end));
+        });
+
+        if (tail.end() != sync)
+        {
+            const uint64_t position = sync->end;
+            const auto     matches  = [&](const Event &event) {
+                return FrameEnd(event) && (position == event.end);
+            };
+            const auto     in_window = std::find_if(scan.window.begin(), scan.window.end(), matches);
+
+            std::for_each(tail.begin(), sync + 1, [&](const Event &event) {
+                stats.Apply(event);
+            });
+
+            if (scan.window.end() != in_window)
+            {
+                std::for_each(in_window + 1, scan.window.end(), [&](const Event &event) {
+                    stats.Apply(event);
+                });
+                stats.Merge(scan.stats);
+                tail = std::move(scan.tail);
+            }
+            else
+            {
+                /* The chunk was too short to synchronize before its end, only its tail is usable */
+                tail.assign(std::find_if(scan.tail.begin(), scan.tail.end(), matches) + 1, scan.tail.end());
+            }
+
+            pending = scan.pending;
+        }
+        else
+        {
+            const auto last = std::find_if(tail.rbegin(), tail.rend(), FrameEnd);
+
+            if (tail.rend() == last)
+            {
+                /* The previous chunk ran into the end of the input without completing another frame */
+                ended = true;
+            }
+            else
+            {
+                Scan rescan(options);
+
+                std::for_each(tail.begin(), last.base(), [&](const Event &event) {
+                    stats.Apply(event);
+                });
+
+                ScanChunk(input, last->end, chunks[index].end, rescan);
+                rescans++;
+
+                for (const Event &event : rescan.window)
+                {
+                    stats.Apply(event);
+                }
+                stats.Merge(rescan.stats);
+                tail    = std::move(rescan.tail);
+                pending = rescan.pending;
+            }
+        }
+    }
+
+    for (const Event &event : tail)
+    {
+        stats.Apply(event);
+    }
+
+    return pending;
+}
+
+const char *ErrorName(const CaveTalk_Error_t error)
+{
+    const char *name = "UNKNOWN";
+
+    switch (error)
+    {
+    case CAVE_TALK_ERROR_SIZE:
+        name = "SIZE";
+        break;
+    case CAVE_TALK_ERROR_CRC:
+        name = "CRC";
+        break;
+    case CAVE_TALK_ERROR_VERSION:
+        name = "VERSION";
+        break;
+    default:
+        break;
+    }
+
+    return name;
+}
+
+std::string IdName(const CaveTalk_Id_t id)
+{
+    std::string name = "UNKNOWN";
+
+    if (cave_talk::Id_IsValid(id))
+    {
+        name = cave_talk::Id_Name(static_cast<cave_talk::Id>(id));
+    }
+
+    return name;
+}
+
+void Stats::Report(const bool timed, const uint64_t trailing_bytes) const
+{
+    const double seconds = static_cast<double>(last_timestamp_ - first_timestamp_) / kMicrosecondsPerSecond;
+
+    std::printf("Frames:   %llu\n", static_cast<unsigned long long>(frames_));
+    std::printf("Errors:   %llu\n", static_cast<unsigned long long>(ErrorCount()));
+    std::printf("Trailing: %llu bytes of an incomplete frame\n", static_cast<unsigned long long>(trailing_bytes));
+    if (timed)
+    {
+        std::printf("Duration: %.6f s\n", seconds);
+    }
+
+    std::printf("\n%-4s %-20s %12s %12s %10s %5s %5s %5s %5s", "Id", "Name", "Frames", "Bytes", "Rate/s", "Min", "P50", "P99", "Max");
+    if (timed)
+    {
+        std::printf(" %10s %10s %10s %10s %10s", "IA P50 us", "IA P90 us", "IA P99 us", "IA P999 us", "Jitter us");
+    }
+    std::printf("\n");
+
+    for (const auto &[id, id_stats] : ids_)
+    {
+        std::size_t minimum = kIdCount;
+        std::size_t maximum = 0U;
+        std::size_t p50     = 0U;
+        std::size_t p99     = 0U;
+        uint64_t    seen    = 0U;
+
+        for (std::size_t size = 0U; size < kIdCount; size++)
+        {
+            if (0U != id_stats.sizes[size])
+            {
+                minimum = std::min(minimum, size);
+                maximum = std::max(maximum, size);
+                p50     = (seen <= ((id_stats.frames - 1U) / 2U)) ? size : p50;
+                p99     = (seen <= (((id_stats.frames - 1U) * 99U) / 100U)) ? size : p99;
+                seen   += id_stats.sizes[size];
+            }
+        }
+
+        std::printf("0x%02X %-20s %12llu %12llu ", id, IdName(id).c_str(), static_cast<unsigned long long>(id_stats.frames),
+                    static_cast<unsigned long long>(id_stats.bytes));
+        if (timed && (seconds > 0.0))
+        {
+            std::printf("%10.2f", static_cast<double>(id_stats.frames) / seconds);
+        }
+        else
+        {
+            std::printf("%10s", "-");
+        }
+        std::printf(" %5zu %5zu %5zu %5zu", minimum, p50, p99, maximum);
+        if (timed && (0U != id_stats.inter_arrival.Count()))
+        {
+            const uint64_t p50 = id_stats.inter_arrival.Percentile(50.0);
+            const uint64_t p99 = id_stats.inter_arrival.Percentile(99.0);
+
+            std::printf(" %10llu %10llu %10llu %10llu %10llu", static_cast<unsigned long long>(p50),
+                        static_cast<unsigned long long>(id_stats.inter_arrival.Percentile(90.0)), static_cast<unsigned long long>(p99),
+                        static_cast<unsigned long long>(id_stats.inter_arrival.Percentile(99.9)), static_cast<unsigned long long>(p99 - p50));
+        }
+        std::printf("\n");
+    }
+
+    if (!errors_.empty())
+    {
+        std::printf("\nErrors (resynchronized past one byte each):\n");
+        for (const auto &[error, count] : errors_)
+        {
+            std::printf("  %-8s %llu\n", ErrorName(error), static_cast<unsigned long long>(count));
+        }
+        std::printf("First errors:\n");
+        for (const Event &event : error_samples_)
+        {
+            std::printf("  %-8s at offset %llu", ErrorName(event.error), static_cast<unsigned long long>(event.end));
+            if (timed)
+            {
+                std::printf(", %llu us", static_cast<unsigned long long>(event.timestamp));
+            }
+            std::printf("\n");
+        }
+    }
+
+    if (options_->sizes)
+    {
+        std::printf("\nPayload sizes:\n");
+        for (const auto &[id, id_stats] : ids_)
+        {
+            for (std::size_t size = 0U; size < kIdCount; size++)
+            {
+                if (0U != id_stats.sizes[size])
+                {
+                    std::printf("  0x%02X %3zu bytes %12llu\n", id, size, static_cast<unsigned long long>(id_stats.sizes[size]));
+                }
+            }
+        }
+    }
+
+    if (timed && options_->rates)
+    {
+        std::printf("\nFrames per %llu us interval:\n", static_cast<unsigned long long>(options_->interval));
+        for (const auto &[key, count] : rates_)
+        {
+            std::printf("  %12llu us 0x%02X %10llu\n", static_cast<unsigned long long>(key.first * options_->interval), key.second,
+                        static_cast<unsigned long long>(count));
+        }
+    }
+}
+
+void Usage(const char *const program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options] FILE\n"
+                 "  FILE is a capture file or, with --raw or without a capture header, raw link bytes\n"
+                 "  --direction rx|tx  capture direction to analyze (default rx)\n"
+                 "  --raw              treat FILE as raw link bytes\n"
+                 "  --threads N        worker threads (default all cores)\n"
+                 "  --interval US      rate interval in microseconds (default 1000000)\n"
+                 "  --rates            print frames per interval and id\n"
+                 "  --sizes            print the payload size distribution\n",
+                 program);
+}
+
+bool ParseOptions(const int argc, char **argv, Options &options)
+{
+    bool valid = true;
+
+    for (int index = 1; valid && (index < argc); index++)
+    {
+        const std::string argument = argv[index];
+        const bool        has_value = (index + 1) < argc;
+
+        if ("--raw" == argument)
+        {
+            options.raw = true;
+        }
+        else if ("--rates" == argument)
+        {
+            options.rates = true;
+        }
+        else if ("--sizes" == argument)
+        {
+            options.sizes = true;
+        }
+        else if (("--direction" == argument) && has_value)
+        {
+            const std::string direction = argv[++index];
+
+            options.direction = ("tx" == direction) ? CAVE_TALK_CAPTURE_DIRECTION_TX : CAVE_TALK_CAPTURE_DIRECTION_RX;
+            valid             = ("tx" == direction) || ("rx" == direction);
+        }
+        else if (("--threads" == argument) && has_value)
+        {
+            options.threads = std::strtoull(argv[++index], nullptr, 0);
+        }
+        else if (("--interval" == argument) && has_value)
+        {
+            options.interval = std::strtoull(argv[++index], nullptr, 0);
+            valid            = (0U != options.interval);
+        }
+        else if (options.path.empty() && ('-' != argument.front()))
+        {
+            options.path = argument;
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    return valid && !options.path.empty();
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    Input   input;
+    int     status = EXIT_FAILURE;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        Usage(argv[0]);
+    }
+    else if (!input.Open(options))
+    {
+        std::fprintf(stderr, "Failed to open %s\n", options.path.c_str());
+    }
+    else
+    {
+        const std::size_t        threads = (0U != options.threads) ? options.threads : std::max(1U, std::thread::hardware_concurrency());
+        const std::vector<Chunk> chunks  = input.Split(threads * kChunksPerThread);
+        std::vector<Scan>        scans(chunks.size(), Scan(options));
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> next(0U);
+        Stats                    stats(options);
+        std::size_t              rescans = 0U;
+
+        for (std::size_t worker = 0U; worker < std::min(threads, chunks.size()); worker++)
+        {
+            workers.emplace_back([&]() {
+                for (std::size_t index = next++; index < chunks.size(); index = next++)
+                {
+                    ScanChunk(input, chunks[index].begin, chunks[index].end, scans[index]);
+                }
+            });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+
+        const std::size_t trailing_bytes = MergeScans(options, input, chunks, scans, stats, rescans);
+
+        std::printf("File:     %s (%s, %llu bytes, %zu chunks, %zu rescanned)\n", options.path.c_str(),
+                    input.Timed() ? ((CAVE_TALK_CAPTURE_DIRECTION_TX == options.direction) ? "capture tx" : "capture rx") : "raw",
+                    static_cast<unsigned long long>(input.Size()), chunks.size(), rescans);
+        stats.Report(input.Timed(), trailing_bytes);
+
+        status = EXIT_SUCCESS;
+    }
+
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ids.pb.h"
+
+#include "cave_talk_types.h"
+
+/* Turns a trace of the CAVeTalk tracepoints (see cave_talk_trace.h) into per stage latencies. The input is the output
+ * of perf script for the sdt_cave_talk events, recorded system wide so the speaking and the listening process are both
+ * in it, and timestamps are comparable as long as both run on the same host.
+ *
+ * Frames carry no sequence number, so events are matched per id in order: the oldest frame of an id that passed a
+ * probe and has not passed the next one yet is taken to be the one passing it now. Frames wrapped in others, such as
+ * reliable or fragmented ones, appear under their own id on the link and under the wrapped id in encode and the
+ * callbacks, so those stages are not matched for them. */
+
+namespace
+{
+
+constexpr std::size_t kProbeCount                = 7U;
+constexpr std::size_t kPendingMax                = 4096U;
+constexpr uint64_t    kNanosecondsPerSecond      = 1000000000U;
+constexpr double      kNanosecondsPerMicrosecond = 1000.0;
+
+constexpr std::array<const char *, kProbeCount> kProbeNames = {
+    "encode", "send", "header", "payload", "decode", "callback_entry", "callback_exit",
+};
+
+struct Options
+{
+    std::string path;
+    int         id = -1;
+};
+
+struct Event
+{
+    uint64_t      timestamp;
+    std::size_t   probe;
+    CaveTalk_Id_t id;
+};
+
+/* A frame that passed a probe, origin is when it was encoded if that was traced */
+struct Pending
+{
+    uint64_t timestamp;
+    uint64_t origin;
+    bool     encoded;
+};
+
+struct IdStages
+{
+    std::array<std::deque<Pending>, kProbeCount>   pending;
+    std::array<std::vector<uint64_t>, kProbeCount> latencies;
+    std::vector<uint64_t>                          total;
+    uint64_t                                       unmatched = 0U;
+    uint64_t                                       dropped   = 0U;
+};
+
+/* perf script prints "comm pid [cpu] seconds.fraction: sdt_cave_talk:probe: (address) arg1=id arg2=length" */
+bool ParseLine(const std::string &line, Event &event)
+{
+    const std::size_t provider = line.find("cave_talk:");
+    bool              valid    = false;
+
+    if (std::string::npos != provider)
+    {
+        const std::size_t name_begin = provider + std::string("cave_talk:").size();
+        const std::size_t name_end   = line.find(':', name_begin);
+        const std::size_t time_end   = line.rfind(':', provider);
+        const std::size_t time_begin = (std::string::npos == time_end) ? std::string::npos : line.rfind(' ', time_end);
+        const std::size_t arg1       = line.find("arg1=", name_begin);
+        const std::string name       = line.substr(name_begin, name_end - name_begin);
+        const auto        probe      = std::find(kProbeNames.begin(), kProbeNames.end(), name);
+
+        if ((std::string::npos != time_begin) && (std::string::npos != arg1) && (kProbeNames.end() != probe))
+        {
+            const std::string time     = line.substr(time_begin + 1U, time_end - time_begin - 1U);
+            const std::size_t point    = time.find('.');
+            std::string       fraction = (std::string::npos == point) ? "" : time.substr(point + 1U, 9U);
+
+            fraction.resize(9U, '0');
+
+            event.timestamp = (std::strtoull(time.c_str(), nullptr, 10) * kNanosecondsPerSecond) + std::strtoull(fraction.c_str(), nullptr, 10);
+            event.probe     = static_cast<std::size_t>(probe - kProbeNames.begin());
+            event.id        = static_cast<CaveTalk_Id_t>(std::strtoul(line.c_str() + arg1 + 5U, nullptr, 0));
+            valid           = true;
+        }
+    }
+
+    return valid;
+}
+
+void Record(IdStages &stages, const Event &event)
+{
+    Pending pending = {event.timestamp, event.timestamp, 0U == event.probe};
+
+    if (0U == event.probe)
+    {
+    }
+    else if (stages.pending[event.probe - 1U].empty())
+    {
+        stages.unmatched++;
+    }
+    else
+    {
+        const Pending previous = stages.pending[event.probe - 1U].front();
+
+        stages.pending[event.probe - 1U].pop_front();
+        stages.latencies[event.probe].push_back(event.timestamp - previous.timestamp);
+        pending.origin  = previous.origin;
+        pending.encoded = previous.encoded;
+    }
+
+    if ((kProbeCount - 1U) != event.probe)
+    {
+        stages.pending[event.probe].push_back(pending);
+
+        if (stages.pending[event.probe].size() > kPendingMax)
+        {
+            stages.pending[event.probe].pop_front();
+            stages.dropped++;
+        }
+    }
+    else if (pending.encoded)
+    {
+        stages.total.push_back(event.timestamp - pending.origin);
+    }
+    else
+    {
+    }
+}
+
+std::string IdName(const CaveTalk_Id_t id)
+{
+    std::string name = "UNKNOWN";
+
+    if (cave_talk::Id_IsValid(id))
+    {
+        name = cave_talk::Id_Name(static_cast<cave_talk::Id>(id));
+    }
+
+    return name;
+}
+
+/* In microseconds, latencies must be sorted */
+double Percentile(const std::vector<uint64_t> &latencies, const double fraction)
+{
+    const std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1U));
+
+    return static_cast<double>(latencies[index]) / kNanosecondsPerMicrosecond;
+}
+
+void ReportStage(const std::string &stage, std::vector<uint64_t> &latencies)
+{
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+
+        std::printf("  %-32s %10zu %10.3f %10.3f %10.3f %10.3f\n", stage.c_str(), latencies.size(), Percentile(latencies, 0.0),
+                    Percentile(latencies, 0.5), Percentile(latencies, 0.99), Percentile(latencies, 1.0));
+    }
+}
+
+void Report(std::map<CaveTalk_Id_t, IdStages> &ids)
+{
+    for (auto &[id, stages] : ids)
+    {
+        std::printf("Id 0x%02X %s\n", id, IdName(id).c_str());
+        std::printf("  %-32s %10s %10s %10s %10s %10s\n", "stage (us)", "frames", "min", "p50", "p99", "max");
+
+        for (std::size_t probe = 1U; probe < kProbeCount; probe++)
+        {
+            ReportStage(std::string(kProbeNames[probe - 1U]) + " -> " + kProbeNames[probe], stages.latencies[probe]);
+        }
+
+        ReportStage(std::string(kProbeNames.front()) + " -> " + kProbeNames.back(), stages.total);
+        std::printf("  unmatched %llu, dropped %llu\n", static_cast<unsigned long long>(stages.unmatched),
+                    static_cast<unsigned long long>(stages.dropped));
+    }
+}
+
+void Usage(const char *const program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options] [FILE]\n"
+                 "  FILE is the output of perf script for the sdt_cave_talk events, standard input without it\n"
+                 "  --id N  only report frames of id N\n",
+                 program);
+}
+
+bool ParseOptions(const int argc, char **argv, Options &options)
+{
+    bool valid = true;
+
+    for (int index = 1; valid && (index < argc); index++)
+    {
+        const std::string argument  = argv[index];
+        const bool        has_value = (index + 1) < argc;
+
+        if (("--id" == argument) && has_value)
+        {
+            options.id = static_cast<int>(std::strtol(argv[++index], nullptr, 0));
+            valid      = (options.id >= 0) && (options.id <= UINT8_MAX);
+        }
+        else if (options.path.empty() && ('-' != argument.front()))
+        {
+            options.path = argument;
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    int     status = EXIT_FAILURE;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        Usage(argv[0]);
+    }
+    else
+    {
+        std::ifstream                     file;
+        std::map<CaveTalk_Id_t, IdStages> ids;
+        std::string                       line;
+        Event                             event;
+        uint64_t                          events = 0U;
+
+        if (!options.path.empty())
+        {
+            file.open(options.path);
+        }
+
+        std::istream &input = options.path.empty() ? std::cin : file;
+
+        if (!input)
+        {
+            std::fprintf(stderr, "Failed to open %s\n", options.path.c_str());
+        }
+        else
+        {
+            while (std::getline(input, line))
+            {
+                if (ParseLine(line, event) && ((options.id < 0) || (options.id == event.id)))
+                {
+                    Record(ids[event.id], event);
+                    events++;
+                }
+            }
+
+            std::printf("Events:   %llu\n", static_cast<unsigned long long>(events));
+            Report(ids);
+
+            status = EXIT_SUCCESS;
+        }
+    }
+
+    return status;
+}
\ No newline at end of file